@@ -121,6 +121,7 @@ macro(InitializeFreeCADBuildOptions)
     option(BUILD_FEM "Build the FreeCAD FEM module" ON)
     option(BUILD_SANDBOX "Build the FreeCAD Sandbox module which is only for testing purposes" OFF)
     option(BUILD_TEMPLATE "Build the FreeCAD template module which is only for testing purposes" OFF)
+    option(BUILD_BENCHMARKS "Build the benchmark programs of the modules" OFF)
     option(BUILD_ADDONMGR "Build the FreeCAD addon manager module" ON)
     option(BUILD_ARCH "Build the FreeCAD Architecture module" ON)
     option(BUILD_ASSEMBLY "Build the FreeCAD Assembly module" OFF)
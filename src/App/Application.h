@@ -513,6 +513,11 @@ private:
     static PyObject *sGetActiveTransaction  (PyObject *self,PyObject *args);
     static PyObject *sCloseActiveTransaction(PyObject *self,PyObject *args);
     static PyObject *sCheckAbort(PyObject *self,PyObject *args);
+
+    static PyObject *sStartProfiling    (PyObject *self,PyObject *args);
+    static PyObject *sStopProfiling     (PyObject *self,PyObject *args);
+    static PyObject *sIsProfiling       (PyObject *self,PyObject *args);
+    static PyObject *sSaveProfile       (PyObject *self,PyObject *args);
     static PyMethodDef    Methods[];
 
     friend class ApplicationObserver;
@@ -43,6 +43,7 @@
 #include <Base/Console.h>
 #include <Base/Factory.h>
 #include <Base/FileInfo.h>
+#include <Base/Profiler.h>
 #include <Base/UnitsApi.h>
 #include <Base/Sequencer.h>
 
@@ -185,6 +186,19 @@ PyMethodDef Application::Methods[] = {
      "There is an active sequencer during document restore and recomputation. User may\n"
      "abort the operation by pressing the ESC key. Once detected, this function will\n"
      "trigger a BaseExceptionFreeCADAbort exception."},
+    {"startProfiling", (PyCFunction) Application::sStartProfiling, METH_VARARGS,
+     "startProfiling(capacity=0) -- start capturing timed zones, e.g. recomputes,\n"
+     "file saving and loading, tessellation and command execution.\n\n"
+     "capacity: maximum number of events kept, older events are overwritten once\n"
+     "          the limit is reached. 0 for the default.\n"
+     "Events of a previous capture are discarded."},
+    {"stopProfiling", (PyCFunction) Application::sStopProfiling, METH_VARARGS,
+     "stopProfiling() -> Int -- stop capturing and return the number of events kept"},
+    {"isProfiling", (PyCFunction) Application::sIsProfiling, METH_VARARGS,
+     "isProfiling() -> Bool -- Test if timed zones are captured"},
+    {"saveProfile", (PyCFunction) Application::sSaveProfile, METH_VARARGS,
+     "saveProfile(filename) -- save the captured events in Chrome trace format\n\n"
+     "The file can be loaded into chrome://tracing or https://ui.perfetto.dev"},
     {NULL, NULL, 0, NULL}		/* Sentinel */
 };
 
@@ -971,3 +985,53 @@ PyObject *Application::sCheckAbort(PyObject * /*self*/, PyObject *args)
         Py_Return;
     }PY_CATCH
 }
+
+PyObject *Application::sStartProfiling(PyObject * /*self*/, PyObject *args)
+{
+    int capacity = 0;
+    if (!PyArg_ParseTuple(args, "|i", &capacity))
+        return 0;
+
+    PY_TRY {
+        if (capacity < 0) {
+            PyErr_SetString(PyExc_ValueError, "Expect capacity to be non-negative");
+            return 0;
+        }
+        Base::Profiler::instance().start(static_cast<std::size_t>(capacity));
+        Py_Return;
+    }PY_CATCH
+}
+
+PyObject *Application::sStopProfiling(PyObject * /*self*/, PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+
+    PY_TRY {
+        return Py::new_reference_to(Py::Int(
+                    static_cast<long>(Base::Profiler::instance().stop())));
+    }PY_CATCH
+}
+
+PyObject *Application::sIsProfiling(PyObject * /*self*/, PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+
+    return Py::new_reference_to(Py::Boolean(Base::Profiler::isActive()));
+}
+
+PyObject *Application::sSaveProfile(PyObject * /*self*/, PyObject *args)
+{
+    char *filename;
+    if (!PyArg_ParseTuple(args, "et", "utf-8", &filename))
+        return 0;
+
+    std::string name(filename);
+    PyMem_Free(filename);
+
+    PY_TRY {
+        Base::Profiler::instance().exportChromeTrace(name.c_str());
+        Py_Return;
+    }PY_CATCH
+}
@@ -41,6 +41,7 @@
 
 namespace Base {
     class Writer;
+    class SequencerLauncher;
 }
 
 namespace App
@@ -401,8 +402,12 @@ public:
     /// Check if a transaction is open and its list is empty.
     /// If no transaction is open true is returned.
     bool isTransactionEmpty() const;
-    /// Set the Undo limit in Byte!
+    /** Set the Undo limit in Byte! The oldest transactions are discarded
+     * when the Undo/Redo stack uses more memory, 0 means no limit.
+     */
     void setUndoLimit(unsigned int UndoMemSize=0);
+    /// Returns the Undo limit in Byte
+    unsigned int getUndoLimit() const;
     /// Returns the actual memory consumption of the Undo redo stuff.
     unsigned int getUndoMemSize (void) const;
     /// Set the Undo limit as stack size
@@ -459,6 +464,15 @@ public:
     static std::vector<App::DocumentObject*> getDependencyList(
             const std::vector<App::DocumentObject*> &objs, int options=0);
 
+    /** Get the objects that depend on the given objects, including
+     * themselves, sorted in recompute order.
+     *
+     * It uses the cached dependency graph of the document, and therefore only
+     * visits the affected objects.
+     */
+    std::vector<App::DocumentObject*> getAffectedObjects(
+            const std::vector<App::DocumentObject*> &objs) const;
+
     std::vector<App::Document*> getDependentDocuments(bool sort=true);
     static std::vector<App::Document*> getDependentDocuments(std::vector<App::Document*> docs, bool sort);
 
@@ -522,6 +536,8 @@ protected:
     void _addObject(DocumentObject* pcObject, const char* pObjectName);
     /// checks if a valid transaction is open
     void _checkTransaction(DocumentObject* pcDelObj, const Property *What, int line);
+    /// keeps the undo/redo records of a property that is changed outside of a transaction
+    void _expandDeltas(const Property *What);
     void breakDependency(DocumentObject* pcObject, bool clear);
     std::vector<App::DocumentObject*> readObjects(Base::XMLReader& reader);
     void writeObjects(const std::vector<App::DocumentObject*>&, Base::Writer &writer) const;
@@ -536,11 +552,25 @@ protected:
     /// helper which Recompute only this feature
     /// @return 0 if succeeded, 1 if failed, -1 if aborted by user.
     int _recomputeFeature(DocumentObject* Feat);
+    /// helper which recomputes independent objects in parallel
+    /// @return 0 if succeeded, -1 if aborted by user.
+    int _recomputeParallel(const std::vector<App::DocumentObject*> &objs, size_t &idx,
+            std::set<App::DocumentObject*> &filter, int &objectCount, bool *hasError,
+            Base::SequencerLauncher *seq, int threads);
+    /// records a property change of an object recomputed in a worker thread
+    /// @return true if the signals of the change must not be sent now
+    static bool _deferPropertySignal(const DocumentObject *Who, const Property *What, bool before);
     void _clearRedos();
 
     /// refresh the internal dependency graph
     void _rebuildDependencyList(
         const std::vector<App::DocumentObject*> &objs = std::vector<App::DocumentObject*>());
+    /** Mark the cached recompute order as outdated
+     *
+     * @param obj: the object whose links have changed, or null to rebuild the
+     * whole order, e.g. after the document is cleared.
+     */
+    void _clearDependencyCache(const DocumentObject *obj=0);
 
     std::string getTransientDirectoryName(const std::string& uuid, const std::string& filename) const;
 
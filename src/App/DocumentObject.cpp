@@ -694,7 +694,9 @@ void DocumentObject::onBeforeChange(const Property* prop)
     if (_pDoc)
         onBeforeChangeProperty(_pDoc, prop);
 
-    signalBeforeChange(*this,*prop);
+    // signaled later by the document if recomputed in a worker thread
+    if (!Document::_deferPropertySignal(this,prop,true))
+        signalBeforeChange(*this,*prop);
 }
 
 /// get called by the container when a Property was changed
@@ -741,7 +743,11 @@ void DocumentObject::onChanged(const Property* prop)
     //call the parent for appropriate handling
     TransactionalObject::onChanged(prop);
 
-    // Now signal the view provider
+    // Now signal the view provider, or let the document do it later if
+    // recomputed in a worker thread
+    if (Document::_deferPropertySignal(this,prop,false))
+        return;
+
     if (_pDoc)
         _pDoc->onChangedProperty(this,prop);
 
@@ -752,6 +758,8 @@ void DocumentObject::clearOutListCache() const {
     _outList.clear();
     _outListMap.clear();
     _outListCached = false;
+    if(_pDoc)
+        _pDoc->_clearDependencyCache(this);
 }
 
 PyObject *DocumentObject::getPyObject(void)
@@ -403,6 +403,15 @@ public:
     /* Return true to bypass duplicate label checking */
     virtual bool allowDuplicateLabel() const {return false;}
 
+    /* Return true if execute() may run in a worker thread
+     *
+     * This is used when the document parameter ParallelRecompute is set. The
+     * object must then only read its dependencies and change its own
+     * properties during execute(), and must not use Python, the GUI or a
+     * progress indicator. Other objects are recomputed in the main thread.
+     */
+    virtual bool canRecomputeInThread() const {return false;}
+
     /*** Called to let object itself control relabeling
      *
      * @param newLabel: input as the new label, which can be modified by object itself
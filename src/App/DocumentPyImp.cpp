@@ -654,6 +654,19 @@ Py::Int DocumentPy::getUndoRedoMemSize(void) const
     return Py::Int((long)getDocumentPtr()->getUndoMemSize());
 }
 
+Py::Int DocumentPy::getUndoLimit(void) const
+{
+    return Py::Int((long)getDocumentPtr()->getUndoLimit());
+}
+
+void DocumentPy::setUndoLimit(Py::Int arg)
+{
+    long limit = arg;
+    if (limit < 0)
+        throw Py::ValueError("Undo limit must not be negative");
+    getDocumentPtr()->setUndoLimit(static_cast<unsigned int>(limit));
+}
+
 Py::Int DocumentPy::getUndoCount(void) const
 {
     return Py::Int((long)getDocumentPtr()->getAvailableUndos());
@@ -821,6 +834,47 @@ PyObject* DocumentPy::getLinksTo(PyObject *args)
     } PY_CATCH
 }
 
+PyObject* DocumentPy::getAffectedObjects(PyObject *args)
+{
+    PyObject *pyobj;
+    if (!PyArg_ParseTuple(args, "O", &pyobj))
+        return NULL;
+
+    std::vector<DocumentObject*> objs;
+    if (PySequence_Check(pyobj)) {
+        Py::Sequence seq(pyobj);
+        for (Py_ssize_t i=0;i<seq.size();++i) {
+            if (!PyObject_TypeCheck(seq[i].ptr(),&DocumentObjectPy::Type)) {
+                PyErr_SetString(PyExc_TypeError, "Expect element in sequence to be of type document object");
+                return 0;
+            }
+            objs.push_back(static_cast<DocumentObjectPy*>(seq[i].ptr())->getDocumentObjectPtr());
+        }
+    }
+    else if (!PyObject_TypeCheck(pyobj,&DocumentObjectPy::Type)) {
+        PyErr_SetString(PyExc_TypeError,
+            "Expect argument to be either a document object or sequence of document objects");
+        return 0;
+    }
+    else
+        objs.push_back(static_cast<DocumentObjectPy*>(pyobj)->getDocumentObjectPtr());
+
+    for (auto obj : objs) {
+        if (obj->getDocument() != getDocumentPtr()) {
+            PyErr_SetString(PyExc_ValueError, "Expect objects of this document");
+            return 0;
+        }
+    }
+
+    PY_TRY {
+        auto ret = getDocumentPtr()->getAffectedObjects(objs);
+        Py::List list;
+        for (auto obj : ret)
+            list.append(Py::Object(obj->getPyObject(),true));
+        return Py::new_reference_to(list);
+    } PY_CATCH
+}
+
 Py::List DocumentPy::getInList(void) const
 {
     Py::List ret;
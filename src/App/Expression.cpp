@@ -2094,20 +2094,31 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const std
         return res;
     }
 
-    Py::Object e1 = args[0]->getPyValue();
-    Quantity v1 = pyToQuantity(e1,expr,"Invalid first argument.");
-    Py::Object e2;
+    static const char *msgs[] = {
+        "Invalid first argument.",
+        "Invalid second argument.",
+        "Invalid third argument.",
+    };
+    Quantity values[3];
+    std::size_t count = std::min<std::size_t>(args.size(), 3);
+    for(std::size_t i=0; i<count; ++i)
+        values[i] = pyToQuantity(args[i]->getPyValue(),expr,msgs[i]);
+    return Py::asObject(new QuantityPy(new Quantity(evaluateQuantity(expr,f,values,count))));
+}
+
+Quantity FunctionExpression::evaluateQuantity(const Expression *expr, int f,
+        const Quantity *args, std::size_t count)
+{
+    if(!count)
+        _EXPR_THROW("Function requires at least one argument.",expr);
+
+    const Quantity &v1 = args[0];
     Quantity v2;
-    if(args.size()>1) {
-        e2 = args[1]->getPyValue();
-        v2 = pyToQuantity(e2,expr,"Invalid second argument.");
-    }
-    Py::Object e3;
+    if(count>1)
+        v2 = args[1];
     Quantity v3;
-    if(args.size()>2) {
-        e3 = args[2]->getPyValue();
-        v3 = pyToQuantity(e3,expr,"Invalid third argument.");
-    }
+    if(count>2)
+        v3 = args[2];
 
     double output;
     Unit unit;
@@ -2178,7 +2189,7 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const std
         break;
     }
     case ATAN2:
-        if (e2.isNone())
+        if (count<2)
             _EXPR_THROW("Invalid second argument.",expr);
 
         if (v1.getUnit() != v2.getUnit())
@@ -2187,12 +2198,12 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const std
         scaler = 180.0 / M_PI;
         break;
     case MOD:
-        if (e2.isNone())
+        if (count<2)
             _EXPR_THROW("Invalid second argument.",expr);
         unit = v1.getUnit() / v2.getUnit();
         break;
     case POW: {
-        if (e2.isNone())
+        if (count<2)
             _EXPR_THROW("Invalid second argument.",expr);
 
         if (!v2.getUnit().isEmpty())
@@ -2210,17 +2221,13 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const std
     }
     case HYPOT:
     case CATH:
-        if (e2.isNone())
+        if (count<2)
             _EXPR_THROW("Invalid second argument.",expr);
         if (v1.getUnit() != v2.getUnit())
             _EXPR_THROW("Units must be equal.",expr);
 
-        if (args.size() > 2) {
-            if (e3.isNone())
-                _EXPR_THROW("Invalid second argument.",expr);
-            if (v2.getUnit() != v3.getUnit())
-                _EXPR_THROW("Units must be equal.",expr);
-        }
+        if (count > 2 && v2.getUnit() != v3.getUnit())
+            _EXPR_THROW("Units must be equal.",expr);
         unit = v1.getUnit();
         break;
     default:
@@ -2284,11 +2291,11 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const std
         break;
     }
     case HYPOT: {
-        output = sqrt(pow(v1.getValue(), 2) + pow(v2.getValue(), 2) + (!e3.isNone() ? pow(v3.getValue(), 2) : 0));
+        output = sqrt(pow(v1.getValue(), 2) + pow(v2.getValue(), 2) + (count>2 ? pow(v3.getValue(), 2) : 0));
         break;
     }
     case CATH: {
-        output = sqrt(pow(v1.getValue(), 2) - pow(v2.getValue(), 2) - (!e3.isNone() ? pow(v3.getValue(), 2) : 0));
+        output = sqrt(pow(v1.getValue(), 2) - pow(v2.getValue(), 2) - (count>2 ? pow(v3.getValue(), 2) : 0));
         break;
     }
     case ROUND:
@@ -2307,7 +2314,7 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const std
         _EXPR_THROW("Unknown function: " << f,expr);
     }
 
-    return Py::asObject(new QuantityPy(new Quantity(scaler * output, unit)));
+    return Quantity(scaler * output, unit);
 }
 
 Py::Object FunctionExpression::_getPyValue() const {
@@ -0,0 +1,601 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <cmath>
+#endif
+
+#include <Base/Interpreter.h>
+#include <Base/Quantity.h>
+#include <Base/QuantityPy.h>
+#include "Document.h"
+#include "DocumentObject.h"
+#include "ExpressionCompiler.h"
+#include "ExpressionParser.h"
+#include "PropertyStandard.h"
+#include "PropertyUnits.h"
+
+using namespace App;
+using namespace Base;
+
+// Largest integer a double holds exactly. Python integers are unbounded, so
+// anything beyond is left to Python.
+static const double MaxExactInteger = 9007199254740992.0;
+
+static inline bool isExactInteger(double v) {
+    double intpart;
+    return std::modf(v,&intpart) == 0.0 && std::fabs(intpart) <= MaxExactInteger;
+}
+
+// Python's float remainder, which takes the sign of the divisor
+static inline double pyMod(double a, double b) {
+    double res = std::fmod(a,b);
+    if(res != 0.0) {
+        if((b < 0) != (res < 0))
+            res += b;
+    } else
+        res = std::copysign(0.0,b);
+    return res;
+}
+
+std::unique_ptr<CompiledExpression> CompiledExpression::compile(const Expression *expr)
+{
+    std::unique_ptr<CompiledExpression> res;
+    if(!expr || !expr->getOwner() || !expr->getOwner()->getDocument())
+        return res;
+
+    res.reset(new CompiledExpression);
+    res->expression = expr;
+    res->document = expr->getOwner()->getDocument();
+    if(!res->compileNode(expr))
+        res.reset();
+    else
+        res->stack.reserve(res->maxDepth);
+    return res;
+}
+
+void CompiledExpression::emit(OpCode opcode, int op, int arg)
+{
+    Instruction ins;
+    ins.code = opcode;
+    ins.op = op;
+    ins.arg = arg;
+    code.push_back(ins);
+
+    switch(opcode) {
+    case OpConst:
+    case OpLoad:
+    case OpPython:
+        ++depth;
+        break;
+    case OpBinary:
+    case OpJumpIfFalse:
+        --depth;
+        break;
+    case OpCall:
+        depth -= arg - 1;
+        break;
+    default:
+        break;
+    }
+    if(depth > maxDepth)
+        maxDepth = depth;
+}
+
+/** Compiles \a expr and its children
+ *
+ * @return false if the node has to be evaluated by Python. In this case
+ * nothing is emitted, and it is up to the caller to either emit an OpPython
+ * instruction, or to give up.
+ */
+bool CompiledExpression::compileNode(const Expression *expr)
+{
+    // Components, e.g. '.x' or '[0]', work on Python objects
+    if(expr->hasComponent())
+        return false;
+
+    Base::Type type = expr->getTypeId();
+
+    if(type == UnitExpression::getClassTypeId()
+            || type == NumberExpression::getClassTypeId()
+            || type == ConstantExpression::getClassTypeId())
+    {
+        auto uexpr = static_cast<const UnitExpression*>(expr);
+        Value value;
+        value.value = uexpr->getValue();
+        value.unit = uexpr->getUnit();
+        if(type == ConstantExpression::getClassTypeId()
+                && !static_cast<const ConstantExpression*>(expr)->isNumber())
+        {
+            std::string name = static_cast<const ConstantExpression*>(expr)->getName();
+            if(name == "True")
+                value.value = 1.0;
+            else if(name == "False")
+                value.value = 0.0;
+            else
+                return false;
+            value.unit = Unit();
+            value.kind = KindBool;
+        }
+        // Same conversion as pyFromQuantity()
+        else if(!value.unit.isEmpty())
+            value.kind = KindQuantity;
+        else if(isExactInteger(value.value))
+            value.kind = KindInt;
+        else {
+            double intpart;
+            if(std::modf(value.value,&intpart) == 0.0)
+                return false;
+            value.kind = KindFloat;
+        }
+        constants.push_back(value);
+        emit(OpConst, 0, static_cast<int>(constants.size()-1));
+        return true;
+    }
+
+    if(type == VariableExpression::getClassTypeId())
+        return compileVariable(expr);
+
+    if(type == OperatorExpression::getClassTypeId()) {
+        auto oexpr = static_cast<const OperatorExpression*>(expr);
+        int op = oexpr->getOperator();
+        switch(op) {
+        case OperatorExpression::NEG:
+        case OperatorExpression::POS:
+            if(!compileNode(oexpr->getLeft()))
+                return false;
+            emit(OpUnary, op);
+            return true;
+        case OperatorExpression::NONE:
+            return false;
+        default:
+            break;
+        }
+        std::size_t start = code.size();
+        bool left = compileNode(oexpr->getLeft());
+        if(!left) {
+            // Keep the evaluation order of the Python implementation
+            emit(OpPython, 0, static_cast<int>(nodes.size()));
+            nodes.push_back(oexpr->getLeft());
+        }
+        bool right = compileNode(oexpr->getRight());
+        if(!right) {
+            if(!left) {
+                // Nothing native in here, let Python do it as a whole
+                code.resize(start);
+                nodes.pop_back();
+                --depth;
+                return false;
+            }
+            emit(OpPython, 0, static_cast<int>(nodes.size()));
+            nodes.push_back(oexpr->getRight());
+        }
+        emit(OpBinary, op);
+        return true;
+    }
+
+    if(type == ConditionalExpression::getClassTypeId()) {
+        auto cexpr = static_cast<const ConditionalExpression*>(expr);
+        const Expression *children[] = {
+            cexpr->getCondition(),
+            cexpr->getTrueExpression(),
+            cexpr->getFalseExpression(),
+        };
+        std::size_t start = code.size();
+        std::size_t nodeCount = nodes.size();
+        std::size_t startDepth = depth;
+        bool native = false;
+        std::size_t jumps[2];
+        for(int i=0; i<3; ++i) {
+            // The false branch starts at the same stack depth as the true one
+            if(i == 2)
+                depth = startDepth;
+            if(compileNode(children[i]))
+                native = true;
+            else {
+                emit(OpPython, 0, static_cast<int>(nodes.size()));
+                nodes.push_back(children[i]);
+            }
+            if(i < 2) {
+                jumps[i] = code.size();
+                emit(i == 0 ? OpJumpIfFalse : OpJump);
+            }
+        }
+        if(!native) {
+            code.resize(start);
+            nodes.resize(nodeCount);
+            depth = startDepth;
+            return false;
+        }
+        code[jumps[0]].arg = static_cast<int>(jumps[1] + 1);
+        code[jumps[1]].arg = static_cast<int>(code.size());
+        return true;
+    }
+
+    if(type == FunctionExpression::getClassTypeId()) {
+        auto fexpr = static_cast<const FunctionExpression*>(expr);
+        int f = fexpr->getFunction();
+        const auto &args = fexpr->getArgs();
+        if(f < FunctionExpression::ACOS || f > FunctionExpression::CATH || args.empty())
+            return false;
+        // Same as FunctionExpression::evaluate(), only the first three
+        // arguments are evaluated.
+        std::size_t count = std::min<std::size_t>(args.size(), 3);
+        for(std::size_t i=0; i<count; ++i) {
+            if(!compileNode(args[i])) {
+                emit(OpPython, 0, static_cast<int>(nodes.size()));
+                nodes.push_back(args[i]);
+            }
+        }
+        emit(OpCall, f, static_cast<int>(count));
+        return true;
+    }
+
+    return false;
+}
+
+/** Resolves a reference to a simple numeric property into a handle
+ *
+ * Only references by internal object name without sub-object or sub-path
+ * are resolved. Anything else may resolve differently over time, and is
+ * left to ObjectIdentifier.
+ */
+bool CompiledExpression::compileVariable(const Expression *expr)
+{
+    ObjectIdentifier path = static_cast<const VariableExpression*>(expr)->getPath();
+    if(path.getSubObjectName().size()
+            || path.getDocumentObjectName().isRealString()
+            || path.getDocumentName().getString().size())
+        return false;
+
+    // ptype is non zero for pseudo properties, e.g. '_shape'
+    int ptype;
+    Property *prop = path.getProperty(&ptype);
+    if(!prop || ptype || path.numSubComponents() != 1)
+        return false;
+
+    auto obj = Base::freecad_dynamic_cast<DocumentObject>(prop->getContainer());
+    if(!obj || !obj->getNameInDocument() || obj->getDocument() != document)
+        return false;
+
+    const std::string &objName = path.getDocumentObjectName().getString();
+    if(objName.size() && objName != obj->getNameInDocument())
+        return false;
+
+    Handle handle;
+    handle.id = obj->getID();
+    handle.name = path.getPropertyName();
+    handle.type = prop->getTypeId();
+    if(obj->getPropertyByName(handle.name.c_str()) != prop)
+        return false;
+
+    if(prop->isDerivedFrom(PropertyQuantity::getClassTypeId()))
+        handle.kind = KindQuantity;
+    else if(prop->isDerivedFrom(PropertyFloat::getClassTypeId()))
+        handle.kind = KindFloat;
+    else if(prop->isDerivedFrom(PropertyInteger::getClassTypeId()))
+        handle.kind = KindInt;
+    else if(prop->isDerivedFrom(PropertyBool::getClassTypeId()))
+        handle.kind = KindBool;
+    else
+        return false;
+
+    handles.push_back(handle);
+    emit(OpLoad, 0, static_cast<int>(handles.size()-1));
+    return true;
+}
+
+bool CompiledExpression::load(const Handle &handle, Value &value) const
+{
+    auto obj = document->getObjectByID(handle.id);
+    if(!obj)
+        return false;
+    auto prop = obj->getPropertyByName(handle.name.c_str());
+    if(!prop || prop->getTypeId() != handle.type)
+        return false;
+
+    value.kind = handle.kind;
+    value.unit = Unit();
+    switch(handle.kind) {
+    case KindQuantity:
+        value.value = static_cast<PropertyQuantity*>(prop)->getValue();
+        value.unit = static_cast<PropertyQuantity*>(prop)->getUnit();
+        break;
+    case KindFloat:
+        value.value = static_cast<PropertyFloat*>(prop)->getValue();
+        break;
+    case KindInt: {
+        long l = static_cast<PropertyInteger*>(prop)->getValue();
+        value.value = static_cast<double>(l);
+        if(std::fabs(value.value) > MaxExactInteger)
+            return false;
+        break;
+    }
+    case KindBool:
+        value.value = static_cast<PropertyBool*>(prop)->getValue() ? 1.0 : 0.0;
+        break;
+    }
+    return true;
+}
+
+bool CompiledExpression::fromPython(const Expression *expr, Value &value) const
+{
+    Base::PyGILStateLocker lock;
+    Py::Object pyobj = expr->getPyValue();
+    PyObject *obj = pyobj.ptr();
+    value.unit = Unit();
+    if(PyObject_TypeCheck(obj, &QuantityPy::Type)) {
+        const Quantity *q = static_cast<QuantityPy*>(obj)->getQuantityPtr();
+        value.value = q->getValue();
+        value.unit = q->getUnit();
+        value.kind = KindQuantity;
+    } else if(PyBool_Check(obj)) {
+        value.value = obj == Py_True ? 1.0 : 0.0;
+        value.kind = KindBool;
+    } else if(PyFloat_Check(obj)) {
+        value.value = PyFloat_AsDouble(obj);
+        value.kind = KindFloat;
+#if PY_MAJOR_VERSION < 3
+    } else if(PyInt_Check(obj)) {
+        value.value = static_cast<double>(PyInt_AsLong(obj));
+        value.kind = KindInt;
+#endif
+    } else if(PyLong_Check(obj)) {
+        int overflow = 0;
+        long l = PyLong_AsLongAndOverflow(obj,&overflow);
+        value.value = static_cast<double>(l);
+        value.kind = KindInt;
+        if(overflow || std::fabs(value.value) > MaxExactInteger) {
+            disabled = true;
+            return false;
+        }
+    } else {
+        // Most likely a string or some other object, which will not change
+        // with the next evaluation either.
+        disabled = true;
+        return false;
+    }
+    return true;
+}
+
+bool CompiledExpression::isTrue(const Value &value)
+{
+    return value.value != 0.0;
+}
+
+bool CompiledExpression::unary(int op, Value &value)
+{
+    if(op == OperatorExpression::NEG)
+        value.value = -value.value;
+    if(value.kind == KindBool)
+        value.kind = KindInt;
+    return true;
+}
+
+/** Applies a binary operator with the same semantics as Python
+ *
+ * Quantities follow QuantityPy, plain numbers follow Python's int and float.
+ * Cases that raise an exception in Python are rejected, so that the caller
+ * can report the error through the expression.
+ */
+bool CompiledExpression::binary(int op, Value &left, const Value &right)
+{
+    bool quantity = left.kind == KindQuantity || right.kind == KindQuantity;
+    bool integer = (left.kind == KindInt || left.kind == KindBool)
+                && (right.kind == KindInt || right.kind == KindBool);
+
+    switch(op) {
+    case OperatorExpression::EQ:
+    case OperatorExpression::NEQ:
+    case OperatorExpression::LT:
+    case OperatorExpression::LTE:
+    case OperatorExpression::GT:
+    case OperatorExpression::GTE: {
+        bool res;
+        if(left.kind == KindQuantity && right.kind == KindQuantity) {
+            bool eq = left.value == right.value && left.unit == right.unit;
+            if(op == OperatorExpression::EQ)
+                res = eq;
+            else if(op == OperatorExpression::NEQ)
+                res = !eq;
+            else {
+                if(left.unit != right.unit)
+                    return false;
+                bool lt = left.value < right.value;
+                if(op == OperatorExpression::LT)
+                    res = lt;
+                else if(op == OperatorExpression::LTE)
+                    res = lt || eq;
+                else if(op == OperatorExpression::GT)
+                    res = !lt && !eq;
+                else
+                    res = !lt;
+            }
+        } else {
+            double a = left.value;
+            double b = right.value;
+            switch(op) {
+            case OperatorExpression::EQ: res = a == b; break;
+            case OperatorExpression::NEQ: res = a != b; break;
+            case OperatorExpression::LT: res = a < b; break;
+            case OperatorExpression::LTE: res = a <= b; break;
+            case OperatorExpression::GT: res = a > b; break;
+            default: res = a >= b; break;
+            }
+        }
+        left.value = res ? 1.0 : 0.0;
+        left.unit = Unit();
+        left.kind = KindBool;
+        return true;
+    }
+    case OperatorExpression::ADD:
+    case OperatorExpression::SUB:
+        if(quantity && left.unit != right.unit)
+            return false;
+        if(op == OperatorExpression::ADD)
+            left.value += right.value;
+        else
+            left.value -= right.value;
+        break;
+    case OperatorExpression::MUL:
+    case OperatorExpression::UNIT:
+        left.value *= right.value;
+        if(quantity)
+            left.unit = left.unit * right.unit;
+        break;
+    case OperatorExpression::DIV:
+        if(!quantity && right.value == 0.0)
+            return false;
+        left.value /= right.value;
+        if(quantity)
+            left.unit = left.unit / right.unit;
+        integer = false;
+        break;
+    case OperatorExpression::MOD:
+        if((quantity && left.kind != KindQuantity) || right.value == 0.0)
+            return false;
+        left.value = pyMod(left.value, right.value);
+        break;
+    case OperatorExpression::POW:
+        if(quantity) {
+            if(left.kind != KindQuantity)
+                return false;
+            Quantity q(left.value, left.unit);
+            if(right.kind == KindQuantity) {
+                if(!right.unit.isEmpty())
+                    return false;
+                q = q.pow(Quantity(right.value));
+            } else
+                q = q.pow(right.value);
+            left.value = q.getValue();
+            left.unit = q.getUnit();
+            return true;
+        }
+        if(left.value == 0.0 && right.value < 0.0)
+            return false;
+        if(left.value < 0.0 && !integer && !isExactInteger(right.value))
+            return false;
+        if(integer && right.value < 0.0)
+            integer = false;
+        left.value = std::pow(left.value, right.value);
+        break;
+    default:
+        return false;
+    }
+
+    if(quantity)
+        left.kind = KindQuantity;
+    else if(integer) {
+        if(std::fabs(left.value) > MaxExactInteger)
+            return false;
+        left.kind = KindInt;
+    } else
+        left.kind = KindFloat;
+    return true;
+}
+
+bool CompiledExpression::evaluate(App::any &res) const
+{
+    if(disabled)
+        return false;
+
+    stack.clear();
+    try {
+        for(int pc=0, count=static_cast<int>(code.size()); pc<count; ++pc) {
+            const Instruction &ins = code[pc];
+            switch(ins.code) {
+            case OpConst:
+                stack.push_back(constants[ins.arg]);
+                break;
+            case OpLoad:
+                stack.emplace_back();
+                if(!load(handles[ins.arg], stack.back()))
+                    return false;
+                break;
+            case OpPython:
+                stack.emplace_back();
+                if(!fromPython(nodes[ins.arg], stack.back()))
+                    return false;
+                break;
+            case OpUnary:
+                if(!unary(ins.op, stack.back()))
+                    return false;
+                break;
+            case OpBinary: {
+                Value right = stack.back();
+                stack.pop_back();
+                if(!binary(ins.op, stack.back(), right))
+                    return false;
+                break;
+            }
+            case OpCall: {
+                Quantity args[3];
+                std::size_t first = stack.size() - ins.arg;
+                for(int i=0; i<ins.arg; ++i) {
+                    const Value &v = stack[first+i];
+                    args[i] = Quantity(v.value, v.unit);
+                }
+                stack.resize(first+1);
+                Quantity q = FunctionExpression::evaluateQuantity(
+                        expression, ins.op, args, static_cast<std::size_t>(ins.arg));
+                Value &v = stack.back();
+                v.value = q.getValue();
+                v.unit = q.getUnit();
+                v.kind = KindQuantity;
+                break;
+            }
+            case OpJump:
+                pc = ins.arg - 1;
+                break;
+            case OpJumpIfFalse: {
+                bool cond = isTrue(stack.back());
+                stack.pop_back();
+                if(!cond)
+                    pc = ins.arg - 1;
+                break;
+            }
+            }
+        }
+    } catch (Base::Exception &) {
+        // Unit errors and the like are reported by the expression itself
+        // with the proper context.
+        return false;
+    }
+
+    assert(stack.size() == 1);
+    const Value &v = stack.back();
+    // Same conversion as pyObjectToAny()
+    switch(v.kind) {
+    case KindQuantity:
+        res = Quantity(v.value, v.unit);
+        break;
+    case KindFloat:
+        res = v.value;
+        break;
+    default:
+        res = static_cast<long>(v.value);
+        break;
+    }
+    return true;
+}
@@ -0,0 +1,146 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef APP_EXPRESSIONCOMPILER_H
+#define APP_EXPRESSIONCOMPILER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <Base/Type.h>
+#include <Base/Unit.h>
+#include "Expression.h"
+
+namespace App
+{
+
+class Document;
+
+/** Flat, natively evaluated form of an Expression
+ *
+ * The expression tree is compiled into a postfix program working on a value
+ * stack. Numbers, units, operators, conditionals and the numeric functions
+ * are evaluated with plain doubles and Base::Unit, and references to simple
+ * Integer, Float, Bool and Quantity properties are resolved once into a
+ * handle of object ID, property name and type. Everything else, e.g. strings,
+ * Python objects, aggregates or sub-paths, is kept as a node evaluated
+ * through Expression::getPyValue().
+ *
+ * The result follows the Python semantics of Expression::getValueAsAny().
+ * Whenever the native evaluation can't guarantee that, e.g. on errors or
+ * non numeric intermediate values, evaluate() returns false and the caller
+ * is expected to fall back to the expression itself.
+ */
+class AppExport CompiledExpression
+{
+public:
+    /** Compiles the expression
+     *
+     * @return The compiled program, or null if there is nothing to gain from
+     * compiling it, e.g. because the expression is not numeric.
+     *
+     * The program keeps a reference to \a expr, which must stay alive and
+     * unchanged for as long as the program is used.
+     */
+    static std::unique_ptr<CompiledExpression> compile(const Expression *expr);
+
+    /** Evaluates the program
+     *
+     * @param res: receives the value in the same form as
+     * Expression::getValueAsAny()
+     *
+     * @return false if the value must be evaluated by the expression instead
+     */
+    bool evaluate(App::any &res) const;
+
+    /// Whether the program failed before on a value it can't represent
+    bool isDisabled() const { return disabled; }
+
+    /// Returns the number of instructions
+    std::size_t size() const { return code.size(); }
+
+private:
+    CompiledExpression() {}
+
+    enum Kind {
+        KindBool,
+        KindInt,
+        KindFloat,
+        KindQuantity,
+    };
+
+    struct Value {
+        double value;
+        Base::Unit unit;
+        Kind kind;
+    };
+
+    enum OpCode {
+        OpConst,
+        OpLoad,
+        OpPython,
+        OpUnary,
+        OpBinary,
+        OpCall,
+        OpJump,
+        OpJumpIfFalse,
+    };
+
+    struct Instruction {
+        OpCode code;
+        int op;
+        int arg;
+    };
+
+    struct Handle {
+        long id;
+        std::string name;
+        Base::Type type;
+        Kind kind;
+    };
+
+    bool compileNode(const Expression *expr);
+    bool compileVariable(const Expression *expr);
+    void emit(OpCode code, int op=0, int arg=0);
+
+    bool load(const Handle &handle, Value &value) const;
+    bool fromPython(const Expression *expr, Value &value) const;
+    static bool unary(int op, Value &value);
+    static bool binary(int op, Value &left, const Value &right);
+    static bool isTrue(const Value &value);
+
+private:
+    const Expression *expression = 0;
+    Document *document = 0;
+    std::vector<Instruction> code;
+    std::vector<Value> constants;
+    std::vector<Handle> handles;
+    std::vector<const Expression*> nodes;
+    std::size_t depth = 0;
+    std::size_t maxDepth = 0;
+    mutable std::vector<Value> stack;
+    mutable bool disabled = false;
+};
+
+} // namespace App
+
+#endif // APP_EXPRESSIONCOMPILER_H
@@ -219,6 +219,12 @@ public:
 
     virtual int priority() const override;
 
+    Expression * getCondition() const { return condition; }
+
+    Expression * getTrueExpression() const { return trueExpr; }
+
+    Expression * getFalseExpression() const { return falseExpr; }
+
 protected:
     virtual Expression * _copy() const override;
     virtual void _visit(ExpressionVisitor & v) override;
@@ -298,6 +304,20 @@ public:
 
     static Py::Object evaluate(const Expression *owner, int type, const std::vector<Expression*> &args);
 
+    /** Evaluates one of the numeric functions (ACOS to CATH)
+     *
+     * @param owner: the expression used for error reporting
+     * @param type: the function type
+     * @param args: the function arguments
+     * @param count: number of arguments, only the first three are used
+     */
+    static Base::Quantity evaluateQuantity(const Expression *owner, int type,
+            const Base::Quantity *args, std::size_t count);
+
+    Function getFunction() const { return f; }
+
+    const std::vector<Expression*> &getArgs() const { return args; }
+
 protected:
     static Py::Object evalAggregate(const Expression *owner, int type, const std::vector<Expression*> &args);
     virtual Py::Object _getPyValue() const override;
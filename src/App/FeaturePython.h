@@ -304,6 +304,11 @@ public:
         return FeatureT::canLoadPartial();
     }
 
+    /// Python code must run in the main thread
+    virtual bool canRecomputeInThread() const override {
+        return false;
+    }
+
     PyObject *getPyObject(void) override {
         if (FeatureT::PythonObject.is(Py::_None())) {
             // ref counter is set to 1
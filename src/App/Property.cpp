@@ -228,6 +228,16 @@ void Property::verifyPath(const ObjectIdentifier &p) const
     p.verify(*this);
 }
 
+std::shared_ptr<const Property> Property::Snapshot() const
+{
+    return std::shared_ptr<const Property>(Copy());
+}
+
+PropertyDelta *Property::Diff(const Property &) const
+{
+    return 0;
+}
+
 Property *Property::Copy(void) const
 {
     // have to be reimplemented by a subclass!
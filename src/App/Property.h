@@ -29,6 +29,7 @@
 #include <Base/Exception.h>
 #include <Base/Persistence.h>
 #include <boost/any.hpp>
+#include <memory>
 #include <string>
 #include <bitset>
 
@@ -40,6 +41,7 @@ namespace App
 {
 
 class PropertyContainer;
+class PropertyDelta;
 class ObjectIdentifier;
 
 /** Base class of all properties
@@ -75,6 +77,7 @@ public:
                       // relevant for the container using it
         EvalOnRestore = 14, // In case of expression binding, evaluate the
                             // expression on restore and touch the object on value change.
+        HasDelta = 15, // an undo/redo record of the property depends on its current value
 
         // The following bits are corresponding to PropertyType set when the
         // property added. These types are meant to be static, and cannot be
@@ -227,6 +230,19 @@ public:
     virtual Property *Copy(void) const = 0;
     /// Paste the value from the property (mainly for Undo/Redo and transactions)
     virtual void Paste(const Property &from) = 0;
+    /** Returns an immutable copy of the property that can be read by another thread
+     * while this property is changed, e.g. to save it in the background. It must be
+     * called in the thread that owns the property. The default implementation returns
+     * Copy(). Properties with big values share them with their snapshots and only
+     * copy them when they are modified.
+     */
+    virtual std::shared_ptr<const Property> Snapshot() const;
+    /** Returns a delta that restores the value of \a from, a snapshot of this
+     * property taken before it was changed. It is used to keep undo/redo records
+     * of big properties small. The default implementation returns null, and so
+     * does a property if the delta isn't smaller than the snapshot itself.
+     */
+    virtual PropertyDelta *Diff(const Property &from) const;
 
     /// Called when a child property has changed value
     virtual void hasSetChildValue(Property &) {}
@@ -530,8 +546,29 @@ protected:
 
     virtual T getPyValue(PyObject *item) const = 0;
 
+public:
+    /// All snapshots share one copy of the list until it's changed
+    virtual std::shared_ptr<const Property> Snapshot() const override {
+        if (!_snapshot)
+            _snapshot = parent_type::Snapshot();
+        return _snapshot;
+    }
+
+protected:
+    virtual void aboutToSetValue(void) override {
+        _snapshot.reset();
+        parent_type::aboutToSetValue();
+    }
+    virtual void hasSetValue(void) override {
+        _snapshot.reset();
+        parent_type::hasSetValue();
+    }
+
 protected:
     ListT _lValueList;
+
+private:
+    mutable std::shared_ptr<const Property> _snapshot;
 };
 
 } // namespace App
@@ -0,0 +1,217 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef APP_PROPERTYDELTA_H
+#define APP_PROPERTYDELTA_H
+
+#include <functional>
+#include <utility>
+#include <vector>
+#include <Base/Exception.h>
+#include <Base/Vector3D.h>
+#include "Material.h"
+#include "Property.h"
+
+namespace App
+{
+
+/** Compact undo/redo record of a property change
+ *
+ * A delta is created by Property::Diff() and only holds the parts of the
+ * value that were changed. Applying it to the property restores the value
+ * the property had before the change.
+ */
+class AppExport PropertyDelta
+{
+public:
+    virtual ~PropertyDelta() {}
+
+    /** Restores the recorded value of the property
+     *
+     * It throws without changing the property if it doesn't have the value
+     * the delta was created from. The document replaces a delta by the full
+     * value before the property is changed outside of a transaction, see
+     * Transaction::expandDelta().
+     */
+    virtual void apply(Property &prop) const = 0;
+
+    /// Returns the memory used by the record
+    virtual unsigned int getMemSize() const = 0;
+
+    /// Combines the hash \a value into \a seed
+    static void hashCombine(std::size_t &seed, std::size_t value) {
+        seed ^= value + 0x9e3779b9 + (seed<<6) + (seed>>2);
+    }
+};
+
+/// Compares and hashes array elements for PropertyArrayDelta
+template<class T>
+struct PropertyArrayTraits
+{
+    static bool equal(const T &a, const T &b) {
+        return a == b;
+    }
+    static std::size_t hash(const T &v) {
+        return std::hash<T>()(v);
+    }
+};
+
+/// Vectors are compared exactly, Vector3::operator==() uses a tolerance
+template<class P>
+struct PropertyArrayTraits<Base::Vector3<P> >
+{
+    static bool equal(const Base::Vector3<P> &a, const Base::Vector3<P> &b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+    static std::size_t hash(const Base::Vector3<P> &v) {
+        std::size_t seed = std::hash<P>()(v.x);
+        PropertyDelta::hashCombine(seed, std::hash<P>()(v.y));
+        PropertyDelta::hashCombine(seed, std::hash<P>()(v.z));
+        return seed;
+    }
+};
+
+/// Colors are compared exactly, Color::operator==() compares the packed value
+template<>
+struct PropertyArrayTraits<Color>
+{
+    static bool equal(const Color &a, const Color &b) {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+    static std::size_t hash(const Color &c) {
+        std::size_t seed = std::hash<float>()(c.r);
+        PropertyDelta::hashCombine(seed, std::hash<float>()(c.g));
+        PropertyDelta::hashCombine(seed, std::hash<float>()(c.b));
+        PropertyDelta::hashCombine(seed, std::hash<float>()(c.a));
+        return seed;
+    }
+};
+
+/** Helper class to implement deltas of array like values
+ *
+ * It keeps the old values of the changed elements, the old size of the
+ * array and a checksum of the changed array that is verified before the
+ * delta is applied.
+ */
+template<class T, class Traits = PropertyArrayTraits<T> >
+class PropertyArrayDelta : public PropertyDelta
+{
+public:
+    /** Records the elements of \a old that are different in \a cur
+     *
+     * @return false if the delta is not clearly smaller than \a old, in which
+     * case a full copy should be kept instead.
+     */
+    template<class ArrayT>
+    bool diff(const ArrayT &cur, const ArrayT &old) {
+        size = cur.size();
+        oldSize = old.size();
+        changes.clear();
+        checksum = size;
+        std::size_t limit = oldSize * sizeof(T) / (2 * sizeof(Change));
+        for (std::size_t i=0; i<size; ++i) {
+            hashCombine(checksum, Traits::hash(cur[i]));
+            if (i < oldSize && !Traits::equal(cur[i], old[i])) {
+                if (changes.size() >= limit)
+                    return false;
+                changes.emplace_back(i, old[i]);
+            }
+        }
+        for (std::size_t i=size; i<oldSize; ++i) {
+            if (changes.size() >= limit)
+                return false;
+            changes.emplace_back(i, old[i]);
+        }
+        changes.shrink_to_fit();
+        return true;
+    }
+
+    /// Throws if \a cur is not the array the delta was created from
+    template<class ArrayT>
+    void check(const ArrayT &cur) const {
+        std::size_t seed = cur.size();
+        if (cur.size() == size) {
+            for (std::size_t i=0; i<size; ++i)
+                hashCombine(seed, Traits::hash(cur[i]));
+        }
+        if (cur.size() != size || seed != checksum)
+            throw Base::RuntimeError("Property changed outside of transaction");
+    }
+
+    /// Restores the old values in \a values
+    template<class ArrayT>
+    void restore(ArrayT &values) const {
+        check(values);
+        values.resize(oldSize);
+        for (auto &change : changes)
+            values[change.first] = change.second;
+    }
+
+    virtual unsigned int getMemSize() const override {
+        return static_cast<unsigned int>(sizeof(*this) + changes.capacity() * sizeof(Change));
+    }
+
+protected:
+    typedef std::pair<std::size_t, T> Change;
+    std::vector<Change> changes;
+    std::size_t size = 0;
+    std::size_t oldSize = 0;
+    std::size_t checksum = 0;
+};
+
+/** Delta of a list property with getValues() and setValues()
+ *
+ * List properties opt in by overriding Property::Diff() with
+ * @code
+ * return PropertyListDelta<PropertyFloatList>::create(*this, from);
+ * @endcode
+ */
+template<class PropT>
+class PropertyListDelta : public PropertyArrayDelta<typename PropT::list_type::value_type>
+{
+public:
+    typedef typename PropT::list_type list_type;
+
+    static PropertyDelta *create(const PropT &prop, const Property &from) {
+        if (!from.isDerivedFrom(PropT::getClassTypeId()))
+            return 0;
+        const list_type &cur = prop.getValues();
+        const list_type &old = static_cast<const PropT&>(from).getValues();
+        std::unique_ptr<PropertyListDelta> delta(new PropertyListDelta);
+        if (!delta->diff(cur, old))
+            return 0;
+        return delta.release();
+    }
+
+    virtual void apply(Property &prop) const override {
+        if (!prop.isDerivedFrom(PropT::getClassTypeId()))
+            throw Base::TypeError("Property type mismatch");
+        PropT &p = static_cast<PropT&>(prop);
+        list_type values(p.getValues());
+        this->restore(values);
+        p.setValues(values);
+    }
+};
+
+} // namespace App
+
+#endif // APP_PROPERTYDELTA_H
@@ -29,6 +29,7 @@
 #include <Base/Reader.h>
 #include <Base/Tools.h>
 #include "Expression.h"
+#include "ExpressionCompiler.h"
 #include "ExpressionVisitors.h"
 #include "PropertyExpressionEngine.h"
 #include "PropertyStandard.h"
@@ -119,6 +120,8 @@ Property *PropertyExpressionEngine::Copy() const
 
 void PropertyExpressionEngine::hasSetValue()
 {
+    resetCompiledExpressions();
+
     App::DocumentObject *owner = dynamic_cast<App::DocumentObject*>(getContainer());
     if(!owner || !owner->getNameInDocument() || owner->isRestoring() || testFlag(LinkDetached)) {
         PropertyExpressionContainer::hasSetValue();
@@ -316,6 +319,7 @@ void PropertyExpressionEngine::afterRestore()
 
 void PropertyExpressionEngine::onContainerRestored() {
     Base::FlagToggler<bool> flag(restoring);
+    resetCompiledExpressions();
     unregisterElementReference();
     UpdateElementReferenceExpressionVisitor<PropertyExpressionEngine> v(*this);
     for(auto &e : expressions) {
@@ -525,6 +529,9 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute(ExecuteOption o
 
     resetter r(running);
 
+    bool compile = App::GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Expression")->GetBool("CompileExpressions",true);
+
     // Compute evaluation order
     std::vector<App::ObjectIdentifier> evaluationOrder = computeEvaluationOrder(option);
     std::vector<ObjectIdentifier>::const_iterator it = evaluationOrder.begin();
@@ -552,7 +559,7 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute(ExecuteOption o
         App::any value;
         try {
             // Evaluate expression
-            value = expressions[*it].expression->getValueAsAny();
+            value = evaluateExpression(expressions[*it],compile);
             if(option == ExecuteOnRestore && prop->testStatus(Property::EvalOnRestore)) {
                 if(isAnyEqual(value, prop->getPathValue(*it)))
                     continue;
@@ -579,6 +586,42 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute(ExecuteOption o
     return DocumentObject::StdReturn;
 }
 
+/**
+ * @brief Evaluate an expression, using its compiled form if possible.
+ * @param info Expression to evaluate.
+ * @param compile Whether to compile the expression.
+ * @return The value of the expression.
+ */
+
+App::any PropertyExpressionEngine::evaluateExpression(const ExpressionInfo &info, bool compile) const
+{
+    if(compile) {
+        if(!info.compileTried) {
+            info.compileTried = true;
+            info.compiled = CompiledExpression::compile(info.expression.get());
+        }
+        // Hold a reference, Python code called during evaluation may
+        // change the expressions.
+        auto compiled = info.compiled;
+        App::any value;
+        if(compiled && compiled->evaluate(value))
+            return value;
+    }
+    return info.expression->getValueAsAny();
+}
+
+/**
+ * @brief Drop the compiled expressions, e.g. after the expressions are changed.
+ */
+
+void PropertyExpressionEngine::resetCompiledExpressions()
+{
+    for(auto &e : expressions) {
+        e.second.compiled.reset();
+        e.second.compileTried = false;
+    }
+}
+
 /**
  * @brief Find paths to document object.
  * @param obj Document object
@@ -709,6 +752,7 @@ void PropertyExpressionEngine::renameExpressions(const std::map<ObjectIdentifier
 
 void PropertyExpressionEngine::renameObjectIdentifiers(const std::map<ObjectIdentifier, ObjectIdentifier> &paths)
 {
+    resetCompiledExpressions();
     for (ExpressionMap::iterator it = expressions.begin(); it != expressions.end(); ++it) {
         RenameObjectIdentifierExpressionVisitor<PropertyExpressionEngine> v(*this, paths, it->first);
         it->second.expression->visit(v);
@@ -775,6 +819,7 @@ bool PropertyExpressionEngine::adjustLink(const std::set<DocumentObject*> &inLis
         return false;
 
     AtomicPropertyChange signaler(*this);
+    resetCompiledExpressions();
     for(auto &v : expressions) {
         try {
             if(v.second.expression->adjustLinks(inList))
@@ -794,6 +839,7 @@ void PropertyExpressionEngine::updateElementReference(DocumentObject *feature, b
     (void)notify;
     if(!feature)
         unregisterElementReference();
+    resetCompiledExpressions();
     UpdateElementReferenceExpressionVisitor<PropertyExpressionEngine> v(*this,feature,reverse);
     for(auto &e : expressions) {
         e.second.expression->visit(v);
@@ -923,6 +969,7 @@ void PropertyExpressionEngine::setExpressions(
 
 void PropertyExpressionEngine::onRelabeledDocument(const App::Document &doc)
 {
+    resetCompiledExpressions();
     RelabelDocumentExpressionVisitor v(doc);
     for(auto &e : expressions) 
         e.second.expression->visit(v);
@@ -30,6 +30,7 @@
 #include <boost/graph/topological_sort.hpp>
 #include <App/PropertyLinks.h>
 #include <App/Expression.h>
+#include <memory>
 #include <set>
 
 namespace Base {
@@ -43,6 +44,7 @@ class DocumentObject;
 class DocumentObjectExecReturn;
 class ObjectIdentifier;
 class Expression;
+class CompiledExpression;
 
 class AppExport PropertyExpressionContainer : public App::PropertyXLinkContainer
 {
@@ -85,6 +87,8 @@ public:
 
     struct ExpressionInfo {
         boost::shared_ptr<App::Expression> expression; /**< The actual expression tree */
+        mutable std::shared_ptr<CompiledExpression> compiled; /**< Compiled form of the expression */
+        mutable bool compileTried = false; /**< Whether the expression was compiled already */
 
         ExpressionInfo(boost::shared_ptr<App::Expression> expression = boost::shared_ptr<App::Expression>()) {
             this->expression = expression;
@@ -186,6 +190,10 @@ private:
                 boost::unordered_map<int, App::ObjectIdentifier> &revNodes, 
                 DiGraph &g, ExecuteOption option=ExecuteAll) const;
 
+    App::any evaluateExpression(const ExpressionInfo &info, bool compile) const;
+
+    void resetCompiledExpressions();
+
     bool running; /**< Boolean used to avoid loops */
     bool restoring = false;
 
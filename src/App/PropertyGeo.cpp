@@ -45,6 +45,7 @@
 #include "DocumentObject.h"
 #include "Placement.h"
 #include "PropertyGeo.h"
+#include "PropertyDelta.h"
 #include "ObjectIdentifier.h"
 
 using namespace App;
@@ -410,6 +411,11 @@ void PropertyVectorList::Paste(const Property &from)
     setValues(dynamic_cast<const PropertyVectorList&>(from)._lValueList);
 }
 
+PropertyDelta *PropertyVectorList::Diff(const Property &from) const
+{
+    return PropertyListDelta<PropertyVectorList>::create(*this, from);
+}
+
 unsigned int PropertyVectorList::getMemSize (void) const
 {
     return static_cast<unsigned int>(_lValueList.size() * sizeof(Base::Vector3d));
@@ -218,10 +218,12 @@ public:
     virtual void Restore(Base::XMLReader &reader) override;
 
     virtual void SaveDocFile (Base::Writer &writer) const override;
+    virtual bool canSaveDocFileInThread() const override {return true;}
     virtual void RestoreDocFile(Base::Reader &reader) override;
 
     virtual Property *Copy(void) const override;
     virtual void Paste(const Property &from) override;
+    virtual PropertyDelta *Diff(const Property &from) const override;
 
     virtual unsigned int getMemSize (void) const override;
     const char* getEditorName(void) const override {
@@ -396,6 +398,7 @@ public:
     virtual void Restore(Base::XMLReader &reader) override;
 
     virtual void SaveDocFile (Base::Writer &writer) const override;
+    virtual bool canSaveDocFileInThread() const override {return true;}
     virtual void RestoreDocFile(Base::Reader &reader) override;
 
     virtual Property *Copy(void) const override;
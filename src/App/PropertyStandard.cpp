@@ -42,6 +42,7 @@
 #include <Base/Tools.h>
 
 #include "PropertyStandard.h"
+#include "PropertyDelta.h"
 #include "PropertyLinks.h"
 #include "MaterialPy.h"
 #include "ObjectIdentifier.h"
@@ -793,6 +794,11 @@ void PropertyIntegerList::Paste(const Property &from)
     setValues(dynamic_cast<const PropertyIntegerList&>(from)._lValueList);
 }
 
+PropertyDelta *PropertyIntegerList::Diff(const Property &from) const
+{
+    return PropertyListDelta<PropertyIntegerList>::create(*this, from);
+}
+
 unsigned int PropertyIntegerList::getMemSize (void) const
 {
     return static_cast<unsigned int>(_lValueList.size() * sizeof(long));
@@ -1328,6 +1334,11 @@ void PropertyFloatList::Paste(const Property &from)
     setValues(dynamic_cast<const PropertyFloatList&>(from)._lValueList);
 }
 
+PropertyDelta *PropertyFloatList::Diff(const Property &from) const
+{
+    return PropertyListDelta<PropertyFloatList>::create(*this, from);
+}
+
 unsigned int PropertyFloatList::getMemSize (void) const
 {
     return static_cast<unsigned int>(_lValueList.size() * sizeof(double));
@@ -2538,6 +2549,11 @@ void PropertyColorList::Paste(const Property &from)
     setValues(dynamic_cast<const PropertyColorList&>(from)._lValueList);
 }
 
+PropertyDelta *PropertyColorList::Diff(const Property &from) const
+{
+    return PropertyListDelta<PropertyColorList>::create(*this, from);
+}
+
 unsigned int PropertyColorList::getMemSize (void) const
 {
     return static_cast<unsigned int>(_lValueList.size() * sizeof(Color));
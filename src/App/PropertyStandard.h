@@ -336,6 +336,7 @@ public:
 
     virtual Property *Copy(void) const override;
     virtual void Paste(const Property &from) override;
+    virtual PropertyDelta *Diff(const Property &from) const override;
     virtual unsigned int getMemSize (void) const override;
 
 protected:
@@ -614,10 +615,12 @@ public:
     virtual void Restore(Base::XMLReader &reader) override;
 
     virtual void SaveDocFile (Base::Writer &writer) const override;
+    virtual bool canSaveDocFileInThread() const override {return true;}
     virtual void RestoreDocFile(Base::Reader &reader) override;
 
     virtual Property *Copy(void) const override;
     virtual void Paste(const Property &from) override;
+    virtual PropertyDelta *Diff(const Property &from) const override;
     virtual unsigned int getMemSize (void) const override;
 
 protected:
@@ -910,10 +913,12 @@ public:
     virtual void Restore(Base::XMLReader &reader) override;
 
     virtual void SaveDocFile (Base::Writer &writer) const override;
+    virtual bool canSaveDocFileInThread() const override {return true;}
     virtual void RestoreDocFile(Base::Reader &reader) override;
 
     virtual Property *Copy(void) const override;
     virtual void Paste(const Property &from) override;
+    virtual PropertyDelta *Diff(const Property &from) const override;
     virtual unsigned int getMemSize (void) const override;
 
 protected:
@@ -998,6 +1003,7 @@ public:
     virtual void Restore(Base::XMLReader &reader) override;
 
     virtual void SaveDocFile(Base::Writer &writer) const override;
+    virtual bool canSaveDocFileInThread() const override {return true;}
     virtual void RestoreDocFile(Base::Reader &reader) override;
 
     virtual const char* getEditorName(void) const override;
@@ -38,6 +38,7 @@ using Base::XMLReader;
 #include <Base/Console.h>
 #include "Transactions.h"
 #include "Property.h"
+#include "PropertyDelta.h"
 #include "Document.h"
 #include "DocumentObject.h"
 
@@ -112,7 +113,40 @@ int Transaction::getLastID() {
 
 unsigned int Transaction::getMemSize (void) const
 {
-    return 0;
+    if(memSize)
+        return memSize;
+
+    unsigned int size = 0;
+    for(auto &info : _Objects.get<0>()) {
+        size += info.second->getMemSize();
+        // removed objects are kept alive by the transaction
+        if(info.second->status == TransactionObject::New
+                && !info.first->isAttachedToDocument())
+            size += info.first->getMemSize();
+    }
+    return size;
+}
+
+void Transaction::compact()
+{
+    for(auto &info : _Objects.get<0>())
+        info.second->compact(const_cast<TransactionalObject*>(info.first));
+    memSize = 0;
+    memSize = getMemSize();
+}
+
+bool Transaction::expandDelta(const Property *prop)
+{
+    auto container = prop->getContainer();
+    if(!container || !container->isDerivedFrom(TransactionalObject::getClassTypeId()))
+        return false;
+    auto &index = _Objects.get<1>();
+    auto pos = index.find(static_cast<const TransactionalObject*>(container));
+    if(pos == index.end() || !pos->second->expandDelta(prop))
+        return false;
+    memSize = 0;
+    memSize = getMemSize();
+    return true;
 }
 
 void Transaction::Save (Base::Writer &/*writer*/) const
@@ -281,8 +315,6 @@ TransactionObject::TransactionObject()
  */
 TransactionObject::~TransactionObject()
 {
-    for(auto &v : _PropChangeMap)
-        delete v.second.property;
 }
 
 void TransactionObject::applyDel(Document & /*Doc*/, TransactionalObject * /*pcObj*/)
@@ -301,7 +333,7 @@ void TransactionObject::applyChn(Document & /*Doc*/, TransactionalObject *pcObj,
             auto &data = v.second;
             auto prop = const_cast<Property*>(v.first);
 
-            if(!data.property) {
+            if(!data.hasValue()) {
                 // here means we are undoing/redoing and property add operation
                 pcObj->removeDynamicProperty(v.second.name.c_str());
                 continue;
@@ -326,12 +358,12 @@ void TransactionObject::applyChn(Document & /*Doc*/, TransactionalObject *pcObj,
                 if(!prop) {
                     // Still not found, re-create the property
                     prop = pcObj->addDynamicProperty(
-                            data.property->getTypeId().getName(),
+                            data.propertyType.getName(),
                             v.second.name.c_str(), data.group.c_str(), data.doc.c_str(),
                             data.attr, data.readonly, data.hidden);
                     if(!prop)
                         continue;
-                    prop->setStatusValue(data.property->getStatus());
+                    prop->setStatusValue(data.propertyStatus);
                 }
             }
 
@@ -349,7 +381,10 @@ void TransactionObject::applyChn(Document & /*Doc*/, TransactionalObject *pcObj,
             //     continue;
             // }
             try {
-                prop->Paste(*data.property);
+                if(data.delta)
+                    data.delta->apply(*prop);
+                else
+                    prop->Paste(*data.value);
             } catch (Base::Exception &e) {
                 e.ReportException();
                 FC_ERR("exception while restoring " << prop->getFullName() << ": " << e.what());
@@ -364,12 +399,15 @@ void TransactionObject::applyChn(Document & /*Doc*/, TransactionalObject *pcObj,
 void TransactionObject::setProperty(const Property* pcProp)
 {
     auto &data = _PropChangeMap[pcProp];
-    if(!data.property && data.name.empty()) {
+    if(!data.hasValue() && data.name.empty()) {
         static_cast<DynamicProperty::PropData&>(data) = 
             pcProp->getContainer()->getDynamicPropertyData(pcProp);
-        data.property = pcProp->Copy();
+        data.property = 0;
+        // Big properties share their value with the snapshot until they are
+        // changed, and compact() later reduces it to the changed parts.
+        data.value = pcProp->Snapshot();
         data.propertyType = pcProp->getTypeId();
-        data.property->setStatusValue(pcProp->getStatus());
+        data.propertyStatus = pcProp->getStatus();
     }
 }
 
@@ -381,32 +419,89 @@ void TransactionObject::addOrRemoveProperty(const Property* pcProp, bool add)
 
     auto &data = _PropChangeMap[pcProp];
     if(data.name.size()) {
-        if(!add && !data.property) {
+        if(!add && !data.hasValue()) {
             // this means add and remove the same property inside a single
             // transaction, so they cancel each other out.
             _PropChangeMap.erase(pcProp);
         }
         return;
     }
-    if(data.property) {
-        delete data.property;
-        data.property = 0;
-    }
+    data.value.reset();
+    data.delta.reset();
 
     static_cast<DynamicProperty::PropData&>(data) = 
         pcProp->getContainer()->getDynamicPropertyData(pcProp);
-    if(add) 
-        data.property = 0;
-    else {
-        data.property = pcProp->Copy();
+    data.property = 0;
+    if(!add) {
+        data.value = pcProp->Snapshot();
         data.propertyType = pcProp->getTypeId();
-        data.property->setStatusValue(pcProp->getStatus());
+        data.propertyStatus = pcProp->getStatus();
     }
 }
 
+void TransactionObject::compact(TransactionalObject *pcObj)
+{
+    if (status != New && status != Chn)
+        return;
+
+    for(auto &v : _PropChangeMap) {
+        auto &data = v.second;
+        if(!data.value)
+            continue;
+        // Only properties that still exist have the values after the
+        // transaction. See applyChn() for getPropertyName() being safe.
+        auto prop = v.first;
+        if(!pcObj->getPropertyName(prop) || prop->getTypeId() != data.propertyType)
+            continue;
+        PropertyDelta *delta = 0;
+        try {
+            delta = prop->Diff(*data.value);
+        } catch (Base::Exception &e) {
+            e.ReportException();
+        } catch (std::exception &e) {
+            FC_ERR("exception while compacting " << prop->getFullName() << ": " << e.what());
+        }
+        if(delta) {
+            data.delta.reset(delta);
+            data.value.reset();
+            // see Document::onBeforeChangeProperty()
+            const_cast<Property*>(prop)->setStatus(Property::HasDelta, true);
+        }
+    }
+}
+
+bool TransactionObject::expandDelta(const Property* pcProp)
+{
+    auto it = _PropChangeMap.find(pcProp);
+    if(it == _PropChangeMap.end())
+        return false;
+    auto &data = it->second;
+    if(data.delta) {
+        try {
+            std::unique_ptr<Property> copy(pcProp->Copy());
+            data.delta->apply(*copy);
+            data.value.reset(copy.release());
+            data.delta.reset();
+        } catch (Base::Exception &e) {
+            e.ReportException();
+            FC_ERR("exception while expanding " << pcProp->getFullName() << ": " << e.what());
+        } catch (std::exception &e) {
+            FC_ERR("exception while expanding " << pcProp->getFullName() << ": " << e.what());
+        }
+    }
+    return true;
+}
+
 unsigned int TransactionObject::getMemSize (void) const
 {
-    return 0;
+    unsigned int size = 0;
+    for(auto &v : _PropChangeMap) {
+        if(v.second.delta)
+            size += v.second.delta->getMemSize();
+        else if(v.second.value)
+            size += v.second.value->getMemSize();
+    }
+    return size;
 }
 
 void TransactionObject::Save (Base::Writer &/*writer*/) const
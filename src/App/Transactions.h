@@ -35,6 +35,7 @@ namespace App
 
 class Document;
 class Property;
+class PropertyDelta;
 class Transaction;
 class TransactionObject;
 class TransactionalObject;
@@ -62,6 +63,22 @@ public:
     /// apply the content to the document
     void apply(Document &Doc,bool forward);
 
+    /** Replace the recorded property values with deltas where possible
+     *
+     * It must be called once the transaction is closed, i.e. when the
+     * properties have their values after the transaction.
+     */
+    void compact();
+
+    /** Replaces the delta of \a prop with the full value it restores
+     *
+     * It must be called before the property is changed outside of a transaction,
+     * as the delta can't be applied any more afterwards.
+     *
+     * @return true if the transaction has a record of the property
+     */
+    bool expandDelta(const Property *prop);
+
     // the utf-8 name of the transaction
     std::string Name;
 
@@ -89,6 +106,7 @@ public:
 
 private:
     int transID;
+    unsigned int memSize = 0;
     typedef std::pair<const TransactionalObject*, TransactionObject*> Info;
     bmi::multi_index_container<
         Info,
@@ -119,6 +137,8 @@ public:
 
     void setProperty(const Property* pcProp);
     void addOrRemoveProperty(const Property* pcProp, bool add);
+    void compact(TransactionalObject *pcObj);
+    bool expandDelta(const Property* pcProp);
 
     virtual unsigned int getMemSize (void) const;
     virtual void Save (Base::Writer &writer) const;
@@ -132,6 +152,15 @@ protected:
 
     struct PropData : DynamicProperty::PropData {
         Base::Type propertyType;
+        unsigned long propertyStatus = 0;
+        /// the property value before the change, shared with the property if possible
+        std::shared_ptr<const Property> value;
+        /// replaces 'value' by a smaller record of the change after compact()
+        std::shared_ptr<PropertyDelta> delta;
+
+        bool hasValue() const {
+            return value || delta;
+        }
     };
     std::unordered_map<const Property*, PropData> _PropChangeMap;
 
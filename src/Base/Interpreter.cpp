@@ -36,6 +36,7 @@
 #include "PyTools.h"
 #include "Exception.h"
 #include "PyObjectBase.h"
+#include "Profiler.h"
 #include <CXX/Extensions.hxx>
 #include <frameobject.h>
 #include <traceback.h>
@@ -761,6 +762,7 @@ InterpreterSingleton::~InterpreterSingleton()
 
 std::string InterpreterSingleton::runString(const char *sCmd)
 {
+    FC_PROFILE_ZONE_DETAIL("Interpreter::runString", sCmd);
     PyObject *module, *dict, *presult;          /* "exec code in d, d" */
 
     PyGILStateLocker locker;
@@ -913,6 +915,7 @@ done:
 
 void InterpreterSingleton::runInteractiveString(const char *sCmd)
 {
+    FC_PROFILE_ZONE_DETAIL("Interpreter::runInteractiveString", sCmd);
     PyObject *module, *dict, *presult;          /* "exec code in d, d" */
 
     PyGILStateLocker locker;
@@ -954,6 +957,7 @@ void InterpreterSingleton::runInteractiveString(const char *sCmd)
 
 void InterpreterSingleton::runFile(const char*pxFileName, bool local)
 {
+    FC_PROFILE_ZONE_DETAIL("Interpreter::runFile", pxFileName);
 #ifdef FC_OS_WIN32
     FileInfo fi(pxFileName);
     FILE *fp = _wfopen(fi.toStdWString().c_str(),L"r");
@@ -99,7 +99,7 @@ std::string Persistence::encodeAttribute(const std::string& str)
     return tmp;
 }
 
-void Persistence::dumpToStream(std::ostream& stream, int compression)
+void Persistence::dumpToStream(std::ostream& stream, int compression) const
 {
     //we need to close the zipstream to get a good result, the only way to do this is to delete the ZipWriter.
     //Hence the scope...
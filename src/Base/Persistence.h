@@ -28,6 +28,8 @@
 
 
 #include <assert.h>
+#include <functional>
+#include <memory>
 
 #include "BaseClass.h"
 
@@ -35,6 +37,7 @@ namespace Base
 {
 class Reader;
 class Writer;
+class DocFileLoader;
 class XMLReader;
 
 /// Persistence class and root of the type system
@@ -116,6 +119,15 @@ public:
      * In this method you can simply stream your content to the file (Base::Writer inheriting from ostream).
      */
     virtual void SaveDocFile (Writer &/*writer*/) const;
+    /** Returns true if SaveDocFile() may run in a worker thread while other
+     * objects are saved. This is the case if it only reads the data of this object,
+     * doesn't call Writer::addFile() and doesn't access Python or global state.
+     * The Writer passed to SaveDocFile() then buffers the file in memory.
+     * The default implementation returns false.
+     */
+    virtual bool canSaveDocFileInThread() const {
+        return false;
+    }
     /** This method is used to restore large amounts of data from a file
      * In this method you simply stream in your SaveDocFile() saved data.
      * Again you have to apply for the call of this method in the Restore() call:
@@ -146,11 +158,40 @@ public:
      * @see Base::Reader,Base::XMLReader
      */
     virtual void RestoreDocFile(Reader &/*reader*/);
+    /** Returns true if the file of this object can be decoded with
+     * RestoreDocFileInThread() while other files are read.
+     * The default implementation returns false.
+     */
+    virtual bool canRestoreDocFileInThread() const {
+        return false;
+    }
+    /** This method is called in a worker thread instead of RestoreDocFile() if
+     * canRestoreDocFileInThread() returns true. It decodes the file into a temporary
+     * without changing the object, and returns a function that is called afterwards
+     * in the main thread to assign the decoded data. It must not access Python or
+     * global state and must not call Reader::initLocalReader().
+     * If an empty function is returned or an exception is raised RestoreDocFile()
+     * is called in the main thread instead. The default implementation returns an
+     * empty function.
+     */
+    virtual std::function<void()> RestoreDocFileInThread(Reader &/*reader*/) {
+        return std::function<void()>();
+    }
+    /** This method is called instead of RestoreDocFile() if the document is opened
+     * in lazy mode. An object that supports it keeps \a loader and reads its file
+     * with it when its data is accessed the first time. The data is then assigned
+     * without notification because it's the restored state. It returns true if it
+     * takes the loader. The default implementation returns false and RestoreDocFile()
+     * is called as usual.
+     */
+    virtual bool RestoreDocFileLater(const std::shared_ptr<DocFileLoader>& /*loader*/) {
+        return false;
+    }
     /// Encodes an attribute upon saving.
     static std::string encodeAttribute(const std::string&);
 
     //dump the binary persistence data into into the stream
-    void dumpToStream(std::ostream& stream, int compression);
+    void dumpToStream(std::ostream& stream, int compression) const;
 
     //restore the binary persistence data from a stream. Must have the format used by dumpToStream
     void restoreFromStream(std::istream& stream);
@@ -0,0 +1,293 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <chrono>
+# include <cstdio>
+# include <ostream>
+#endif
+
+#include "Exception.h"
+#include "FileInfo.h"
+#include "Profiler.h"
+#include "Stream.h"
+
+using namespace Base;
+
+static const std::size_t DefaultCapacity = 1 << 16;
+
+std::atomic<bool> Profiler::_active(false);
+
+static int64_t steadyMicroseconds()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Profiler::Profiler()
+    : session(0)
+    , epoch(0)
+{
+}
+
+Profiler &Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+unsigned Profiler::currentThread()
+{
+    static std::atomic<unsigned> threads(0);
+    thread_local unsigned id = ++threads;
+    return id;
+}
+
+struct Profiler::Buffer
+{
+    // only contended while the events are collected
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::size_t capacity = 0;
+    std::size_t next = 0;
+    std::size_t overwritten = 0;
+    unsigned session = 0;
+    unsigned thread = 0;
+};
+
+void Profiler::start(std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!capacity)
+        capacity = DefaultCapacity;
+    // the threads create new buffers for the new session
+    buffers.clear();
+    this->capacity = capacity;
+    epoch = steadyMicroseconds();
+    ++session;
+    _active = true;
+}
+
+std::size_t Profiler::stop()
+{
+    _active = false;
+    return size();
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &buf : buffers) {
+        std::lock_guard<std::mutex> bufLock(buf->mutex);
+        buf->events.clear();
+        buf->next = 0;
+        buf->overwritten = 0;
+    }
+}
+
+std::size_t Profiler::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t count = 0;
+    for (auto &buf : buffers) {
+        std::lock_guard<std::mutex> bufLock(buf->mutex);
+        count += buf->events.size();
+    }
+    return std::min(count, capacity);
+}
+
+std::size_t Profiler::dropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t count = 0;
+    std::size_t overwritten = 0;
+    for (auto &buf : buffers) {
+        std::lock_guard<std::mutex> bufLock(buf->mutex);
+        count += buf->events.size();
+        overwritten += buf->overwritten;
+    }
+    return overwritten + (count > capacity ? count - capacity : 0);
+}
+
+int64_t Profiler::now(unsigned *s) const
+{
+    if (s)
+        *s = session;
+    return steadyMicroseconds() - epoch;
+}
+
+Profiler::Buffer *Profiler::getBuffer(unsigned s)
+{
+    // The profiler keeps the buffers of finished threads until the next start
+    thread_local std::shared_ptr<Buffer> _buffer;
+    if (!_buffer || _buffer->session != s) {
+        std::shared_ptr<Buffer> buf = std::make_shared<Buffer>();
+        buf->session = s;
+        buf->thread = currentThread();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (s != session)
+            return 0;
+        buf->capacity = capacity;
+        buffers.push_back(buf);
+        _buffer = buf;
+    }
+    return _buffer.get();
+}
+
+void Profiler::record(const char *name, const char *detail, int64_t begin, unsigned s)
+{
+    int64_t end = now();
+    if (!_active || s != session)
+        return;
+    Buffer *buf = getBuffer(s);
+    if (!buf || !buf->capacity)
+        return;
+
+    std::lock_guard<std::mutex> lock(buf->mutex);
+    if (buf->events.size() < buf->capacity) {
+        buf->events.emplace_back();
+    }
+    else {
+        ++buf->overwritten;
+    }
+
+    Event &ev = buf->events[buf->next];
+    ev.name = name;
+    if (detail)
+        ev.detail = detail;
+    else
+        ev.detail.clear();
+    ev.begin = begin;
+    ev.duration = end - begin;
+    ev.thread = buf->thread;
+    buf->next = (buf->next + 1) % buf->capacity;
+}
+
+std::vector<Profiler::Event> Profiler::collect(std::size_t *lost) const
+{
+    std::vector<Event> result;
+    std::size_t limit;
+    *lost = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        limit = capacity;
+        for (auto &buf : buffers) {
+            std::lock_guard<std::mutex> bufLock(buf->mutex);
+            std::size_t count = buf->events.size();
+            std::size_t first = count < buf->capacity ? 0 : buf->next;
+            for (std::size_t i = 0; i < count; ++i)
+                result.push_back(buf->events[(first + i) % count]);
+            *lost += buf->overwritten;
+        }
+    }
+
+    // keep the latest events of all threads like a single ring buffer would
+    std::stable_sort(result.begin(), result.end(), [](const Event &a, const Event &b) {
+        return a.begin + a.duration < b.begin + b.duration;
+    });
+    if (result.size() > limit) {
+        *lost += result.size() - limit;
+        result.erase(result.begin(), result.end() - limit);
+    }
+    return result;
+}
+
+static void writeJsonString(std::ostream &out, const char *s)
+{
+    out << '"';
+    for (; *s; ++s) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        switch (c) {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\r':
+            out << "\\r";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out << buf;
+            }
+            else {
+                out << *s;
+            }
+            break;
+        }
+    }
+    out << '"';
+}
+
+void Profiler::exportChromeTrace(std::ostream &out) const
+{
+    std::size_t lost = 0;
+    std::vector<Event> copy = collect(&lost);
+
+    // Parents are recorded after their children, sorting by start time lets
+    // viewers nest them without further work.
+    std::stable_sort(copy.begin(), copy.end(), [](const Event &a, const Event &b) {
+        return a.begin < b.begin;
+    });
+
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto &ev : copy) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":";
+        writeJsonString(out, ev.name);
+        out << ",\"cat\":\"FreeCAD\",\"ph\":\"X\",\"ts\":" << ev.begin
+            << ",\"dur\":" << ev.duration
+            << ",\"pid\":1,\"tid\":" << ev.thread;
+        if (ev.detail.size()) {
+            out << ",\"args\":{\"detail\":";
+            writeJsonString(out, ev.detail.c_str());
+            out << '}';
+        }
+        out << '}';
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Profiler::exportChromeTrace(const char *filename) const
+{
+    Base::FileInfo fi(filename);
+    Base::ofstream file(fi, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        throw Base::FileException("Cannot open file", fi);
+    exportChromeTrace(file);
+    if (!file.good())
+        throw Base::FileException("Failed to write file", fi);
+}
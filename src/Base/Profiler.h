@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BASE_PROFILER_H
+#define BASE_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Base
+{
+
+/** Records timed zones into a ring buffer for later inspection
+ *
+ * Capturing is off by default, in which case a zone costs a single atomic
+ * load. Once started, every finished zone is stored as one event with its
+ * name, an optional detail string, the thread it ran in and its start time
+ * and duration in microseconds.
+ *
+ * Each thread records into its own buffer, so threads don't wait for each
+ * other. The buffers are merged when the events are queried or exported,
+ * and only the latest events up to the capacity are kept.
+ *
+ * The captured events can be exported in the Chrome trace event format,
+ * which can be loaded into chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Zones are usually declared with FC_PROFILE_ZONE():
+ * @code
+ * void Document::recompute() {
+ *     FC_PROFILE_ZONE_DETAIL("Document::recompute", getName());
+ *     ...
+ * }
+ * @endcode
+ */
+class BaseExport Profiler
+{
+public:
+    /// Returns the one and only profiler
+    static Profiler &instance();
+
+    /// Whether events are captured
+    static bool isActive() {
+        return _active.load(std::memory_order_relaxed);
+    }
+
+    /** Starts capturing
+     *
+     * @param capacity: maximum number of events kept, or 0 for the default
+     *
+     * Events of a previous capture are discarded.
+     */
+    void start(std::size_t capacity = 0);
+
+    /// Stops capturing and returns the number of events kept
+    std::size_t stop();
+
+    /// Discards all captured events
+    void clear();
+
+    /// Returns the number of events kept
+    std::size_t size() const;
+
+    /// Returns the number of events that were overwritten
+    std::size_t dropped() const;
+
+    /** Stores a finished zone
+     *
+     * @param name: zone name, must be a string literal or otherwise outlive
+     * the profiler
+     * @param detail: optional detail string
+     * @param begin: start time as returned by now()
+     * @param session: the session returned by now(), events of older
+     * sessions are ignored
+     */
+    void record(const char *name, const char *detail, int64_t begin, unsigned session);
+
+    /// Returns the time in microseconds since capture start, and the session
+    int64_t now(unsigned *session = 0) const;
+
+    /// Writes the captured events as Chrome trace JSON
+    void exportChromeTrace(std::ostream &out) const;
+
+    /// Writes the captured events as Chrome trace JSON to \a filename
+    void exportChromeTrace(const char *filename) const;
+
+    /// Returns a small number identifying the calling thread
+    static unsigned currentThread();
+
+private:
+    Profiler();
+
+    struct Event {
+        const char *name;
+        std::string detail;
+        int64_t begin;
+        int64_t duration;
+        unsigned thread;
+    };
+
+    /// the ring buffer of events of one thread
+    struct Buffer;
+
+    /// Returns the buffer of the calling thread for \a session, or null if
+    /// the session is over
+    Buffer *getBuffer(unsigned session);
+    /// Returns the kept events ordered by their end, and the number of
+    /// events that were overwritten or don't fit into the capacity
+    std::vector<Event> collect(std::size_t *lost) const;
+
+    static std::atomic<bool> _active;
+
+    /// guards the list of buffers and the capacity
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<Buffer> > buffers;
+    std::size_t capacity = 0;
+    std::atomic<unsigned> session;
+    std::atomic<int64_t> epoch;
+};
+
+/** Times the enclosing scope and reports it to the Profiler
+ *
+ * The detail string is only copied while capturing.
+ */
+class BaseExport ProfileZone
+{
+public:
+    ProfileZone(const char *name, const char *detail = 0)
+        : name(name)
+    {
+        if (Profiler::isActive())
+            begin(detail);
+    }
+
+    ProfileZone(const char *name, const std::string &detail)
+        : name(name)
+    {
+        if (Profiler::isActive())
+            begin(detail.c_str());
+    }
+
+    ~ProfileZone() {
+        if (started)
+            Profiler::instance().record(name, detail.size() ? detail.c_str() : 0, start, session);
+    }
+
+private:
+    void begin(const char *d) {
+        if (d)
+            detail = d;
+        start = Profiler::instance().now(&session);
+        started = true;
+    }
+
+    ProfileZone(const ProfileZone&);
+    ProfileZone& operator=(const ProfileZone&);
+
+private:
+    const char *name;
+    std::string detail;
+    int64_t start = 0;
+    unsigned session = 0;
+    bool started = false;
+};
+
+} // namespace Base
+
+#define FC_PROFILE_CONCAT_(_a, _b) _a##_b
+#define FC_PROFILE_CONCAT(_a, _b) FC_PROFILE_CONCAT_(_a, _b)
+
+/// Times the enclosing scope with the given zone name
+#define FC_PROFILE_ZONE(_name) \
+    Base::ProfileZone FC_PROFILE_CONCAT(_fc_profile_zone, __LINE__)(_name)
+
+/// Times the enclosing scope with the given zone name and detail string
+#define FC_PROFILE_ZONE_DETAIL(_name, _detail) \
+    Base::ProfileZone FC_PROFILE_CONCAT(_fc_profile_zone, __LINE__)(_name, _detail)
+
+#endif // BASE_PROFILER_H
@@ -31,6 +31,7 @@
 #endif
 
 #include <locale>
+#include <sstream>
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include "Reader.h"
@@ -40,6 +41,7 @@
 #include "InputSource.h"
 #include "Console.h"
 #include "Sequencer.h"
+#include "Stream.h"
 
 #ifdef _MSC_VER
 #include <zipios++/zipios-config.h>
@@ -51,6 +53,16 @@
 
 #include "XMLTools.h"
 
+#include <future>
+#include <iterator>
+#include <list>
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+FC_LOG_LEVEL_INIT("Reader", true, true)
+
 XERCES_CPP_NAMESPACE_USE
 
 using namespace std;
@@ -64,7 +76,7 @@ using namespace std;
 Base::XMLReader::XMLReader(const char* FileName, std::istream& str)
   : DocumentSchema(0), ProgramVersion(""), FileVersion(0), Level(0),
     CharacterCount(0), ReadType(None), _File(FileName), _valid(false),
-    _verbose(true)
+    _verbose(true), _lazy(false), _threads(1)
 {
 #ifdef _MSC_VER
     str.imbue(std::locale::empty());
@@ -307,6 +319,56 @@ void Base::XMLReader::readBinFile(const char* filename)
     to.close();
 }
 
+namespace {
+
+struct DocFileBuffer
+{
+    DocFileBuffer() : object(0)
+    {
+        FC_DURATION_INIT(duration);
+    }
+
+    std::string name;
+    Base::Persistence* object;
+    std::string data;
+    std::function<void()> assign;
+    FC_DURATION_DECLARE(duration);
+    std::future<void> ready;
+};
+
+class RestoreDocFileTask : public QRunnable
+{
+public:
+    RestoreDocFileTask(DocFileBuffer& buffer, int version)
+      : buffer(buffer), version(version)
+    {
+        buffer.ready = promise.get_future();
+    }
+    virtual void run()
+    {
+        FC_TIME_INIT(t);
+        try {
+            Base::MemoryIStreambuf buf(buffer.data.c_str(), buffer.data.size());
+            std::istream str(&buf);
+            Base::Reader reader(str, buffer.name, version);
+            buffer.assign = buffer.object->RestoreDocFileInThread(reader);
+        }
+        catch (...) {
+            // the file is read again in the main thread to report the error
+            buffer.assign = std::function<void()>();
+        }
+        FC_DURATION_PLUS(buffer.duration, t);
+        promise.set_value();
+    }
+
+private:
+    DocFileBuffer& buffer;
+    int version;
+    std::promise<void> promise;
+};
+
+}
+
 void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
 {
     // It's possible that not all objects inside the document could be created, e.g. if a module
@@ -326,6 +388,40 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
         // project file was created without GUI
         return;
     }
+
+    // Files that can be decoded in a thread are inflated into memory and decoded
+    // meanwhile the next entries are inflated. Before any other file is read the
+    // decoded data is assigned so that the objects see the same order as without
+    // threads.
+    int threads = _threads > 0 ? _threads : QThread::idealThreadCount();
+    std::list<DocFileBuffer> pending;
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    auto assignPending = [&pending, this]() {
+        for (std::list<DocFileBuffer>::iterator it = pending.begin(); it != pending.end(); ++it) {
+            it->ready.wait();
+            FC_TIME_INIT(t);
+            try {
+                if (it->assign) {
+                    it->assign();
+                }
+                else {
+                    Base::MemoryIStreambuf buf(it->data.c_str(), it->data.size());
+                    std::istream str(&buf);
+                    Base::Reader reader(str, it->name, FileVersion);
+                    it->object->RestoreDocFile(reader);
+                }
+            }
+            catch(...) {
+                Base::Console().Error("Reading failed from embedded file: %s\n", it->name.c_str());
+            }
+            FC_DURATION_PLUS(it->duration, t);
+            FC_DURATION_LOG(it->duration, "Reading " << it->name);
+        }
+        pending.clear();
+    };
+
     std::vector<FileEntry>::const_iterator it = FileList.begin();
     Base::SequencerLauncher seq("Importing project files...", FileList.size());
     while (entry->isValid() && it != FileList.end()) {
@@ -337,19 +433,40 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
         // If this condition is true both file names match and we can read-in the data, otherwise
         // no file name for the current entry in the zip was registered.
         if (jt != FileList.end()) {
-            try {
-                Base::Reader reader(zipstream, jt->FileName, FileVersion);
-                jt->Object->RestoreDocFile(reader);
-                if (reader.getLocalReader())
-                    reader.getLocalReader()->readFiles(zipstream);
+            FC_TIME_INIT(t);
+            if (_lazy && !_archive)
+                _archive = std::make_shared<DocFileArchive>(_File.filePath());
+            if (_lazy && jt->Object->RestoreDocFileLater(std::make_shared<DocFileLoader>
+                    (_archive, jt->FileName, FileVersion))) {
+                FC_LOG("Deferring " << jt->FileName);
             }
-            catch(...) {
-                // For any exception we just continue with the next file.
-                // It doesn't matter if the last reader has read more or
-                // less data than the file size would allow.
-                // All what we need to do is to notify the user about the
-                // failure.
-                Base::Console().Error("Reading failed from embedded file: %s\n", entry->toString().c_str());
+            else if (threads > 1 && jt->Object->canRestoreDocFileInThread()) {
+                pending.push_back(DocFileBuffer());
+                DocFileBuffer& buffer = pending.back();
+                buffer.name = jt->FileName;
+                buffer.object = jt->Object;
+                buffer.data.assign(std::istreambuf_iterator<char>(zipstream),
+                                   std::istreambuf_iterator<char>());
+                FC_TIME_LOG(t, "Inflating " << jt->FileName);
+                pool.start(new RestoreDocFileTask(buffer, FileVersion));
+            }
+            else {
+                assignPending();
+                try {
+                    Base::Reader reader(zipstream, jt->FileName, FileVersion);
+                    jt->Object->RestoreDocFile(reader);
+                    if (reader.getLocalReader())
+                        reader.getLocalReader()->readFiles(zipstream);
+                }
+                catch(...) {
+                    // For any exception we just continue with the next file.
+                    // It doesn't matter if the last reader has read more or
+                    // less data than the file size would allow.
+                    // All what we need to do is to notify the user about the
+                    // failure.
+                    Base::Console().Error("Reading failed from embedded file: %s\n", entry->toString().c_str());
+                }
+                FC_TIME_LOG(t, "Reading " << jt->FileName);
             }
             // Go to the next registered file name
             it = jt + 1;
@@ -366,6 +483,8 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
             break;
         }
     }
+
+    assignPending();
 }
 
 const char *Base::XMLReader::addFile(const char* Name, Base::Persistence *Object)
@@ -397,6 +516,29 @@ bool Base::XMLReader::isRegistered(Base::Persistence *Object) const
     return false;
 }
 
+std::shared_ptr<Base::DocFileLoader> Base::XMLReader::getFileLoader(const char* Name)
+{
+    if (!_archive) {
+        if (!_File.exists())
+            return std::shared_ptr<DocFileLoader>();
+        _archive = std::make_shared<DocFileArchive>(_File.filePath());
+    }
+    return std::make_shared<DocFileLoader>(_archive, Name, FileVersion);
+}
+
+void Base::XMLReader::addSharedObject(const std::string& key, const std::shared_ptr<Base::Persistence>& Object)
+{
+    SharedObjects[key] = Object;
+}
+
+std::shared_ptr<Base::Persistence> Base::XMLReader::getSharedObject(const std::string& key) const
+{
+    std::map<std::string, std::shared_ptr<Base::Persistence> >::const_iterator it = SharedObjects.find(key);
+    if (it != SharedObjects.end())
+        return it->second;
+    return std::shared_ptr<Base::Persistence>();
+}
+
 void Base::XMLReader::addName(const char*, const char*)
 {
 }
@@ -563,6 +705,85 @@ void Base::XMLReader::clearPartialRestoreObject(void)
 
 // ----------------------------------------------------------
 
+Base::DocFileArchive::DocFileArchive(const std::string& fileName)
+  : fileName(fileName)
+{
+    modified = FileInfo(fileName).lastModified();
+}
+
+Base::DocFileArchive::~DocFileArchive()
+{
+}
+
+std::unique_ptr<std::istream> Base::DocFileArchive::getInputStream(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Base::FileInfo fi(fileName);
+    if (!fi.exists() || fi.lastModified() != modified) {
+        zip.reset();
+        std::stringstream str;
+        str << "Project file '" << fileName << "' has changed, cannot read '" << name << "'";
+        throw Base::FileException(str.str().c_str());
+    }
+
+    if (!zip)
+        zip.reset(new zipios::ZipFile(fileName));
+    std::unique_ptr<std::istream> str(zip->getInputStream(name));
+    if (!str) {
+        std::stringstream msg;
+        msg << "Cannot read '" << name << "' from project file '" << fileName << "'";
+        throw Base::FileException(msg.str().c_str());
+    }
+    return str;
+}
+
+// ----------------------------------------------------------
+
+Base::DocFileLoader::DocFileLoader(const std::shared_ptr<DocFileArchive>& archive,
+                                   const std::string& fileName, int version)
+  : archive(archive), fileName(fileName), fileVersion(version), reading(false), done(false)
+{
+}
+
+Base::DocFileLoader::~DocFileLoader()
+{
+}
+
+bool Base::DocFileLoader::isPending() const
+{
+    return !done;
+}
+
+void Base::DocFileLoader::read(const std::function<void(Reader&)>& func)
+{
+    if (done)
+        return;
+
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    // func() may access the value again
+    if (done || reading)
+        return;
+
+    reading = true;
+    try {
+        FC_TIME_INIT(t);
+        std::unique_ptr<std::istream> str = archive->getInputStream(fileName);
+        Base::Reader reader(*str, fileName, fileVersion);
+        func(reader);
+        FC_TIME_LOG(t, "Reading " << fileName << " on demand");
+        done = true;
+    }
+    catch (const Base::Exception& e) {
+        Base::Console().Error("%s\n", e.what());
+    }
+    catch (...) {
+        Base::Console().Error("Reading failed from embedded file: %s\n", fileName.c_str());
+    }
+    reading = false;
+}
+
+// ----------------------------------------------------------------------------
+
 Base::Reader::Reader(std::istream& str, const std::string& name, int version)
   : std::istream(str.rdbuf()), _str(str), _name(name), fileVersion(version)
 {
@@ -26,8 +26,11 @@
 
 #include <string>
 #include <map>
+#include <atomic>
 #include <bitset>
+#include <functional>
 #include <memory>
+#include <mutex>
 
 #include <xercesc/framework/XMLPScanToken.hpp>
 #include <xercesc/sax2/Attributes.hpp>
@@ -38,6 +41,7 @@
 
 namespace zipios {
 class ZipInputStream;
+class ZipFile;
 }
 
 XERCES_CPP_NAMESPACE_BEGIN
@@ -48,6 +52,9 @@ XERCES_CPP_NAMESPACE_END
 namespace Base
 {
 
+class DocFileArchive;
+class DocFileLoader;
+
 
 /** The XML reader class
  * This is an important helper class for the store and retrieval system
@@ -182,9 +189,35 @@ public:
     const char *addFile(const char* Name, Base::Persistence *Object);
     /// process the requested file writes
     void readFiles(zipios::ZipInputStream &zipstream) const;
+    /** Sets the number of threads used by readFiles(). Files of objects that
+     * allow it are then inflated into memory and decoded in parallel. The
+     * decoded data is still assigned in the order of the files.
+     * A value of 0 uses one thread per core, the default is 1.
+     */
+    void setThreadCount(int count) { _threads = count; }
+    int getThreadCount() const { return _threads; }
+    /** In lazy mode readFiles() skips the files of objects that accept to read
+     * them later with a DocFileLoader, see Persistence::RestoreDocFileLater().
+     * This requires that the reader was created with the name of the project file.
+     */
+    void setLazyRestore(bool on) { _lazy = on; }
+    bool isLazyRestore() const { return _lazy; }
+    /** Returns a loader that reads the file \a Name of the project file on
+     * demand, without registering it for readFiles(). It can be used to read
+     * data that is only needed if other data of an object cannot be read.
+     * It returns null if the reader wasn't created with the name of an
+     * existing project file.
+     */
+    std::shared_ptr<DocFileLoader> getFileLoader(const char* Name);
     /// get all registered file names
     const std::vector<std::string>& getFilenames() const;
     bool isRegistered(Base::Persistence *Object) const;
+    /** Adds an object that is shared by the objects being restored, e.g. a common
+     * storage for their data. It's kept until the reader is destroyed.
+     */
+    void addSharedObject(const std::string& key, const std::shared_ptr<Base::Persistence>& Object);
+    /// Returns the shared object registered with \a key or null
+    std::shared_ptr<Base::Persistence> getSharedObject(const std::string& key) const;
     virtual void addName(const char*, const char*);
     virtual const char* getName(const char*) const;
     virtual bool doNameMapping() const;
@@ -286,8 +319,12 @@ protected:
     XERCES_CPP_NAMESPACE_QUALIFIER XMLPScanToken token;
     bool _valid;
     bool _verbose;
+    bool _lazy;
+    int _threads;
+    std::shared_ptr<DocFileArchive> _archive;
 
     std::vector<std::string> FileNames;
+    std::map<std::string, std::shared_ptr<Base::Persistence> > SharedObjects;
 
     std::bitset<32> StatusBits;
 };
@@ -310,6 +347,65 @@ private:
     std::shared_ptr<Base::XMLReader> localreader;
 };
 
+/** The DocFileArchive class keeps a project file open for the DocFileLoader
+ * objects of a restored document, so that its central directory is read once.
+ */
+class BaseExport DocFileArchive
+{
+public:
+    DocFileArchive(const std::string& fileName);
+    ~DocFileArchive();
+
+    const std::string& getFileName() const { return fileName; }
+    /** Returns a stream to read the embedded file \a name. It throws a
+     * FileException if the project file has been changed since it was restored
+     * or if it has no such file. It can be called from several threads.
+     */
+    std::unique_ptr<std::istream> getInputStream(const std::string& name);
+
+private:
+    DocFileArchive(const DocFileArchive&);
+    DocFileArchive& operator = (const DocFileArchive&);
+
+private:
+    std::string fileName;
+    TimeInfo modified;
+    std::unique_ptr<zipios::ZipFile> zip;
+    std::mutex mutex;
+};
+
+/** The DocFileLoader class reads a single file of a project file on demand,
+ * after the document has been restored. If the project file has been changed
+ * in the meantime the file is not read and stays pending.
+ */
+class BaseExport DocFileLoader
+{
+public:
+    DocFileLoader(const std::shared_ptr<DocFileArchive>& archive, const std::string& fileName, int version);
+    ~DocFileLoader();
+
+    /** Returns true if the file hasn't been read yet. */
+    bool isPending() const;
+    /** Opens the file and passes it to \a func unless this has been done before.
+     * It can be called from several threads, then only the first call reads the
+     * file and the others wait until it's done. If the file cannot be read an
+     * error is reported and the file stays pending.
+     */
+    void read(const std::function<void(Reader&)>& func);
+
+private:
+    DocFileLoader(const DocFileLoader&);
+    DocFileLoader& operator = (const DocFileLoader&);
+
+private:
+    std::shared_ptr<DocFileArchive> archive;
+    std::string fileName;
+    int fileVersion;
+    bool reading;
+    std::atomic<bool> done;
+    std::recursive_mutex mutex;
+};
+
 }
 
 
@@ -825,3 +825,42 @@ Streambuf::seekpos(std::streambuf::pos_type pos,
 {
     return seekoff(pos, std::ios_base::beg);
 }
+
+// ---------------------------------------------------------
+
+MemoryIStreambuf::MemoryIStreambuf(const char* data, std::size_t size)
+{
+    char* beg = const_cast<char*>(data);
+    setg(beg, beg, beg + size);
+}
+
+MemoryIStreambuf::~MemoryIStreambuf()
+{
+}
+
+std::streambuf::pos_type
+MemoryIStreambuf::seekoff(std::streambuf::off_type off,
+                          std::ios_base::seekdir way,
+                          std::ios_base::openmode /*mode*/ )
+{
+    off_type p_pos = -1;
+    if (way == std::ios_base::beg)
+        p_pos = 0;
+    else if (way == std::ios_base::end)
+        p_pos = egptr() - eback();
+    else if (way == std::ios_base::cur)
+        p_pos = gptr() - eback();
+
+    if (p_pos < 0 || (p_pos + off) > (egptr() - eback()) || (p_pos + off) < 0)
+        return pos_type(off_type(-1));
+
+    setg(eback(), eback() + p_pos + off, egptr());
+    return pos_type(p_pos + off);
+}
+
+std::streambuf::pos_type
+MemoryIStreambuf::seekpos(std::streambuf::pos_type pos,
+                          std::ios_base::openmode /*mode*/)
+{
+    return seekoff(pos, std::ios_base::beg);
+}
@@ -304,6 +304,40 @@ private:
     std::string::const_iterator _cur;
 };
 
+/**
+ * This class implements the streambuf interface to read data from a memory block,
+ * e.g. a memory-mapped file. The data is not copied and thus must be kept alive
+ * as long as the stream buffer is used. Readers that know about this class can
+ * access the memory directly with data() and position() instead of reading it
+ * through the stream.
+ * This class can only be used for reading but not for writing purposes.
+ */
+class BaseExport MemoryIStreambuf : public std::streambuf
+{
+public:
+    MemoryIStreambuf(const char* data, std::size_t size);
+    ~MemoryIStreambuf();
+
+    /** Returns the start of the memory block. */
+    const char* data() const
+    { return eback(); }
+    /** Returns the size of the memory block. */
+    std::size_t size() const
+    { return static_cast<std::size_t>(egptr() - eback()); }
+    /** Returns the current read position relative to the start of the memory block. */
+    std::size_t position() const
+    { return static_cast<std::size_t>(gptr() - eback()); }
+
+protected:
+    virtual pos_type seekoff(std::streambuf::off_type off,
+        std::ios_base::seekdir way,
+        std::ios_base::openmode which =
+            std::ios::in | std::ios::out);
+    virtual pos_type seekpos(std::streambuf::pos_type pos,
+        std::ios_base::openmode which =
+            std::ios::in | std::ios::out);
+};
+
 // ----------------------------------------------------------------------------
 
 class FileInfo;
@@ -36,8 +36,15 @@
 #include "Tools.h"
 
 #include <algorithm>
+#include <cstring>
+#include <future>
 #include <locale>
 #include <limits>
+#include <zlib.h>
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 
 using namespace Base;
 using namespace std;
@@ -142,6 +149,19 @@ void Writer::clearModes()
     Modes.clear();
 }
 
+void Writer::addSharedObject(const std::string& key, const std::shared_ptr<Base::Persistence>& Object)
+{
+    SharedObjects[key] = Object;
+}
+
+std::shared_ptr<Base::Persistence> Writer::getSharedObject(const std::string& key) const
+{
+    std::map<std::string, std::shared_ptr<Base::Persistence> >::const_iterator it = SharedObjects.find(key);
+    if (it != SharedObjects.end())
+        return it->second;
+    return std::shared_ptr<Base::Persistence>();
+}
+
 void Writer::addError(const std::string& msg)
 {
     Errors.push_back(msg);
@@ -241,7 +261,7 @@ void Writer::decInd(void)
 // ----------------------------------------------------------------------------
 
 ZipWriter::ZipWriter(const char* FileName)
-  : ZipStream(FileName)
+  : ZipStream(FileName), level(6), threads(1)
 {
 #ifdef _MSC_VER
     ZipStream.imbue(std::locale::empty());
@@ -253,7 +273,7 @@ ZipWriter::ZipWriter(const char* FileName)
 }
 
 ZipWriter::ZipWriter(std::ostream& os)
-  : ZipStream(os)
+  : ZipStream(os), level(6), threads(1)
 {
 #ifdef _MSC_VER
     ZipStream.imbue(std::locale::empty());
@@ -264,16 +284,168 @@ ZipWriter::ZipWriter(std::ostream& os)
     ZipStream.setf(ios::fixed,ios::floatfield);
 }
 
+namespace {
+
+/* Writes the file of one object into memory, used by the worker threads
+ * of ZipWriter::writeFiles(). It's created in the main thread and takes
+ * over the settings of the archive writer. */
+class BufferWriter : public Writer
+{
+public:
+    BufferWriter(Writer& parent)
+    {
+        setForceXML(parent.isForceXML());
+        setFileVersion(parent.getFileVersion());
+        setModes(parent.getModes());
+        ObjectName = parent.ObjectName;
+#ifdef _MSC_VER
+        StrStream.imbue(std::locale::empty());
+#else
+        StrStream.imbue(std::locale::classic());
+#endif
+        StrStream.precision(std::numeric_limits<double>::digits10 + 1);
+        StrStream.setf(ios::fixed,ios::floatfield);
+    }
+    virtual std::ostream &Stream(void){return StrStream;}
+    virtual void writeFiles(void){}
+    std::string getString(void) const {return StrStream.str();}
+    void clearString() {std::stringstream().swap(StrStream);}
+
+private:
+    std::stringstream StrStream;
+};
+
+struct FileBuffer
+{
+    std::string data;   // raw deflate stream
+    uLong crc;
+    uLong size;
+    bool failed;        // write the file again in the main thread
+    std::vector<std::string> errors;
+    std::future<void> ready;
+};
+
+bool deflateBuffer(const std::string& in, int level, std::string& out)
+{
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    // no zlib header, the same settings as zipios
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    out.resize(deflateBound(&zs, static_cast<uLong>(in.size())));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+
+    int err = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return err == Z_STREAM_END;
+}
+
+class SaveDocFileTask : public QRunnable
+{
+public:
+    SaveDocFileTask(Writer& parent, const Persistence* object, FileBuffer& buffer, int level)
+      : writer(parent), object(object), buffer(buffer), level(level)
+    {
+        buffer.ready = promise.get_future();
+    }
+    virtual void run()
+    {
+        try {
+            object->SaveDocFile(writer);
+            // a file that requests further files is written sequentially
+            if (!writer.getFilenames().empty()) {
+                buffer.failed = true;
+            }
+            else {
+                std::string data = writer.getString();
+                writer.clearString();
+                buffer.size = static_cast<uLong>(data.size());
+                buffer.crc = crc32(crc32(0, Z_NULL, 0),
+                                   reinterpret_cast<const Bytef*>(data.data()),
+                                   static_cast<uInt>(data.size()));
+                buffer.errors = writer.getErrors();
+                buffer.failed = !deflateBuffer(data, level, buffer.data);
+            }
+        }
+        catch (...) {
+            // the main thread writes the file again and gets the exception
+            buffer.failed = true;
+        }
+        promise.set_value();
+    }
+
+private:
+    BufferWriter writer;
+    const Persistence* object;
+    FileBuffer& buffer;
+    int level;
+    std::promise<void> promise;
+};
+
+}
+
 void ZipWriter::writeFiles(void)
 {
+    int count = threads > 0 ? threads : QThread::idealThreadCount();
+
     // use a while loop because it is possible that while
     // processing the files new ones can be added
     size_t index = 0;
     while (index < FileList.size()) {
-        FileEntry entry = FileList.begin()[index];
-        ZipStream.putNextEntry(entry.FileName);
-        entry.Object->SaveDocFile(*this);
-        index++;
+        if (count > 1) {
+            size_t last = FileList.size();
+            writeFilesParallel(index, last, count);
+            index = last;
+        }
+        else {
+            FileEntry entry = FileList.begin()[index];
+            ZipStream.putNextEntry(entry.FileName);
+            entry.Object->SaveDocFile(*this);
+            index++;
+        }
+    }
+}
+
+void ZipWriter::writeFilesParallel(size_t first, size_t last, int count)
+{
+    // copy the entries because SaveDocFile() may add new ones
+    std::vector<FileEntry> entries(FileList.begin() + first, FileList.begin() + last);
+    std::vector<FileBuffer> buffers(entries.size());
+
+    // the pool must be destroyed before the buffers
+    QThreadPool pool;
+    pool.setMaxThreadCount(count);
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        buffers[i].failed = false;
+        if (entries[i].Object->canSaveDocFileInThread())
+            pool.start(new SaveDocFileTask(*this, entries[i].Object, buffers[i], level));
+    }
+
+    // append the files in the original order, the others are written
+    // meanwhile in the main thread
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        FileBuffer& buffer = buffers[i];
+        if (buffer.ready.valid()) {
+            buffer.ready.wait();
+            if (!buffer.failed) {
+                ZipStream.putCompressedEntry(entries[i].FileName, buffer.data.c_str(),
+                                             static_cast<zipios::uint32>(buffer.data.size()),
+                                             static_cast<zipios::uint32>(buffer.size),
+                                             static_cast<zipios::uint32>(buffer.crc));
+                for (std::vector<std::string>::iterator it = buffer.errors.begin(); it != buffer.errors.end(); ++it)
+                    addError(*it);
+                std::string().swap(buffer.data);
+                continue;
+            }
+        }
+
+        ZipStream.putNextEntry(entries[i].FileName);
+        entries[i].Object->SaveDocFile(*this);
     }
 }
 
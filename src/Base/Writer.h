@@ -24,6 +24,8 @@
 #define BASE_WRITER_H
 
 
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <sstream>
@@ -93,6 +95,12 @@ public:
     void clearMode(const std::string& mode);
     /// Clear modes
     void clearModes();
+    /** Adds an object that is shared by the objects being saved, e.g. a common
+     * storage for their data. It's kept until the writer is destroyed.
+     */
+    void addSharedObject(const std::string& key, const std::shared_ptr<Base::Persistence>& Object);
+    /// Returns the shared object registered with \a key or null
+    std::shared_ptr<Base::Persistence> getSharedObject(const std::string& key) const;
     //@}
 
     /** @name Error handling */
@@ -128,6 +136,7 @@ protected:
     std::vector<std::string> FileNames;
     std::vector<std::string> Errors;
     std::set<std::string> Modes;
+    std::map<std::string, std::shared_ptr<Base::Persistence> > SharedObjects;
 
     short indent;
     char indBuf[1024];
@@ -155,11 +164,23 @@ public:
     virtual std::ostream &Stream(void){return ZipStream;}
 
     void setComment(const char* str){ZipStream.setComment(str);}
-    void setLevel(int level){ZipStream.setLevel( level );}
+    void setLevel(int level){ZipStream.setLevel( level ); this->level = level;}
     void putNextEntry(const char* str){ZipStream.putNextEntry(str);}
+    /** Sets the number of threads used by writeFiles(). Files of objects that
+     * allow it are then written to memory buffers and compressed in parallel.
+     * The archive itself is written in the same order as with one thread.
+     * A value of 0 uses one thread per core, the default is 1.
+     */
+    void setThreadCount(int count){threads = count;}
+    int getThreadCount() const {return threads;}
+
+private:
+    void writeFilesParallel(size_t first, size_t last, int count);
 
 private:
     zipios::ZipOutputStream ZipStream;
+    int level;
+    int threads;
 };
 
 /** The StringWriter class
@@ -269,6 +269,8 @@ public:
     static PyObject* sExport                   (PyObject *self,PyObject *args);
     static PyObject* sReload                   (PyObject *self,PyObject *args); // reload FCStd file
     static PyObject* sLoadFile                 (PyObject *self,PyObject *args); // open all types of files
+    static PyObject* sAutoSaveDocument         (PyObject *self,PyObject *args); // write recovery data now
+    static PyObject* sReplayRecoveryJournal    (PyObject *self,PyObject *args);
 
     static PyObject* sCoinRemoveAllChildren    (PyObject *self,PyObject *args);
 
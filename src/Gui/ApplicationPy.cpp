@@ -39,6 +39,7 @@
 #include <boost/regex.hpp>
 
 #include "Action.h"
+#include "AutoSaver.h"
 #include "Application.h"
 #include "BitmapFactory.h"
 #include "Command.h"
@@ -217,6 +218,15 @@ PyMethodDef Application::Methods[] = {
    "* If more than one module can load a file the first one will be taken.\n"
    "* If no module exists to load the file an exception will be raised."},
 
+  {"autoSaveDocument",          (PyCFunction) Application::sAutoSaveDocument, METH_VARARGS,
+   "autoSaveDocument(name) -> None\n\n"
+   "Writes the recovery data of a document now"},
+
+  {"replayRecoveryJournal",     (PyCFunction) Application::sReplayRecoveryJournal, METH_VARARGS,
+   "replayRecoveryJournal(doc, filename) -> None\n\n"
+   "Applies the changes of a recovery journal to a document that\n"
+   "has been opened from the compressed recovery file"},
+
   {"coinRemoveAllChildren",     (PyCFunction) Application::sCoinRemoveAllChildren, METH_VARARGS,
    "Remove all children from a group node"},
 
@@ -1463,6 +1473,34 @@ PyObject* Application::sLoadFile(PyObject * /*self*/, PyObject *args)
     } PY_CATCH
 }
 
+PyObject* Application::sAutoSaveDocument(PyObject * /*self*/, PyObject *args)
+{
+    const char *name;
+    if (!PyArg_ParseTuple(args, "s", &name))
+        return NULL;
+
+    PY_TRY {
+        AutoSaver::instance()->saveDocument(name);
+        Py_Return;
+    } PY_CATCH
+}
+
+PyObject* Application::sReplayRecoveryJournal(PyObject * /*self*/, PyObject *args)
+{
+    PyObject *pyDoc;
+    char *fileName;
+    if (!PyArg_ParseTuple(args, "O!et", &App::DocumentPy::Type, &pyDoc, "utf-8", &fileName))
+        return NULL;
+
+    std::string name = fileName;
+    PyMem_Free(fileName);
+    PY_TRY {
+        App::Document* doc = static_cast<App::DocumentPy*>(pyDoc)->getDocumentPtr();
+        AutoSaver::replayJournal(doc, name);
+        Py_Return;
+    } PY_CATCH
+}
+
 PyObject* Application::sAddDocObserver(PyObject * /*self*/, PyObject *args)
 {
     PyObject* o;
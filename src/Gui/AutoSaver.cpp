@@ -60,6 +60,9 @@ AutoSaver* AutoSaver::self = 0;
 AutoSaver::AutoSaver(QObject* parent)
   : QObject(parent), timeout(900000), compressed(true)
 {
+    // the journal is appended by one thread at a time
+    journalPool = new QThreadPool(this);
+    journalPool->setMaxThreadCount(1);
     App::GetApplication().signalNewDocument.connect(boost::bind(&AutoSaver::slotCreateDocument, this, bp::_1));
     App::GetApplication().signalDeleteDocument.connect(boost::bind(&AutoSaver::slotDeleteDocument, this, bp::_1));
 }
@@ -126,11 +129,23 @@ void AutoSaver::slotDeleteDocument(const App::Document& Doc)
     if (it != saverMap.end()) {
         if (it->second->timerId > 0)
             killTimer(it->second->timerId);
+        journalPool->waitForDone();
         delete it->second;
         saverMap.erase(it);
     }
 }
 
+void AutoSaver::saveDocument(const std::string& name)
+{
+    std::map<std::string, AutoSaveProperty*>::iterator it = saverMap.find(name);
+    if (it != saverMap.end()) {
+        saveDocument(it->first, *it->second);
+        it->second->touched.clear();
+        it->second->clearChanged();
+        journalPool->waitForDone();
+    }
+}
+
 void AutoSaver::saveDocument(const std::string& name, AutoSaveProperty& saver)
 {
     Gui::WaitCursor wc;
@@ -195,24 +210,44 @@ void AutoSaver::saveDocument(const std::string& name, AutoSaveProperty& saver)
                 std::string fn = doc->TransientDir.getValue();
                 fn += "/fc_recovery_file.fcstd";
                 Base::FileInfo tmp(fn);
-                Base::ofstream file(tmp, std::ios::out | std::ios::binary);
-                if (file.is_open())
-                {
-                    Base::ZipWriter writer(file);
-                    if (hGrp->GetBool("SaveBinaryBrep", true))
-                        writer.setMode("BinaryBrep");
-
-                    writer.setComment("AutoRecovery file");
-                    writer.setLevel(1); // apparently the fastest compression
-                    writer.putNextEntry("Document.xml");
-
-                    doc->Save(writer);
-
-                    // Special handling for Gui document.
-                    doc->signalSaveDocument(writer);
-
-                    // write additional files
-                    writer.writeFiles();
+                std::string jn = doc->TransientDir.getValue();
+                jn += "/fc_recovery_journal.dat";
+                Base::FileInfo journal(jn);
+
+                // Only append the changed properties to the journal as long as it's
+                // smaller than the recovery file, otherwise rewrite the whole file.
+                bool append = hGrp->GetBool("AutoSaveJournal", true) && !saver.compact
+                    && saver.journalCount < hGrp->GetInt("AutoSaveCompactInterval", 10)
+                    && tmp.exists() && (!journal.exists() || journal.size() < tmp.size());
+                if (append && saveJournal(doc, saver, jn)) {
+                    FC_LOG("auto saver appended " << saver.changed.size() << " properties to journal");
+                }
+                else {
+                    // the journal is discarded with the full save
+                    journalPool->waitForDone();
+                    journal.deleteFile();
+                    saver.compact = false;
+                    saver.journalCount = 0;
+
+                    Base::ofstream file(tmp, std::ios::out | std::ios::binary);
+                    if (file.is_open())
+                    {
+                        Base::ZipWriter writer(file);
+                        if (hGrp->GetBool("SaveBinaryBrep", true))
+                            writer.setMode("BinaryBrep");
+
+                        writer.setComment("AutoRecovery file");
+                        writer.setLevel(1); // apparently the fastest compression
+                        writer.putNextEntry("Document.xml");
+
+                        doc->Save(writer);
+
+                        // Special handling for Gui document.
+                        doc->signalSaveDocument(writer);
+
+                        // write additional files
+                        writer.writeFiles();
+                    }
                 }
             }
         }
@@ -231,6 +266,7 @@ void AutoSaver::timerEvent(QTimerEvent * event)
             try {
                 saveDocument(it->first, *it->second);
                 it->second->touched.clear();
+                it->second->clearChanged();
                 break;
             }
             catch (...) {
@@ -242,22 +278,241 @@ void AutoSaver::timerEvent(QTimerEvent * event)
 
 // ----------------------------------------------------------------------------
 
-AutoSaveProperty::AutoSaveProperty(const App::Document* doc) : timerId(-1)
+namespace Gui {
+
+/*
+ The journal is a sequence of records, each holding the name of an object, the name
+ of one of its properties and the property as written by Persistence::dumpToStream().
+ A record that was cut off by a crash is ignored when reading the journal.
+ */
+class JournalRunnable : public QRunnable
+{
+public:
+    JournalRunnable(const std::string& fileName)
+        : fileName(fileName)
+    {
+    }
+    virtual ~JournalRunnable()
+    {
+    }
+    /// adds the already serialized \a data of a property
+    void addData(const std::string& object, const std::string& name, const std::string& data)
+    {
+        Record rec;
+        rec.object = object;
+        rec.name = name;
+        rec.data = data;
+        records.push_back(rec);
+    }
+    /// adds a snapshot of a property that is serialized in the thread
+    void addProperty(const std::string& object, const std::string& name,
+                     const std::shared_ptr<const App::Property>& prop)
+    {
+        Record rec;
+        rec.object = object;
+        rec.name = name;
+        rec.prop = prop;
+        records.push_back(rec);
+    }
+    virtual void run()
+    {
+        Base::FileInfo fi(fileName);
+        Base::ofstream file(fi, std::ios::out | std::ios::binary | std::ios::app);
+        if (!file.is_open())
+            return;
+
+        for (std::vector<Record>::iterator it = records.begin(); it != records.end(); ++it) {
+            try {
+                if (it->prop) {
+                    std::ostringstream str;
+                    it->prop->dumpToStream(str, 1);
+                    it->data = str.str();
+                    it->prop.reset();
+                }
+            }
+            catch (...) {
+                Base::Console().Error("Failed to write property '%s.%s' to recovery journal\n",
+                    it->object.c_str(), it->name.c_str());
+                continue;
+            }
+
+            Base::OutputStream str(file);
+            str << static_cast<uint32_t>(JournalTag);
+            writeString(str, file, it->object);
+            writeString(str, file, it->name);
+            writeString(str, file, it->data);
+        }
+        file.flush();
+    }
+
+    static const uint32_t JournalTag = 0x4C4E524A; // "JRNL"
+
+    static void writeString(Base::OutputStream& str, std::ostream& out, const std::string& s)
+    {
+        str << static_cast<uint64_t>(s.size());
+        out.write(s.c_str(), s.size());
+    }
+    static bool readString(Base::InputStream& str, std::istream& in, std::string& s)
+    {
+        uint64_t size = 0;
+        str >> size;
+        if (!in)
+            return false;
+        s.resize(static_cast<std::size_t>(size));
+        if (size > 0)
+            in.read(&s[0], s.size());
+        return in.gcount() == static_cast<std::streamsize>(s.size()) && !in.fail();
+    }
+
+private:
+    struct Record {
+        std::string object;
+        std::string name;
+        std::string data;
+        std::shared_ptr<const App::Property> prop;
+    };
+    std::string fileName;
+    std::vector<Record> records;
+};
+
+}
+
+bool AutoSaver::saveJournal(App::Document* doc, AutoSaveProperty& saver, const std::string& fileName)
+{
+    // The properties are snapshot or serialized now to have a consistent state.
+    // Properties that can be saved in a thread are serialized by the journal thread.
+    // They are written in the order of their first change so that the journal is
+    // replayed in the same order.
+    std::unique_ptr<JournalRunnable> task(new JournalRunnable(fileName));
+    for (std::vector<const App::Property*>::const_iterator it = saver.changed.begin(); it != saver.changed.end(); ++it) {
+        const App::Property* prop = *it;
+        App::PropertyContainer* parent = prop->getContainer();
+        if (!parent || !parent->isDerivedFrom(App::DocumentObject::getClassTypeId()))
+            return false;
+        App::DocumentObject* obj = static_cast<App::DocumentObject*>(parent);
+        if (!obj->getNameInDocument() || obj->getDocument() != doc || !prop->getName())
+            return false;
+
+        if (prop->canSaveDocFileInThread()) {
+            task->addProperty(obj->getNameInDocument(), prop->getName(), prop->Snapshot());
+        }
+        else {
+            std::ostringstream str;
+            prop->dumpToStream(str, 1);
+            task->addData(obj->getNameInDocument(), prop->getName(), str.str());
+        }
+    }
+
+    journalPool->start(task.release());
+    saver.journalCount++;
+    return true;
+}
+
+void AutoSaver::replayJournal(App::Document* doc, const std::string& fileName)
+{
+    Base::FileInfo fi(fileName);
+    Base::ifstream file(fi, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return;
+
+    // Like on restore the objects must not react on the changes of their
+    // properties, e.g. by changing other properties that are in the journal too.
+    Base::ObjectStatusLocker<App::Document::Status, App::Document> restoreBit(App::Document::Restoring, doc);
+
+    Base::InputStream str(file);
+    int count = 0;
+    for (;;) {
+        uint32_t tag = 0;
+        str >> tag;
+        if (!file || tag != JournalRunnable::JournalTag)
+            break;
+
+        std::string object, name, data;
+        if (!JournalRunnable::readString(str, file, object) ||
+            !JournalRunnable::readString(str, file, name) ||
+            !JournalRunnable::readString(str, file, data)) {
+            FC_WARN("Ignore incomplete record at the end of recovery journal");
+            break;
+        }
+
+        App::DocumentObject* obj = doc->getObject(object.c_str());
+        App::Property* prop = obj ? obj->getPropertyByName(name.c_str()) : 0;
+        if (!prop) {
+            FC_WARN("Ignore unknown property '" << object << "." << name << "' in recovery journal");
+            continue;
+        }
+
+        try {
+            Base::ObjectStatusLocker<App::ObjectStatus, App::DocumentObject> restore(App::ObjectStatus::Restore, obj);
+            std::istringstream in(data);
+            prop->restoreFromStream(in);
+            count++;
+        }
+        catch (const Base::Exception& e) {
+            FC_ERR("Failed to recover property '" << object << "." << name << "': " << e.what());
+        }
+        catch (...) {
+            FC_ERR("Failed to recover property '" << object << "." << name << "'");
+        }
+    }
+
+    FC_LOG("Recovered " << count << " properties from journal " << fileName);
+}
+
+// ----------------------------------------------------------------------------
+
+AutoSaveProperty::AutoSaveProperty(const App::Document* doc)
+  : timerId(-1), compact(true), journalCount(0), document(doc)
 {
     documentNew = const_cast<App::Document*>(doc)->signalNewObject.connect
         (boost::bind(&AutoSaveProperty::slotNewObject, this, bp::_1));
+    documentDel = const_cast<App::Document*>(doc)->signalDeletedObject.connect
+        (boost::bind(&AutoSaveProperty::slotDeletedObject, this, bp::_1));
     documentMod = const_cast<App::Document*>(doc)->signalChangedObject.connect
         (boost::bind(&AutoSaveProperty::slotChangePropertyData, this, bp::_2));
+    propertyAdd = App::GetApplication().signalAppendDynamicProperty.connect
+        (boost::bind(&AutoSaveProperty::slotDynamicProperty, this, bp::_1));
+    propertyRem = App::GetApplication().signalRemoveDynamicProperty.connect
+        (boost::bind(&AutoSaveProperty::slotDynamicProperty, this, bp::_1));
 }
 
 AutoSaveProperty::~AutoSaveProperty()
 {
     documentNew.disconnect();
+    documentDel.disconnect();
     documentMod.disconnect();
+    propertyAdd.disconnect();
+    propertyRem.disconnect();
+}
+
+void AutoSaveProperty::slotDeletedObject(const App::DocumentObject&)
+{
+    // the journal only records changed properties of existing objects
+    compact = true;
+    clearChanged();
+}
+
+void AutoSaveProperty::slotDynamicProperty(const App::Property& prop)
+{
+    App::PropertyContainer* parent = prop.getContainer();
+    if (parent && parent->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
+        if (static_cast<App::DocumentObject*>(parent)->getDocument() == document) {
+            compact = true;
+            clearChanged();
+        }
+    }
+}
+
+void AutoSaveProperty::clearChanged()
+{
+    changed.clear();
+    changedSet.clear();
 }
 
 void AutoSaveProperty::slotNewObject(const App::DocumentObject& obj)
 {
+    compact = true;
+
     std::vector<App::Property*> props;
     obj.getPropertyList(props);
 
@@ -274,6 +529,8 @@ void AutoSaveProperty::slotChangePropertyData(const App::Property& prop)
     str << static_cast<const void *>(&prop) << std::ends;
     std::string address = str.str();
     this->touched.insert(address);
+    if (!compact && this->changedSet.insert(&prop).second)
+        this->changed.push_back(&prop);
 }
 
 // ----------------------------------------------------------------------------
@@ -324,7 +581,7 @@ class RecoveryRunnable : public QRunnable
 {
 public:
     RecoveryRunnable(const std::set<std::string>& modes, const char* dir, const char* file, const App::Property* p)
-        : prop(p->Copy())
+        : prop(p->Snapshot())
         , writer(dir)
     {
         writer.setModes(modes);
@@ -336,7 +593,6 @@ public:
     }
     virtual ~RecoveryRunnable()
     {
-        delete prop;
     }
     virtual void run()
     {
@@ -354,7 +610,7 @@ public:
     }
 
 private:
-    App::Property* prop;
+    std::shared_ptr<const App::Property> prop;
     Base::FileWriter writer;
     QString dirName;
     QString fileName;
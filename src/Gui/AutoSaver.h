@@ -29,8 +29,11 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 #include <boost_signals2.hpp>
 
+class QThreadPool;
+
 namespace App {
 class Document;
 class DocumentObject;
@@ -49,13 +52,30 @@ public:
     std::set<std::string> touched;
     std::string dirName;
     std::map<std::string, std::string> fileMap;
+    /// changed properties of document objects since the last auto-save
+    /// in the order of their first change
+    std::vector<const App::Property*> changed;
+    /// the properties of changed for a fast lookup
+    std::set<const App::Property*> changedSet;
+    /// true if the next auto-save must write the whole document
+    bool compact;
+    /// the number of journal updates since the whole document was written
+    int journalCount;
+
+    void clearChanged();
 
 private:
     void slotNewObject(const App::DocumentObject&);
+    void slotDeletedObject(const App::DocumentObject&);
     void slotChangePropertyData(const App::Property&);
+    void slotDynamicProperty(const App::Property&);
     typedef boost::signals2::connection Connection;
+    const App::Document* document;
     Connection documentNew;
+    Connection documentDel;
     Connection documentMod;
+    Connection propertyAdd;
+    Connection propertyRem;
 };
 
 /*!
@@ -81,12 +101,23 @@ public:
      Enables or disables to create compreesed recovery files.
      */
     void setCompressed(bool on);
+    /*!
+     Writes the recovery data of the document \a name now and waits until
+     the journal has been written.
+     */
+    void saveDocument(const std::string& name);
+    /*!
+     Applies the changes recorded in the journal file \a fileName to the
+     document \a doc that has been opened from the compressed recovery file.
+     */
+    static void replayJournal(App::Document* doc, const std::string& fileName);
 
 protected:
     void slotCreateDocument(const App::Document& Doc);
     void slotDeleteDocument(const App::Document& Doc);
     void timerEvent(QTimerEvent * event);
     void saveDocument(const std::string&, AutoSaveProperty&);
+    bool saveJournal(App::Document*, AutoSaveProperty&, const std::string&);
 
 public Q_SLOTS:
     void renameFile(QString dirName, QString file, QString tmpFile);
@@ -95,6 +126,7 @@ private:
     int timeout; /*!< Timeout in milliseconds */
     bool compressed;
     std::map<std::string, AutoSaveProperty*> saverMap;
+    QThreadPool* journalPool;
 };
 
 class RecoveryWriter : public Base::FileWriter
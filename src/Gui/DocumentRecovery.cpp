@@ -50,6 +50,7 @@
 #include <Base/Console.h>
 #include "DocumentRecovery.h"
 #include "ui_DocumentRecovery.h"
+#include "AutoSaver.h"
 #include "WaitCursor.h"
 
 #include <Base/Exception.h>
@@ -302,6 +303,12 @@ void DocumentRecovery::accept()
                 d->writeRecoveryInfo(info);
             }
             else {
+                // apply the changes saved after the compressed recovery file
+                QFileInfo fi(info.projectFile);
+                QFileInfo jfi(fi.dir(), QLatin1String("fc_recovery_journal.dat"));
+                if (fi.fileName() == QLatin1String("fc_recovery_file.fcstd") && jfi.exists())
+                    AutoSaver::replayJournal(docs[i], jfi.absoluteFilePath().toUtf8().constData());
+
                 auto gdoc = Application::Instance->getDocument(docs[i]);
                 if (gdoc)
                     gdoc->setModified(true);
@@ -315,12 +322,16 @@ void DocumentRecovery::accept()
                 QDir transDir(QString::fromUtf8(docs[i]->TransientDir.getValue()));
 
                 QFileInfo xfi(info.xmlFile);
-                QFileInfo fi(info.projectFile);
                 bool res = false;
 
                 if (fi.fileName() == QLatin1String("fc_recovery_file.fcstd")) {
                     transDir.remove(fi.fileName());
                     res = transDir.rename(fi.absoluteFilePath(),fi.fileName());
+                    // keep the journal in case of another crash
+                    if (res && jfi.exists()) {
+                        transDir.remove(jfi.fileName());
+                        res = transDir.rename(jfi.absoluteFilePath(),jfi.fileName());
+                    }
                 }
                 else {
                     transDir.rmdir(fi.dir().dirName());
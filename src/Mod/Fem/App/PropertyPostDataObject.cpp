@@ -69,6 +69,7 @@ PropertyPostDataObject::~PropertyPostDataObject()
 void PropertyPostDataObject::setValue(const vtkSmartPointer<vtkDataObject>& ds)
 {
     aboutToSetValue();
+    _loader.reset();
 
     if(ds) {
         createDataObjectByExternalType(ds);
@@ -82,20 +83,24 @@ void PropertyPostDataObject::setValue(const vtkSmartPointer<vtkDataObject>& ds)
 
 const vtkSmartPointer<vtkDataObject>& PropertyPostDataObject::getValue(void)const
 {
+    restoreLazily();
     return m_dataObject;
 }
 
 bool PropertyPostDataObject::isComposite() {
+    restoreLazily();
 
     return m_dataObject && !m_dataObject->IsA("vtkDataSet");
 }
 
 bool PropertyPostDataObject::isDataSet() {
+    restoreLazily();
 
     return m_dataObject && m_dataObject->IsA("vtkDataSet");
 }
 
 int PropertyPostDataObject::getDataType() {
+    restoreLazily();
 
     if(!m_dataObject)
         return -1;
@@ -117,6 +122,7 @@ void PropertyPostDataObject::setPyObject(PyObject * /*value*/)
 
 App::Property *PropertyPostDataObject::Copy(void) const
 {
+    restoreLazily();
     PropertyPostDataObject *prop = new PropertyPostDataObject();
     if (m_dataObject) {
 
@@ -163,13 +169,17 @@ void PropertyPostDataObject::createDataObjectByExternalType(vtkSmartPointer< vtk
 
 void PropertyPostDataObject::Paste(const App::Property &from)
 {
+    const PropertyPostDataObject& prop = dynamic_cast<const PropertyPostDataObject&>(from);
+    prop.restoreLazily();
     aboutToSetValue();
-    m_dataObject = dynamic_cast<const PropertyPostDataObject&>(from).m_dataObject;
+    _loader.reset();
+    m_dataObject = prop.m_dataObject;
     hasSetValue();
 }
 
 unsigned int PropertyPostDataObject::getMemSize (void) const
 {
+    restoreLazily();
     return m_dataObject->GetActualMemorySize();
 }
 
@@ -189,6 +199,7 @@ void PropertyPostDataObject::getPaths(std::vector<App::ObjectIdentifier> & /*pat
 
 void PropertyPostDataObject::Save (Base::Writer &writer) const
 {
+    restoreLazily();
     std::string extension;
     if(!m_dataObject)
         return;
@@ -248,6 +259,12 @@ void PropertyPostDataObject::Restore(Base::XMLReader &reader)
 
 void PropertyPostDataObject::SaveDocFile (Base::Writer &writer) const
 {
+    restoreLazily();
+    if (_loader && _loader->isPending()) {
+        // don't replace the data in the project file that couldn't be read
+        writer.addError(std::string("Cannot save '") + getName() + "' because its data couldn't be loaded");
+        return;
+    }
     // If the shape is empty we simply store nothing. The file size will be 0 which
     // can be checked when reading in the data.
     if (!m_dataObject)
@@ -294,8 +311,9 @@ void PropertyPostDataObject::SaveDocFile (Base::Writer &writer) const
     fi.deleteFile();
 }
 
-void PropertyPostDataObject::RestoreDocFile(Base::Reader &reader)
+vtkSmartPointer<vtkDataObject> PropertyPostDataObject::readDataObject(Base::Reader &reader) const
 {
+    vtkSmartPointer<vtkDataObject> dataObject;
     Base::FileInfo xml(reader.getFileName());
     // create a temporary file and copy the content from the zip stream
     Base::FileInfo fi(App::Application::getTempFileName());
@@ -347,13 +365,43 @@ void PropertyPostDataObject::RestoreDocFile(Base::Reader &reader)
             }
         }
         else {
-            aboutToSetValue();
-            createDataObjectByExternalType(xmlReader->GetOutputAsDataSet());
-            m_dataObject->DeepCopy(xmlReader->GetOutputAsDataSet());
-            hasSetValue();
+            dataObject = xmlReader->GetOutputAsDataSet();
         }
     }
 
     // delete the temp file
     fi.deleteFile();
+    return dataObject;
+}
+
+void PropertyPostDataObject::RestoreDocFile(Base::Reader &reader)
+{
+    _loader.reset();
+    vtkSmartPointer<vtkDataObject> dataObject = readDataObject(reader);
+    if (dataObject) {
+        aboutToSetValue();
+        createDataObjectByExternalType(dataObject);
+        m_dataObject->DeepCopy(dataObject);
+        hasSetValue();
+    }
+}
+
+bool PropertyPostDataObject::RestoreDocFileLater(const std::shared_ptr<Base::DocFileLoader>& loader)
+{
+    _loader = loader;
+    return true;
+}
+
+void PropertyPostDataObject::restoreLazily() const
+{
+    if (_loader && _loader->isPending()) {
+        PropertyPostDataObject* self = const_cast<PropertyPostDataObject*>(this);
+        _loader->read([self](Base::Reader& reader) {
+            vtkSmartPointer<vtkDataObject> dataObject = self->readDataObject(reader);
+            if (dataObject) {
+                self->createDataObjectByExternalType(dataObject);
+                self->m_dataObject->DeepCopy(dataObject);
+            }
+        });
+    }
 }
@@ -68,6 +68,7 @@ public:
 
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    bool RestoreDocFileLater(const std::shared_ptr<Base::DocFileLoader>& loader);
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
@@ -80,6 +81,12 @@ public:
 protected:
     void createDataObjectByExternalType(vtkSmartPointer<vtkDataObject> ex);
     vtkSmartPointer<vtkDataObject> m_dataObject;
+
+private:
+    vtkSmartPointer<vtkDataObject> readDataObject(Base::Reader &reader) const;
+    /// reads the data set if it was skipped on restore
+    void restoreLazily() const;
+    std::shared_ptr<Base::DocFileLoader> _loader;
 };
 
 } //namespace FEM
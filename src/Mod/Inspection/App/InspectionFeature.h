@@ -24,6 +24,7 @@
 #ifndef INSPECTION_FEATURE_H
 #define INSPECTION_FEATURE_H
 
+#include <memory>
 #include <App/DocumentObject.h>
 #include <App/PropertyLinks.h>
 #include <App/DocumentObjectGroup.h>
@@ -37,6 +38,7 @@ class BRepExtrema_DistShapeShape;
 namespace MeshCore {
 class MeshKernel;
 class MeshGrid;
+class MeshFacetBVH;
 }
 
 namespace Mesh   { class MeshObject; }
@@ -112,10 +114,11 @@ public:
 
 private:
     const MeshCore::MeshKernel& _mesh;
-    MeshCore::MeshGrid* _pGrid;
+    std::shared_ptr<const MeshCore::MeshFacetBVH> _tree;
     Base::BoundBox3f _box;
     bool _bApply;
     Base::Matrix4D _clTrf;
+    Base::Matrix4D _clInv;
 };
 
 class InspectionExport InspectNominalFastMesh : public InspectNominalGeometry
@@ -30,6 +30,7 @@
 #include <CXX/Extensions.hxx>
 #include <CXX/Objects.hxx>
 
+#include <Base/Converter.h>
 #include <Base/Interpreter.h>
 #include <Base/FileInfo.h>
 #include <Base/Tools.h>
@@ -41,12 +42,15 @@
 
 #include <Base/GeometryPyCXX.h>
 #include <Base/VectorPy.h>
+#include <Base/BoundBoxPy.h>
 
 #include "Core/MeshKernel.h"
 #include "Core/MeshIO.h"
 #include "Core/Evaluation.h"
 #include "Core/Iterator.h"
 #include "Core/Approximation.h"
+#include "Core/OutOfCore.h"
+#include "Core/Projection.h"
 
 #include "WildMagic4/Wm4ContBox3.h"
 
@@ -67,6 +71,26 @@ public:
         add_varargs_method("read",&Module::read,
             "Read a mesh from a file and returns a Mesh object."
         );
+        add_varargs_method("outOfCoreStatistics",&Module::outOfCoreStatistics,
+            "outOfCoreStatistics(string, string, [int=1000000]) -> dict\n"
+            "Splits a binary STL file that is too big to be loaded into chunk\n"
+            "files of at most about the given number of facets in the directory.\n"
+            "Returns the number of chunks and facets, the bounding box, area,\n"
+            "volume and whether the mesh is solid."
+        );
+        add_varargs_method("outOfCoreFacets",&Module::outOfCoreFacets,
+            "outOfCoreFacets(string, [int]) -> list\n"
+            "Returns the corner points of the facets with the given indices of\n"
+            "the chunk files in the directory. The indices are global, i.e. they\n"
+            "count the facets of all chunks in the order of the chunks."
+        );
+        add_varargs_method("projectLineOutOfCore",&Module::projectLineOutOfCore,
+            "projectLineOutOfCore(string, Vector, int, Vector, int, Vector) -> list\n"
+            "Projects the line between two points along the view direction onto\n"
+            "the mesh in the chunk files of the directory. The start and end\n"
+            "point must lie on the facets with the given global indices.\n"
+            "Returns the points of the projected polyline."
+        );
         add_varargs_method("open",&Module::open,
             "open(string)\n"
             "Create a new document and a Mesh feature to load the file into\n"
@@ -164,6 +188,93 @@ private:
         mesh->load(EncodedName.c_str());
         return Py::asObject(new MeshPy(mesh.release()));
     }
+    Py::Object outOfCoreStatistics(const Py::Tuple& args)
+    {
+        char* Name;
+        char* Dir;
+        unsigned long maxFacets = 1000000;
+        if (!PyArg_ParseTuple(args.ptr(), "etet|k","utf-8",&Name,"utf-8",&Dir,&maxFacets))
+            throw Py::Exception();
+        std::string EncodedName = std::string(Name);
+        PyMem_Free(Name);
+        std::string EncodedDir = std::string(Dir);
+        PyMem_Free(Dir);
+
+        MeshCore::MeshOutOfCoreKernel kernel;
+        if (!kernel.Create(EncodedName, EncodedDir, maxFacets))
+            throw Py::RuntimeError("Failed to split the binary STL file into chunks");
+
+        Base::BoundBox3f bbox = kernel.GetBoundBox();
+        Py::Dict dict;
+        dict.setItem(Py::String("Chunks"), Py::Long(kernel.CountChunks()));
+        dict.setItem(Py::String("Facets"), Py::Long(kernel.CountFacets()));
+        dict.setItem(Py::String("BoundBox"), Py::asObject(new Base::BoundBoxPy(new Base::BoundBox3d(
+            bbox.MinX, bbox.MinY, bbox.MinZ, bbox.MaxX, bbox.MaxY, bbox.MaxZ))));
+        dict.setItem(Py::String("Area"), Py::Float(kernel.GetSurface()));
+        dict.setItem(Py::String("Volume"), Py::Float(kernel.GetVolume()));
+        dict.setItem(Py::String("Solid"), Py::Boolean(!kernel.HasOpenEdges()));
+        return dict;
+    }
+    Py::Object outOfCoreFacets(const Py::Tuple& args)
+    {
+        char* Dir;
+        PyObject* list;
+        if (!PyArg_ParseTuple(args.ptr(), "etO","utf-8",&Dir,&list))
+            throw Py::Exception();
+        std::string EncodedDir = std::string(Dir);
+        PyMem_Free(Dir);
+
+        MeshCore::MeshOutOfCoreKernel kernel;
+        if (!kernel.Open(EncodedDir))
+            throw Py::RuntimeError("Failed to open the chunk files");
+
+        Py::Sequence indices(list);
+        Py::List facets;
+        for (Py::Sequence::iterator it = indices.begin(); it != indices.end(); ++it) {
+            unsigned long index = static_cast<unsigned long>(static_cast<long>(Py::Long(*it)));
+            if (index >= kernel.CountFacets())
+                throw Py::IndexError("Facet index out of range");
+            MeshCore::MeshGeomFacet facet = kernel.GetFacet(index);
+            Py::Tuple points(3);
+            for (int i = 0; i < 3; i++)
+                points.setItem(i, Py::Vector(facet._aclPoints[i]));
+            facets.append(points);
+        }
+        return facets;
+    }
+    Py::Object projectLineOutOfCore(const Py::Tuple& args)
+    {
+        char* Dir;
+        PyObject *p1, *p2, *view;
+        unsigned long f1, f2;
+        if (!PyArg_ParseTuple(args.ptr(), "etO!kO!kO!","utf-8",&Dir,
+                              &Base::VectorPy::Type, &p1, &f1,
+                              &Base::VectorPy::Type, &p2, &f2,
+                              &Base::VectorPy::Type, &view))
+            throw Py::Exception();
+        std::string EncodedDir = std::string(Dir);
+        PyMem_Free(Dir);
+
+        MeshCore::MeshOutOfCoreKernel kernel;
+        if (!kernel.Open(EncodedDir))
+            throw Py::RuntimeError("Failed to open the chunk files");
+
+        Base::Vector3d v1 = Py::Vector(p1, false).toVector();
+        Base::Vector3d v2 = Py::Vector(p2, false).toVector();
+        Base::Vector3d vd = Py::Vector(view, false).toVector();
+
+        std::vector<Base::Vector3f> polyline;
+        MeshCore::MeshProjection proj(kernel);
+        if (!proj.projectLineOnMesh(Base::convertTo<Base::Vector3f>(v1), f1,
+                                    Base::convertTo<Base::Vector3f>(v2), f2,
+                                    Base::convertTo<Base::Vector3f>(vd), polyline))
+            throw Py::RuntimeError("Failed to project the line onto the mesh");
+
+        Py::List points;
+        for (std::vector<Base::Vector3f>::iterator it = polyline.begin(); it != polyline.end(); ++it)
+            points.append(Py::Vector(*it));
+        return points;
+    }
     Py::Object open(const Py::Tuple& args)
     {
         char* Name;
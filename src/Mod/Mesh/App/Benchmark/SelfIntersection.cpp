@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (c) 2020 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+// Compares MeshEvalSelfIntersection with the serial grid walk it replaced.
+// Usage: MeshBenchmarkSelfIntersection [rings]
+// Two overlapping spheres with 8 * rings^2 facets in total are checked.
+
+#include <FCConfig.h>
+
+#ifdef FC_OS_WIN32
+# define MeshExport __declspec(dllimport)
+#else
+# define MeshExport
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <Mod/Mesh/App/Core/Evaluation.h>
+#include <Mod/Mesh/App/Core/Grid.h>
+#include <Mod/Mesh/App/Core/Iterator.h>
+#include <Mod/Mesh/App/Core/MeshKernel.h>
+
+using namespace MeshCore;
+
+typedef std::vector<std::pair<unsigned long, unsigned long> > PairArray;
+
+static void addSphere(std::vector<MeshGeomFacet>& facets, const Base::Vector3f& center,
+                      float radius, int rings)
+{
+    const double pi = 3.14159265358979323846;
+    int segments = 2 * rings;
+    auto point = [&](int i, int j) {
+        double theta = pi * i / rings;
+        double phi = 2.0 * pi * j / segments;
+        return center + radius * Base::Vector3f(float(std::sin(theta) * std::cos(phi)),
+                                                float(std::sin(theta) * std::sin(phi)),
+                                                float(std::cos(theta)));
+    };
+
+    for (int i = 0; i < rings; i++) {
+        for (int j = 0; j < segments; j++) {
+            Base::Vector3f p00 = point(i, j), p01 = point(i, j + 1);
+            Base::Vector3f p10 = point(i + 1, j), p11 = point(i + 1, j + 1);
+            if (i > 0)
+                facets.emplace_back(p00, p10, p01);
+            if (i < rings - 1)
+                facets.emplace_back(p01, p10, p11);
+        }
+    }
+}
+
+// The implementation of MeshEvalSelfIntersection::GetIntersections() before
+// it was parallelized. A pair that shares several grid cells is reported once
+// per cell.
+static void serialIntersections(const MeshKernel& mesh, PairArray& intersection)
+{
+    std::vector<Base::BoundBox3f> boxes;
+
+    MeshFacetGrid cMeshFacetGrid(mesh);
+    const MeshFacetArray& rFaces = mesh.GetFacets();
+    MeshGridIterator clGridIter(cMeshFacetGrid);
+
+    MeshFacetIterator cMFI(mesh);
+    for (cMFI.Begin(); cMFI.More(); cMFI.Next()) {
+        boxes.push_back((*cMFI).GetBoundBox());
+    }
+
+    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
+        std::vector<unsigned long> aulGridElements;
+        clGridIter.GetElements(aulGridElements);
+        if (aulGridElements.empty())
+            continue;
+
+        MeshGeomFacet facet1, facet2;
+        Base::Vector3f pt1, pt2;
+        for (auto it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
+            const Base::BoundBox3f& box1 = boxes[*it];
+            cMFI.Set(*it);
+            facet1 = *cMFI;
+            const MeshFacet& rface1 = rFaces[*it];
+            for (auto jt = it + 1; jt != aulGridElements.end(); ++jt) {
+                // ignore facets sharing a common vertex
+                const MeshFacet& rface2 = rFaces[*jt];
+                bool common = false;
+                for (int i = 0; i < 3 && !common; i++) {
+                    for (int j = 0; j < 3; j++) {
+                        if (rface1._aulPoints[i] == rface2._aulPoints[j]) {
+                            common = true;
+                            break;
+                        }
+                    }
+                }
+                if (common)
+                    continue;
+
+                const Base::BoundBox3f& box2 = boxes[*jt];
+                if (box1 && box2) {
+                    cMFI.Set(*jt);
+                    facet2 = *cMFI;
+                    if (facet1.IntersectWithFacet(facet2, pt1, pt2) == 2)
+                        intersection.emplace_back(*it, *jt);
+                }
+            }
+        }
+    }
+}
+
+template <typename Func>
+static double measure(Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void normalize(PairArray& pairs)
+{
+    for (auto& it : pairs) {
+        if (it.first > it.second)
+            std::swap(it.first, it.second);
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+int main(int argc, char** argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 250;
+    if (rings < 2) {
+        std::cerr << "Usage: " << argv[0] << " [rings]" << std::endl;
+        return 1;
+    }
+
+    std::vector<MeshGeomFacet> facets;
+    addSphere(facets, Base::Vector3f(0.0f, 0.0f, 0.0f), 10.0f, rings);
+    addSphere(facets, Base::Vector3f(7.0f, 3.0f, 1.0f), 8.0f, rings);
+    MeshKernel mesh;
+    mesh = facets;
+    std::cout << "Facets: " << mesh.CountFacets() << std::endl;
+
+    PairArray serial, parallel;
+    double serialTime = measure([&]() { serialIntersections(mesh, serial); });
+    double parallelTime = measure([&]() {
+        MeshEvalSelfIntersection eval(mesh);
+        eval.GetIntersections(parallel);
+    });
+
+    std::size_t reported = serial.size();
+    normalize(serial);
+    std::cout << "Serial:   " << serialTime << " s, " << reported
+              << " pairs reported, " << serial.size() << " unique" << std::endl;
+    std::cout << "Parallel: " << parallelTime << " s, " << parallel.size()
+              << " pairs" << std::endl;
+    std::cout << "Speed-up: " << serialTime / parallelTime << std::endl;
+
+    normalize(parallel);
+    if (serial != parallel) {
+        std::cerr << "The results differ" << std::endl;
+        return 1;
+    }
+    return 0;
+}
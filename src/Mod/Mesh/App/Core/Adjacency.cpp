@@ -0,0 +1,362 @@
+/***************************************************************************
+ *   Copyright (c) 2018 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+#endif
+
+#include <QMutexLocker>
+
+#include "Adjacency.h"
+#include "MeshKernel.h"
+
+using namespace MeshCore;
+
+MeshIndexRows::MeshIndexRows()
+  : _ulGarbage(0)
+{
+}
+
+void MeshIndexRows::Clear()
+{
+    _aulStart.clear();
+    _aulCount.clear();
+    _aulCapacity.clear();
+    _aulIndices.clear();
+    _ulGarbage = 0;
+}
+
+void MeshIndexRows::Reserve(const std::vector<unsigned long>& counts)
+{
+    std::size_t rows = counts.size();
+    _aulStart.resize(rows);
+    _aulCount.assign(rows, 0);
+    _aulCapacity.resize(rows);
+
+    // leave some room in each row for later insertions
+    unsigned long offset = 0;
+    for (std::size_t i = 0; i < rows; i++) {
+        _aulStart[i] = offset;
+        _aulCapacity[i] = counts[i] + 2;
+        offset += _aulCapacity[i];
+    }
+
+    _aulIndices.resize(offset);
+    _ulGarbage = 0;
+}
+
+void MeshIndexRows::Resize(unsigned long rows)
+{
+    if (rows <= CountRows())
+        return;
+
+    unsigned long offset = static_cast<unsigned long>(_aulIndices.size());
+    _aulStart.reserve(rows);
+    _aulCapacity.reserve(rows);
+    for (unsigned long i = CountRows(); i < rows; i++) {
+        _aulStart.push_back(offset);
+        _aulCapacity.push_back(2);
+        offset += 2;
+    }
+
+    _aulCount.resize(rows, 0);
+    _aulIndices.resize(offset);
+}
+
+bool MeshIndexRows::Contains(unsigned long row, unsigned long value) const
+{
+    return std::binary_search(Begin(row), End(row), value);
+}
+
+void MeshIndexRows::Sort()
+{
+    for (std::size_t i = 0; i < _aulCount.size(); i++) {
+        std::vector<unsigned long>::iterator first = _aulIndices.begin() + _aulStart[i];
+        std::vector<unsigned long>::iterator last = first + _aulCount[i];
+        std::sort(first, last);
+        _aulCount[i] = static_cast<unsigned long>(std::unique(first, last) - first);
+    }
+}
+
+bool MeshIndexRows::Insert(unsigned long row, unsigned long value)
+{
+    std::vector<unsigned long>::iterator first = _aulIndices.begin() + _aulStart[row];
+    std::vector<unsigned long>::iterator last = first + _aulCount[row];
+    std::vector<unsigned long>::iterator it = std::lower_bound(first, last, value);
+    if (it != last && *it == value)
+        return false;
+
+    if (_aulCount[row] == _aulCapacity[row]) {
+        std::ptrdiff_t pos = it - first;
+        Relocate(row, std::max<unsigned long>(4, 2 * _aulCapacity[row]));
+        first = _aulIndices.begin() + _aulStart[row];
+        last = first + _aulCount[row];
+        it = first + pos;
+    }
+
+    std::copy_backward(it, last, last + 1);
+    *it = value;
+    _aulCount[row]++;
+    return true;
+}
+
+bool MeshIndexRows::Remove(unsigned long row, unsigned long value)
+{
+    std::vector<unsigned long>::iterator first = _aulIndices.begin() + _aulStart[row];
+    std::vector<unsigned long>::iterator last = first + _aulCount[row];
+    std::vector<unsigned long>::iterator it = std::lower_bound(first, last, value);
+    if (it == last || *it != value)
+        return false;
+
+    std::copy(it + 1, last, it);
+    _aulCount[row]--;
+    return true;
+}
+
+void MeshIndexRows::Relocate(unsigned long row, unsigned long capacity)
+{
+    // move the row to the end of the array, its old place becomes unused
+    unsigned long start = static_cast<unsigned long>(_aulIndices.size());
+    _aulIndices.resize(start + capacity);
+    std::copy(_aulIndices.begin() + _aulStart[row],
+              _aulIndices.begin() + _aulStart[row] + _aulCount[row],
+              _aulIndices.begin() + start);
+
+    _ulGarbage += _aulCapacity[row];
+    _aulStart[row] = start;
+    _aulCapacity[row] = capacity;
+
+    if (_ulGarbage > _aulIndices.size() / 2)
+        Compact();
+}
+
+void MeshIndexRows::Compact()
+{
+    std::vector<unsigned long> indices;
+    indices.resize(_aulIndices.size() - _ulGarbage);
+
+    unsigned long offset = 0;
+    for (std::size_t i = 0; i < _aulCount.size(); i++) {
+        std::copy(_aulIndices.begin() + _aulStart[i],
+                  _aulIndices.begin() + _aulStart[i] + _aulCount[i],
+                  indices.begin() + offset);
+        _aulStart[i] = offset;
+        offset += _aulCapacity[i];
+    }
+
+    _aulIndices.swap(indices);
+    _ulGarbage = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+namespace MeshCore {
+
+// Checks whether the facet has an edge from point a to point b
+static inline bool HasEdge(const MeshFacet& rclFacet, unsigned long a, unsigned long b)
+{
+    for (int i = 0; i < 3; i++) {
+        if (rclFacet._aulPoints[i] != a)
+            continue;
+        for (int j = 0; j < 3; j++) {
+            if (i != j && rclFacet._aulPoints[j] == b)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+}
+
+MeshAdjacency::MeshAdjacency()
+  : _ulVersion(0), _bValid(false)
+{
+}
+
+MeshAdjacency::MeshAdjacency(const MeshAdjacency&)
+  : _ulVersion(0), _bValid(false)
+{
+}
+
+MeshAdjacency& MeshAdjacency::operator = (const MeshAdjacency&)
+{
+    Clear();
+    return *this;
+}
+
+void MeshAdjacency::Clear()
+{
+    QMutexLocker locker(&_clMutex);
+    _bValid = false;
+    _clPointFacets.Clear();
+    _clPointPoints.Clear();
+}
+
+void MeshAdjacency::Acquire(const MeshKernel& rclMesh, unsigned long version)
+{
+    if (_bValid && _ulVersion == version)
+        return;
+
+    QMutexLocker locker(&_clMutex);
+    if (_bValid && _ulVersion == version)
+        return;
+
+    Rebuild(rclMesh);
+    _ulVersion = version;
+    _bValid = true;
+}
+
+void MeshAdjacency::Rebuild(const MeshKernel& rclMesh)
+{
+    const MeshFacetArray& rFacets = rclMesh.GetFacets();
+    unsigned long ulCtPoints = rclMesh.CountPoints();
+
+    std::vector<unsigned long> counts(ulCtPoints, 0);
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        for (int i = 0; i < 3; i++) {
+            if (it->_aulPoints[i] < ulCtPoints)
+                counts[it->_aulPoints[i]]++;
+        }
+    }
+
+    _clPointFacets.Reserve(counts);
+    MeshFacetArray::_TConstIterator pFBegin = rFacets.begin();
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        unsigned long index = static_cast<unsigned long>(it - pFBegin);
+        for (int i = 0; i < 3; i++) {
+            if (it->_aulPoints[i] < ulCtPoints)
+                _clPointFacets.Append(it->_aulPoints[i], index);
+        }
+    }
+    _clPointFacets.Sort();
+
+    // each corner adds its two neighbours
+    for (std::vector<unsigned long>::iterator it = counts.begin(); it != counts.end(); ++it)
+        *it *= 2;
+    _clPointPoints.Reserve(counts);
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        for (int i = 0; i < 3; i++) {
+            unsigned long p = it->_aulPoints[i];
+            unsigned long q = it->_aulPoints[(i+1)%3];
+            unsigned long r = it->_aulPoints[(i+2)%3];
+            if (p < ulCtPoints && q < ulCtPoints)
+                _clPointPoints.Append(p, q);
+            if (p < ulCtPoints && r < ulCtPoints)
+                _clPointPoints.Append(p, r);
+        }
+    }
+    _clPointPoints.Sort();
+}
+
+void MeshAdjacency::Update(const MeshKernel& rclMesh, const std::vector<std::pair<unsigned long, MeshFacet> >& raclOld,
+                           unsigned long oldVersion, unsigned long newVersion)
+{
+    QMutexLocker locker(&_clMutex);
+    if (!_bValid || _ulVersion != oldVersion)
+        return;
+
+    const MeshFacetArray& rFacets = rclMesh.GetFacets();
+    unsigned long ulCtPoints = rclMesh.CountPoints();
+
+    // only the first recorded state of a facet is of interest
+    std::vector<std::pair<unsigned long, MeshFacet> > changes;
+    changes.reserve(raclOld.size());
+    for (std::vector<std::pair<unsigned long, MeshFacet> >::const_iterator it = raclOld.begin(); it != raclOld.end(); ++it) {
+        if (it->first >= rFacets.size()) {
+            // facets were removed, the indices of the others are not valid any more
+            _bValid = false;
+            return;
+        }
+
+        bool known = false;
+        for (std::vector<std::pair<unsigned long, MeshFacet> >::iterator jt = changes.begin(); jt != changes.end(); ++jt) {
+            if (jt->first == it->first) {
+                known = true;
+                break;
+            }
+        }
+        if (!known)
+            changes.push_back(*it);
+    }
+
+    _clPointFacets.Resize(ulCtPoints);
+    _clPointPoints.Resize(ulCtPoints);
+
+    // point to facets
+    for (std::vector<std::pair<unsigned long, MeshFacet> >::iterator it = changes.begin(); it != changes.end(); ++it) {
+        const MeshFacet& rOld = it->second;
+        const MeshFacet& rNew = rFacets[it->first];
+        for (int i = 0; i < 3; i++) {
+            unsigned long p = rOld._aulPoints[i];
+            if (p < ulCtPoints && !rNew.HasPoint(p))
+                _clPointFacets.Remove(p, it->first);
+        }
+        for (int i = 0; i < 3; i++) {
+            unsigned long p = rNew._aulPoints[i];
+            if (p < ulCtPoints)
+                _clPointFacets.Insert(p, it->first);
+        }
+    }
+
+    // point to points: an old edge only disappears if no other facet uses it any more
+    for (std::vector<std::pair<unsigned long, MeshFacet> >::iterator it = changes.begin(); it != changes.end(); ++it) {
+        const MeshFacet& rOld = it->second;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                unsigned long a = rOld._aulPoints[i];
+                unsigned long b = rOld._aulPoints[j];
+                if (i == j || a >= ulCtPoints || b >= ulCtPoints)
+                    continue;
+                if (!_clPointPoints.Contains(a, b))
+                    continue;
+
+                bool used = false;
+                for (MeshIndexRows::const_iterator jt = _clPointFacets.Begin(a); jt != _clPointFacets.End(a); ++jt) {
+                    if (HasEdge(rFacets[*jt], a, b)) {
+                        used = true;
+                        break;
+                    }
+                }
+                if (!used)
+                    _clPointPoints.Remove(a, b);
+            }
+        }
+    }
+
+    for (std::vector<std::pair<unsigned long, MeshFacet> >::iterator it = changes.begin(); it != changes.end(); ++it) {
+        const MeshFacet& rNew = rFacets[it->first];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                unsigned long a = rNew._aulPoints[i];
+                unsigned long b = rNew._aulPoints[j];
+                if (i != j && a < ulCtPoints && b < ulCtPoints)
+                    _clPointPoints.Insert(a, b);
+            }
+        }
+    }
+
+    _ulVersion = newVersion;
+}
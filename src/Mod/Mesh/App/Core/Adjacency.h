@@ -0,0 +1,146 @@
+/***************************************************************************
+ *   Copyright (c) 2018 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_ADJACENCY_H
+#define MESH_ADJACENCY_H
+
+#include <atomic>
+#include <utility>
+#include <vector>
+#include <QMutex>
+
+#include "Elements.h"
+
+namespace MeshCore {
+
+class MeshKernel;
+
+/**
+ * The MeshIndexRows class stores a list of sorted index rows in one flat
+ * array (compressed-row format). Each row keeps some spare capacity so that
+ * single indices can be inserted or removed without rebuilding the whole
+ * structure. A row that runs out of space is moved to the end of the array.
+ */
+class MeshExport MeshIndexRows
+{
+public:
+    typedef std::vector<unsigned long>::const_iterator const_iterator;
+
+    MeshIndexRows (void);
+
+    /** Removes all rows. */
+    void Clear (void);
+    /** Sets up one row for each entry of \a counts with enough space to take
+     * the given number of indices. The rows are empty afterwards.
+     */
+    void Reserve (const std::vector<unsigned long>& counts);
+    /** Appends empty rows until there are \a rows rows. */
+    void Resize (unsigned long rows);
+    /** Returns the number of rows. */
+    unsigned long CountRows (void) const
+    { return static_cast<unsigned long>(_aulCount.size()); }
+    /** Returns the number of indices in row \a row. */
+    unsigned long Count (unsigned long row) const
+    { return _aulCount[row]; }
+    const_iterator Begin (unsigned long row) const
+    { return _aulIndices.begin() + _aulStart[row]; }
+    const_iterator End (unsigned long row) const
+    { return _aulIndices.begin() + _aulStart[row] + _aulCount[row]; }
+    /** Checks whether row \a row contains \a value. */
+    bool Contains (unsigned long row, unsigned long value) const;
+
+    /** Appends \a value to row \a row without keeping the row sorted. The row
+     * must have been reserved large enough. Call Sort() when done.
+     */
+    void Append (unsigned long row, unsigned long value)
+    { _aulIndices[_aulStart[row] + _aulCount[row]++] = value; }
+    /** Sorts all rows and removes duplicates. */
+    void Sort (void);
+
+    /** Inserts \a value into row \a row. Returns false if it was already there. */
+    bool Insert (unsigned long row, unsigned long value);
+    /** Removes \a value from row \a row. Returns false if it wasn't there. */
+    bool Remove (unsigned long row, unsigned long value);
+
+private:
+    void Relocate (unsigned long row, unsigned long capacity);
+    void Compact (void);
+
+private:
+    std::vector<unsigned long> _aulStart;
+    std::vector<unsigned long> _aulCount;
+    std::vector<unsigned long> _aulCapacity;
+    std::vector<unsigned long> _aulIndices;
+    unsigned long _ulGarbage; /**< Number of unused elements left by relocated rows. */
+};
+
+/**
+ * The MeshAdjacency class holds the point to facets and point to points
+ * adjacency of a mesh kernel. It is owned by MeshKernel which rebuilds it on
+ * demand when the topology version has changed, or updates it for a few
+ * facets after topological operations.
+ */
+class MeshExport MeshAdjacency
+{
+public:
+    MeshAdjacency (void);
+    /** Copying doesn't take over the cached data. */
+    MeshAdjacency (const MeshAdjacency&);
+    MeshAdjacency& operator = (const MeshAdjacency&);
+
+    /** Returns the facets of each point. */
+    const MeshIndexRows& PointToFacets (void) const
+    { return _clPointFacets; }
+    /** Returns the points connected with each point by an edge. */
+    const MeshIndexRows& PointToPoints (void) const
+    { return _clPointPoints; }
+
+    /** Rebuilds the data of \a rclMesh if it isn't up-to-date with \a version.
+     * This method is thread-safe.
+     */
+    void Acquire (const MeshKernel& rclMesh, unsigned long version);
+    /** Adjusts the data after the facets in \a raclOld have changed. Each entry
+     * keeps the index of the facet and its former point indices, a newly added
+     * facet has its former point indices set to ULONG_MAX. The update is only
+     * done if the data is up-to-date with \a oldVersion, otherwise it will be
+     * rebuilt by the next Acquire() call.
+     */
+    void Update (const MeshKernel& rclMesh, const std::vector<std::pair<unsigned long, MeshFacet> >& raclOld,
+                 unsigned long oldVersion, unsigned long newVersion);
+    /** Drops the cached data. */
+    void Clear (void);
+
+private:
+    void Rebuild (const MeshKernel& rclMesh);
+
+private:
+    MeshIndexRows _clPointFacets;
+    MeshIndexRows _clPointPoints;
+    std::atomic<unsigned long> _ulVersion;
+    std::atomic<bool> _bValid;
+    QMutex _clMutex;
+};
+
+} // namespace MeshCore
+
+#endif // MESH_ADJACENCY_H
@@ -0,0 +1,640 @@
+/***************************************************************************
+ *   Copyright (c) 2018 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <atomic>
+# include <climits>
+# include <cmath>
+#endif
+
+#include "BVH.h"
+#include "MeshKernel.h"
+#include "Functional.h"
+
+using namespace MeshCore;
+
+namespace {
+
+typedef MeshFacetBVH::Node Node;
+typedef MeshFacetBVH::Triangle Triangle;
+
+const uint32_t maxLeafSize = 4;
+const int numBins = 16;
+const int maxSAHDepth = 48;
+const int stackSize = 128;
+
+struct Primitive
+{
+    float bmin[3];
+    float bmax[3];
+    float center[3];
+};
+
+struct Bounds
+{
+    float bmin[3];
+    float bmax[3];
+
+    Bounds()
+    {
+        for (int i = 0; i < 3; i++) {
+            bmin[i] =  FLOAT_MAX;
+            bmax[i] = -FLOAT_MAX;
+        }
+    }
+    void Add(const float* lo, const float* hi)
+    {
+        for (int i = 0; i < 3; i++) {
+            bmin[i] = std::min(bmin[i], lo[i]);
+            bmax[i] = std::max(bmax[i], hi[i]);
+        }
+    }
+    float HalfArea() const
+    {
+        if (bmin[0] > bmax[0])
+            return 0.0f;
+        float dx = bmax[0] - bmin[0];
+        float dy = bmax[1] - bmin[1];
+        float dz = bmax[2] - bmin[2];
+        return dx * dy + dy * dz + dz * dx;
+    }
+};
+
+struct BuildContext
+{
+    std::vector<Primitive> prims;
+    std::vector<uint32_t> order;
+    std::vector<Node> nodes;
+    std::atomic<uint32_t> nextNode;
+    int spawnDepth;
+};
+
+void buildNode(BuildContext* ctx, uint32_t index, uint32_t begin, uint32_t end, int depth)
+{
+    const Primitive* prims = &ctx->prims[0];
+    uint32_t* order = &ctx->order[0];
+
+    Bounds box, centers;
+    for (uint32_t i = begin; i < end; i++) {
+        const Primitive& p = prims[order[i]];
+        box.Add(p.bmin, p.bmax);
+        centers.Add(p.center, p.center);
+    }
+
+    Node& node = ctx->nodes[index];
+    std::copy(box.bmin, box.bmin + 3, node.bmin);
+    std::copy(box.bmax, box.bmax + 3, node.bmax);
+
+    uint32_t count = end - begin;
+    if (count <= maxLeafSize) {
+        node.start = begin;
+        node.count = count;
+        return;
+    }
+
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (centers.bmax[i] - centers.bmin[i] > centers.bmax[axis] - centers.bmin[axis])
+            axis = i;
+    }
+    float cmin = centers.bmin[axis];
+    float extent = centers.bmax[axis] - cmin;
+
+    uint32_t mid = begin + count / 2;
+    if (extent <= 0.0f) {
+        // all centers coincide, so any split is as good as another
+    }
+    else if (depth >= maxSAHDepth) {
+        // limit the depth of degenerated trees by splitting at the median
+        std::nth_element(order + begin, order + mid, order + end, [prims, axis](uint32_t a, uint32_t b) {
+            return prims[a].center[axis] < prims[b].center[axis];
+        });
+    }
+    else {
+        // binned surface area heuristic
+        float scale = numBins / extent;
+        auto binOf = [prims, axis, cmin, scale](uint32_t p) -> int {
+            int bin = static_cast<int>((prims[p].center[axis] - cmin) * scale);
+            return std::min(bin, numBins - 1);
+        };
+
+        Bounds bins[numBins];
+        uint32_t binCount[numBins] = {0};
+        for (uint32_t i = begin; i < end; i++) {
+            int bin = binOf(order[i]);
+            bins[bin].Add(prims[order[i]].bmin, prims[order[i]].bmax);
+            binCount[bin]++;
+        }
+
+        float rightArea[numBins];
+        uint32_t rightCount[numBins];
+        Bounds right;
+        uint32_t numRight = 0;
+        for (int i = numBins - 1; i > 0; i--) {
+            right.Add(bins[i].bmin, bins[i].bmax);
+            numRight += binCount[i];
+            rightArea[i] = right.HalfArea();
+            rightCount[i] = numRight;
+        }
+
+        Bounds left;
+        uint32_t numLeft = 0;
+        float bestCost = FLOAT_MAX;
+        int bestSplit = -1;
+        for (int i = 0; i < numBins - 1; i++) {
+            left.Add(bins[i].bmin, bins[i].bmax);
+            numLeft += binCount[i];
+            if (numLeft == 0 || rightCount[i+1] == 0)
+                continue;
+            float cost = left.HalfArea() * numLeft + rightArea[i+1] * rightCount[i+1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        // a leaf is cheaper than the best split
+        float leafCost = box.HalfArea() * count;
+        if (bestSplit < 0 || (count <= 4 * maxLeafSize && bestCost >= leafCost)) {
+            if (count <= 4 * maxLeafSize) {
+                node.start = begin;
+                node.count = count;
+                return;
+            }
+        }
+        else {
+            mid = static_cast<uint32_t>(std::partition(order + begin, order + end, [&binOf, bestSplit](uint32_t p) {
+                return binOf(p) <= bestSplit;
+            }) - order);
+        }
+    }
+
+    uint32_t child = ctx->nextNode.fetch_add(2);
+    node.start = child;
+    node.count = 0;
+
+    if (depth < ctx->spawnDepth && count > 10000) {
+        QFuture<void> future = QtConcurrent::run(buildNode, ctx, child, begin, mid, depth + 1);
+        buildNode(ctx, child + 1, mid, end, depth + 1);
+        future.waitForFinished();
+    }
+    else {
+        buildNode(ctx, child, begin, mid, depth + 1);
+        buildNode(ctx, child + 1, mid, end, depth + 1);
+    }
+}
+
+inline void prepareRay(const Base::Vector3f& pt, const Base::Vector3f& dir,
+                       float org[3], float vec[3], float inv[3])
+{
+    org[0] = pt.x;  org[1] = pt.y;  org[2] = pt.z;
+    vec[0] = dir.x; vec[1] = dir.y; vec[2] = dir.z;
+    for (int i = 0; i < 3; i++)
+        inv[i] = 1.0f / vec[i];
+}
+
+// The comparisons are written so that NaNs from axis-parallel rays are ignored
+inline bool intersectBox(const Node& node, const float org[3], const float inv[3], float tmax, float& tnear)
+{
+    float t0 = 0.0f, t1 = tmax;
+    for (int i = 0; i < 3; i++) {
+        float ta = (node.bmin[i] - org[i]) * inv[i];
+        float tb = (node.bmax[i] - org[i]) * inv[i];
+        if (ta > tb)
+            std::swap(ta, tb);
+        t0 = ta > t0 ? ta : t0;
+        t1 = tb < t1 ? tb : t1;
+    }
+
+    tnear = t0;
+    return t0 <= t1;
+}
+
+inline void cross(const float a[3], const float b[3], float c[3])
+{
+    c[0] = a[1] * b[2] - a[2] * b[1];
+    c[1] = a[2] * b[0] - a[0] * b[2];
+    c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline float dot(const float a[3], const float b[3])
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// Moeller-Trumbore, both sides of the triangle are hit
+inline bool intersectTriangle(const Triangle& tria, const float org[3], const float vec[3], float tmax, float& t)
+{
+    float p[3], q[3], s[3];
+    cross(vec, tria.e2, p);
+    float det = dot(tria.e1, p);
+    if (det == 0.0f)
+        return false;
+
+    float inv = 1.0f / det;
+    s[0] = org[0] - tria.v0[0];
+    s[1] = org[1] - tria.v0[1];
+    s[2] = org[2] - tria.v0[2];
+    float u = dot(s, p) * inv;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    cross(s, tria.e1, q);
+    float v = dot(vec, q) * inv;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    float r = dot(tria.e2, q) * inv;
+    if (r < 0.0f || r >= tmax)
+        return false;
+
+    // reject rays (nearly) parallel to the triangle like MeshGeomFacet::Foraminate
+    float n[3];
+    cross(tria.e1, tria.e2, n);
+    if (det * det <= 1.0e-6f * dot(vec, vec) * dot(n, n))
+        return false;
+
+    t = r;
+    return true;
+}
+
+inline float distanceToBox(const Node& node, const float pnt[3])
+{
+    float dist = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float d = std::max(std::max(node.bmin[i] - pnt[i], pnt[i] - node.bmax[i]), 0.0f);
+        dist += d * d;
+    }
+    return dist;
+}
+
+// Closest point on a triangle, see Ericson: Real-Time Collision Detection, 5.1.5
+inline float closestPoint(const Triangle& tria, const float pnt[3], float res[3])
+{
+    const float* a = tria.v0;
+    const float* ab = tria.e1;
+    const float* ac = tria.e2;
+    float ap[3] = {pnt[0] - a[0], pnt[1] - a[1], pnt[2] - a[2]};
+
+    float d1 = dot(ab, ap);
+    float d2 = dot(ac, ap);
+    float s = 0.0f, t = 0.0f;
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        // vertex a
+    }
+    else {
+        float bp[3] = {ap[0] - ab[0], ap[1] - ab[1], ap[2] - ab[2]};
+        float d3 = dot(ab, bp);
+        float d4 = dot(ac, bp);
+        float cp[3] = {ap[0] - ac[0], ap[1] - ac[1], ap[2] - ac[2]};
+        float d5 = dot(ab, cp);
+        float d6 = dot(ac, cp);
+        float vc = d1 * d4 - d3 * d2;
+        float vb = d5 * d2 - d1 * d6;
+        float va = d3 * d6 - d5 * d4;
+
+        if (d3 >= 0.0f && d4 <= d3) {
+            s = 1.0f; // vertex b
+        }
+        else if (d6 >= 0.0f && d5 <= d6) {
+            t = 1.0f; // vertex c
+        }
+        else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+            s = d1 / (d1 - d3); // edge ab
+        }
+        else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+            t = d2 / (d2 - d6); // edge ac
+        }
+        else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+            t = (d4 - d3) / ((d4 - d3) + (d5 - d6)); // edge bc
+            s = 1.0f - t;
+        }
+        else {
+            float denom = va + vb + vc;
+            if (denom > 0.0f) {
+                s = vb / denom;
+                t = vc / denom;
+            }
+        }
+    }
+
+    float dist = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        res[i] = a[i] + s * ab[i] + t * ac[i];
+        dist += (res[i] - pnt[i]) * (res[i] - pnt[i]);
+    }
+    return dist;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+
+MeshFacetBVH::MeshFacetBVH()
+{
+}
+
+MeshFacetBVH::MeshFacetBVH(const MeshKernel& mesh)
+{
+    Build(mesh);
+}
+
+MeshFacetBVH::~MeshFacetBVH()
+{
+}
+
+void MeshFacetBVH::Clear()
+{
+    std::vector<Node>().swap(_nodes);
+    std::vector<Triangle>().swap(_triangles);
+    std::vector<unsigned long>().swap(_facets);
+}
+
+void MeshFacetBVH::Build(const MeshKernel& mesh)
+{
+    Clear();
+
+    const MeshPointArray& points = mesh.GetPoints();
+    const MeshFacetArray& facets = mesh.GetFacets();
+    std::size_t ctFacets = facets.size();
+    if (ctFacets == 0)
+        return;
+
+    int threads = QThread::idealThreadCount();
+    BuildContext ctx;
+    ctx.prims.resize(ctFacets);
+    ctx.order.resize(ctFacets);
+    MeshCore::parallel_blocks(ctFacets, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            Primitive& prim = ctx.prims[i];
+            const MeshFacet& face = facets[i];
+            for (int j = 0; j < 3; j++) {
+                prim.bmin[j] =  FLOAT_MAX;
+                prim.bmax[j] = -FLOAT_MAX;
+            }
+            for (int k = 0; k < 3; k++) {
+                const MeshPoint& p = points[face._aulPoints[k]];
+                float c[3] = {p.x, p.y, p.z};
+                for (int j = 0; j < 3; j++) {
+                    prim.bmin[j] = std::min(prim.bmin[j], c[j]);
+                    prim.bmax[j] = std::max(prim.bmax[j], c[j]);
+                }
+            }
+            for (int j = 0; j < 3; j++)
+                prim.center[j] = 0.5f * (prim.bmin[j] + prim.bmax[j]);
+            ctx.order[i] = static_cast<uint32_t>(i);
+        }
+    }, threads);
+
+    // a binary tree with at least one facet per leaf has less than 2n nodes
+    ctx.nodes.resize(2 * ctFacets);
+    ctx.nextNode = 1;
+    ctx.spawnDepth = 0;
+    while ((1 << ctx.spawnDepth) < 2 * threads)
+        ctx.spawnDepth++;
+    buildNode(&ctx, 0, 0, static_cast<uint32_t>(ctFacets), 0);
+
+    ctx.nodes.resize(ctx.nextNode);
+    _nodes.swap(ctx.nodes);
+
+    // store the facets in leaf order to have the facets of a leaf close together
+    _triangles.resize(ctFacets);
+    _facets.resize(ctFacets);
+    MeshCore::parallel_blocks(ctFacets, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            unsigned long index = ctx.order[i];
+            const MeshFacet& face = facets[index];
+            const MeshPoint& p0 = points[face._aulPoints[0]];
+            const MeshPoint& p1 = points[face._aulPoints[1]];
+            const MeshPoint& p2 = points[face._aulPoints[2]];
+            Triangle& tria = _triangles[i];
+            tria.v0[0] = p0.x;        tria.v0[1] = p0.y;        tria.v0[2] = p0.z;
+            tria.e1[0] = p1.x - p0.x; tria.e1[1] = p1.y - p0.y; tria.e1[2] = p1.z - p0.z;
+            tria.e2[0] = p2.x - p0.x; tria.e2[1] = p2.y - p0.y; tria.e2[2] = p2.z - p0.z;
+            _facets[i] = index;
+        }
+    }, threads);
+}
+
+bool MeshFacetBVH::NearestFacetOnRay(const Base::Vector3f& rclPt, const Base::Vector3f& rclDir,
+                                     Base::Vector3f& rclRes, unsigned long& rulFacet) const
+{
+    if (_nodes.empty())
+        return false;
+
+    float org[3], vec[3], inv[3];
+    prepareRay(rclPt, rclDir, org, vec, inv);
+
+    float tbest = FLOAT_MAX, tnear;
+    uint32_t best = UINT_MAX;
+    if (!intersectBox(_nodes[0], org, inv, tbest, tnear))
+        return false;
+
+    std::pair<uint32_t, float> stack[stackSize];
+    int top = 0;
+    stack[top++] = std::make_pair(0u, tnear);
+    while (top > 0) {
+        const std::pair<uint32_t, float>& entry = stack[--top];
+        if (entry.second > tbest)
+            continue;
+
+        const Node& node = _nodes[entry.first];
+        if (node.count > 0) {
+            float t;
+            for (uint32_t i = node.start; i < node.start + node.count; i++) {
+                if (intersectTriangle(_triangles[i], org, vec, tbest, t)) {
+                    tbest = t;
+                    best = i;
+                }
+            }
+        }
+        else {
+            // visit the nearer child first
+            float t0, t1;
+            bool hit0 = intersectBox(_nodes[node.start], org, inv, tbest, t0);
+            bool hit1 = intersectBox(_nodes[node.start + 1], org, inv, tbest, t1);
+            if (hit0 && hit1) {
+                if (t0 <= t1) {
+                    stack[top++] = std::make_pair(node.start + 1, t1);
+                    stack[top++] = std::make_pair(node.start, t0);
+                }
+                else {
+                    stack[top++] = std::make_pair(node.start, t0);
+                    stack[top++] = std::make_pair(node.start + 1, t1);
+                }
+            }
+            else if (hit0) {
+                stack[top++] = std::make_pair(node.start, t0);
+            }
+            else if (hit1) {
+                stack[top++] = std::make_pair(node.start + 1, t1);
+            }
+        }
+    }
+
+    if (best == UINT_MAX)
+        return false;
+
+    rclRes = rclPt + tbest * rclDir;
+    rulFacet = _facets[best];
+    return true;
+}
+
+void MeshFacetBVH::NearestFacetsOnRays(const std::vector<Base::Vector3f>& raclPts,
+                                       const std::vector<Base::Vector3f>& raclDirs,
+                                       std::vector<Base::Vector3f>& raclRes,
+                                       std::vector<unsigned long>& raulFacets) const
+{
+    const std::size_t packetSize = 8;
+    std::size_t ctRays = std::min(raclPts.size(), raclDirs.size());
+    raclRes.resize(ctRays);
+    raulFacets.assign(ctRays, ULONG_MAX);
+    if (_nodes.empty())
+        return;
+
+    std::size_t ctPackets = (ctRays + packetSize - 1) / packetSize;
+    MeshCore::parallel_blocks(ctPackets, [&](std::size_t begin, std::size_t end) {
+        float org[packetSize][3], vec[packetSize][3], inv[packetSize][3];
+        float tbest[packetSize];
+        uint32_t best[packetSize];
+        bool active[packetSize];
+        uint32_t stack[stackSize];
+
+        for (std::size_t p = begin; p < end; p++) {
+            std::size_t first = p * packetSize;
+            std::size_t size = std::min(packetSize, ctRays - first);
+            for (std::size_t r = 0; r < size; r++) {
+                prepareRay(raclPts[first + r], raclDirs[first + r], org[r], vec[r], inv[r]);
+                tbest[r] = FLOAT_MAX;
+                best[r] = UINT_MAX;
+            }
+
+            // the packet enters a node if any of its rays does
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0) {
+                const Node& node = _nodes[stack[--top]];
+                bool any = false;
+                float tnear;
+                for (std::size_t r = 0; r < size; r++) {
+                    active[r] = intersectBox(node, org[r], inv[r], tbest[r], tnear);
+                    any |= active[r];
+                }
+                if (!any)
+                    continue;
+
+                if (node.count > 0) {
+                    float t;
+                    for (uint32_t i = node.start; i < node.start + node.count; i++) {
+                        for (std::size_t r = 0; r < size; r++) {
+                            if (active[r] && intersectTriangle(_triangles[i], org[r], vec[r], tbest[r], t)) {
+                                tbest[r] = t;
+                                best[r] = i;
+                            }
+                        }
+                    }
+                }
+                else {
+                    // visit the child first that is nearer for the first active ray
+                    std::size_t r = 0;
+                    while (!active[r])
+                        r++;
+                    float t0 = FLOAT_MAX, t1 = FLOAT_MAX;
+                    intersectBox(_nodes[node.start], org[r], inv[r], tbest[r], t0);
+                    intersectBox(_nodes[node.start + 1], org[r], inv[r], tbest[r], t1);
+                    if (t0 <= t1) {
+                        stack[top++] = node.start + 1;
+                        stack[top++] = node.start;
+                    }
+                    else {
+                        stack[top++] = node.start;
+                        stack[top++] = node.start + 1;
+                    }
+                }
+            }
+
+            for (std::size_t r = 0; r < size; r++) {
+                if (best[r] != UINT_MAX) {
+                    raclRes[first + r] = raclPts[first + r] + tbest[r] * raclDirs[first + r];
+                    raulFacets[first + r] = _facets[best[r]];
+                }
+            }
+        }
+    }, QThread::idealThreadCount(), 16);
+}
+
+bool MeshFacetBVH::NearestFacet(const Base::Vector3f& rclPt, Base::Vector3f& rclRes,
+                                unsigned long& rulFacet, float fMaxDist) const
+{
+    if (_nodes.empty())
+        return false;
+
+    const float pnt[3] = {rclPt.x, rclPt.y, rclPt.z};
+    float dbest = fMaxDist < FLOAT_MAX ? fMaxDist * fMaxDist : FLOAT_MAX;
+    float res[3] = {0.0f, 0.0f, 0.0f}, tmp[3];
+    uint32_t best = UINT_MAX;
+
+    std::pair<uint32_t, float> stack[stackSize];
+    int top = 0;
+    stack[top++] = std::make_pair(0u, distanceToBox(_nodes[0], pnt));
+    while (top > 0) {
+        const std::pair<uint32_t, float>& entry = stack[--top];
+        if (entry.second > dbest)
+            continue;
+
+        const Node& node = _nodes[entry.first];
+        if (node.count > 0) {
+            for (uint32_t i = node.start; i < node.start + node.count; i++) {
+                float dist = closestPoint(_triangles[i], pnt, tmp);
+                if (dist <= dbest) {
+                    dbest = dist;
+                    best = i;
+                    std::copy(tmp, tmp + 3, res);
+                }
+            }
+        }
+        else {
+            // visit the nearer child first
+            float d0 = distanceToBox(_nodes[node.start], pnt);
+            float d1 = distanceToBox(_nodes[node.start + 1], pnt);
+            if (d0 <= d1) {
+                stack[top++] = std::make_pair(node.start + 1, d1);
+                stack[top++] = std::make_pair(node.start, d0);
+            }
+            else {
+                stack[top++] = std::make_pair(node.start, d0);
+                stack[top++] = std::make_pair(node.start + 1, d1);
+            }
+        }
+    }
+
+    if (best == UINT_MAX)
+        return false;
+
+    rclRes.Set(res[0], res[1], res[2]);
+    rulFacet = _facets[best];
+    return true;
+}
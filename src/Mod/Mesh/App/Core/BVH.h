@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   Copyright (c) 2018 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "Definitions.h"
+#include "Elements.h"
+
+namespace MeshCore
+{
+
+class MeshKernel;
+
+/**
+ * The MeshFacetBVH class is a bounding volume hierarchy over the facets of a mesh.
+ * The tree is built with the surface area heuristic, the upper levels in parallel.
+ * It doesn't depend on a grid resolution and answers ray and closest point queries
+ * in logarithmic time.
+ *
+ * The facets are copied into the tree, so it stays valid when the mesh changes but
+ * then doesn't reflect the changes. All queries are const and may be called from
+ * several threads at the same time.
+ */
+class MeshExport MeshFacetBVH
+{
+public:
+    MeshFacetBVH();
+    MeshFacetBVH(const MeshKernel& mesh);
+    ~MeshFacetBVH();
+
+    /** Builds the tree for the facets of \a mesh. */
+    void Build(const MeshKernel& mesh);
+    void Clear();
+    bool IsEmpty() const
+    { return _nodes.empty(); }
+    unsigned long CountFacets() const
+    { return static_cast<unsigned long>(_facets.size()); }
+
+    /** @name Ray casting */
+    //@{
+    /**
+     * Searches for the first facet hit by the ray starting at \a rclPt with the direction
+     * \a rclDir. The point \a rclRes holds the intersection point and \a rulFacet the
+     * index of the facet. Unlike MeshAlgorithm::NearestFacetOnRay() facets behind \a rclPt
+     * are ignored.
+     */
+    bool NearestFacetOnRay(const Base::Vector3f& rclPt, const Base::Vector3f& rclDir,
+                           Base::Vector3f& rclRes, unsigned long& rulFacet) const;
+    /**
+     * Does the same as above for many rays. Rays with neighbouring indices are traced
+     * together in small packets, so it is fastest if they are coherent, like the rays of
+     * a scan line. A facet index of ULONG_MAX marks a ray that misses the mesh.
+     */
+    void NearestFacetsOnRays(const std::vector<Base::Vector3f>& raclPts,
+                             const std::vector<Base::Vector3f>& raclDirs,
+                             std::vector<Base::Vector3f>& raclRes,
+                             std::vector<unsigned long>& raulFacets) const;
+    //@}
+
+    /** @name Closest point */
+    //@{
+    /**
+     * Searches for the facet closest to \a rclPt within the distance \a fMaxDist. The
+     * point \a rclRes holds the closest point on the facet with the index \a rulFacet.
+     */
+    bool NearestFacet(const Base::Vector3f& rclPt, Base::Vector3f& rclRes,
+                      unsigned long& rulFacet, float fMaxDist = FLOAT_MAX) const;
+    //@}
+
+public:
+    struct Node {
+        float bmin[3];
+        uint32_t start; /**< First facet of a leaf or the left child of an inner node. */
+        float bmax[3];
+        uint32_t count; /**< Number of facets of a leaf, 0 for inner nodes. */
+    };
+    struct Triangle {
+        float v0[3];
+        float e1[3];
+        float e2[3];
+    };
+
+private:
+    MeshFacetBVH(const MeshFacetBVH&);
+    MeshFacetBVH& operator = (const MeshFacetBVH&);
+
+private:
+    std::vector<Node> _nodes;
+    std::vector<Triangle> _triangles;   /**< Facets in leaf order. */
+    std::vector<unsigned long> _facets; /**< Mesh facet index of each triangle. */
+};
+
+} // namespace MeshCore
+
+#endif // MESH_BVH_H
@@ -25,6 +25,7 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <cstring>
 #endif
 
 #include <Base/Sequencer.h>
@@ -56,6 +57,7 @@ void MeshBuilder::SetTolerance(float fTol)
 
 void MeshBuilder::Initialize (size_t ctFacets, bool deletion)
 {
+    _meshKernel.InvalidateTopology();
     if (deletion)
     {
         // Clear the mesh structure and free all memory
@@ -217,6 +219,8 @@ void MeshBuilder::RemoveUnreferencedPoints()
 
 void MeshBuilder::Finish (bool freeMemory)
 {
+    _meshKernel.InvalidateTopology();
+
     // now we can resize the vertex array to the exact size and copy the vertices with their correct positions in the array
     unsigned long i=0;
     _meshKernel._aclPointArray.resize(_pointsIterator.size());
@@ -322,6 +326,30 @@ void MeshFastBuilder::AddFacet (const MeshGeomFacet& facetPoints)
     }
 }
 
+void MeshFastBuilder::AddFacets (const char* data, size_type ctFacets, std::size_t stride)
+{
+    QVector<Private::Vertex>& verts = p->verts;
+    size_type offset = verts.size();
+    verts.resize(offset + 3 * ctFacets);
+    Private::Vertex* vertex = verts.data() + offset;
+
+    int threads = std::max(1, QThread::idealThreadCount());
+    MeshCore::parallel_blocks(static_cast<std::size_t>(ctFacets), [data, stride, vertex](std::size_t begin, std::size_t end) {
+        float pnt[9];
+        for (std::size_t i = begin; i < end; i++) {
+            std::memcpy(pnt, data + i * stride, sizeof(pnt));
+            Private::Vertex* v = vertex + 3 * i;
+            // like the sequential STL reader the facet starts with the third point
+            for (int j = 0; j < 3; j++) {
+                int k = 3 * ((j + 2) % 3);
+                v[j].x = pnt[k];
+                v[j].y = pnt[k+1];
+                v[j].z = pnt[k+2];
+            }
+        }
+    }, threads);
+}
+
 void MeshFastBuilder::Finish ()
 {
     typedef QVector<Private::Vertex>::size_type size_type;
@@ -347,19 +375,24 @@ void MeshFastBuilder::Finish ()
 
     size_type ulCt = verts.size()/3;
     MeshFacetArray rFacets(static_cast<unsigned long>(ulCt));
-    for (size_type i=0; i < ulCt; ++i) {
-        rFacets[static_cast<size_t>(i)]._aulPoints[0] = indices[3*i];
-        rFacets[static_cast<size_t>(i)]._aulPoints[1] = indices[3*i + 1];
-        rFacets[static_cast<size_t>(i)]._aulPoints[2] = indices[3*i + 2];
-    }
+    const unsigned long* index = indices.constData();
+    MeshCore::parallel_blocks(static_cast<std::size_t>(ulCt), [&rFacets, index](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            rFacets[i]._aulPoints[0] = index[3*i];
+            rFacets[i]._aulPoints[1] = index[3*i + 1];
+            rFacets[i]._aulPoints[2] = index[3*i + 2];
+        }
+    }, threads);
 
     verts.resize(vertex_count);
 
-    MeshPointArray rPoints;
-    rPoints.reserve(static_cast<size_t>(vertex_count));
-    for (QVector<Private::Vertex>::iterator v = verts.begin(); v != verts.end(); ++v) {
-        rPoints.push_back(MeshPoint(v->x, v->y, v->z));
-    }
+    MeshPointArray rPoints(static_cast<unsigned long>(vertex_count));
+    const Private::Vertex* vertex = verts.constData();
+    MeshCore::parallel_blocks(static_cast<std::size_t>(vertex_count), [&rPoints, vertex](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            rPoints[i].Set(vertex[i].x, vertex[i].y, vertex[i].z);
+        }
+    }, threads);
 
     _meshKernel.Adopt(rPoints, rFacets, true);
 }
@@ -201,6 +201,13 @@ public:
     /** Add new facet
      */
     void AddFacet (const MeshGeomFacet& facetPoints);
+    /** Adds \a ctFacets facets at once. The corner points of the i-th facet are read
+     * as nine consecutive floats starting at \a data + i * \a stride and added in the
+     * order third, first, second point, as done by the STL reader. The records are
+     * decoded in parallel. This is meant for binary file formats with fixed-size records
+     * that are mapped into memory.
+     */
+    void AddFacets (const char* data, size_type ctFacets, std::size_t stride);
 
     /** Finishes building up the mesh structure. Must be done after adding facets.
      */
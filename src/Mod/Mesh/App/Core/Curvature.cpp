@@ -127,8 +127,8 @@ void MeshCurvature::ComputePerVertex()
     // get all points
     const MeshPointArray& pts = myKernel.GetPoints();
 
-    MeshCore::MeshRefPointToFacets pt2f(myKernel);
-    MeshCore::MeshRefPointToPoints pt2p(myKernel);
+    const MeshCore::MeshIndexRows& pt2f = myKernel.GetPointToFacets();
+    const MeshCore::MeshIndexRows& pt2p = myKernel.GetPointToPoints();
     unsigned long numPoints = myKernel.CountPoints();
 
     myCurvature.clear();
@@ -136,8 +136,15 @@ void MeshCurvature::ComputePerVertex()
 
     std::vector<Eigen::Vector3f> akNormal(numPoints);
     std::vector<Eigen::Vector3f> akVertex(numPoints);
+    MeshGeomFacet f;
     for (unsigned long i=0; i<numPoints; i++) {
-        Base::Vector3f n = pt2f.GetNormal(i);
+        // area weighted normal of the adjacent facets
+        Base::Vector3f n;
+        for (MeshIndexRows::const_iterator it = pt2f.Begin(i); it != pt2f.End(i); ++it) {
+            f = myKernel.GetFacet(*it);
+            n += f.Area() * f.GetNormal();
+        }
+        n.Normalize();
         akNormal[i][0] = n.x;
         akNormal[i][1] = n.y;
         akNormal[i][2] = n.z;
@@ -162,8 +169,7 @@ void MeshCurvature::ComputePerVertex()
 
         int iV0 = i;
         int iV1;
-        const std::set<unsigned long>& nb = pt2p[i];
-        for (std::set<unsigned long>::const_iterator it = nb.begin(); it != nb.end(); ++it) {
+        for (MeshIndexRows::const_iterator it = pt2p.Begin(i); it != pt2p.End(i); ++it) {
             iV1 = *it;
 
             // Compute edge from V0 to V1, project to tangent plane of vertex,
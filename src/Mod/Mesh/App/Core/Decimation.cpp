@@ -25,38 +25,100 @@
 #ifndef _PreComp_
 #endif
 
+#include <QThread>
+
 #include "Decimation.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
 #include "Iterator.h"
 #include "TopoAlgorithm.h"
+#include "Functional.h"
 #include <Base/Tools.h>
 #include "Simplify.h"
 
 
 using namespace MeshCore;
 
-MeshSimplify::MeshSimplify(MeshKernel& mesh)
-  : myKernel(mesh)
+namespace {
+
+// Spreads the lower ten bits of v so that two zero bits follow each of them
+inline uint32_t spreadBits(uint32_t v)
 {
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v <<  8)) & 0x0300f00f;
+    v = (v | (v <<  4)) & 0x030c30c3;
+    v = (v | (v <<  2)) & 0x09249249;
+    return v;
 }
 
-MeshSimplify::~MeshSimplify()
+// Computes for each point the quadric of the planes through its feature edges that are
+// perpendicular to the adjacent facets. They are weighted high compared to the facet
+// planes so that points on a crease may only slide along it.
+void featureQuadrics(const MeshKernel& kernel, float angle, int threads,
+                     std::vector<SymmetricMatrix>& quadrics)
 {
+    const MeshPointArray& points = kernel.GetPoints();
+    const MeshFacetArray& facets = kernel.GetFacets();
+    quadrics.assign(points.size(), SymmetricMatrix(0.0));
+    if (angle <= 0.0f)
+        return;
+
+    std::vector<Base::Vector3f> normals(facets.size());
+    MeshCore::parallel_blocks(facets.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++)
+            normals[i] = kernel.GetFacet(facets[i]).GetNormal();
+    }, threads);
+
+    const double weight = 1000.0;
+    const double scale = sqrt(weight);
+    float cosAngle = cos(angle);
+    for (std::size_t i = 0; i < facets.size(); i++) {
+        const MeshFacet& face = facets[i];
+        for (int j = 0; j < 3; j++) {
+            unsigned long nb = face._aulNeighbours[j];
+            // handle each edge only once
+            if (nb == ULONG_MAX || nb < i)
+                continue;
+            if (normals[i] * normals[nb] > cosAngle)
+                continue;
+
+            unsigned long p0 = face._aulPoints[j];
+            unsigned long p1 = face._aulPoints[(j+1)%3];
+            Base::Vector3f dir = points[p1] - points[p0];
+            dir.Normalize();
+            const Base::Vector3f* n[2] = {&normals[i], &normals[nb]};
+            for (int k = 0; k < 2; k++) {
+                Base::Vector3f m = dir % *n[k];
+                m.Normalize();
+                double d = -(m * points[p0]);
+                SymmetricMatrix q(scale*m.x, scale*m.y, scale*m.z, scale*d);
+                quadrics[p0] += q;
+                quadrics[p1] += q;
+            }
+        }
+    }
 }
 
-void MeshSimplify::simplify(float tolerance, float reduction)
+// Simplifies the whole mesh in one go
+void decimateMesh(MeshKernel& kernel, int targetSize, double tolerance,
+                  const std::vector<SymmetricMatrix>& constraints)
 {
     Simplify alg;
 
-    const MeshPointArray& points = myKernel.GetPoints();
+    const MeshPointArray& points = kernel.GetPoints();
+    alg.vertices.reserve(points.size());
     for (std::size_t i = 0; i < points.size(); i++) {
         Simplify::Vertex v;
         v.p = points[i];
+        v.locked = 0;
+        v.id = static_cast<int>(i);
+        v.c = constraints[i];
         alg.vertices.push_back(v);
     }
 
-    const MeshFacetArray& facets = myKernel.GetFacets();
+    const MeshFacetArray& facets = kernel.GetFacets();
+    alg.triangles.reserve(facets.size());
     for (std::size_t i = 0; i < facets.size(); i++) {
         Simplify::Triangle t;
         for (int j = 0; j < 3; j++)
@@ -64,10 +126,8 @@ void MeshSimplify::simplify(float tolerance, float reduction)
         alg.triangles.push_back(t);
     }
 
-    int target_count = static_cast<int>(static_cast<float>(facets.size()) * (1.0f-reduction));
-
     // Simplification starts
-    alg.simplify_mesh(target_count, tolerance);
+    alg.simplify_mesh(targetSize, tolerance);
 
     // Simplification done
     MeshPointArray new_points;
@@ -76,71 +136,214 @@ void MeshSimplify::simplify(float tolerance, float reduction)
         new_points.push_back(alg.vertices[i].p);
     }
 
-    std::size_t numFacets = 0;
-    for (std::size_t i = 0; i < alg.triangles.size(); i++) {
-        if (!alg.triangles[i].deleted)
-            numFacets++;
-    }
     MeshFacetArray new_facets;
-    new_facets.reserve(numFacets);
+    new_facets.reserve(alg.triangles.size());
     for (std::size_t i = 0; i < alg.triangles.size(); i++) {
-        if (!alg.triangles[i].deleted) {
-            MeshFacet face;
-            face._aulPoints[0] = alg.triangles[i].v[0];
-            face._aulPoints[1] = alg.triangles[i].v[1];
-            face._aulPoints[2] = alg.triangles[i].v[2];
-            new_facets.push_back(face);
-        }
+        MeshFacet face;
+        face._aulPoints[0] = alg.triangles[i].v[0];
+        face._aulPoints[1] = alg.triangles[i].v[1];
+        face._aulPoints[2] = alg.triangles[i].v[2];
+        new_facets.push_back(face);
     }
 
-    myKernel.Adopt(new_points, new_facets, true);
+    kernel.Adopt(new_points, new_facets, true);
 }
 
-void MeshSimplify::simplify(int targetSize)
+// Splits the mesh into compact partitions and simplifies them in parallel. Points shared
+// by several partitions are locked so that the partitions still fit together afterwards.
+void decimatePartitions(MeshKernel& kernel, int targetSize, double tolerance,
+                        const std::vector<SymmetricMatrix>& constraints,
+                        std::size_t numParts, int threads)
 {
-    Simplify alg;
+    const MeshPointArray& points = kernel.GetPoints();
+    const MeshFacetArray& facets = kernel.GetFacets();
+    std::size_t numFacets = facets.size();
 
-    const MeshPointArray& points = myKernel.GetPoints();
-    for (std::size_t i = 0; i < points.size(); i++) {
-        Simplify::Vertex v;
-        v.p = points[i];
-        alg.vertices.push_back(v);
-    }
+    // sort the facets along a Z-order curve of their centres, consecutive ranges
+    // of this order then are compact regions
+    Base::BoundBox3f box = kernel.GetBoundBox();
+    float lenX = std::max(box.LengthX(), FLOAT_EPS);
+    float lenY = std::max(box.LengthY(), FLOAT_EPS);
+    float lenZ = std::max(box.LengthZ(), FLOAT_EPS);
+    const float cells = 1024.0f;
 
-    const MeshFacetArray& facets = myKernel.GetFacets();
-    for (std::size_t i = 0; i < facets.size(); i++) {
-        Simplify::Triangle t;
-        for (int j = 0; j < 3; j++)
-            t.v[j] = facets[i]._aulPoints[j];
-        alg.triangles.push_back(t);
+    typedef std::pair<uint32_t, unsigned long> SortKey;
+    std::vector<SortKey> order(numFacets);
+    MeshCore::parallel_blocks(numFacets, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            const MeshFacet& face = facets[i];
+            Base::Vector3f c = (points[face._aulPoints[0]] +
+                                points[face._aulPoints[1]] +
+                                points[face._aulPoints[2]]) / 3.0f;
+            uint32_t ix = static_cast<uint32_t>(std::min(cells - 1.0f, std::max(0.0f, (c.x - box.MinX) / lenX * cells)));
+            uint32_t iy = static_cast<uint32_t>(std::min(cells - 1.0f, std::max(0.0f, (c.y - box.MinY) / lenY * cells)));
+            uint32_t iz = static_cast<uint32_t>(std::min(cells - 1.0f, std::max(0.0f, (c.z - box.MinZ) / lenZ * cells)));
+            order[i].first = spreadBits(ix) | (spreadBits(iy) << 1) | (spreadBits(iz) << 2);
+            order[i].second = static_cast<unsigned long>(i);
+        }
+    }, threads);
+    MeshCore::parallel_sort(order.begin(), order.end(), std::less<SortKey>(), threads);
+
+    // points used by facets of different partitions form the seams
+    const int seam = -2;
+    std::vector<int> owner(points.size(), -1);
+    for (std::size_t p = 0; p < numParts; p++) {
+        std::size_t first = p * numFacets / numParts;
+        std::size_t last = (p + 1) * numFacets / numParts;
+        for (std::size_t k = first; k < last; k++) {
+            const MeshFacet& face = facets[order[k].second];
+            for (int j = 0; j < 3; j++) {
+                int& o = owner[face._aulPoints[j]];
+                if (o == -1)
+                    o = static_cast<int>(p);
+                else if (o != static_cast<int>(p))
+                    o = seam;
+            }
+        }
     }
 
-    // Simplification starts
-    alg.simplify_mesh(targetSize, FLT_MAX);
+    std::vector<Simplify> parts(numParts);
+    MeshCore::parallel_blocks(numParts, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t p = begin; p < end; p++) {
+            std::size_t first = p * numFacets / numParts;
+            std::size_t last = (p + 1) * numFacets / numParts;
 
-    // Simplification done
-    MeshPointArray new_points;
-    new_points.reserve(alg.vertices.size());
-    for (std::size_t i = 0; i < alg.vertices.size(); i++) {
-        new_points.push_back(alg.vertices[i].p);
-    }
+            std::vector<unsigned long> ids;
+            ids.reserve(3 * (last - first));
+            for (std::size_t k = first; k < last; k++) {
+                const MeshFacet& face = facets[order[k].second];
+                ids.insert(ids.end(), face._aulPoints, face._aulPoints + 3);
+            }
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
 
-    std::size_t numFacets = 0;
-    for (std::size_t i = 0; i < alg.triangles.size(); i++) {
-        if (!alg.triangles[i].deleted)
-            numFacets++;
+            Simplify& alg = parts[p];
+            alg.vertices.reserve(ids.size());
+            for (std::size_t i = 0; i < ids.size(); i++) {
+                Simplify::Vertex v;
+                v.p = points[ids[i]];
+                v.locked = owner[ids[i]] == seam ? 1 : 0;
+                v.id = static_cast<int>(ids[i]);
+                v.c = constraints[ids[i]];
+                alg.vertices.push_back(v);
+            }
+
+            int seamFacets = 0;
+            alg.triangles.reserve(last - first);
+            for (std::size_t k = first; k < last; k++) {
+                const MeshFacet& face = facets[order[k].second];
+                Simplify::Triangle t;
+                bool locked = false;
+                for (int j = 0; j < 3; j++) {
+                    t.v[j] = static_cast<int>(std::lower_bound(ids.begin(), ids.end(),
+                                              face._aulPoints[j]) - ids.begin());
+                    if (alg.vertices[t.v[j]].locked)
+                        locked = true;
+                }
+                if (locked)
+                    seamFacets++;
+                alg.triangles.push_back(t);
+            }
+
+            // Each partition gets twice its share of the facets plus the facets at the
+            // seam. Forcing it down to its share would collapse edges with a high error
+            // because the seam can't be reduced yet. The final pass removes the rest.
+            int target = static_cast<int>(2.0 * static_cast<double>(targetSize) *
+                                          static_cast<double>(last - first) /
+                                          static_cast<double>(numFacets)) + seamFacets;
+            alg.simplify_mesh(target, tolerance);
+        }
+    }, threads, 1);
+
+    // merge the partitions, the locked points are shared
+    std::size_t countPoints = 0, countFacets = 0;
+    for (std::size_t p = 0; p < numParts; p++) {
+        countPoints += parts[p].vertices.size();
+        countFacets += parts[p].triangles.size();
     }
+
+    MeshPointArray new_points;
+    new_points.reserve(countPoints);
     MeshFacetArray new_facets;
-    new_facets.reserve(numFacets);
-    for (std::size_t i = 0; i < alg.triangles.size(); i++) {
-        if (!alg.triangles[i].deleted) {
+    new_facets.reserve(countFacets);
+
+    std::vector<unsigned long> seamIndex(points.size(), ULONG_MAX);
+    std::vector<unsigned long> index;
+    for (std::size_t p = 0; p < numParts; p++) {
+        const Simplify& alg = parts[p];
+        index.resize(alg.vertices.size());
+        for (std::size_t i = 0; i < alg.vertices.size(); i++) {
+            const Simplify::Vertex& v = alg.vertices[i];
+            if (owner[v.id] == seam) {
+                unsigned long& pos = seamIndex[v.id];
+                if (pos == ULONG_MAX) {
+                    pos = static_cast<unsigned long>(new_points.size());
+                    new_points.push_back(v.p);
+                }
+                index[i] = pos;
+            }
+            else {
+                index[i] = static_cast<unsigned long>(new_points.size());
+                new_points.push_back(v.p);
+            }
+        }
+
+        for (std::size_t i = 0; i < alg.triangles.size(); i++) {
             MeshFacet face;
-            face._aulPoints[0] = alg.triangles[i].v[0];
-            face._aulPoints[1] = alg.triangles[i].v[1];
-            face._aulPoints[2] = alg.triangles[i].v[2];
+            face._aulPoints[0] = index[alg.triangles[i].v[0]];
+            face._aulPoints[1] = index[alg.triangles[i].v[1]];
+            face._aulPoints[2] = index[alg.triangles[i].v[2]];
             new_facets.push_back(face);
         }
     }
 
-    myKernel.Adopt(new_points, new_facets, true);
+    kernel.Adopt(new_points, new_facets, true);
+}
+
+}
+
+MeshSimplify::MeshSimplify(MeshKernel& mesh)
+  : myKernel(mesh)
+  , featureAngle(0.0f)
+{
+}
+
+MeshSimplify::~MeshSimplify()
+{
+}
+
+void MeshSimplify::setFeatureAngle(float angle)
+{
+    featureAngle = angle;
+}
+
+void MeshSimplify::simplify(float tolerance, float reduction)
+{
+    int target_count = static_cast<int>(static_cast<float>(myKernel.CountFacets()) * (1.0f-reduction));
+    decimate(target_count, tolerance);
+}
+
+void MeshSimplify::simplify(int targetSize)
+{
+    decimate(targetSize, FLT_MAX);
+}
+
+void MeshSimplify::decimate(int targetSize, double tolerance)
+{
+    // partitions smaller than this don't pay off
+    const std::size_t minPartSize = 20000;
+
+    int threads = QThread::idealThreadCount();
+    std::size_t numFacets = myKernel.CountFacets();
+    std::size_t numParts = std::min<std::size_t>(std::max<int>(threads, 1), numFacets / minPartSize);
+
+    std::vector<SymmetricMatrix> constraints;
+    if (numParts > 1 && static_cast<std::size_t>(std::max<int>(targetSize, 0)) < numFacets) {
+        featureQuadrics(myKernel, featureAngle, threads, constraints);
+        decimatePartitions(myKernel, targetSize, tolerance, constraints, numParts, threads);
+    }
+
+    // the final pass also reduces the seams between the partitions
+    featureQuadrics(myKernel, featureAngle, threads, constraints);
+    decimateMesh(myKernel, targetSize, tolerance, constraints);
 }
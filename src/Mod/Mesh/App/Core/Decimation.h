@@ -29,16 +29,38 @@ namespace MeshCore
 {
 class MeshKernel;
 
+/**
+ * The MeshSimplify class reduces the number of facets of a mesh by collapsing edges
+ * in the order of their quadric error.
+ *
+ * Large meshes are split along a Z-order curve into one partition per thread. The
+ * partitions are simplified in parallel while the points they share are locked. A
+ * final pass over the merged mesh then also reduces the seams between them.
+ */
 class MeshExport MeshSimplify
 {
 public:
     MeshSimplify(MeshKernel&);
     ~MeshSimplify();
+    /**
+     * Edges whose adjacent facets enclose an angle above \a angle (in radians) are
+     * kept as sharp as possible: their points may only slide along them. An angle of
+     * 0, the default, disables this.
+     */
+    void setFeatureAngle(float angle);
+    /** Removes up to the fraction \a reduction of the facets as long as the quadric
+     * error stays below \a tolerance.
+     */
     void simplify(float tolerance, float reduction);
+    /** Reduces the mesh to about \a targetSize facets. */
     void simplify(int targetSize);
 
+private:
+    void decimate(int targetSize, double tolerance);
+
 private:
     MeshKernel& myKernel;
+    float featureAngle;
 };
 
 } // namespace MeshCore
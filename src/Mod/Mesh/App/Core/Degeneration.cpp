@@ -896,7 +896,8 @@ bool MeshFixMergeFacets::Fixup()
 bool MeshEvalDentsOnSurface::Evaluate()
 {
     this->indices.clear();
-    MeshRefPointToFacets  clPt2Facets(_rclMesh);
+    const MeshIndexRows& clPt2Points = _rclMesh.GetPointToPoints();
+    const MeshIndexRows& clPt2Facets = _rclMesh.GetPointToFacets();
     const MeshPointArray& rPntAry = _rclMesh.GetPoints();
     MeshFacetArray::_TConstIterator f_beg = _rclMesh.GetFacets().begin();
 
@@ -904,17 +905,12 @@ bool MeshEvalDentsOnSurface::Evaluate()
     Base::Vector3f tmp;
     unsigned long ctPoints = _rclMesh.CountPoints();
     for (unsigned long index=0; index < ctPoints; index++) {
-        std::vector<unsigned long> point;
-        point.push_back(index);
-
-        // get the local neighbourhood of the point
-        std::set<unsigned long> nb = clPt2Facets.NeighbourPoints(point,1);
-        const std::set<unsigned long>& faces = clPt2Facets[index];
-
-        for (std::set<unsigned long>::iterator pt = nb.begin(); pt != nb.end(); ++pt) {
+        // the local neighbourhood of the point are the points of its facets
+        for (MeshIndexRows::const_iterator
+            pt = clPt2Points.Begin(index); pt != clPt2Points.End(index); ++pt) {
             const MeshPoint& mp = rPntAry[*pt];
-            for (std::set<unsigned long>::const_iterator
-                ft = faces.begin(); ft != faces.end(); ++ft) {
+            for (MeshIndexRows::const_iterator
+                ft = clPt2Facets.Begin(index); ft != clPt2Facets.End(index); ++ft) {
                     // the point must not be part of the facet we test
                     if (f_beg[*ft]._aulPoints[0] == *pt)
                         continue;
@@ -925,8 +921,8 @@ bool MeshEvalDentsOnSurface::Evaluate()
                     // is the point projectable onto the facet?
                     rTriangle = _rclMesh.GetFacet(f_beg[*ft]);
                     if (rTriangle.IntersectWithLine(mp,rTriangle.GetNormal(),tmp)) {
-                        const std::set<unsigned long>& f = clPt2Facets[*pt];
-                        this->indices.insert(this->indices.end(), f.begin(), f.end());
+                        this->indices.insert(this->indices.end(),
+                            clPt2Facets.Begin(*pt), clPt2Facets.End(*pt));
                         break;
                     }
             }
@@ -1087,14 +1083,14 @@ bool MeshEvalBorderFacet::Evaluate()
     const MeshCore::MeshFacetArray& facets = _rclMesh.GetFacets();
     MeshCore::MeshFacetArray::_TConstIterator f_it,
         f_beg = facets.begin(), f_end = facets.end();
-    MeshCore::MeshRefPointToPoints vv_it(_rclMesh);
-    MeshCore::MeshRefPointToFacets vf_it(_rclMesh);
+    const MeshCore::MeshIndexRows& vv_it = _rclMesh.GetPointToPoints();
+    const MeshCore::MeshIndexRows& vf_it = _rclMesh.GetPointToFacets();
 
     for (f_it = facets.begin(); f_it != f_end; ++f_it) {
         bool ok = true;
         for (int i=0; i<3; i++) {
             unsigned long index = f_it->_aulPoints[i];
-            if (vv_it[index].size() == vf_it[index].size()) {
+            if (vv_it.Count(index) == vf_it.Count(index)) {
                 ok = false;
                 break;
             }
@@ -33,6 +33,7 @@
 
 #include "Elements.h"
 #include "Algorithm.h"
+#include "MeshKernel.h"
 #include "tritritest.h"
 #include "Utilities.h"
 
@@ -178,6 +179,14 @@ MeshFacetArray& MeshFacetArray::operator = (const MeshFacetArray &rclFAry)
 
 // -----------------------------------------------------------------
 
+void MeshFacetModifier::Transpose(unsigned long pos, unsigned long old, unsigned long now)
+{
+  rFacets[pos].Transpose(old, now);
+  rKernel.InvalidateTopology();
+}
+
+// -----------------------------------------------------------------
+
 bool MeshGeomEdge::ContainedByOrIntersectBoundingBox ( const Base::BoundBox3f &rclBB ) const
 {
   // Test, ob alle Eckpunkte der Edge sich auf einer der 6 Seiten der BB befinden
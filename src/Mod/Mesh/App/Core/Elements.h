@@ -44,6 +44,7 @@ namespace MeshCore {
 
 class MeshHelpEdge;
 class MeshPoint;
+class MeshKernel;
 
 /**
  * Helper class providing an operator for comparison 
@@ -669,13 +670,13 @@ private:
 class MeshExport MeshFacetModifier
 {
 public:
-    MeshFacetModifier(MeshFacetArray& facets)
-        : rFacets(facets)
+    MeshFacetModifier(MeshKernel& kernel, MeshFacetArray& facets)
+        : rKernel(kernel), rFacets(facets)
     {
     }
 
     MeshFacetModifier(const MeshFacetModifier& c)
-        : rFacets(c.rFacets)
+        : rKernel(c.rKernel), rFacets(c.rFacets)
     {
     }
 
@@ -683,13 +684,12 @@ public:
      * Replaces the index of the corner point of the facet at position \a pos
      * that is equal to \a old by \a now. If the facet does not have a corner
      * point with this index nothing happens.
+     * The adjacency data of the mesh kernel is marked as outdated.
      */
-    void Transpose(unsigned long pos, unsigned long old, unsigned long now)
-    {
-        rFacets[pos].Transpose(old, now);
-    }
+    void Transpose(unsigned long pos, unsigned long old, unsigned long now);
 
 private:
+    MeshKernel& rKernel;
     MeshFacetArray& rFacets;
 };
 
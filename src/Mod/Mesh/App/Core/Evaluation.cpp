@@ -25,9 +25,13 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <atomic>
 # include <vector>
 #endif
 
+#include <QtConcurrentMap>
+#include <QThread>
+
 #include <Mod/Mesh/App/WildMagic4/Wm4Matrix3.h>
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
 
@@ -470,25 +474,22 @@ bool MeshEvalPointManifolds::Evaluate ()
     this->nonManifoldPoints.clear();
     this->facetsOfNonManifoldPoints.clear();
 
-    MeshCore::MeshRefPointToPoints vv_it(_rclMesh);
-    MeshCore::MeshRefPointToFacets vf_it(_rclMesh);
+    const MeshIndexRows& vv_it = _rclMesh.GetPointToPoints();
+    const MeshIndexRows& vf_it = _rclMesh.GetPointToFacets();
 
     unsigned long ctPoints = _rclMesh.CountPoints();
     for (unsigned long index=0; index < ctPoints; index++) {
         // get the local neighbourhood of the point
-        const std::set<unsigned long>& nf = vf_it[index];
-        const std::set<unsigned long>& np = vv_it[index];
-
-        std::set<unsigned long>::size_type sp, sf;
-        sp = np.size();
-        sf = nf.size();
+        unsigned long sp, sf;
+        sp = vv_it.Count(index);
+        sf = vf_it.Count(index);
         // for an inner point the number of adjacent points is equal to the number of shared faces
         // for a boundary point the number of adjacent points is higher by one than the number of shared faces
         // for a non-manifold point the number of adjacent points is higher by more than one than the number of shared faces
         if (sp > sf + 1) {
             nonManifoldPoints.push_back(index);
             std::vector<unsigned long> faces;
-            faces.insert(faces.end(), nf.begin(), nf.end());
+            faces.insert(faces.end(), vf_it.Begin(index), vf_it.End(index));
             this->facetsOfNonManifoldPoints.push_back(faces);
         }
     }
@@ -593,76 +594,189 @@ bool MeshFixSingleFacet::Fixup ()
 
 // ----------------------------------------------------------------
 
-bool MeshEvalSelfIntersection::Evaluate ()
+namespace MeshCore {
+
+/**
+ * The MeshSelfIntersectionFacet struct keeps the data of a facet that is needed
+ * by the self-intersection test. It is computed once and then shared by all threads.
+ */
+struct MeshSelfIntersectionFacet
+{
+    MeshGeomFacet facet;
+    Base::BoundBox3f box;
+    double plane[4]; /**< Unnormalized plane normal and distance. */
+    double tol;      /**< Tolerance of the plane test. */
+};
+
+/**
+ * The MeshSelfIntersectionJob struct holds a range of grid cells checked by one
+ * worker and the facet pairs the worker has found.
+ */
+struct MeshSelfIntersectionJob
+{
+    unsigned long ulBegin;
+    unsigned long ulEnd;
+    std::vector<std::pair<unsigned long, unsigned long> > aulPairs;
+};
+
+/**
+ * Returns true if all points of \a f2 lie strictly on one side of the plane of \a f1.
+ * This is the first rejection test of the triangle-triangle test but computed with
+ * a tolerance on the safe side, so it never rejects a pair that
+ * MeshGeomFacet::IntersectWithFacet() would report.
+ */
+static inline bool SeparatedByPlane(const MeshSelfIntersectionFacet& f1, const MeshSelfIntersectionFacet& f2)
+{
+    int side = 0;
+    for (int i = 0; i < 3; i++) {
+        const Base::Vector3f& p = f2.facet._aclPoints[i];
+        double dist = f1.plane[0] * p.x + f1.plane[1] * p.y + f1.plane[2] * p.z - f1.plane[3];
+        double tol = f1.tol * (1.0 + fabs(p.x) + fabs(p.y) + fabs(p.z));
+        if (dist > tol)
+            side++;
+        else if (dist < -tol)
+            side--;
+        else
+            return false;
+    }
+
+    return side == 3 || side == -3;
+}
+
+}
+
+void MeshEvalSelfIntersection::FindIntersections(std::vector<std::pair<unsigned long, unsigned long> >& intersection,
+                                                 bool firstOnly) const
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
+    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
+    std::size_t ctFacets = rFaces.size();
+    int threads = std::max(1, QThread::idealThreadCount());
+
+    // Computes the geometry of every facet only once
+    std::vector<MeshSelfIntersectionFacet> facets(ctFacets);
+    const MeshKernel& kernel = _rclMesh;
+    MeshCore::parallel_blocks(ctFacets, [&kernel, &rFaces, &facets](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            MeshSelfIntersectionFacet& data = facets[i];
+            data.facet = kernel.GetFacet(rFaces[i]);
+            data.facet.GetNormal(); // computes and caches the normal
+            data.box = data.facet.GetBoundBox();
+
+            const Base::Vector3f& p0 = data.facet._aclPoints[0];
+            const Base::Vector3f& p1 = data.facet._aclPoints[1];
+            const Base::Vector3f& p2 = data.facet._aclPoints[2];
+            double u[3] = {double(p1.x) - p0.x, double(p1.y) - p0.y, double(p1.z) - p0.z};
+            double v[3] = {double(p2.x) - p0.x, double(p2.y) - p0.y, double(p2.z) - p0.z};
+            data.plane[0] = u[1] * v[2] - u[2] * v[1];
+            data.plane[1] = u[2] * v[0] - u[0] * v[2];
+            data.plane[2] = u[0] * v[1] - u[1] * v[0];
+            data.plane[3] = data.plane[0] * p0.x + data.plane[1] * p0.y + data.plane[2] * p0.z;
+            double len = fabs(data.plane[0]) + fabs(data.plane[1]) + fabs(data.plane[2]);
+            data.tol = 1.0e-5 * (1.0 + len * (1.0 + fabs(p0.x) + fabs(p0.y) + fabs(p0.z)));
+        }
+    }, threads);
 
     // Splits the mesh using grid for speeding up the calculation
     MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
+    const MeshGridCells& cells = cMeshFacetGrid.GetGridCells();
+    unsigned long ulCtCells = cells.CountCells();
+
+    // Distributes the cells to jobs with about the same number of facet pairs
+    double work = 0.0;
+    for (unsigned long i = 0; i < ulCtCells; i++) {
+        double n = cells.CountIndices(i);
+        work += n * n;
+    }
 
-    MeshFacetIterator cMFI(_rclMesh);
-    for (cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
+    std::vector<MeshSelfIntersectionJob> jobs;
+    double workPerJob = std::max(work / (8.0 * threads), 1.0);
+    double current = 0.0;
+    MeshSelfIntersectionJob job;
+    job.ulBegin = 0;
+    for (unsigned long i = 0; i < ulCtCells; i++) {
+        double n = cells.CountIndices(i);
+        current += n * n;
+        if (current >= workPerJob || i + 1 == ulCtCells) {
+            job.ulEnd = i + 1;
+            jobs.push_back(job);
+            job.ulBegin = i + 1;
+            current = 0.0;
+        }
     }
 
     // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
-
-        seq.next();
-        if (aulGridElements.size()==0)
-            continue;
-
-        MeshGeomFacet facet1, facet2;
+    std::atomic<bool> found(false);
+    auto check = [&rFaces, &facets, &cells, &found, firstOnly](MeshSelfIntersectionJob& job) {
         Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
-                // If the facets share a common vertex we do not check for self-intersections because they 
-                // could but usually do not intersect each other and the algorithm below would detect false-positives,
-                // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
-                if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[0] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[0] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[1] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[1] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[1] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[2] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[2] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[2] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-
-                const Base::BoundBox3f& box2 = boxes[*jt];
-                if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
-                    int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
-                    if (ret == 2) {
-                        // abort after the first detected self-intersection
-                        return false;
+        for (unsigned long cell = job.ulBegin; cell < job.ulEnd; cell++) {
+            if (firstOnly && found)
+                return;
+
+            MeshGridCells::const_iterator end = cells.End(cell);
+            for (MeshGridCells::const_iterator it = cells.Begin(cell); it != end; ++it) {
+                const MeshSelfIntersectionFacet& data1 = facets[*it];
+                const MeshFacet& rface1 = rFaces[*it];
+                for (MeshGridCells::const_iterator jt = it + 1; jt != end; ++jt) {
+                    // If the facets share a common vertex we do not check for self-intersections because they
+                    // could but usually do not intersect each other and the algorithm below would detect false-positives,
+                    // otherwise
+                    const MeshFacet& rface2 = rFaces[*jt];
+                    if (rface1._aulPoints[0] == rface2._aulPoints[0] ||
+                        rface1._aulPoints[0] == rface2._aulPoints[1] ||
+                        rface1._aulPoints[0] == rface2._aulPoints[2])
+                        continue; // ignore facets sharing a common vertex
+                    if (rface1._aulPoints[1] == rface2._aulPoints[0] ||
+                        rface1._aulPoints[1] == rface2._aulPoints[1] ||
+                        rface1._aulPoints[1] == rface2._aulPoints[2])
+                        continue; // ignore facets sharing a common vertex
+                    if (rface1._aulPoints[2] == rface2._aulPoints[0] ||
+                        rface1._aulPoints[2] == rface2._aulPoints[1] ||
+                        rface1._aulPoints[2] == rface2._aulPoints[2])
+                        continue; // ignore facets sharing a common vertex
+
+                    const MeshSelfIntersectionFacet& data2 = facets[*jt];
+                    if (!(data1.box && data2.box))
+                        continue;
+                    if (SeparatedByPlane(data1, data2) || SeparatedByPlane(data2, data1))
+                        continue;
+                    if (data1.facet.IntersectWithFacet(data2.facet, pt1, pt2) == 2) {
+                        job.aulPairs.emplace_back(*it, *jt);
+                        if (firstOnly) {
+                            found = true;
+                            return;
+                        }
                     }
                 }
             }
         }
+    };
+
+    // Runs as many jobs at a time as there are threads to keep the sequencer going
+    Base::SequencerLauncher seq("Checking for self-intersections...", jobs.size());
+    std::size_t numJobs = jobs.size();
+    for (std::size_t i = 0; i < numJobs; i += threads) {
+        std::vector<MeshSelfIntersectionJob>::iterator first = jobs.begin() + i;
+        std::vector<MeshSelfIntersectionJob>::iterator last = jobs.begin() + std::min<std::size_t>(i + threads, numJobs);
+        QtConcurrent::blockingMap(first, last, check);
+        for (std::vector<MeshSelfIntersectionJob>::iterator it = first; it != last; ++it)
+            seq.next(!firstOnly);
+        if (firstOnly && found)
+            break;
     }
 
-    return true;
+    // A pair of facets may share several cells
+    std::size_t ctPairs = intersection.size();
+    for (std::vector<MeshSelfIntersectionJob>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+        intersection.insert(intersection.end(), it->aulPairs.begin(), it->aulPairs.end());
+    std::sort(intersection.begin() + ctPairs, intersection.end());
+    intersection.erase(std::unique(intersection.begin() + ctPairs, intersection.end()), intersection.end());
+}
+
+bool MeshEvalSelfIntersection::Evaluate ()
+{
+    std::vector<std::pair<unsigned long, unsigned long> > intersection;
+    FindIntersections(intersection, true);
+    return intersection.empty();
 }
 
 void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsigned long, unsigned long> >& indices,
@@ -691,72 +805,7 @@ void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsi
 
 void MeshEvalSelfIntersection::GetIntersections(std::vector<std::pair<unsigned long, unsigned long> >& intersection) const
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
-    //intersection.clear();
-
-    // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
-
-    MeshFacetIterator cMFI(_rclMesh);
-    for(cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
-    }
-
-    // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
-
-        seq.next(true);
-        if (aulGridElements.size()==0)
-            continue;
-
-        MeshGeomFacet facet1, facet2;
-        Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
-                // If the facets share a common vertex we do not check for self-intersections because they 
-                // could but usually do not intersect each other and the algorithm below would detect false-positives,
-                // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
-                if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[0] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[0] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[1] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[1] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[1] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[2] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[2] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[2] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-
-                const Base::BoundBox3f& box2 = boxes[*jt];
-                if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
-                    int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
-                    if (ret == 2) {
-                        intersection.emplace_back (*it,*jt);
-                    }
-                }
-            }
-        }
-    }
+    FindIntersections(intersection, false);
 }
 
 std::vector<unsigned long> MeshFixSelfIntersection::GetFacets() const
@@ -297,6 +297,14 @@ public:
         std::vector<std::pair<Base::Vector3f, Base::Vector3f> >&) const;
     /// collect the index of all facets with self intersections
     void GetIntersections(std::vector<std::pair<unsigned long, unsigned long> >&) const;
+
+private:
+    /**
+     * Checks all pairs of facets sharing a grid cell in several threads. The found
+     * pairs are sorted and each pair is only reported once. If \a firstOnly is true
+     * the search stops after the first intersection.
+     */
+    void FindIntersections(std::vector<std::pair<unsigned long, unsigned long> >&, bool firstOnly) const;
 };
 
 /**
@@ -25,6 +25,9 @@
 #define MESH_FUNCTIONAL_H
 
 #include <algorithm>
+#include <utility>
+#include <vector>
+#include <QtConcurrentMap>
 #include <QtConcurrentRun>
 #include <QFuture>
 #include <QThread>
@@ -58,6 +61,35 @@ namespace MeshCore
         }
     }
 
+    /**
+     * Splits the index range [0, count) into at most \a threads consecutive blocks
+     * of about the same size and calls \a func(begin, end) for each block in parallel.
+     * Blocks are not made smaller than \a minSize elements.
+     */
+    template <class Func>
+    static void parallel_blocks(std::size_t count, Func func, int threads, std::size_t minSize = 1000)
+    {
+        typedef std::pair<std::size_t, std::size_t> Block;
+        std::size_t numBlocks = std::min<std::size_t>(std::max<int>(threads, 1),
+                                                      std::max<std::size_t>(count / std::max<std::size_t>(minSize, 1), 1));
+        if (numBlocks < 2) {
+            if (count > 0)
+                func(std::size_t(0), count);
+            return;
+        }
+
+        std::vector<Block> blocks(numBlocks);
+        std::size_t step = count / numBlocks;
+        for (std::size_t i = 0; i < numBlocks; i++) {
+            blocks[i].first = i * step;
+            blocks[i].second = (i + 1 == numBlocks) ? count : (i + 1) * step;
+        }
+
+        QtConcurrent::blockingMap(blocks, [&func](Block& block) {
+            func(block.first, block.second);
+        });
+    }
+
 } // namespace MeshCore
 
 
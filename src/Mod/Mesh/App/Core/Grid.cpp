@@ -27,6 +27,9 @@
 # include <algorithm>
 #endif
 
+#include <QtConcurrentMap>
+#include <QThread>
+
 #include "Grid.h"
 #include "Iterator.h"
 
@@ -62,7 +65,7 @@ void MeshGrid::Attach (const MeshKernel &rclM)
 
 void MeshGrid::Clear (void)
 {
-  _aulGrid.clear();
+  _aulGrid.Clear();
   _pclMesh = NULL;  
 }
 
@@ -93,8 +96,6 @@ void MeshGrid::InitGrid (void)
 {
   assert(_pclMesh != NULL);
 
-  unsigned long i, j;
-
   // Grid Laengen berechnen wenn nicht initialisiert
   //
   if ((_ulCtGridsX == 0) || (_ulCtGridsY == 0) || (_ulCtGridsZ == 0))
@@ -128,14 +129,82 @@ void MeshGrid::InitGrid (void)
   }
 
   // Daten-Struktur anlegen
-  _aulGrid.clear();
-  _aulGrid.resize(_ulCtGridsX);
-  for (i = 0; i < _ulCtGridsX; i++)
-  {
-    _aulGrid[i].resize(_ulCtGridsY);
-    for (j = 0; j < _ulCtGridsY; j++)
-      _aulGrid[i][j].resize(_ulCtGridsZ);
+  _aulGrid.Resize(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ);
+}
+
+namespace MeshCore {
+/**
+ * Range of elements that is handled by one thread when filling the grid.
+ * The counters hold the number of elements per cell of this range and are
+ * afterwards reused as insert positions.
+ */
+struct MeshGridChunk
+{
+  unsigned long ulBegin;
+  unsigned long ulEnd;
+  std::vector<unsigned long> aulCounts;
+};
+}
+
+void MeshGrid::FillGrid (void)
+{
+  unsigned long ulCtCells = _ulCtGridsX * _ulCtGridsY * _ulCtGridsZ;
+  _aulGrid.Resize(ulCtCells);
+  if (_ulCtElements == 0 || ulCtCells == 0)
+    return;
+
+  // Each range needs its own counter for every cell, so for very fine grids
+  // and for small meshes fewer ranges are used.
+  unsigned long ulCtChunks = static_cast<unsigned long>(std::max<int>(QThread::idealThreadCount(), 1));
+  ulCtChunks = std::min<unsigned long>(ulCtChunks, std::max<unsigned long>(_ulCtElements / MESH_GRID_MIN_CHUNK, 1));
+  ulCtChunks = std::min<unsigned long>(ulCtChunks, std::max<unsigned long>(MESH_GRID_MAX_COUNTERS / ulCtCells, 1));
+
+  std::vector<MeshGridChunk> aclChunks(ulCtChunks);
+  unsigned long ulStep = _ulCtElements / ulCtChunks;
+  for (unsigned long i = 0; i < ulCtChunks; i++) {
+    aclChunks[i].ulBegin = i * ulStep;
+    aclChunks[i].ulEnd = (i + 1 == ulCtChunks) ? _ulCtElements : (i + 1) * ulStep;
+  }
+
+  // count the elements per cell
+  QtConcurrent::blockingMap(aclChunks, [this, ulCtCells](MeshGridChunk& chunk) {
+    std::vector<unsigned long> aulCells;
+    chunk.aulCounts.assign(ulCtCells, 0);
+    for (unsigned long i = chunk.ulBegin; i < chunk.ulEnd; i++) {
+      aulCells.clear();
+      GetCells(i, aulCells);
+      for (std::vector<unsigned long>::iterator it = aulCells.begin(); it != aulCells.end(); ++it)
+        chunk.aulCounts[*it]++;
+    }
+  });
+
+  // Prefix sum over the cells. Inside a cell the ranges are placed in ascending
+  // order so that the indices of each cell end up sorted.
+  std::vector<unsigned long>& aulOffsets = _aulGrid._aulOffsets;
+  unsigned long ulPos = 0;
+  for (unsigned long c = 0; c < ulCtCells; c++) {
+    aulOffsets[c] = ulPos;
+    for (std::vector<MeshGridChunk>::iterator it = aclChunks.begin(); it != aclChunks.end(); ++it) {
+      unsigned long ulCount = it->aulCounts[c];
+      it->aulCounts[c] = ulPos;
+      ulPos += ulCount;
+    }
   }
+  aulOffsets[ulCtCells] = ulPos;
+
+  // scatter the element indices into the cells
+  _aulGrid._aulIndices.resize(ulPos);
+  unsigned long* pulIndices = _aulGrid._aulIndices.data();
+  QtConcurrent::blockingMap(aclChunks, [this, pulIndices](MeshGridChunk& chunk) {
+    std::vector<unsigned long> aulCells;
+    for (unsigned long i = chunk.ulBegin; i < chunk.ulEnd; i++) {
+      aulCells.clear();
+      GetCells(i, aulCells);
+      for (std::vector<unsigned long>::iterator it = aulCells.begin(); it != aulCells.end(); ++it)
+        pulIndices[chunk.aulCounts[*it]++] = i;
+    }
+    std::vector<unsigned long>().swap(chunk.aulCounts);
+  });
 }
 
 unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulElements,
@@ -155,7 +224,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(raulElements.end(), _aulGrid.Begin(Cell(i, j, k)), _aulGrid.End(Cell(i, j, k)));
       }
     }
   }  
@@ -190,7 +259,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).GetCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          raulElements.insert(raulElements.end(), _aulGrid.Begin(Cell(i, j, k)), _aulGrid.End(Cell(i, j, k)));
       }
     }
   }  
@@ -221,7 +290,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(_aulGrid.Begin(Cell(i, j, k)), _aulGrid.End(Cell(i, j, k)));
       }
     }
   }  
@@ -478,7 +547,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(_aulGrid.Begin(Cell(nX, i, j)), _aulGrid.End(Cell(nX, i, j)));
           }
           nX++;
         }
@@ -492,7 +561,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(_aulGrid.Begin(Cell(nX, i, j)), _aulGrid.End(Cell(nX, i, j)));
           }
           nX++;
         }
@@ -506,7 +575,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(_aulGrid.Begin(Cell(i, nY, j)), _aulGrid.End(Cell(i, nY, j)));
           }
           nY++;
         }
@@ -520,7 +589,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(_aulGrid.Begin(Cell(i, nY, j)), _aulGrid.End(Cell(i, nY, j)));
           }
           nY--;
         }
@@ -534,7 +603,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(_aulGrid.Begin(Cell(i, j, nZ)), _aulGrid.End(Cell(i, j, nZ)));
           }
           nZ++;
         }
@@ -548,7 +617,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(_aulGrid.Begin(Cell(i, j, nZ)), _aulGrid.End(Cell(i, j, nZ)));
           }
           nZ--;
         }
@@ -644,14 +713,9 @@ void MeshGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ,
 unsigned long MeshGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
-  {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
-  }
-
-  return 0;
+  unsigned long ulCell = Cell(ulX, ulY, ulZ);
+  raclInd.insert(_aulGrid.Begin(ulCell), _aulGrid.End(ulCell));
+  return _aulGrid.CountIndices(ulCell);
 }
 
 unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<unsigned long>& aulFacets) const
@@ -660,9 +724,8 @@ unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<
   if (!CheckPosition(rclPoint, ulX, ulY, ulZ))
     return 0;
 
-  aulFacets.resize(_aulGrid[ulX][ulY][ulZ].size());
-
-  std::copy(_aulGrid[ulX][ulY][ulZ].begin(), _aulGrid[ulX][ulY][ulZ].end(), aulFacets.begin());
+  unsigned long ulCell = Cell(ulX, ulY, ulZ);
+  aulFacets.assign(_aulGrid.Begin(ulCell), _aulGrid.End(ulCell));
   return aulFacets.size();
 }
 
@@ -767,15 +830,7 @@ void MeshFacetGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-  MeshFacetIterator clFIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (clFIter.Init(); clFIter.More(); clFIter.Next())
-  {
-//    AddFacet(*clFIter, i++, 2.0f);
-    AddFacet(*clFIter, i++);
-  }
-
+  FillGrid();
 }
 
 unsigned long MeshFacetGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt) const
@@ -1006,8 +1061,8 @@ void MeshFacetGrid::SearchNearestFacetInGrid(unsigned long ulX, unsigned long ul
                                              const Base::Vector3f &rclPt, float &rfMinDist,
                                              unsigned long &rulFacetInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  for (std::set<unsigned long>::const_iterator pI = rclSet.begin(); pI != rclSet.end(); ++pI)
+  unsigned long ulCell = Cell(ulX, ulY, ulZ);
+  for (MeshGridCells::const_iterator pI = _aulGrid.Begin(ulCell); pI != _aulGrid.End(ulCell); ++pI)
   {
     float fDist = _pclMesh->GetFacet(*pI).DistanceToPoint(rclPt);
     if (fDist < rfMinDist)
@@ -1052,13 +1107,13 @@ MeshPointGrid::MeshPointGrid (const MeshKernel &rclM, float fGridLen)
           std::max<unsigned long>(static_cast<unsigned long>(clBBMesh.LengthZ() / fGridLen), 1));
 }
 
-void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon)
+void MeshPointGrid::GetCells (unsigned long ulIndex, std::vector<unsigned long> &raulCells) const
 {
-  (void)fEpsilon;
+  const MeshPoint& rclPt = _pclMesh->GetPoints()[ulIndex];
   unsigned long ulX, ulY, ulZ;
   Pos(Base::Vector3f(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
   if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+    raulCells.push_back(Cell(ulX, ulY, ulZ));
 }
 
 void MeshPointGrid::Validate (const MeshKernel &rclMesh)
@@ -1109,14 +1164,7 @@ void MeshPointGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-
-  MeshPointIterator cPIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (cPIter.Init(); cPIter.More(); cPIter.Next())
-  {
-    AddPoint(*cPIter, i++);
-  }
+  FillGrid();
 }
 
 void MeshPointGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -1178,7 +1226,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    GetElements(raulElements);
     _bValidRay = true;
   }
   else
@@ -1191,7 +1239,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      GetElements(raulElements);
       _bValidRay = true;
     }
   }
@@ -1242,7 +1290,7 @@ bool MeshGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    GetElements(raulElements);
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
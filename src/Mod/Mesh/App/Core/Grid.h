@@ -25,6 +25,7 @@
 #define MESH_GRID_H
 
 #include <set>
+#include <vector>
 
 #include "MeshKernel.h"
 #include <Base/Vector3D.h>
@@ -33,6 +34,8 @@
 #define  MESH_CT_GRID          256     // Default value for number of elements per grid
 #define  MESH_MAX_GRIDS        100000  // Default value for maximum number of grids
 #define  MESH_CT_GRID_PER_AXIS 20
+#define  MESH_GRID_MIN_CHUNK   10000     // Minimum number of elements handled by one thread when filling a grid
+#define  MESH_GRID_MAX_COUNTERS 50000000 // Maximum number of per-thread cell counters when filling a grid
 
 
 namespace MeshCore {
@@ -44,6 +47,47 @@ class MeshGrid;
 //#define MESHGRID_BBOX_EXTENSION 1.0e-3f
 #define MESHGRID_BBOX_EXTENSION 10.0f
 
+/**
+ * The MeshGridCells class stores the element indices of all cells of a grid
+ * in compressed row format. Instead of an own container for each cell the
+ * indices of all cells are kept in one contiguous array and an offset array
+ * tells where the indices of a cell start. Within a cell the indices are sorted
+ * in ascending order.
+ */
+class MeshExport MeshGridCells
+{
+public:
+  typedef std::vector<unsigned long>::const_iterator const_iterator;
+
+  /** Removes all cells. */
+  void Clear (void)
+  { std::vector<unsigned long>().swap(_aulOffsets); std::vector<unsigned long>().swap(_aulIndices); }
+  /** Sets the number of cells. All cells are empty afterwards. */
+  void Resize (unsigned long ulCtCells)
+  { _aulIndices.clear(); _aulOffsets.assign(ulCtCells + 1, 0); }
+  /** Returns the number of cells. */
+  unsigned long CountCells (void) const
+  { return _aulOffsets.empty() ? 0 : static_cast<unsigned long>(_aulOffsets.size() - 1); }
+  /** Returns the number of stored indices of all cells. */
+  unsigned long CountIndices (void) const
+  { return static_cast<unsigned long>(_aulIndices.size()); }
+  /** Returns the number of indices in the cell \a ulCell. */
+  unsigned long CountIndices (unsigned long ulCell) const
+  { return _aulOffsets[ulCell + 1] - _aulOffsets[ulCell]; }
+  /** Returns an iterator to the first index of the cell \a ulCell. */
+  const_iterator Begin (unsigned long ulCell) const
+  { return _aulIndices.begin() + _aulOffsets[ulCell]; }
+  /** Returns an iterator past the last index of the cell \a ulCell. */
+  const_iterator End (unsigned long ulCell) const
+  { return _aulIndices.begin() + _aulOffsets[ulCell + 1]; }
+
+private:
+  std::vector<unsigned long> _aulOffsets; /**< Start position of each cell in _aulIndices. */
+  std::vector<unsigned long> _aulIndices; /**< Element indices of all cells. */
+
+  friend class MeshGrid;
+};
+
 /**
  * The MeshGrid allows to divide a global mesh object into smaller regions
  * of elements (e.g. facets, points or edges) depending on the resolution
@@ -96,6 +140,9 @@ public:
   /** Returns the indices of the elements in the given grid. */
   unsigned long GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  std::set<unsigned long> &raclInd) const;
   unsigned long GetElements (const Base::Vector3f &rclPoint, std::vector<unsigned long>& aulFacets) const;
+  /** Returns the cell structure. The cell of a grid position is given by GetIndexToPosition(). */
+  const MeshGridCells& GetGridCells (void) const
+  { return _aulGrid; }
   //@}
 
   /** Returns the lengths of the grid elements in x,y and z direction. */
@@ -125,7 +172,7 @@ public:
   bool GetPositionToIndex(unsigned long id, unsigned long& ulX, unsigned long& ulY, unsigned long& ulZ) const;
   /** Returns the number of elements in a given grid. */
   unsigned long GetCtElements(unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
-  { return static_cast<unsigned long>(_aulGrid[ulX][ulY][ulZ].size()); }
+  { return _aulGrid.CountIndices(Cell(ulX, ulY, ulZ)); }
   /** Validates the grid structure and rebuilds it if needed. Must be implemented in sub-classes. */
   virtual void Validate (const MeshKernel &rclM) = 0;
   /** Verifies the grid structure and returns false if inconsistencies are found. */
@@ -155,9 +202,21 @@ protected:
   virtual void RebuildGrid (void) = 0;
   /** Returns the number of stored elements. Must be implemented in sub-classes. */
   virtual unsigned long HasElements (void) const = 0;
+  /** Appends the cell numbers of all grid elements the element with index \a ulIndex
+   * belongs to. A cell number must not be added twice. The method is called from
+   * several threads at the same time. Must be implemented in sub-classes. */
+  virtual void GetCells (unsigned long ulIndex, std::vector<unsigned long> &raulCells) const = 0;
+  /** Fills the grid cells with the first \a _ulCtElements elements. The elements are
+   * distributed over several threads which count the elements per cell, then the cell
+   * offsets are computed and finally the element indices are scattered to the cells.
+   * InitGrid() must have been called before. */
+  void FillGrid (void);
+  /** Returns the cell number of the grid element at the given position. */
+  unsigned long Cell (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX; }
 
 protected:
-  std::vector<std::vector<std::vector<std::set<unsigned long> > > >  _aulGrid;   /**< Grid data structure. */
+  MeshGridCells     _aulGrid;     /**< Grid data structure. */
   const MeshKernel* _pclMesh;     /**< The mesh kernel. */
   unsigned long     _ulCtElements;/**< Number of grid elements for validation issues. */
   unsigned long     _ulCtGridsX;  /**< Number of grid elements in z. */
@@ -224,10 +283,11 @@ protected:
   inline void Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   inline void PosWithCheck (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
-  /** Adds a new facet element to the grid structure. \a rclFacet is the geometric facet and \a ulFacetIndex 
-   * the corresponding index in the mesh kernel. The facet is added to each grid element that intersects 
-   * the facet. */
-  inline void AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float fEpsilon = 0.0f);
+  /** Appends the cell numbers of all grid elements that intersect the geometric facet \a rclFacet. */
+  inline void GetCells (const MeshGeomFacet &rclFacet, std::vector<unsigned long> &raulCells) const;
+  /** Appends the cell numbers of all grid elements that intersect the facet with index \a ulIndex. */
+  virtual void GetCells (unsigned long ulIndex, std::vector<unsigned long> &raulCells) const
+  { GetCells(_pclMesh->GetFacet(ulIndex), raulCells); }
   /** Returns the number of stored elements. */
   unsigned long HasElements (void) const
   { return _pclMesh->CountFacets(); }
@@ -268,9 +328,8 @@ public:
   virtual bool Verify() const;
 
 protected:
-  /** Adds a new point element to the grid structure. \a rclPt is the geometric point and \a ulPtIndex 
-   * the corresponding index in the mesh kernel. */
-  void AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon = 0.0f);
+  /** Appends the cell number of the grid element the point with index \a ulIndex lies in. */
+  virtual void GetCells (unsigned long ulIndex, std::vector<unsigned long> &raulCells) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   void Pos(const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the number of stored elements. */
@@ -295,7 +354,8 @@ public:
   /** Returns indices of the elements in the current grid. */
   void GetElements (std::vector<unsigned long> &raulElements) const
   {
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    unsigned long ulCell = _rclGrid.Cell(_ulX, _ulY, _ulZ);
+    raulElements.insert(raulElements.end(), _rclGrid._aulGrid.Begin(ulCell), _rclGrid._aulGrid.End(ulCell));
   }
   /** Returns the number of elements in the current grid. */
   unsigned long GetCtElements() const
@@ -434,38 +494,8 @@ inline void MeshFacetGrid::PosWithCheck (const Base::Vector3f &rclPoint, unsigne
   assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
 }
 
-inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float /*fEpsilon*/)
+inline void MeshFacetGrid::GetCells (const MeshGeomFacet &rclFacet, std::vector<unsigned long> &raulCells) const
 {
-#if 0
-  unsigned long  i, ulX, ulY, ulZ, ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
-  
-  ulX1 = ulY1 = ulZ1 = ULONG_MAX;
-  ulX2 = ulY2 = ulZ2 = 0;
-
-  for (i = 0; i < 3; i++)
-  {
-    Pos(rclFacet._aclPoints[i], ulX, ulY, ulZ);
-    _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-    ulX1 = RSmin<unsigned long>(ulX1, ulX); ulY1 = RSmin<unsigned long>(ulY1, ulY); ulZ1 = RSmin<unsigned long>(ulZ1, ulZ);
-    ulX2 = RSmax<unsigned long>(ulX2, ulX); ulY2 = RSmax<unsigned long>(ulY2, ulY); ulZ2 = RSmax<unsigned long>(ulZ2, ulZ);
-  }
-  
-  // falls Facet ueber mehrere BB reicht
-  if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
-  {
-    for (ulX = ulX1; ulX <= ulX2; ulX++)
-    {
-      for (ulY = ulY1; ulY <= ulY2; ulY++)
-      {
-        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
-        {
-          if (CMeshFacetFunc::BBoxContainFacet(GetBoundBox(ulX, ulY, ulZ), rclFacet) == true)
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-        }
-      }
-    }
-  }
-#else
   unsigned long ulX, ulY, ulZ;
 
   unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
@@ -476,22 +506,8 @@ inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned lon
   clBB.Add(rclFacet._aclPoints[1]);
   clBB.Add(rclFacet._aclPoints[2]);
 
-  //float fDiagonalLength = clBB.CalcDiagonalLength();
-
-  //clBB.Enlarge(fEpsilon*fDiagonalLength);
-
   Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
   Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
-  
-  /*
-  if (ulX1 > 0) ulX1--;
-  if (ulY1 > 0) ulY1--;
-  if (ulZ1 > 0) ulZ1--;
-  
-  if (ulX2 < (_ulCtGridsX-1)) ulX2++;
-  if (ulY2 < (_ulCtGridsY-1)) ulY2++;
-  if (ulZ2 < (_ulCtGridsZ-1)) ulZ2++;
-  */
 
   // falls Facet ueber mehrere BB reicht
   if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
@@ -503,15 +519,13 @@ inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned lon
         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
         {
           if ( rclFacet.IntersectBoundingBox( GetBoundBox(ulX, ulY, ulZ) ) )
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+            raulCells.push_back(Cell(ulX, ulY, ulZ));
         }
       }
     }
   }
   else
-    _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
-
-#endif
+    raulCells.push_back(Cell(ulX1, ulY1, ulZ1));
 }
 
 } // namespace MeshCore
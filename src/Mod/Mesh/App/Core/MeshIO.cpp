@@ -29,6 +29,7 @@
 #include "MeshIO.h"
 #include "Algorithm.h"
 #include "Builder.h"
+#include "Functional.h"
 
 #include <Base/Builder3D.h>
 #include <Base/Console.h>
@@ -38,11 +39,16 @@
 #include <Base/FileInfo.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 #include <Base/Placement.h>
 #include <Base/Tools.h>
 #include <zipios++/gzipoutputstream.h>
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentMap>
 
 #include <cmath>
+#include <memory>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
@@ -119,6 +125,48 @@ struct QUAD {int iV[4];};
 
 namespace MeshCore {
 
+/**
+ * Maps a file into memory and provides an input stream on the mapped data.
+ * If the file cannot be mapped isMapped() returns false and the caller must
+ * fall back to an ordinary file stream.
+ */
+class MeshMappedFile
+{
+public:
+    MeshMappedFile(const Base::FileInfo& fi)
+        : file(QString::fromUtf8(fi.filePath().c_str())), data(0)
+    {
+        if (file.open(QIODevice::ReadOnly) && file.size() > 0)
+            data = file.map(0, file.size());
+        if (data) {
+            buf.reset(new Base::MemoryIStreambuf(reinterpret_cast<const char*>(data),
+                                                 static_cast<std::size_t>(file.size())));
+            str.reset(new std::istream(buf.get()));
+        }
+    }
+    ~MeshMappedFile()
+    {
+        str.reset();
+        buf.reset();
+        if (data)
+            file.unmap(data);
+    }
+    bool isMapped() const
+    {
+        return data != 0;
+    }
+    std::istream& stream()
+    {
+        return *str;
+    }
+
+private:
+    QFile file;
+    uchar* data;
+    std::unique_ptr<Base::MemoryIStreambuf> buf;
+    std::unique_ptr<std::istream> str;
+};
+
 struct Color_Less
 {
     bool operator()(const App::Color& x,
@@ -134,6 +182,149 @@ struct Color_Less
     }
 };
 
+/**
+ * Writes the text representation of a float with six decimal places, i.e. the
+ * same output as std::ostream in fixed mode with precision 6, but independent
+ * of the stream locale and without the overhead of formatted stream output.
+ */
+static inline void appendFloat(std::string& str, float value)
+{
+    double v = value;
+    // v * 1e6 is exact for floats of this magnitude, so rounding to nearest
+    // even gives the same digits as printf
+    if (!(std::fabs(v) < 1e12)) {
+        char buf[64];
+        int len = snprintf(buf, sizeof(buf), "%f", v);
+        str.append(buf, static_cast<std::size_t>(len));
+        return;
+    }
+
+    char buf[32];
+    char* end = buf + sizeof(buf);
+    char* ptr = end;
+    uint64_t scaled = static_cast<uint64_t>(std::nearbyint(std::fabs(v) * 1e6));
+    uint64_t ipart = scaled / 1000000;
+    uint64_t fpart = scaled % 1000000;
+    for (int i = 0; i < 6; i++) {
+        *--ptr = static_cast<char>('0' + fpart % 10);
+        fpart /= 10;
+    }
+    *--ptr = '.';
+    do {
+        *--ptr = static_cast<char>('0' + ipart % 10);
+        ipart /= 10;
+    }
+    while (ipart > 0);
+    if (std::signbit(v))
+        *--ptr = '-';
+    str.append(ptr, static_cast<std::size_t>(end - ptr));
+}
+
+static inline void appendVector(std::string& str, const Base::Vector3f& v)
+{
+    appendFloat(str, v.x);
+    str.push_back(' ');
+    appendFloat(str, v.y);
+    str.push_back(' ');
+    appendFloat(str, v.z);
+}
+
+static inline void appendInt(std::string& str, uint64_t value)
+{
+    char buf[24];
+    char* end = buf + sizeof(buf);
+    char* ptr = end;
+    do {
+        *--ptr = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    while (value > 0);
+    str.append(ptr, static_cast<std::size_t>(end - ptr));
+}
+
+template <class T>
+static inline void appendBinary(std::string& str, T value, bool swap)
+{
+    if (swap)
+        Base::SwapEndian(value);
+    str.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Encodes consecutive blocks of elements in parallel, one block per thread, and
+ * writes the encoded blocks in their original order to the output stream.
+ * The buffers are reused for all blocks so that the memory consumption only
+ * depends on the block size and the number of threads, not on the mesh size.
+ */
+class MeshBlockWriter
+{
+public:
+    MeshBlockWriter(std::ostream& out, std::size_t blockSize = 16384)
+        : out(out)
+        , blockSize(blockSize)
+        , buffers(static_cast<std::size_t>(std::max(1, QThread::idealThreadCount())))
+    {
+    }
+    /// Returns the number of blocks needed to write \a count elements.
+    std::size_t countBlocks(std::size_t count) const
+    {
+        return (count + blockSize - 1) / blockSize;
+    }
+    /**
+     * Calls \a encode(begin, end, buffer) for all blocks of the range [0, count)
+     * and writes the buffers to the stream. After each written block the sequencer
+     * advances by one step.
+     */
+    template <class Func>
+    bool write(std::size_t count, Func encode, Base::SequencerLauncher& seq)
+    {
+        std::vector<Block> blocks;
+        blocks.reserve(buffers.size());
+        std::size_t begin = 0;
+        while (begin < count) {
+            blocks.clear();
+            for (std::size_t i = 0; i < buffers.size() && begin < count; i++) {
+                Block block;
+                block.begin = begin;
+                block.end = std::min(begin + blockSize, count);
+                block.buffer = &buffers[i];
+                blocks.push_back(block);
+                begin = block.end;
+            }
+
+            auto func = [&encode](Block& block) {
+                block.buffer->clear();
+                encode(block.begin, block.end, *block.buffer);
+            };
+            if (blocks.size() > 1)
+                QtConcurrent::blockingMap(blocks, func);
+            else
+                func(blocks.front());
+
+            for (std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+                out.write(it->buffer->data(), static_cast<std::streamsize>(it->buffer->size()));
+                seq.next(true); // allow to cancel
+            }
+
+            if (!out)
+                return false;
+        }
+
+        return true;
+    }
+
+private:
+    struct Block {
+        std::size_t begin;
+        std::size_t end;
+        std::string* buffer;
+    };
+
+    std::ostream& out;
+    std::size_t blockSize;
+    std::vector<std::string> buffers;
+};
+
 }
 
 // --------------------------------------------------------------
@@ -170,7 +361,9 @@ bool MeshInput::LoadAny(const char* FileName)
         // read file
         bool ok = false;
         if (fi.hasExtension("stl") || fi.hasExtension("ast")) {
-            ok = LoadSTL(str);
+            // binary data of a mapped file is decoded in parallel
+            MeshMappedFile mapped(fi);
+            ok = mapped.isMapped() ? LoadSTL(mapped.stream()) : LoadSTL(str);
         }
         else if (fi.hasExtension("iv")) {
             ok = LoadInventor( str );
@@ -190,7 +383,8 @@ bool MeshInput::LoadAny(const char* FileName)
             ok = LoadOFF( str );
         }
         else if (fi.hasExtension("ply")) {
-            ok = LoadPLY( str );
+            MeshMappedFile mapped(fi);
+            ok = mapped.isMapped() ? LoadPLY(mapped.stream()) : LoadPLY(str);
         }
         else {
             throw Base::FileException("File extension not supported",FileName);
@@ -797,6 +991,157 @@ namespace MeshCore {
                 return x.first == y;
             }
         };
+
+        inline std::size_t sizeOf(Number number)
+        {
+            switch (number) {
+            case int8:
+            case uint8:
+                return 1;
+            case int16:
+            case uint16:
+                return 2;
+            case int32:
+            case uint32:
+            case float32:
+                return 4;
+            case float64:
+                return 8;
+            }
+            return 0;
+        }
+
+        template <typename T>
+        inline T readValue(const char* data, bool swap)
+        {
+            T v;
+            std::memcpy(&v, data, sizeof(T));
+            if (swap)
+                Base::SwapEndian(v);
+            return v;
+        }
+
+        inline float readNumber(const char* data, Number number, bool swap)
+        {
+            switch (number) {
+            case int8:
+                return static_cast<float>(readValue<int8_t>(data, swap));
+            case uint8:
+                return static_cast<float>(readValue<uint8_t>(data, swap));
+            case int16:
+                return static_cast<float>(readValue<int16_t>(data, swap));
+            case uint16:
+                return static_cast<float>(readValue<uint16_t>(data, swap));
+            case int32:
+                return static_cast<float>(readValue<int32_t>(data, swap));
+            case uint32:
+                return static_cast<float>(readValue<uint32_t>(data, swap));
+            case float32:
+                return readValue<float>(data, swap);
+            case float64:
+                return static_cast<float>(readValue<double>(data, swap));
+            }
+            return 0.0f;
+        }
+
+        /**
+         * Decodes the binary data section of a memory-mapped PLY file in parallel.
+         * This requires records of fixed size, i.e. all faces must be triangles and
+         * must not have properties other than integers. Otherwise Read() returns false
+         * and the data must be read sequentially.
+         */
+        class MappedReader
+        {
+        public:
+            MappedReader(const std::vector<std::pair<std::string, Number> >& vertex_props,
+                         const std::vector<Number>& face_props, bool swap)
+                : swap(swap), vertex_size(0), face_size(1 + 3 * sizeof(uint32_t)), fixed_faces(true)
+            {
+                for (std::vector<std::pair<std::string, Number> >::const_iterator it =
+                    vertex_props.begin(); it != vertex_props.end(); ++it) {
+                    // like the sequential reader the last property of a name wins
+                    offsets[it->first] = std::make_pair(vertex_size, it->second);
+                    vertex_size += sizeOf(it->second);
+                }
+                for (std::vector<Number>::const_iterator it = face_props.begin(); it != face_props.end(); ++it) {
+                    if (*it == float32 || *it == float64)
+                        fixed_faces = false;
+                    face_size += sizeOf(*it);
+                }
+            }
+
+            bool Read(const char* data, std::size_t size, std::size_t v_count, std::size_t f_count,
+                      MeshPointArray& points, MeshFacetArray& facets, std::vector<App::Color>* colors) const
+            {
+                if (!fixed_faces || size < v_count * vertex_size + f_count * face_size)
+                    return false;
+
+                // all faces must be triangles
+                const char* face_data = data + v_count * vertex_size;
+                std::size_t face_size = this->face_size;
+                int threads = std::max(1, QThread::idealThreadCount());
+                std::vector<char> triangles(f_count, 1);
+                char* is_triangle = triangles.data();
+                MeshCore::parallel_blocks(f_count, [face_data, face_size, is_triangle](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; i++)
+                        is_triangle[i] = (static_cast<unsigned char>(face_data[i * face_size]) == 3);
+                }, threads);
+                if (std::find(triangles.begin(), triangles.end(), 0) != triangles.end())
+                    return false;
+
+                std::pair<std::size_t, Number> x = offsets.find("x")->second;
+                std::pair<std::size_t, Number> y = offsets.find("y")->second;
+                std::pair<std::size_t, Number> z = offsets.find("z")->second;
+                std::size_t vertex_size = this->vertex_size;
+                bool swap = this->swap;
+
+                points.resize(v_count);
+                MeshCore::parallel_blocks(v_count, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; i++) {
+                        const char* record = data + i * vertex_size;
+                        points[i].Set(readNumber(record + x.first, x.second, swap),
+                                      readNumber(record + y.first, y.second, swap),
+                                      readNumber(record + z.first, z.second, swap));
+                    }
+                }, threads);
+
+                if (colors) {
+                    std::pair<std::size_t, Number> r = offsets.find("red")->second;
+                    std::pair<std::size_t, Number> g = offsets.find("green")->second;
+                    std::pair<std::size_t, Number> b = offsets.find("blue")->second;
+                    colors->resize(v_count);
+                    App::Color* color = colors->data();
+                    MeshCore::parallel_blocks(v_count, [&](std::size_t begin, std::size_t end) {
+                        for (std::size_t i = begin; i < end; i++) {
+                            const char* record = data + i * vertex_size;
+                            color[i].set(readNumber(record + r.first, r.second, swap) / 255.0f,
+                                         readNumber(record + g.first, g.second, swap) / 255.0f,
+                                         readNumber(record + b.first, b.second, swap) / 255.0f);
+                        }
+                    }, threads);
+                }
+
+                // indices out of range are removed afterwards by MeshCleanup
+                facets.resize(f_count);
+                MeshCore::parallel_blocks(f_count, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; i++) {
+                        const char* record = face_data + i * face_size + 1;
+                        facets[i]._aulPoints[0] = readValue<uint32_t>(record, swap);
+                        facets[i]._aulPoints[1] = readValue<uint32_t>(record + 4, swap);
+                        facets[i]._aulPoints[2] = readValue<uint32_t>(record + 8, swap);
+                    }
+                }, threads);
+
+                return true;
+            }
+
+        private:
+            bool swap;
+            std::size_t vertex_size;
+            std::size_t face_size;
+            bool fixed_faces;
+            std::map<std::string, std::pair<std::size_t, Number> > offsets;
+        };
     }
     using namespace Ply;
 }
@@ -1037,6 +1382,18 @@ bool MeshInput::LoadPLY (std::istream &inp)
         }
     }
 
+    // the binary data of a memory-mapped file can be decoded in parallel
+    bool mapped = false;
+    Base::MemoryIStreambuf* mem = dynamic_cast<Base::MemoryIStreambuf*>(buf);
+    if (mem && format != ascii) {
+        Ply::MappedReader reader(vertex_props, face_props, format == binary_big_endian);
+        std::vector<App::Color>* colors = 0;
+        if (_material && rgb_value == MeshIO::PER_VERTEX)
+            colors = &_material->diffuseColor;
+        mapped = reader.Read(mem->data() + mem->position(), mem->size() - mem->position(),
+                             v_count, f_count, meshPoints, meshFacets, colors);
+    }
+
     if (format == ascii) {
         boost::regex rx_d("(([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?))\\s*");
         boost::regex rx_s("\\b([-+]?[0-9]+)\\s*");
@@ -1119,8 +1476,8 @@ bool MeshInput::LoadPLY (std::istream &inp)
             }
         }
     }
-    // binary
-    else {
+    // binary, unless already decoded from the memory-mapped file
+    else if (!mapped) {
         Base::InputStream is(inp);
         if (format == binary_little_endian)
             is.setByteOrder(Base::Stream::LittleEndian);
@@ -1432,6 +1789,16 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
 #endif
     builder.Initialize(ulCt);
 
+    // The records of a memory-mapped file can be decoded directly: each record
+    // has the normal, the three points and a 2-byte attribute.
+    Base::MemoryIStreambuf* mem = dynamic_cast<Base::MemoryIStreambuf*>(buf);
+    if (mem) {
+        const char* data = mem->data() + mem->position();
+        builder.AddFacets(data + sizeof(Base::Vector3f), ulCt, 50);
+        builder.Finish();
+        return true;
+    }
+
     for (uint32_t i = 0; i < ulCt; i++) {
         // read normal, points
         rstrIn.read((char*)&clVects, sizeof(clVects));
@@ -2067,47 +2434,42 @@ bool MeshOutput::SaveFormat(std::ostream &str, MeshIO::Format fmt) const
 /** Saves the mesh object into an ASCII file. */
 bool MeshOutput::SaveAsciiSTL (std::ostream &rstrOut) const
 {
-    MeshFacetIterator clIter(_rclMesh), clEnd(_rclMesh);
-    clIter.Transform(this->_transform);
-    const MeshGeomFacet *pclFacet;
-    unsigned long i;
-
     if (!rstrOut || rstrOut.bad() == true || _rclMesh.CountFacets() == 0)
         return false;
 
-    rstrOut.precision(6);
-    rstrOut.setf(std::ios::fixed | std::ios::showpoint);
-    Base::SequencerLauncher seq("saving...", _rclMesh.CountFacets() + 1);
+    MeshBlockWriter writer(rstrOut);
+    std::size_t ctFacets = _rclMesh.CountFacets();
+    Base::SequencerLauncher seq("saving...", writer.countBlocks(ctFacets) + 1);
 
     if (this->objectName.empty())
         rstrOut << "solid Mesh\n";
     else
         rstrOut << "solid " << this->objectName << '\n';
 
-    clIter.Begin();
-    clEnd.End();
-    while (clIter < clEnd) {
-        pclFacet = &(*clIter);
-
-        // normal
-        rstrOut << "  facet normal " << pclFacet->GetNormal().x << " "
-                                     << pclFacet->GetNormal().y << " "
-                                     << pclFacet->GetNormal().z << '\n';
-        rstrOut << "    outer loop\n";
+    const MeshKernel& kernel = _rclMesh;
+    const Base::Matrix4D& mat = this->_transform;
+    bool transform = this->apply_transform;
+    writer.write(ctFacets, [&kernel, &mat, transform](std::size_t begin, std::size_t end, std::string& str) {
+        for (std::size_t i = begin; i < end; i++) {
+            MeshGeomFacet facet = kernel.GetFacet(static_cast<unsigned long>(i));
+            if (transform)
+                facet.Transform(mat);
+
+            // normal
+            str.append("  facet normal ");
+            appendVector(str, facet.GetNormal());
+            str.append("\n    outer loop\n");
+
+            // vertices
+            for (int j = 0; j < 3; j++) {
+                str.append("      vertex ");
+                appendVector(str, facet._aclPoints[j]);
+                str.push_back('\n');
+            }
 
-        // vertices
-        for (i = 0; i < 3; i++) {
-            rstrOut << "      vertex "  << pclFacet->_aclPoints[i].x << " "
-                                        << pclFacet->_aclPoints[i].y << " "
-                                        << pclFacet->_aclPoints[i].z << '\n';
+            str.append("    endloop\n  endfacet\n");
         }
-
-        rstrOut << "    endloop\n";
-        rstrOut << "  endfacet\n";
-
-        ++clIter;
-        seq.next(true);// allow to cancel
-    }
+    }, seq);
 
     rstrOut << "endsolid Mesh\n";
 
@@ -2117,51 +2479,52 @@ bool MeshOutput::SaveAsciiSTL (std::ostream &rstrOut) const
 /** Saves the mesh object into a binary file. */
 bool MeshOutput::SaveBinarySTL (std::ostream &rstrOut) const
 {
-    MeshFacetIterator clIter(_rclMesh), clEnd(_rclMesh);
-    clIter.Transform(this->_transform);
-    const MeshGeomFacet *pclFacet;
-    uint32_t i;
-    uint16_t usAtt;
     char szInfo[81];
 
     if (!rstrOut || rstrOut.bad() == true /*|| _rclMesh.CountFacets() == 0*/)
         return false;
 
-    Base::SequencerLauncher seq("saving...", _rclMesh.CountFacets() + 1);
+    MeshBlockWriter writer(rstrOut);
+    std::size_t ctFacets = _rclMesh.CountFacets();
+    Base::SequencerLauncher seq("saving...", writer.countBlocks(ctFacets) + 1);
 
     // stl_header has a length of 80
     strcpy(szInfo, stl_header.c_str());
     rstrOut.write(szInfo, std::strlen(szInfo));
 
-    uint32_t uCtFts = (uint32_t)_rclMesh.CountFacets();
+    uint32_t uCtFts = (uint32_t)ctFacets;
     rstrOut.write((const char*)&uCtFts, sizeof(uCtFts));
 
-    usAtt = 0;
-    clIter.Begin();
-    clEnd.End();
-    while (clIter < clEnd) {
-        pclFacet = &(*clIter);
-        // normal
-        Base::Vector3f normal = pclFacet->GetNormal();
-        rstrOut.write((const char*)&(normal.x), sizeof(float));
-        rstrOut.write((const char*)&(normal.y), sizeof(float));
-        rstrOut.write((const char*)&(normal.z), sizeof(float));
+    // a record consists of normal, vertices and attribute
+    const std::size_t recordSize = 12 * sizeof(float) + sizeof(uint16_t);
+    const MeshKernel& kernel = _rclMesh;
+    const Base::Matrix4D& mat = this->_transform;
+    bool transform = this->apply_transform;
+    return writer.write(ctFacets, [&kernel, &mat, transform, recordSize](std::size_t begin, std::size_t end, std::string& str) {
+        str.resize((end - begin) * recordSize);
+        char* data = &str[0];
+        float pnt[12];
+        uint16_t usAtt = 0;
+        for (std::size_t i = begin; i < end; i++) {
+            MeshGeomFacet facet = kernel.GetFacet(static_cast<unsigned long>(i));
+            if (transform)
+                facet.Transform(mat);
+
+            Base::Vector3f normal = facet.GetNormal();
+            pnt[0] = normal.x;
+            pnt[1] = normal.y;
+            pnt[2] = normal.z;
+            for (int j = 0; j < 3; j++) {
+                pnt[3*j+3] = facet._aclPoints[j].x;
+                pnt[3*j+4] = facet._aclPoints[j].y;
+                pnt[3*j+5] = facet._aclPoints[j].z;
+            }
 
-        // vertices
-        for (i = 0; i < 3; i++) {
-            rstrOut.write((const char*)&(pclFacet->_aclPoints[i].x), sizeof(float));
-            rstrOut.write((const char*)&(pclFacet->_aclPoints[i].y), sizeof(float));
-            rstrOut.write((const char*)&(pclFacet->_aclPoints[i].z), sizeof(float));
+            std::memcpy(data, pnt, sizeof(pnt));
+            std::memcpy(data + sizeof(pnt), &usAtt, sizeof(usAtt));
+            data += recordSize;
         }
-
-        // attribute
-        rstrOut.write((const char*)&usAtt, sizeof(usAtt));
-
-        ++clIter;
-        seq.next(true); // allow to cancel
-    }
-
-    return true;
+    }, seq);
 }
 
 /** Saves an OBJ file. */
@@ -2173,7 +2536,6 @@ bool MeshOutput::SaveOBJ (std::ostream &out) const
     if (!out || out.bad() == true)
         return false;
 
-    Base::SequencerLauncher seq("saving...", _rclMesh.CountPoints() + _rclMesh.CountFacets());
     bool exportColorPerVertex = false;
     bool exportColorPerFace = false;
 
@@ -2204,6 +2566,13 @@ bool MeshOutput::SaveOBJ (std::ostream &out) const
         }
     }
 
+    // facets with groups or colors are written sequentially, everything else in blocks
+    MeshBlockWriter writer(out);
+    bool blockFacets = _groups.empty() && !exportColorPerFace;
+    std::size_t steps = writer.countBlocks(rPoints.size()) + writer.countBlocks(rFacets.size());
+    steps += blockFacets ? writer.countBlocks(rFacets.size()) : rFacets.size();
+    Base::SequencerLauncher seq("saving...", steps);
+
     // Header
     out << "# Created by FreeCAD <http://www.freecadweb.org>\n";
     if (exportColorPerFace) {
@@ -2214,51 +2583,51 @@ bool MeshOutput::SaveOBJ (std::ostream &out) const
     out.setf(std::ios::fixed | std::ios::showpoint);
 
     // vertices
-    Base::Vector3f pt;
-    std::size_t index = 0;
-    for (MeshPointArray::_TConstIterator it = rPoints.begin(); it != rPoints.end(); ++it, ++index) {
-        if (this->apply_transform) {
-            pt = this->_transform * *it;
-        }
-        else {
-            pt.Set(it->x, it->y, it->z);
-        }
-
-        if (exportColorPerVertex) {
-            App::Color c;
-            if (_material->binding == MeshIO::PER_VERTEX) {
-                c = _material->diffuseColor[index];
+    const Base::Matrix4D& mat = this->_transform;
+    bool transform = this->apply_transform;
+    const Material* material = exportColorPerVertex ? _material : 0;
+    writer.write(rPoints.size(), [&rPoints, &mat, transform, material](std::size_t begin, std::size_t end, std::string& str) {
+        Base::Vector3f pt;
+        for (std::size_t index = begin; index < end; index++) {
+            const MeshPoint& p = rPoints[index];
+            if (transform) {
+                pt = mat * p;
             }
             else {
-                c = _material->diffuseColor.front();
+                pt.Set(p.x, p.y, p.z);
             }
 
-            int r = static_cast<int>(c.r * 255.0f);
-            int g = static_cast<int>(c.g * 255.0f);
-            int b = static_cast<int>(c.b * 255.0f);
+            str.append("v ");
+            appendVector(str, pt);
+            if (material) {
+                App::Color c;
+                if (material->binding == MeshIO::PER_VERTEX) {
+                    c = material->diffuseColor[index];
+                }
+                else {
+                    c = material->diffuseColor.front();
+                }
 
-            out << "v " << pt.x << " " << pt.y << " " << pt.z << " " << r << " " << g << " " << b << '\n';
-        }
-        else {
-            out << "v " << pt.x << " " << pt.y << " " << pt.z << '\n';
+                str.push_back(' ');
+                appendInt(str, static_cast<uint64_t>(c.r * 255.0f));
+                str.push_back(' ');
+                appendInt(str, static_cast<uint64_t>(c.g * 255.0f));
+                str.push_back(' ');
+                appendInt(str, static_cast<uint64_t>(c.b * 255.0f));
+            }
+            str.push_back('\n');
         }
-        seq.next(true); // allow to cancel
-    }
-    // Export normals
-    MeshFacetIterator clIter(_rclMesh), clEnd(_rclMesh);
-    const MeshGeomFacet* pclFacet;
-
-    clIter.Begin();
-    clEnd.End();
+    }, seq);
 
-    while (clIter < clEnd) {
-        pclFacet = &(*clIter);
-        out << "vn " << pclFacet->GetNormal().x << " "
-            << pclFacet->GetNormal().y << " "
-            << pclFacet->GetNormal().z << '\n';
-        ++clIter;
-        seq.next(true); // allow to cancel
-    }
+    // Export normals
+    const MeshKernel& kernel = _rclMesh;
+    writer.write(rFacets.size(), [&kernel](std::size_t begin, std::size_t end, std::string& str) {
+        for (std::size_t index = begin; index < end; index++) {
+            str.append("vn ");
+            appendVector(str, kernel.GetFacet(static_cast<unsigned long>(index)).GetNormal());
+            str.push_back('\n');
+        }
+    }, seq);
 
     if (_groups.empty()) {
         if (exportColorPerFace) {
@@ -2290,14 +2659,19 @@ bool MeshOutput::SaveOBJ (std::ostream &out) const
         }
         else {
             // facet indices (no texture and normal indices)
-            std::size_t faceIdx = 1;
-            for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
-                out << "f " << it->_aulPoints[0]+1 << "//" << faceIdx << " "
-                            << it->_aulPoints[1]+1 << "//" << faceIdx << " "
-                            << it->_aulPoints[2]+1 << "//" << faceIdx << '\n';
-                seq.next(true); // allow to cancel
-                faceIdx++;
-            }
+            writer.write(rFacets.size(), [&rFacets](std::size_t begin, std::size_t end, std::string& str) {
+                for (std::size_t index = begin; index < end; index++) {
+                    const MeshFacet& face = rFacets[index];
+                    str.push_back('f');
+                    for (int i = 0; i < 3; i++) {
+                        str.push_back(' ');
+                        appendInt(str, face._aulPoints[i] + 1);
+                        str.append("//");
+                        appendInt(str, index + 1);
+                    }
+                    str.push_back('\n');
+                }
+            }, seq);
         }
     }
     else {
@@ -2645,38 +3019,39 @@ bool MeshOutput::SaveBinaryPLY (std::ostream &out) const
         << "property list uchar int vertex_index\n"
         << "end_header\n";
 
-    Base::OutputStream os(out);
-    os.setByteOrder(Base::Stream::LittleEndian);
-
-    for (std::size_t i = 0; i < v_count; i++) {
-        const MeshPoint& p = rPoints[i];
-        if (this->apply_transform) {
-            Base::Vector3f pt = this->_transform * p;
-            os << pt.x << pt.y << pt.z;
-        }
-        else {
-            os << p.x << p.y << p.z;
-        }
-        if (saveVertexColor) {
-            const App::Color& c = _material->diffuseColor[i];
-            uint8_t r = uint8_t(255.0f * c.r);
-            uint8_t g = uint8_t(255.0f * c.g);
-            uint8_t b = uint8_t(255.0f * c.b);
-            os << r << g << b;
+    MeshBlockWriter writer(out);
+    Base::SequencerLauncher seq("saving...", writer.countBlocks(v_count) + writer.countBlocks(f_count));
+    bool swap = (Base::SwapOrder() != LOW_ENDIAN);
+    const Base::Matrix4D& mat = this->_transform;
+    bool transform = this->apply_transform;
+    const Material* material = saveVertexColor ? _material : 0;
+
+    writer.write(v_count, [&rPoints, &mat, transform, material, swap](std::size_t begin, std::size_t end, std::string& str) {
+        for (std::size_t i = begin; i < end; i++) {
+            Base::Vector3f pt = rPoints[i];
+            if (transform)
+                pt = mat * pt;
+            appendBinary(str, pt.x, swap);
+            appendBinary(str, pt.y, swap);
+            appendBinary(str, pt.z, swap);
+            if (material) {
+                const App::Color& c = material->diffuseColor[i];
+                str.push_back(static_cast<char>(uint8_t(255.0f * c.r)));
+                str.push_back(static_cast<char>(uint8_t(255.0f * c.g)));
+                str.push_back(static_cast<char>(uint8_t(255.0f * c.b)));
+            }
         }
-    }
-    unsigned char n = 3;
-    int f1, f2, f3;
-    for (std::size_t i = 0; i < f_count; i++) {
-        const MeshFacet& f = rFacets[i];
-        f1 = (int)f._aulPoints[0];
-        f2 = (int)f._aulPoints[1];
-        f3 = (int)f._aulPoints[2];
-        os << n;
-        os << f1 << f2 << f3;
-    }
+    }, seq);
 
-    return true;
+    return writer.write(f_count, [&rFacets, swap](std::size_t begin, std::size_t end, std::string& str) {
+        for (std::size_t i = begin; i < end; i++) {
+            const MeshFacet& f = rFacets[i];
+            str.push_back(3);
+            appendBinary(str, static_cast<int32_t>(f._aulPoints[0]), swap);
+            appendBinary(str, static_cast<int32_t>(f._aulPoints[1]), swap);
+            appendBinary(str, static_cast<int32_t>(f._aulPoints[2]), swap);
+        }
+    }, seq);
 }
 
 bool MeshOutput::SaveAsciiPLY (std::ostream &out) const
@@ -2706,50 +3081,43 @@ bool MeshOutput::SaveAsciiPLY (std::ostream &out) const
         << "property list uchar int vertex_index\n"
         << "end_header\n";
 
-    out.precision(6);
-    out.setf(std::ios::fixed | std::ios::showpoint);
-    if (saveVertexColor) {
-        for (std::size_t i = 0; i < v_count; i++) {
-            const MeshPoint& p = rPoints[i];
-            if (this->apply_transform) {
-                Base::Vector3f pt = this->_transform * p;
-                out << pt.x << " " << pt.y << " " << pt.z;
-            }
-            else {
-                out << p.x << " " << p.y << " " << p.z;
+    MeshBlockWriter writer(out);
+    Base::SequencerLauncher seq("saving...", writer.countBlocks(v_count) + writer.countBlocks(f_count));
+    const Base::Matrix4D& mat = this->_transform;
+    bool transform = this->apply_transform;
+    const Material* material = saveVertexColor ? _material : 0;
+
+    writer.write(v_count, [&rPoints, &mat, transform, material](std::size_t begin, std::size_t end, std::string& str) {
+        for (std::size_t i = begin; i < end; i++) {
+            Base::Vector3f pt = rPoints[i];
+            if (transform)
+                pt = mat * pt;
+            appendVector(str, pt);
+            if (material) {
+                const App::Color& c = material->diffuseColor[i];
+                str.push_back(' ');
+                appendInt(str, static_cast<uint64_t>(255.0f * c.r));
+                str.push_back(' ');
+                appendInt(str, static_cast<uint64_t>(255.0f * c.g));
+                str.push_back(' ');
+                appendInt(str, static_cast<uint64_t>(255.0f * c.b));
             }
-
-            const App::Color& c = _material->diffuseColor[i];
-            int r = (int)(255.0f * c.r);
-            int g = (int)(255.0f * c.g);
-            int b = (int)(255.0f * c.b);
-            out << " " << r << " " << g << " " << b << '\n';
-        }
-    }
-    else {
-        for (std::size_t i = 0; i < v_count; i++) {
-            const MeshPoint& p = rPoints[i];
-            if (this->apply_transform) {
-                Base::Vector3f pt = this->_transform * p;
-                out << pt.x << " " << pt.y << " " << pt.z << '\n';
-            }
-            else {
-                out << p.x << " " << p.y << " " << p.z << '\n';
-            }
-        }
-    }
-
-    unsigned int n = 3;
-    int f1, f2, f3;
-    for (std::size_t i = 0; i < f_count; i++) {
-        const MeshFacet& f = rFacets[i];
-        f1 = (int)f._aulPoints[0];
-        f2 = (int)f._aulPoints[1];
-        f3 = (int)f._aulPoints[2];
-        out << n << " " << f1 << " " << f2 << " " << f3 << '\n';
-    }
-
-    return true;
+            str.push_back('\n');
+        }
+    }, seq);
+
+    return writer.write(f_count, [&rFacets](std::size_t begin, std::size_t end, std::string& str) {
+        for (std::size_t i = begin; i < end; i++) {
+            const MeshFacet& f = rFacets[i];
+            str.append("3 ");
+            appendInt(str, f._aulPoints[0]);
+            str.push_back(' ');
+            appendInt(str, f._aulPoints[1]);
+            str.push_back(' ');
+            appendInt(str, f._aulPoints[2]);
+            str.push_back('\n');
+        }
+    }, seq);
 }
 
 bool MeshOutput::SaveMeshNode (std::ostream &rstrOut)
@@ -25,6 +25,7 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <iterator>
 # include <stdexcept>
 # include <map>
 # include <queue>
@@ -48,18 +49,20 @@
 using namespace MeshCore;
 
 MeshKernel::MeshKernel (void)
-: _bValid(true)
+: _bValid(true), _ulTopologyVersion(0), _ulGeometryVersion(0)
 {
     _clBoundBox.SetVoid();
 }
 
 MeshKernel::MeshKernel (const MeshKernel &rclMesh)
+: _ulTopologyVersion(0), _ulGeometryVersion(0)
 {
     *this = rclMesh;
 }
 
 MeshKernel& MeshKernel::operator = (const MeshKernel &rclMesh)
 {
+    InvalidateTopology();
     if (this != &rclMesh) { // must be a different instance
         this->_aclPointArray  = rclMesh._aclPointArray;
         this->_aclFacetArray  = rclMesh._aclFacetArray;
@@ -84,6 +87,7 @@ MeshKernel& MeshKernel::operator = (const std::vector<MeshGeomFacet> &rclFAry)
 
 void MeshKernel::Assign(const MeshPointArray& rPoints, const MeshFacetArray& rFacets, bool checkNeighbourHood)
 {
+    InvalidateTopology();
     _aclPointArray = rPoints;
     _aclFacetArray = rFacets;
     RecalcBoundBox();
@@ -93,6 +97,7 @@ void MeshKernel::Assign(const MeshPointArray& rPoints, const MeshFacetArray& rFa
 
 void MeshKernel::Adopt(MeshPointArray& rPoints, MeshFacetArray& rFacets, bool checkNeighbourHood)
 {
+    InvalidateTopology();
     _aclPointArray.swap(rPoints);
     _aclFacetArray.swap(rFacets);
     RecalcBoundBox();
@@ -102,6 +107,8 @@ void MeshKernel::Adopt(MeshPointArray& rPoints, MeshFacetArray& rFacets, bool ch
 
 void MeshKernel::Swap(MeshKernel& mesh)
 {
+    this->InvalidateTopology();
+    mesh.InvalidateTopology();
     this->_aclPointArray.swap(mesh._aclPointArray);
     this->_aclFacetArray.swap(mesh._aclFacetArray);
     this->_clBoundBox = mesh._clBoundBox;
@@ -115,6 +122,7 @@ MeshKernel& MeshKernel::operator += (const MeshGeomFacet &rclSFacet)
 
 void MeshKernel::AddFacet(const MeshGeomFacet &rclSFacet)
 {
+    InvalidateTopology();
     unsigned long i;
     MeshFacet clFacet;
 
@@ -176,6 +184,7 @@ void MeshKernel::AddFacets(const std::vector<MeshGeomFacet> &rclFAry)
 unsigned long MeshKernel::AddFacets(const std::vector<MeshFacet> &rclFAry,
                                     bool checkManifolds)
 {
+    InvalidateTopology();
     // Build map of edges of the referencing facets we want to append
 #ifdef FC_DEBUG
     unsigned long countPoints = CountPoints();
@@ -339,6 +348,7 @@ unsigned long MeshKernel::AddFacets(const std::vector<MeshFacet> &rclFAry,
                                     const std::vector<Base::Vector3f>& rclPAry,
                                     bool checkManifolds)
 {
+    InvalidateTopology();
     for (std::vector<Base::Vector3f>::const_iterator it = rclPAry.begin(); it != rclPAry.end(); ++it)
         _clBoundBox.Add(*it);
     this->_aclPointArray.insert(this->_aclPointArray.end(), rclPAry.begin(), rclPAry.end());
@@ -356,6 +366,7 @@ void MeshKernel::Merge(const MeshKernel& rKernel)
 
 void MeshKernel::Merge(const MeshPointArray& rPoints, const MeshFacetArray& rFaces)
 {
+    InvalidateTopology();
     if (rPoints.empty() || rFaces.empty())
         return; // nothing to do
     std::vector<unsigned long> increments(rPoints.size());
@@ -410,12 +421,14 @@ void MeshKernel::Merge(const MeshPointArray& rPoints, const MeshFacetArray& rFac
 
 void MeshKernel::Cleanup()
 {
+    InvalidateTopology();
     MeshCleanup meshCleanup(_aclPointArray, _aclFacetArray);
     meshCleanup.RemoveInvalids();
 }
 
 void MeshKernel::Clear (void)
 {
+    InvalidateTopology();
     _aclPointArray.clear();
     _aclFacetArray.clear();
 
@@ -428,6 +441,7 @@ void MeshKernel::Clear (void)
 
 bool MeshKernel::DeleteFacet (const MeshFacetIterator &rclIter)
 {
+    InvalidateTopology();
     unsigned long i, j, ulNFacet, ulInd;
 
     if (rclIter._clIter >= _aclFacetArray.end())
@@ -477,6 +491,7 @@ bool MeshKernel::DeleteFacet (unsigned long ulInd)
 
 void MeshKernel::DeleteFacets (const std::vector<unsigned long> &raulFacets)
 {
+    InvalidateTopology();
     _aclPointArray.SetProperty(0);
 
     // number of referencing facets per point
@@ -520,6 +535,7 @@ bool MeshKernel::DeletePoint (unsigned long ulInd)
 
 bool MeshKernel::DeletePoint (const MeshPointIterator &rclIter)
 {
+    InvalidateTopology();
     MeshFacetIterator pFIter(*this), pFEnd(*this);
     std::vector<MeshFacetIterator>  clToDel; 
     unsigned long ulInd;
@@ -551,6 +567,7 @@ bool MeshKernel::DeletePoint (const MeshPointIterator &rclIter)
 
 void MeshKernel::DeletePoints (const std::vector<unsigned long> &raulPoints)
 {
+    InvalidateTopology();
     _aclPointArray.ResetInvalid();
     for (std::vector<unsigned long>::const_iterator pI = raulPoints.begin(); pI != raulPoints.end(); ++pI)
         _aclPointArray[*pI].SetInvalid();
@@ -631,6 +648,7 @@ void MeshKernel::ErasePoint (unsigned long ulIndex, unsigned long ulFacetIndex,
 
 void MeshKernel::RemoveInvalids ()
 {
+    InvalidateTopology();
     std::vector<unsigned long> aulDecrements;
     std::vector<unsigned long>::iterator pDIter;
     unsigned long ulDec, i, k;
@@ -782,23 +800,54 @@ std::vector<unsigned long> MeshKernel::GetPointFacets(const std::vector<unsigned
 
 std::vector<unsigned long> MeshKernel::HasFacets (const MeshPointIterator &rclIter) const
 {
-    unsigned long i, ulPtInd = rclIter.Position();
-    std::vector<MeshFacet>::const_iterator  pFIter = _aclFacetArray.begin();
-    std::vector<MeshFacet>::const_iterator  pFBegin = _aclFacetArray.begin();
-    std::vector<MeshFacet>::const_iterator  pFEnd = _aclFacetArray.end();
-    std::vector<unsigned long> aulBelongs;
+    const MeshIndexRows& rPointFacets = GetPointToFacets();
+    unsigned long ulPtInd = rclIter.Position();
+    return std::vector<unsigned long>(rPointFacets.Begin(ulPtInd), rPointFacets.End(ulPtInd));
+}
 
-      while (pFIter < pFEnd) {
-        for (i = 0; i < 3; i++) {
-            if (pFIter->_aulPoints[i] == ulPtInd) {
-                aulBelongs.push_back(pFIter - pFBegin);
-                break;
-            }
-        }
-        ++pFIter;
+const MeshIndexRows& MeshKernel::GetPointToFacets (void) const
+{
+    _clAdjacency.Acquire(*this, _ulTopologyVersion);
+    return _clAdjacency.PointToFacets();
+}
+
+const MeshIndexRows& MeshKernel::GetPointToPoints (void) const
+{
+    _clAdjacency.Acquire(*this, _ulTopologyVersion);
+    return _clAdjacency.PointToPoints();
+}
+
+void MeshKernel::GetFacetToFacets (unsigned long ulFacet, std::vector<unsigned long>& raulFacets) const
+{
+    const MeshIndexRows& rPointFacets = GetPointToFacets();
+    const MeshFacet& rFacet = _aclFacetArray[ulFacet];
+
+    raulFacets.clear();
+    for (int i = 0; i < 3; i++) {
+        unsigned long ulPt = rFacet._aulPoints[i];
+        raulFacets.insert(raulFacets.end(), rPointFacets.Begin(ulPt), rPointFacets.End(ulPt));
     }
 
-    return aulBelongs;
+    std::sort(raulFacets.begin(), raulFacets.end());
+    raulFacets.erase(std::unique(raulFacets.begin(), raulFacets.end()), raulFacets.end());
+    raulFacets.erase(std::remove(raulFacets.begin(), raulFacets.end(), ulFacet), raulFacets.end());
+}
+
+void MeshKernel::GetEdgeToFacets (unsigned long ulPt0, unsigned long ulPt1, std::vector<unsigned long>& raulFacets) const
+{
+    const MeshIndexRows& rPointFacets = GetPointToFacets();
+
+    raulFacets.clear();
+    std::set_intersection(rPointFacets.Begin(ulPt0), rPointFacets.End(ulPt0),
+                          rPointFacets.Begin(ulPt1), rPointFacets.End(ulPt1),
+                          std::back_inserter(raulFacets));
+}
+
+void MeshKernel::UpdateTopology (const std::vector<std::pair<unsigned long, MeshFacet> >& raclOld)
+{
+    unsigned long ulOldVersion = _ulTopologyVersion++;
+    _ulGeometryVersion++;
+    _clAdjacency.Update(*this, raclOld, ulOldVersion, _ulTopologyVersion);
 }
 
 MeshPointArray MeshKernel::GetPoints(const std::vector<unsigned long>& indices) const
@@ -861,6 +910,7 @@ void MeshKernel::Write (std::ostream &rclOut) const
 
 void MeshKernel::Read (std::istream &rclIn)
 {
+    InvalidateTopology();
     if (!rclIn || rclIn.bad())
         return;
 
@@ -1041,6 +1091,7 @@ void MeshKernel::Transform (const Base::Matrix4D &rclMat)
     MeshPointArray::_TIterator  clPIter = _aclPointArray.begin(), clPEIter = _aclPointArray.end();
     Base::Matrix4D clMatrix(rclMat);
 
+    InvalidateGeometry();
     _clBoundBox.SetVoid();
     while (clPIter < clPEIter) {
         *clPIter *= clMatrix;
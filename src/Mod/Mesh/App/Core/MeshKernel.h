@@ -27,6 +27,7 @@
 #include <assert.h>
 #include <iosfwd>
 
+#include "Adjacency.h"
 #include "Elements.h"
 #include "Helpers.h"
 
@@ -151,6 +152,7 @@ public:
     /** Returns a modifier for the point array */
     MeshPointModifier ModifyPoints()
     {
+        InvalidateGeometry();
         return MeshPointModifier(_aclPointArray);
     }
 
@@ -164,7 +166,7 @@ public:
     /** Returns a modifier for the facet array */
     MeshFacetModifier ModifyFacets()
     {
-        return MeshFacetModifier(_aclFacetArray);
+        return MeshFacetModifier(*this, _aclFacetArray);
     }
 
     /** Returns the array of all edges.
@@ -174,6 +176,33 @@ public:
     void GetEdges (std::vector<MeshGeomEdge>&) const;
     //@}
 
+    /** @name Adjacency
+     * The point to facets and point to points adjacency is built on demand and kept
+     * until the topology of the mesh changes. Topological operations of MeshTopoAlgorithm
+     * update it instead of discarding it.
+     */
+    //@{
+    /** Returns a counter that changes whenever facets or points are added or removed
+     * or facets get other point indices.
+     */
+    unsigned long GetTopologyVersion (void) const
+    { return _ulTopologyVersion; }
+    /** Returns a counter that changes whenever the topology changes or points are moved.
+     * Data derived from the geometry, like a MeshFacetBVH, can be kept as long as it
+     * doesn't change.
+     */
+    unsigned long GetGeometryVersion (void) const
+    { return _ulGeometryVersion; }
+    /** Returns the sorted indices of the facets that reference each point. */
+    const MeshIndexRows& GetPointToFacets (void) const;
+    /** Returns the sorted indices of the points connected with each point by an edge. */
+    const MeshIndexRows& GetPointToPoints (void) const;
+    /** Returns the facets that share at least one point with the facet \a ulFacet. */
+    void GetFacetToFacets (unsigned long ulFacet, std::vector<unsigned long>& raulFacets) const;
+    /** Returns the facets that share the edge defined by the points \a ulPt0 and \a ulPt1. */
+    void GetEdgeToFacets (unsigned long ulPt0, unsigned long ulPt1, std::vector<unsigned long>& raulFacets) const;
+    //@}
+
     /** @name Evaluation */
     //@{
     /** Calculates the surface area of the mesh object. */
@@ -437,6 +466,20 @@ protected:
      */
     void ErasePoint (unsigned long ulIndex, unsigned long ulFacetIndex, bool bOnlySetInvalid = false);
 
+    /** Marks the adjacency data as outdated. This must be called by all methods
+     * that change the topology.
+     */
+    void InvalidateTopology (void)
+    { ++_ulTopologyVersion; ++_ulGeometryVersion; }
+    /** Must be called by all methods that move points. */
+    void InvalidateGeometry (void)
+    { ++_ulGeometryVersion; }
+    /** Updates the adjacency data after the facets in \a raclOld have been modified.
+     * Each entry holds the facet index and the facet as it was before, a new facet
+     * has its former point indices set to ULONG_MAX.
+     */
+    void UpdateTopology (const std::vector<std::pair<unsigned long, MeshFacet> >& raclOld);
+
     /** Adjusts the facet's orierntation to the given normal direction. */
     inline void AdjustNormal (MeshFacet &rclFacet, const Base::Vector3f &rclNormal);
     /** Calculates the normal to the given facet. */
@@ -448,6 +491,9 @@ protected:
     MeshFacetArray   _aclFacetArray; /**< Holds the array of facets. */
     Base::BoundBox3f _clBoundBox;    /**< The current calculated bounding box. */
     bool            _bValid; /**< Current state of validality. */
+    unsigned long   _ulTopologyVersion; /**< Changes with each topological modification. */
+    unsigned long   _ulGeometryVersion; /**< Changes with each topological or geometric modification. */
+    mutable MeshAdjacency _clAdjacency; /**< Cached adjacency data. */
 
     // friends
     friend class MeshPointIterator;
@@ -458,6 +504,7 @@ protected:
     friend class MeshFixDuplicatePoints;
     friend class MeshBuilder;
     friend class MeshTrimming;
+    friend class MeshFacetModifier;
 };
 
 inline MeshPoint MeshKernel::GetPoint (unsigned long ulIndex) const
@@ -510,16 +557,19 @@ inline void MeshKernel::GetFacetNeighbours (unsigned long ulIndex, unsigned long
 
 inline void MeshKernel::MovePoint (unsigned long ulPtIndex, const Base::Vector3f &rclTrans)
 {
+    InvalidateGeometry();
     _aclPointArray[ulPtIndex] += rclTrans;
 }
 
 inline void MeshKernel::SetPoint (unsigned long ulPtIndex, const Base::Vector3f &rPoint)
 {
+    InvalidateGeometry();
     _aclPointArray[ulPtIndex] = rPoint;
 }
 
 inline void MeshKernel::SetPoint (unsigned long ulPtIndex, float x, float y, float z)
 {
+    InvalidateGeometry();
     _aclPointArray[ulPtIndex].Set(x,y,z);
 }
 
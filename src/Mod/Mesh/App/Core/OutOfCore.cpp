@@ -0,0 +1,675 @@
+/***************************************************************************
+ *   Copyright (c) 2018 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cmath>
+# include <cstdio>
+# include <cstring>
+# include <memory>
+#endif
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <Base/FileInfo.h>
+#include <Base/Sequencer.h>
+#include <Base/Stream.h>
+
+#include "OutOfCore.h"
+#include "Functional.h"
+
+using namespace MeshCore;
+
+namespace MeshCore {
+
+struct MeshChunkHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t countPoints;
+    uint32_t countFacets;
+    uint32_t reserved;
+    float box[6];
+};
+
+static const char chunkMagic[8] = {'M','E','S','H','C','H','N','K'};
+static const char indexMagic[8] = {'M','E','S','H','I','N','D','X'};
+static const uint32_t chunkVersion = 1;
+
+// The point of a facet corner while a chunk is built
+struct MeshChunkCorner
+{
+    float x, y, z;
+    uint32_t corner;
+
+    bool operator < (const MeshChunkCorner& c) const
+    {
+        if (x != c.x)
+            return x < c.x;
+        if (y != c.y)
+            return y < c.y;
+        return z < c.z;
+    }
+    bool operator != (const MeshChunkCorner& c) const
+    {
+        return x != c.x || y != c.y || z != c.z;
+    }
+};
+
+// An edge given by the coordinates of its end points, the smaller point first
+struct MeshChunkEdge
+{
+    float c[6];
+
+    MeshChunkEdge(const Base::Vector3f& p, const Base::Vector3f& q)
+    {
+        float a[3] = {p.x, p.y, p.z};
+        float b[3] = {q.x, q.y, q.z};
+        bool swap = std::lexicographical_compare(b, b+3, a, a+3);
+        std::copy(a, a+3, swap ? c+3 : c);
+        std::copy(b, b+3, swap ? c : c+3);
+    }
+    bool operator < (const MeshChunkEdge& e) const
+    {
+        return std::lexicographical_compare(c, c+6, e.c, e.c+6);
+    }
+    bool operator == (const MeshChunkEdge& e) const
+    {
+        return std::equal(c, c+6, e.c);
+    }
+};
+
+// Spreads the lower ten bits of v so that two zero bits follow each of them
+static inline uint32_t spreadBits(uint32_t v)
+{
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v <<  8)) & 0x0300f00f;
+    v = (v | (v <<  4)) & 0x030c30c3;
+    v = (v | (v <<  2)) & 0x09249249;
+    return v;
+}
+
+// Sums up func(facet) over all facets of the chunk in parallel
+template <class Func>
+static double sumFacets(const MeshChunk& chunk, Func func)
+{
+    QMutex mutex;
+    double sum = 0.0;
+    MeshCore::parallel_blocks(chunk.CountFacets(), [&](std::size_t begin, std::size_t end) {
+        double local = 0.0;
+        for (std::size_t i = begin; i < end; i++)
+            local += func(chunk.GetFacet(static_cast<unsigned long>(i)));
+        QMutexLocker locker(&mutex);
+        sum += local;
+    }, QThread::idealThreadCount());
+    return sum;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+
+struct MeshChunk::Private
+{
+    QFile file;
+    uchar* data;
+    const MeshChunkHeader* header;
+
+    Private(const std::string& fileName)
+        : file(QString::fromUtf8(fileName.c_str())), data(0), header(0)
+    {
+    }
+};
+
+MeshChunk::MeshChunk(const std::string& fileName)
+  : d(new Private(fileName)), points(0), facets(0)
+{
+    if (!d->file.open(QIODevice::ReadOnly))
+        return;
+    qint64 size = d->file.size();
+    if (size < static_cast<qint64>(sizeof(MeshChunkHeader)))
+        return;
+    d->data = d->file.map(0, size);
+    if (!d->data)
+        return;
+
+    const MeshChunkHeader* header = reinterpret_cast<const MeshChunkHeader*>(d->data);
+    qint64 expected = static_cast<qint64>(sizeof(MeshChunkHeader)) +
+                      12 * static_cast<qint64>(header->countPoints) +
+                      12 * static_cast<qint64>(header->countFacets);
+    if (std::memcmp(header->magic, chunkMagic, 8) != 0 ||
+        header->version != chunkVersion || size != expected)
+        return;
+
+    d->header = header;
+    points = reinterpret_cast<const float*>(d->data + sizeof(MeshChunkHeader));
+    facets = reinterpret_cast<const uint32_t*>(points + 3 * header->countPoints);
+}
+
+MeshChunk::~MeshChunk()
+{
+    if (d->data)
+        d->file.unmap(d->data);
+    delete d;
+}
+
+bool MeshChunk::IsValid() const
+{
+    return d->header != 0;
+}
+
+unsigned long MeshChunk::CountPoints() const
+{
+    return d->header ? d->header->countPoints : 0;
+}
+
+unsigned long MeshChunk::CountFacets() const
+{
+    return d->header ? d->header->countFacets : 0;
+}
+
+Base::BoundBox3f MeshChunk::GetBoundBox() const
+{
+    if (!d->header)
+        return Base::BoundBox3f();
+    const float* b = d->header->box;
+    return Base::BoundBox3f(b[0], b[1], b[2], b[3], b[4], b[5]);
+}
+
+// ----------------------------------------------------------------------------
+
+struct MeshOutOfCoreKernel::ChunkCache
+{
+    QMutex mutex;
+    std::unique_ptr<MeshChunk> chunk;
+    unsigned long index;
+
+    ChunkCache() : index(ULONG_MAX) {}
+    void Clear()
+    {
+        QMutexLocker locker(&mutex);
+        chunk.reset();
+        index = ULONG_MAX;
+    }
+};
+
+MeshOutOfCoreKernel::MeshOutOfCoreKernel()
+  : _ulCountFacets(0)
+  , _cache(new ChunkCache)
+{
+}
+
+MeshOutOfCoreKernel::~MeshOutOfCoreKernel()
+{
+    delete _cache;
+}
+
+void MeshOutOfCoreKernel::Close()
+{
+    // the chunk files may be overwritten afterwards
+    _cache->Clear();
+    _directory.clear();
+    _chunks.clear();
+    _clBoundBox = Base::BoundBox3f();
+    _ulCountFacets = 0;
+}
+
+std::string MeshOutOfCoreKernel::GetChunkFile(unsigned long chunk) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "chunk%05lu.dat", chunk);
+    return _directory + "/" + name;
+}
+
+bool MeshOutOfCoreKernel::Create(const std::string& stlFile, const std::string& directory,
+                                 unsigned long maxFacets)
+{
+    Close();
+
+    Base::FileInfo fi(stlFile);
+    QFile file(QString::fromUtf8(fi.filePath().c_str()));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < 84)
+        return false;
+    uchar* data = file.map(0, file.size());
+    if (!data)
+        return false;
+
+    // binary STL: 80 bytes header, number of facets and 50 bytes per facet
+    uint32_t count;
+    std::memcpy(&count, data + 80, sizeof(count));
+    if (file.size() < 84 + 50 * static_cast<qint64>(count)) {
+        file.unmap(data);
+        return false;
+    }
+
+    Base::FileInfo di(directory);
+    if (!di.exists() && !di.createDirectory()) {
+        file.unmap(data);
+        return false;
+    }
+    _directory = di.filePath();
+
+    const uchar* records = data + 84;
+    int threads = QThread::idealThreadCount();
+    maxFacets = std::max<unsigned long>(maxFacets, 1);
+
+    // first pass: bounding box
+    QMutex mutex;
+    Base::BoundBox3f box;
+    MeshCore::parallel_blocks(count, [&](std::size_t begin, std::size_t end) {
+        Base::BoundBox3f local;
+        float v[9];
+        for (std::size_t i = begin; i < end; i++) {
+            std::memcpy(v, records + 50 * i + 12, sizeof(v));
+            local.Add(Base::Vector3f(v[0], v[1], v[2]));
+            local.Add(Base::Vector3f(v[3], v[4], v[5]));
+            local.Add(Base::Vector3f(v[6], v[7], v[8]));
+        }
+        QMutexLocker locker(&mutex);
+        box.Add(local);
+    }, threads);
+
+    // the facets are sorted into the cells of a regular grid which are
+    // then grouped along a Z-order curve into chunks
+    unsigned long numChunks = (count + maxFacets - 1) / maxFacets;
+    int bits = 0;
+    while (bits < 7 && (1ul << (3 * bits)) < 8 * numChunks)
+        bits++;
+    const uint32_t cells = 1u << bits;
+    const float lenX = box.LengthX() > 0.0f ? box.LengthX() : 1.0f;
+    const float lenY = box.LengthY() > 0.0f ? box.LengthY() : 1.0f;
+    const float lenZ = box.LengthZ() > 0.0f ? box.LengthZ() : 1.0f;
+    const float minX = box.MinX, minY = box.MinY, minZ = box.MinZ;
+    auto cellOf = [=](const float* v) -> uint32_t {
+        float c[3] = {(v[0] + v[3] + v[6]) / 3.0f - minX,
+                      (v[1] + v[4] + v[7]) / 3.0f - minY,
+                      (v[2] + v[5] + v[8]) / 3.0f - minZ};
+        uint32_t ix = std::min<uint32_t>(cells - 1, static_cast<uint32_t>(std::max(0.0f, c[0] / lenX * cells)));
+        uint32_t iy = std::min<uint32_t>(cells - 1, static_cast<uint32_t>(std::max(0.0f, c[1] / lenY * cells)));
+        uint32_t iz = std::min<uint32_t>(cells - 1, static_cast<uint32_t>(std::max(0.0f, c[2] / lenZ * cells)));
+        return spreadBits(ix) | (spreadBits(iy) << 1) | (spreadBits(iz) << 2);
+    };
+
+    // second pass: number of facets per cell
+    std::vector<unsigned long> cellCount(std::size_t(1) << (3 * bits), 0);
+    float v[9];
+    for (uint32_t i = 0; i < count; i++) {
+        std::memcpy(v, records + 50 * std::size_t(i) + 12, sizeof(v));
+        cellCount[cellOf(v)]++;
+    }
+
+    std::vector<uint32_t> cellChunk(cellCount.size());
+    unsigned long chunk = 0, fill = 0;
+    for (std::size_t c = 0; c < cellCount.size(); c++) {
+        if (fill > 0 && fill + cellCount[c] > maxFacets) {
+            chunk++;
+            fill = 0;
+        }
+        cellChunk[c] = chunk;
+        fill += cellCount[c];
+    }
+    numChunks = count > 0 ? chunk + 1 : 0;
+    _chunks.resize(numChunks);
+
+    // third pass: copy the facets of a group of chunks into temporary files,
+    // limited to not run out of file handles
+    const unsigned long groupSize = 64;
+    Base::SequencerLauncher seq("Creating chunks...", numChunks);
+    bool ok = true;
+    for (unsigned long first = 0; ok && first < numChunks; first += groupSize) {
+        unsigned long last = std::min(first + groupSize, numChunks);
+        std::vector<Base::ofstream*> tmp;
+        for (unsigned long c = first; c < last; c++) {
+            Base::FileInfo tf(GetChunkFile(c) + ".tmp");
+            tmp.push_back(new Base::ofstream(tf, std::ios::out | std::ios::binary | std::ios::trunc));
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            const char* rec = reinterpret_cast<const char*>(records + 50 * std::size_t(i) + 12);
+            std::memcpy(v, rec, sizeof(v));
+            unsigned long c = cellChunk[cellOf(v)];
+            if (c >= first && c < last)
+                tmp[c - first]->write(rec, sizeof(v));
+        }
+
+        for (std::vector<Base::ofstream*>::iterator it = tmp.begin(); it != tmp.end(); ++it) {
+            ok &= !(*it)->fail();
+            delete *it;
+        }
+
+        // turn each temporary file into a chunk
+        for (unsigned long c = first; c < last; c++) {
+            Base::FileInfo tf(GetChunkFile(c) + ".tmp");
+            std::vector<float> corners;
+            if (ok) {
+                Base::ifstream str(tf, std::ios::in | std::ios::binary | std::ios::ate);
+                corners.resize(static_cast<std::size_t>(str.tellg()) / sizeof(float));
+                str.seekg(0, std::ios::beg);
+                if (!corners.empty())
+                    str.read(reinterpret_cast<char*>(&corners[0]), corners.size() * sizeof(float));
+                ok = !str.fail();
+            }
+            tf.deleteFile();
+            if (ok)
+                ok = WriteChunk(c, corners);
+            seq.next(true);
+        }
+    }
+
+    file.unmap(data);
+
+    if (!ok || !WriteIndex()) {
+        Close();
+        return false;
+    }
+
+    return ReadIndex();
+}
+
+bool MeshOutOfCoreKernel::WriteChunk(unsigned long chunk, std::vector<float>& corners)
+{
+    std::size_t ctCorners = corners.size() / 3;
+    int threads = QThread::idealThreadCount();
+
+    // merge the corners with equal coordinates
+    std::vector<MeshChunkCorner> sorted(ctCorners);
+    MeshCore::parallel_blocks(ctCorners, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            MeshChunkCorner& c = sorted[i];
+            c.x = corners[3*i];
+            c.y = corners[3*i+1];
+            c.z = corners[3*i+2];
+            c.corner = static_cast<uint32_t>(i);
+        }
+    }, threads);
+    std::vector<float>().swap(corners);
+    MeshCore::parallel_sort(sorted.begin(), sorted.end(), std::less<MeshChunkCorner>(), threads);
+
+    std::vector<float> points;
+    std::vector<uint32_t> facets(ctCorners);
+    Base::BoundBox3f box;
+    for (std::size_t i = 0; i < ctCorners; i++) {
+        const MeshChunkCorner& c = sorted[i];
+        if (i == 0 || sorted[i-1] != c) {
+            points.push_back(c.x);
+            points.push_back(c.y);
+            points.push_back(c.z);
+            box.Add(Base::Vector3f(c.x, c.y, c.z));
+        }
+        facets[c.corner] = static_cast<uint32_t>(points.size() / 3 - 1);
+    }
+
+    MeshChunkHeader header;
+    std::memcpy(header.magic, chunkMagic, 8);
+    header.version = chunkVersion;
+    header.countPoints = static_cast<uint32_t>(points.size() / 3);
+    header.countFacets = static_cast<uint32_t>(ctCorners / 3);
+    header.reserved = 0;
+    header.box[0] = box.MinX; header.box[1] = box.MinY; header.box[2] = box.MinZ;
+    header.box[3] = box.MaxX; header.box[4] = box.MaxY; header.box[5] = box.MaxZ;
+
+    Base::FileInfo fi(GetChunkFile(chunk));
+    Base::ofstream str(fi, std::ios::out | std::ios::binary | std::ios::trunc);
+    str.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!points.empty())
+        str.write(reinterpret_cast<const char*>(&points[0]), points.size() * sizeof(float));
+    if (!facets.empty())
+        str.write(reinterpret_cast<const char*>(&facets[0]), facets.size() * sizeof(uint32_t));
+    return !str.fail();
+}
+
+bool MeshOutOfCoreKernel::WriteIndex() const
+{
+    // the header of each chunk file is repeated so that opening doesn't need to
+    // touch all chunk files
+    Base::FileInfo fi(_directory + "/index.dat");
+    Base::ofstream str(fi, std::ios::out | std::ios::binary | std::ios::trunc);
+    str.write(indexMagic, 8);
+    uint32_t version = chunkVersion;
+    uint32_t count = static_cast<uint32_t>(_chunks.size());
+    str.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    str.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    for (unsigned long c = 0; c < _chunks.size(); c++) {
+        MeshChunk chunk(GetChunkFile(c));
+        if (!chunk.IsValid())
+            return false;
+        uint32_t counts[2] = {static_cast<uint32_t>(chunk.CountPoints()),
+                              static_cast<uint32_t>(chunk.CountFacets())};
+        Base::BoundBox3f box = chunk.GetBoundBox();
+        float b[6] = {box.MinX, box.MinY, box.MinZ, box.MaxX, box.MaxY, box.MaxZ};
+        str.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+        str.write(reinterpret_cast<const char*>(b), sizeof(b));
+    }
+
+    return !str.fail();
+}
+
+bool MeshOutOfCoreKernel::ReadIndex()
+{
+    Base::FileInfo fi(_directory + "/index.dat");
+    Base::ifstream str(fi, std::ios::in | std::ios::binary);
+    char magic[8];
+    uint32_t version = 0, count = 0;
+    str.read(magic, 8);
+    str.read(reinterpret_cast<char*>(&version), sizeof(version));
+    str.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (str.fail() || std::memcmp(magic, indexMagic, 8) != 0 || version != chunkVersion)
+        return false;
+
+    _chunks.resize(count);
+    _clBoundBox = Base::BoundBox3f();
+    _ulCountFacets = 0;
+    for (std::vector<ChunkInfo>::iterator it = _chunks.begin(); it != _chunks.end(); ++it) {
+        uint32_t counts[2];
+        float b[6];
+        str.read(reinterpret_cast<char*>(counts), sizeof(counts));
+        str.read(reinterpret_cast<char*>(b), sizeof(b));
+        it->countPoints = counts[0];
+        it->countFacets = counts[1];
+        it->offset = _ulCountFacets;
+        it->box = Base::BoundBox3f(b[0], b[1], b[2], b[3], b[4], b[5]);
+        _ulCountFacets += counts[1];
+        _clBoundBox.Add(it->box);
+    }
+
+    return !str.fail();
+}
+
+bool MeshOutOfCoreKernel::Open(const std::string& directory)
+{
+    Close();
+    _directory = Base::FileInfo(directory).filePath();
+    if (!ReadIndex()) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+unsigned long MeshOutOfCoreKernel::GetChunkOfFacet(unsigned long index) const
+{
+    // the chunks are ordered by their offsets
+    std::vector<ChunkInfo>::const_iterator it = std::upper_bound(_chunks.begin(), _chunks.end(), index,
+        [](unsigned long value, const ChunkInfo& info) {
+            return value < info.offset;
+        });
+    if (it == _chunks.begin())
+        return ULONG_MAX;
+    --it;
+    if (index >= it->offset + it->countFacets)
+        return ULONG_MAX;
+    return static_cast<unsigned long>(it - _chunks.begin());
+}
+
+MeshGeomFacet MeshOutOfCoreKernel::GetFacet(unsigned long index) const
+{
+    unsigned long c = GetChunkOfFacet(index);
+    if (c == ULONG_MAX)
+        return MeshGeomFacet();
+
+    QMutexLocker locker(&_cache->mutex);
+    if (_cache->index != c) {
+        _cache->chunk.reset(new MeshChunk(GetChunkFile(c)));
+        _cache->index = c;
+    }
+
+    if (!_cache->chunk->IsValid())
+        return MeshGeomFacet();
+    return _cache->chunk->GetFacet(index - _chunks[c].offset);
+}
+
+float MeshOutOfCoreKernel::GetSurface() const
+{
+    double surface = 0.0;
+    for (unsigned long c = 0; c < _chunks.size(); c++) {
+        MeshChunk chunk(GetChunkFile(c));
+        surface += sumFacets(chunk, [](const MeshGeomFacet& f) {
+            return static_cast<double>(f.Area());
+        });
+    }
+
+    return static_cast<float>(surface);
+}
+
+float MeshOutOfCoreKernel::GetVolume() const
+{
+    double volume = 0.0;
+    for (unsigned long c = 0; c < _chunks.size(); c++) {
+        MeshChunk chunk(GetChunkFile(c));
+        volume += sumFacets(chunk, [](const MeshGeomFacet& f) {
+            const Base::Vector3f& p1 = f._aclPoints[0];
+            const Base::Vector3f& p2 = f._aclPoints[1];
+            const Base::Vector3f& p3 = f._aclPoints[2];
+            return static_cast<double>(-p3.x*p2.y*p1.z + p2.x*p3.y*p1.z + p3.x*p1.y*p2.z
+                                       - p1.x*p3.y*p2.z - p2.x*p1.y*p3.z + p1.x*p2.y*p3.z);
+        });
+    }
+
+    return static_cast<float>(fabs(volume / 6.0));
+}
+
+bool MeshOutOfCoreKernel::HasOpenEdges() const
+{
+    typedef std::pair<uint32_t, uint32_t> Edge;
+    int threads = QThread::idealThreadCount();
+
+    // edges used once inside a chunk may be continued in a neighbour chunk
+    std::vector<MeshChunkEdge> seams;
+    for (unsigned long c = 0; c < _chunks.size(); c++) {
+        MeshChunk chunk(GetChunkFile(c));
+        std::size_t ctFacets = chunk.CountFacets();
+        std::vector<Edge> edges(3 * ctFacets);
+        MeshCore::parallel_blocks(ctFacets, [&](std::size_t begin, std::size_t end) {
+            unsigned long p[3];
+            for (std::size_t i = begin; i < end; i++) {
+                chunk.GetFacetPoints(static_cast<unsigned long>(i), p[0], p[1], p[2]);
+                for (int j = 0; j < 3; j++) {
+                    uint32_t a = static_cast<uint32_t>(p[j]);
+                    uint32_t b = static_cast<uint32_t>(p[(j+1)%3]);
+                    edges[3*i+j] = Edge(std::min(a, b), std::max(a, b));
+                }
+            }
+        }, threads);
+        MeshCore::parallel_sort(edges.begin(), edges.end(), std::less<Edge>(), threads);
+
+        for (std::size_t i = 0; i < edges.size(); ) {
+            std::size_t j = i + 1;
+            while (j < edges.size() && edges[j] == edges[i])
+                j++;
+            if (j - i == 1)
+                seams.push_back(MeshChunkEdge(chunk.GetPoint(edges[i].first), chunk.GetPoint(edges[i].second)));
+            i = j;
+        }
+    }
+
+    MeshCore::parallel_sort(seams.begin(), seams.end(), std::less<MeshChunkEdge>(), threads);
+    for (std::size_t i = 0; i < seams.size(); ) {
+        std::size_t j = i + 1;
+        while (j < seams.size() && seams[j] == seams[i])
+            j++;
+        if (j - i == 1)
+            return true;
+        i = j;
+    }
+
+    return false;
+}
+
+bool MeshOutOfCoreKernel::SaveBinarySTL(std::ostream& rstrOut) const
+{
+    if (!rstrOut || rstrOut.bad())
+        return false;
+
+    const char header[] = "MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-"
+                          "MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH\n";
+    rstrOut.write(header, 80);
+    uint32_t uCtFts = static_cast<uint32_t>(_ulCountFacets);
+    rstrOut.write(reinterpret_cast<const char*>(&uCtFts), sizeof(uCtFts));
+
+    // a record consists of normal, vertices and attribute
+    const std::size_t recordSize = 12 * sizeof(float) + sizeof(uint16_t);
+    Base::SequencerLauncher seq("saving...", _chunks.size());
+    std::string buffer;
+    for (unsigned long c = 0; c < _chunks.size(); c++) {
+        MeshChunk chunk(GetChunkFile(c));
+        if (!chunk.IsValid())
+            return false;
+
+        std::size_t ctFacets = chunk.CountFacets();
+        buffer.resize(ctFacets * recordSize);
+        char* data = buffer.empty() ? 0 : &buffer[0];
+        MeshCore::parallel_blocks(ctFacets, [&chunk, data, recordSize](std::size_t begin, std::size_t end) {
+            float pnt[12];
+            uint16_t usAtt = 0;
+            for (std::size_t i = begin; i < end; i++) {
+                MeshGeomFacet facet = chunk.GetFacet(static_cast<unsigned long>(i));
+                Base::Vector3f normal = facet.GetNormal();
+                pnt[0] = normal.x;
+                pnt[1] = normal.y;
+                pnt[2] = normal.z;
+                for (int j = 0; j < 3; j++) {
+                    pnt[3+3*j] = facet._aclPoints[j].x;
+                    pnt[4+3*j] = facet._aclPoints[j].y;
+                    pnt[5+3*j] = facet._aclPoints[j].z;
+                }
+                char* rec = data + i * recordSize;
+                std::memcpy(rec, pnt, sizeof(pnt));
+                std::memcpy(rec + sizeof(pnt), &usAtt, sizeof(usAtt));
+            }
+        }, QThread::idealThreadCount());
+
+        rstrOut.write(buffer.c_str(), static_cast<std::streamsize>(buffer.size()));
+        seq.next(true);
+    }
+
+    return !rstrOut.fail();
+}
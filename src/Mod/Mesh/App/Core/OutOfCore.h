@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright (c) 2018 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_OUTOFCORE_H
+#define MESH_OUTOFCORE_H
+
+#include <iosfwd>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <Base/BoundBox.h>
+#include <Base/Vector3D.h>
+
+#include "Elements.h"
+
+namespace MeshCore
+{
+
+/**
+ * The MeshChunk class gives read access to one chunk file of an out-of-core mesh.
+ * The file is mapped into memory as long as the object exists.
+ *
+ * A chunk file holds a small header, the points as three floats each and the
+ * facets as three 32-bit point indices each. Unlike MeshPoint and MeshFacet no
+ * flags, properties or neighbour indices are stored. The files use the byte order
+ * of the machine that created them.
+ */
+class MeshExport MeshChunk
+{
+public:
+    MeshChunk(const std::string& fileName);
+    ~MeshChunk();
+
+    /** Returns true if the file could be mapped and has a valid header. */
+    bool IsValid() const;
+    unsigned long CountPoints() const;
+    unsigned long CountFacets() const;
+    Base::BoundBox3f GetBoundBox() const;
+
+    /** Returns the point with the local index \a index. */
+    inline Base::Vector3f GetPoint(unsigned long index) const;
+    /** Returns the local point indices of the facet \a index. */
+    inline void GetFacetPoints(unsigned long index, unsigned long& p0,
+                               unsigned long& p1, unsigned long& p2) const;
+    /** Returns the geometric facet \a index. */
+    inline MeshGeomFacet GetFacet(unsigned long index) const;
+
+private:
+    MeshChunk(const MeshChunk&);
+    MeshChunk& operator = (const MeshChunk&);
+
+private:
+    struct Private;
+    Private* d;
+    const float* points;
+    const uint32_t* facets;
+};
+
+/**
+ * The MeshOutOfCoreKernel class handles meshes that don't fit into memory.
+ * The facets are sorted spatially into chunks of limited size that are kept in
+ * files of a directory. Algorithms map one chunk after the other into memory
+ * and work on each chunk in parallel, so the memory use is bounded by the chunk
+ * size instead of the mesh size.
+ *
+ * Points shared by facets of different chunks are stored once per chunk. Edges
+ * across chunks are matched by the coordinates of their end points.
+ */
+class MeshExport MeshOutOfCoreKernel
+{
+public:
+    MeshOutOfCoreKernel();
+    ~MeshOutOfCoreKernel();
+
+    /** @name Chunk files */
+    //@{
+    /** Splits the binary STL file \a stlFile into chunk files of at most about
+     * \a maxFacets facets in the directory \a directory. The STL file is mapped
+     * into memory but never loaded as a whole. It is read once for the bounding
+     * box, once to count the facets per grid cell and once more for each group
+     * of 64 chunks that are written.
+     */
+    bool Create(const std::string& stlFile, const std::string& directory,
+                unsigned long maxFacets = 1000000);
+    /** Opens the chunk files created before by Create(). */
+    bool Open(const std::string& directory);
+    /** Forgets the chunks. The files are not deleted. */
+    void Close();
+    //@}
+
+    /** @name Querying */
+    //@{
+    unsigned long CountChunks() const
+    { return static_cast<unsigned long>(_chunks.size()); }
+    unsigned long CountFacets() const
+    { return _ulCountFacets; }
+    const Base::BoundBox3f& GetBoundBox() const
+    { return _clBoundBox; }
+    const Base::BoundBox3f& GetChunkBoundBox(unsigned long chunk) const
+    { return _chunks[chunk].box; }
+    /** Returns the global index of the first facet of the chunk \a chunk. */
+    unsigned long GetChunkOffset(unsigned long chunk) const
+    { return _chunks[chunk].offset; }
+    /** Returns the name of the file of the chunk \a chunk. */
+    std::string GetChunkFile(unsigned long chunk) const;
+    /** Returns the chunk that contains the facet with the global index \a index. */
+    unsigned long GetChunkOfFacet(unsigned long index) const;
+    /** Returns the facet with the global index \a index. The chunk containing
+     * the facet stays mapped until a facet of another chunk is requested, so
+     * visiting the facets in the order of their indices is cheap.
+     */
+    MeshGeomFacet GetFacet(unsigned long index) const;
+    //@}
+
+    /** @name Evaluation */
+    //@{
+    /** Calculates the surface area of the mesh. */
+    float GetSurface() const;
+    /** Calculates the volume of the mesh. */
+    float GetVolume() const;
+    /** Checks whether the mesh has edges used by only one facet. This is the
+     * out-of-core counterpart of MeshEvalSolid.
+     */
+    bool HasOpenEdges() const;
+    //@}
+
+    /** @name Export */
+    //@{
+    /** Writes the mesh as binary STL. */
+    bool SaveBinarySTL(std::ostream&) const;
+    //@}
+
+private:
+    MeshOutOfCoreKernel(const MeshOutOfCoreKernel&);
+    MeshOutOfCoreKernel& operator = (const MeshOutOfCoreKernel&);
+
+    bool ReadIndex();
+    bool WriteIndex() const;
+    bool WriteChunk(unsigned long chunk, std::vector<float>& corners);
+
+private:
+    struct ChunkInfo {
+        Base::BoundBox3f box;
+        unsigned long countPoints;
+        unsigned long countFacets;
+        unsigned long offset;
+    };
+
+    std::string _directory;
+    std::vector<ChunkInfo> _chunks;
+    Base::BoundBox3f _clBoundBox;
+    unsigned long _ulCountFacets;
+
+    struct ChunkCache;
+    ChunkCache* _cache; /**< The chunk last mapped by GetFacet(). */
+};
+
+inline Base::Vector3f MeshChunk::GetPoint(unsigned long index) const
+{
+    const float* p = points + 3 * index;
+    return Base::Vector3f(p[0], p[1], p[2]);
+}
+
+inline void MeshChunk::GetFacetPoints(unsigned long index, unsigned long& p0,
+                                      unsigned long& p1, unsigned long& p2) const
+{
+    const uint32_t* f = facets + 3 * index;
+    p0 = f[0];
+    p1 = f[1];
+    p2 = f[2];
+}
+
+inline MeshGeomFacet MeshChunk::GetFacet(unsigned long index) const
+{
+    const uint32_t* f = facets + 3 * index;
+    return MeshGeomFacet(GetPoint(f[0]), GetPoint(f[1]), GetPoint(f[2]));
+}
+
+} // namespace MeshCore
+
+#endif // MESH_OUTOFCORE_H
@@ -32,6 +32,7 @@
 #include "Iterator.h"
 #include "Algorithm.h"
 #include "Grid.h"
+#include "OutOfCore.h"
 
 #include <Base/Exception.h>
 #include <Base/Console.h>
@@ -44,7 +45,12 @@ using namespace MeshCore;
 // ------------------------------------------------------------------------
 
 MeshProjection::MeshProjection(const MeshKernel& mesh)
-  : kernel(mesh)
+  : kernel(&mesh), chunks(0)
+{
+}
+
+MeshProjection::MeshProjection(const MeshOutOfCoreKernel& mesh)
+  : kernel(0), chunks(&mesh)
 {
 }
 
@@ -138,17 +144,57 @@ bool MeshProjection::connectLines(std::list< std::pair<Base::Vector3f, Base::Vec
     return true;
 }
 
-bool MeshProjection::projectLineOnMesh(const MeshFacetGrid& grid,
-                                       const Base::Vector3f& v1, unsigned long f1,
-                                       const Base::Vector3f& v2, unsigned long f2,
-                                       const Base::Vector3f& vd,
-                                       std::vector<Base::Vector3f>& polyline)
+void MeshProjection::cutFacet(const MeshGeomFacet& tria, unsigned long index,
+                              const Base::Vector3f& v1, unsigned long f1,
+                              const Base::Vector3f& v2, unsigned long f2,
+                              const Base::Vector3f& vd,
+                              std::list< std::pair<Base::Vector3f, Base::Vector3f> >& cutLine) const
 {
+    if (!bboxInsideRectangle(tria.GetBoundBox(), v1, v2, vd))
+        return;
+
     Base::Vector3f dir(v2 - v1);
     Base::Vector3f base(v1), normal(vd % dir);
     normal.Normalize();
     dir.Normalize();
 
+    Base::Vector3f e1, e2;
+    if (tria.IntersectWithPlane(base, normal, e1, e2)) {
+        if ((index != f1) && (index != f2)) {
+            // inside cut line
+            if ((isPointInsideDistance(v1, v2, e1) == false) ||
+                (isPointInsideDistance(v1, v2, e2) == false)) {
+                return;
+            }
+
+            cutLine.emplace_back(e1, e2);
+        }
+        else {
+            if (index == f1) { // start facet
+                if (((e2 - v1) * dir) > 0.0f)
+                    cutLine.emplace_back(v1, e2);
+                else
+                    cutLine.emplace_back(v1, e1);
+            }
+
+            if (index == f2) { // end facet
+                if (((e2 - v2) * -dir) > 0.0f)
+                    cutLine.emplace_back(v2, e2);
+                else
+                    cutLine.emplace_back(v2, e1);
+            }
+        }
+    }
+}
+
+bool MeshProjection::projectLineOnMesh(const MeshFacetGrid& grid,
+                                       const Base::Vector3f& v1, unsigned long f1,
+                                       const Base::Vector3f& v2, unsigned long f2,
+                                       const Base::Vector3f& vd,
+                                       std::vector<Base::Vector3f>& polyline)
+{
+    if (!kernel)
+        return false;
 
     std::vector<unsigned long> facets;
 
@@ -172,41 +218,38 @@ bool MeshProjection::projectLineOnMesh(const MeshFacetGrid& grid,
 
     // cut all facets with plane
     std::list< std::pair<Base::Vector3f, Base::Vector3f> > cutLine;
-    //unsigned long start = 0, end = 0;
     for (std::vector<unsigned long>::iterator it = facets.begin(); it != facets.end(); ++it) {
-        Base::Vector3f e1, e2;
-        MeshGeomFacet tria = kernel.GetFacet(*it);
-        if (bboxInsideRectangle(tria.GetBoundBox(), v1, v2, vd)) {
-            if (tria.IntersectWithPlane(base, normal, e1, e2)) {
-                if ((*it != f1) && (*it != f2)) {
-                    // inside cut line
-                    if ((isPointInsideDistance(v1, v2, e1) == false) ||
-                        (isPointInsideDistance(v1, v2, e2) == false)) {
-                        continue;
-                    }
-
-                    cutLine.emplace_back(e1, e2);
-                }
-                else {
-                    if (*it == f1) { // start facet
-                        if (((e2 - v1) * dir) > 0.0f)
-                            cutLine.emplace_back(v1, e2);
-                        else
-                            cutLine.emplace_back(v1, e1);
-
-                        //start = it - facets.begin();
-                    }
-
-                    if (*it == f2) { // end facet
-                        if (((e2 - v2) * -dir) > 0.0f)
-                            cutLine.emplace_back(v2, e2);
-                        else
-                            cutLine.emplace_back(v2, e1);
-
-                        //end = it - facets.begin();
-                    }
-                }
-            }
+        cutFacet(kernel->GetFacet(*it), *it, v1, f1, v2, f2, vd, cutLine);
+    }
+
+    return connectLines(cutLine, v1, v2, polyline);
+}
+
+bool MeshProjection::projectLineOnMesh(const Base::Vector3f& v1, unsigned long f1,
+                                       const Base::Vector3f& v2, unsigned long f2,
+                                       const Base::Vector3f& vd,
+                                       std::vector<Base::Vector3f>& polyline)
+{
+    if (!chunks)
+        return false;
+
+    // special case: start and endpoint inside same facet
+    if (f1 == f2) {
+        polyline.push_back(v1);
+        polyline.push_back(v2);
+        return true;
+    }
+
+    // cut the facets of all chunks between the two endpoints
+    std::list< std::pair<Base::Vector3f, Base::Vector3f> > cutLine;
+    for (unsigned long c = 0; c < chunks->CountChunks(); c++) {
+        if (!bboxInsideRectangle(chunks->GetChunkBoundBox(c), v1, v2, vd))
+            continue;
+        MeshChunk chunk(chunks->GetChunkFile(c));
+        unsigned long offset = chunks->GetChunkOffset(c);
+        unsigned long ctFacets = chunk.CountFacets();
+        for (unsigned long i = 0; i < ctFacets; i++) {
+            cutFacet(chunk.GetFacet(i), offset + i, v1, f1, v2, f2, vd, cutLine);
         }
     }
 
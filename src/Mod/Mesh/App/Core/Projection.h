@@ -41,24 +41,36 @@ namespace MeshCore
 class MeshFacetGrid;
 class MeshKernel;
 class MeshGeomFacet;
+class MeshOutOfCoreKernel;
 
 class MeshExport MeshProjection
 {
 public:
     MeshProjection(const MeshKernel&);
+    MeshProjection(const MeshOutOfCoreKernel&);
     ~MeshProjection();
 
     bool projectLineOnMesh(const MeshFacetGrid& grid, const Base::Vector3f& p1, unsigned long f1,
         const Base::Vector3f& p2, unsigned long f2, const Base::Vector3f& view,
         std::vector<Base::Vector3f>& polyline);
+    /** Projects the line onto an out-of-core mesh. Only the chunks whose bounding
+     * box is touched by the line are mapped into memory. The facet indices are global.
+     */
+    bool projectLineOnMesh(const Base::Vector3f& p1, unsigned long f1,
+        const Base::Vector3f& p2, unsigned long f2, const Base::Vector3f& view,
+        std::vector<Base::Vector3f>& polyline);
 protected:
     bool bboxInsideRectangle (const Base::BoundBox3f& bbox, const Base::Vector3f& p1, const Base::Vector3f& p2, const Base::Vector3f& view) const;
     bool isPointInsideDistance (const Base::Vector3f& p1, const Base::Vector3f& p2, const Base::Vector3f& pt) const;
     bool connectLines(std::list< std::pair<Base::Vector3f, Base::Vector3f> >& cutLines, const Base::Vector3f& startPoint,
         const Base::Vector3f& endPoint, std::vector<Base::Vector3f>& polyline) const;
+    void cutFacet(const MeshGeomFacet& tria, unsigned long index, const Base::Vector3f& p1, unsigned long f1,
+        const Base::Vector3f& p2, unsigned long f2, const Base::Vector3f& view,
+        std::list< std::pair<Base::Vector3f, Base::Vector3f> >& cutLines) const;
 
 private:
-    const MeshKernel& kernel;
+    const MeshKernel* kernel;
+    const MeshOutOfCoreKernel* chunks;
 };
 
 } // namespace MeshCore
@@ -9,7 +9,11 @@
 // * Comment out printf statements
 // * Fix compiler warnings
 // * Remove macros loop,i,j,k
+// * Add locked vertices that are never moved or removed
+// * Add constraint quadrics to preserve feature edges
+// * Keep the user id of a vertex when compacting the mesh
 
+#include <cfloat>
 #include <vector>
 #include <Base/Vector3D.h>
 
@@ -84,7 +88,10 @@ class Simplify
 {
 public:
     struct Triangle { int v[3];double err[4];int deleted,dirty;vec3f n; };
-    struct Vertex { vec3f p;int tstart,tcount;SymmetricMatrix q;int border;};
+    // locked : the vertex is neither moved nor removed
+    // id     : user data, e.g. the index of the vertex in the original mesh
+    // c      : constraint quadric that is added to the plane quadrics
+    struct Vertex { vec3f p;int tstart,tcount;SymmetricMatrix q;int border;int locked;int id;SymmetricMatrix c;};
     struct Ref { int tid,tvertex; }; 
     std::vector<Triangle> triangles;
     std::vector<Vertex> vertices;
@@ -348,7 +355,7 @@ void Simplify::update_mesh(int iteration)
     if (iteration == 0)
     {
         for (std::size_t i=0;i<vertices.size();++i)
-            vertices[i].q=SymmetricMatrix(0.0);
+            vertices[i].q=vertices[i].c;
 
         for (std::size_t i=0;i<triangles.size();++i)
         {
@@ -480,6 +487,7 @@ void Simplify::compact_mesh()
         {
             vertices[i].tstart=dst;
             vertices[dst].p=vertices[i].p;
+            vertices[dst].id=vertices[i].id;
             dst++;
         }
     }
@@ -536,6 +544,10 @@ double Simplify::calculate_error(int id_v1, int id_v2, vec3f &p_result)
         if (error3 == error)
             p_result=p3;
     }
+
+    // edges at locked vertices are never collapsed
+    if (vertices[id_v1].locked || vertices[id_v2].locked)
+        error = DBL_MAX;
     return error;
 }
 
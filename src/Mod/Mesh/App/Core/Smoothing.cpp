@@ -25,12 +25,15 @@
 #ifndef _PreComp_
 #endif
 
+#include <QThread>
+
 #include "Smoothing.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
 #include "Elements.h"
 #include "Iterator.h"
 #include "Approximation.h"
+#include "Functional.h"
 
 
 using namespace MeshCore;
@@ -171,7 +174,7 @@ void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<
 }
 
 LaplaceSmoothing::LaplaceSmoothing(MeshKernel& m)
-  : AbstractSmoothing(m), lambda(0.6307)
+  : AbstractSmoothing(m), lambda(0.6307), parallel(false)
 {
 }
 
@@ -179,95 +182,174 @@ LaplaceSmoothing::~LaplaceSmoothing()
 {
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize)
+void LaplaceSmoothing::Initialize(const std::vector<unsigned long>* point_indices)
 {
+    const MeshCore::MeshIndexRows& vv_it = kernel.GetPointToPoints();
+    const MeshCore::MeshIndexRows& vf_it = kernel.GetPointToFacets();
     const MeshCore::MeshPointArray& points = kernel.GetPoints();
-    MeshCore::MeshPointArray::_TConstIterator v_it,
-    v_beg = points.begin(), v_end = points.end();
+    unsigned long count = kernel.CountPoints();
+
+    // the coordinates are kept as separate arrays for the whole run
+    px.resize(count);
+    py.resize(count);
+    pz.resize(count);
+    for (unsigned long pos = 0; pos < count; pos++) {
+        px[pos] = points[pos].x;
+        py[pos] = points[pos].y;
+        pz[pos] = points[pos].z;
+    }
+
+    active.clear();
+    neighbours.clear();
+    offsets.clear();
+    offsets.push_back(0);
 
-    unsigned long pos = 0;
-    for (v_it = points.begin(); v_it != v_end; ++v_it,++pos) {
-        const std::set<unsigned long>& cv = vv_it[pos];
-        if (cv.size() < 3)
+    // in parallel mode a point must not be moved twice in one step
+    std::vector<bool> taken;
+    if (parallel)
+        taken.resize(count, false);
+
+    unsigned long num = point_indices ? static_cast<unsigned long>(point_indices->size()) : count;
+    for (unsigned long i = 0; i < num; i++) {
+        unsigned long pos = point_indices ? (*point_indices)[i] : i;
+        if (pos >= count)
             continue;
-        if (cv.size() != vf_it[pos].size()) {
+        if (parallel) {
+            if (taken[pos])
+                continue;
+            taken[pos] = true;
+        }
+        unsigned long n_count = vv_it.Count(pos);
+        if (n_count < 3)
+            continue;
+        if (n_count != vf_it.Count(pos)) {
             // do nothing for border points
             continue;
         }
 
-        size_t n_count = cv.size();
-        double w;
-        w=1.0/double(n_count);
+        active.push_back(pos);
+        neighbours.insert(neighbours.end(), vv_it.Begin(pos), vv_it.End(pos));
+        offsets.push_back(static_cast<unsigned long>(neighbours.size()));
+    }
+
+    if (parallel) {
+        qx.resize(active.size());
+        qy.resize(active.size());
+        qz.resize(active.size());
+    }
+}
+
+void LaplaceSmoothing::Umbrella(double stepsize)
+{
+    if (parallel) {
+        ParallelUmbrella(stepsize);
+        return;
+    }
+
+    // The points are updated in place in the same order as they are visited, so a
+    // point is moved towards neighbours that may have been moved already in this step.
+    std::size_t count = active.size();
+    for (std::size_t i = 0; i < count; i++) {
+        unsigned long pos = active[i];
+        unsigned long first = offsets[i], last = offsets[i+1];
+        double w = 1.0/double(last - first);
 
         double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
-        for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
-            delx += w*static_cast<double>((v_beg[*cv_it]).x-v_it->x);
-            dely += w*static_cast<double>((v_beg[*cv_it]).y-v_it->y);
-            delz += w*static_cast<double>((v_beg[*cv_it]).z-v_it->z);
+        for (unsigned long k = first; k < last; k++) {
+            unsigned long nb = neighbours[k];
+            delx += w*static_cast<double>(px[nb]-px[pos]);
+            dely += w*static_cast<double>(py[nb]-py[pos]);
+            delz += w*static_cast<double>(pz[nb]-pz[pos]);
         }
 
-        float x = static_cast<float>(static_cast<double>(v_it->x)+stepsize*delx);
-        float y = static_cast<float>(static_cast<double>(v_it->y)+stepsize*dely);
-        float z = static_cast<float>(static_cast<double>(v_it->z)+stepsize*delz);
-        kernel.SetPoint(pos,x,y,z);
+        px[pos] = static_cast<float>(static_cast<double>(px[pos])+stepsize*delx);
+        py[pos] = static_cast<float>(static_cast<double>(py[pos])+stepsize*dely);
+        pz[pos] = static_cast<float>(static_cast<double>(pz[pos])+stepsize*delz);
     }
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize,
-                                const std::vector<unsigned long>& point_indices)
+void LaplaceSmoothing::ParallelUmbrella(double stepsize)
 {
-    const MeshCore::MeshPointArray& points = kernel.GetPoints();
-    MeshCore::MeshPointArray::_TConstIterator v_beg = points.begin();
+    std::size_t count = active.size();
+    if (count == 0)
+        return;
+
+    int threads = QThread::idealThreadCount();
+    const unsigned long* act = &active[0];
+    const unsigned long* off = &offsets[0];
+    const unsigned long* nbs = neighbours.empty() ? 0 : &neighbours[0];
+    float* x = &px[0];
+    float* y = &py[0];
+    float* z = &pz[0];
+    float* nx = &qx[0];
+    float* ny = &qy[0];
+    float* nz = &qz[0];
+
+    // compute the new positions from the positions of the previous step only
+    MeshCore::parallel_blocks(count, [=](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            unsigned long pos = act[i];
+            unsigned long first = off[i], last = off[i+1];
+            double w = 1.0/double(last - first);
+
+            double delx=0.0,dely=0.0,delz=0.0;
+            for (unsigned long k = first; k < last; k++) {
+                unsigned long nb = nbs[k];
+                delx += w*static_cast<double>(x[nb]-x[pos]);
+                dely += w*static_cast<double>(y[nb]-y[pos]);
+                delz += w*static_cast<double>(z[nb]-z[pos]);
+            }
 
-    for (std::vector<unsigned long>::const_iterator pos = point_indices.begin(); pos != point_indices.end(); ++pos) {
-        const std::set<unsigned long>& cv = vv_it[*pos];
-        if (cv.size() < 3)
-            continue;
-        if (cv.size() != vf_it[*pos].size()) {
-            // do nothing for border points
-            continue;
+            nx[i] = static_cast<float>(static_cast<double>(x[pos])+stepsize*delx);
+            ny[i] = static_cast<float>(static_cast<double>(y[pos])+stepsize*dely);
+            nz[i] = static_cast<float>(static_cast<double>(z[pos])+stepsize*delz);
         }
-
-        size_t n_count = cv.size();
-        double w;
-        w=1.0/double(n_count);
-
-        double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
-        for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
-            delx += w*static_cast<double>((v_beg[*cv_it]).x-(v_beg[*pos]).x);
-            dely += w*static_cast<double>((v_beg[*cv_it]).y-(v_beg[*pos]).y);
-            delz += w*static_cast<double>((v_beg[*cv_it]).z-(v_beg[*pos]).z);
+    }, threads);
+
+    // the active points are distinct, so the blocks write to different points
+    MeshCore::parallel_blocks(count, [=](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            unsigned long pos = act[i];
+            x[pos] = nx[i];
+            y[pos] = ny[i];
+            z[pos] = nz[i];
         }
+    }, threads);
+}
 
-        float x = static_cast<float>(static_cast<double>((v_beg[*pos]).x)+stepsize*delx);
-        float y = static_cast<float>(static_cast<double>((v_beg[*pos]).y)+stepsize*dely);
-        float z = static_cast<float>(static_cast<double>((v_beg[*pos]).z)+stepsize*delz);
-        kernel.SetPoint(*pos,x,y,z);
+void LaplaceSmoothing::Finish()
+{
+    for (std::vector<unsigned long>::const_iterator it = active.begin(); it != active.end(); ++it) {
+        kernel.SetPoint(*it, px[*it], py[*it], pz[*it]);
     }
+
+    std::vector<unsigned long>().swap(active);
+    std::vector<unsigned long>().swap(offsets);
+    std::vector<unsigned long>().swap(neighbours);
+    std::vector<float>().swap(px);
+    std::vector<float>().swap(py);
+    std::vector<float>().swap(pz);
+    std::vector<float>().swap(qx);
+    std::vector<float>().swap(qy);
+    std::vector<float>().swap(qz);
 }
 
 void LaplaceSmoothing::Smooth(unsigned int iterations)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
-
+    Initialize(0);
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda);
+        Umbrella(lambda);
     }
+    Finish();
 }
 
 void LaplaceSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
-
+    Initialize(&point_indices);
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda, point_indices);
+        Umbrella(lambda);
     }
+    Finish();
 }
 
 TaubinSmoothing::TaubinSmoothing(MeshKernel& m)
@@ -281,26 +363,28 @@ TaubinSmoothing::~TaubinSmoothing()
 
 void TaubinSmoothing::Smooth(unsigned int iterations)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    Initialize(0);
 
     // Theoretically Taubin does not shrink the surface
     iterations = (iterations+1)/2; // two steps per iteration
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda);
-        Umbrella(vv_it, vf_it, -(lambda+micro));
+        Umbrella(lambda);
+        Umbrella(-(lambda+micro));
     }
+
+    Finish();
 }
 
 void TaubinSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    Initialize(&point_indices);
 
     // Theoretically Taubin does not shrink the surface
     iterations = (iterations+1)/2; // two steps per iteration
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda, point_indices);
-        Umbrella(vv_it, vf_it, -(lambda+micro), point_indices);
+        Umbrella(lambda);
+        Umbrella(-(lambda+micro));
     }
+
+    Finish();
 }
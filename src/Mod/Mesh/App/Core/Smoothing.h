@@ -81,16 +81,41 @@ public:
     void Smooth(unsigned int);
     void SmoothPoints(unsigned int, const std::vector<unsigned long>&);
     void SetLambda(double l) { lambda = l;}
+    /** By default the points of a step are moved one after another, so a point
+     * already sees the new positions of the points before it (Gauss-Seidel).
+     * If \a on is true the new positions of all points are computed in parallel
+     * from the positions of the previous step (Jacobi). This gives slightly
+     * different results and usually needs more iterations for the same smoothness.
+     */
+    void SetParallel(bool on) { parallel = on;}
 
 protected:
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double);
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double,
-                  const std::vector<unsigned long>&);
+    /** Copies the coordinates and collects the neighbourhood of the points to be
+     * smoothed. If \a point_indices is null all points are taken. Border points and
+     * points with less than three neighbours are skipped.
+     */
+    void Initialize(const std::vector<unsigned long>* point_indices);
+    /** Moves all collected points by \a stepsize towards the centre of their
+     * neighbours. The points are moved one after another in the order they were
+     * collected, so each point already sees the new positions of the points before it.
+     * In parallel mode all new positions are computed from the previous step.
+     */
+    void Umbrella(double stepsize);
+    /** The parallel version of Umbrella(). */
+    void ParallelUmbrella(double stepsize);
+    /** Writes the smoothed coordinates back to the mesh and releases the buffers. */
+    void Finish();
 
 protected:
     double lambda;
+    bool parallel;
+
+private:
+    std::vector<unsigned long> active;      /**< Points to be smoothed. */
+    std::vector<unsigned long> offsets;     /**< Start of the neighbours of each active point. */
+    std::vector<unsigned long> neighbours;  /**< Neighbour points of all active points. */
+    std::vector<float> px, py, pz;          /**< Coordinates of all points. */
+    std::vector<float> qx, qy, qz;          /**< New coordinates of the active points in parallel mode. */
 };
 
 class MeshExport TaubinSmoothing : public LaplaceSmoothing
@@ -68,6 +68,11 @@ bool MeshTopoAlgorithm::InsertVertex(unsigned long ulFacetPos, const Base::Vecto
   if ( ulPtInd < ulPtCnt )
     return false; // the given point is already part of the mesh => creating new facets would be an illegal operation
 
+  std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
+  aclOld.push_back(std::make_pair(ulFacetPos, rclF));
+  aclOld.push_back(std::make_pair(ulSize, MeshFacet()));
+  aclOld.push_back(std::make_pair(ulSize+1, MeshFacet()));
+
   // adjust the facets
   //
   // first new facet
@@ -97,6 +102,7 @@ bool MeshTopoAlgorithm::InsertVertex(unsigned long ulFacetPos, const Base::Vecto
   // insert new facets
   _rclMesh._aclFacetArray.push_back(clNewFacet1);
   _rclMesh._aclFacetArray.push_back(clNewFacet2);
+  _rclMesh.UpdateTopology(aclOld);
 
   return true;
 }
@@ -133,7 +139,10 @@ bool MeshTopoAlgorithm::SnapVertex(unsigned long ulFacetPos, const Base::Vector3
         cTria._aulPoints[2] = rFace._aulPoints[i];
         cTria._aulNeighbours[1] = ulFacetPos;
         rFace._aulNeighbours[i] = _rclMesh.CountFacets();
+        std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
+        aclOld.push_back(std::make_pair(_rclMesh.CountFacets(), MeshFacet()));
         _rclMesh._aclFacetArray.push_back(cTria);
+        _rclMesh.UpdateTopology(aclOld);
         return true;
       }
     }
@@ -651,6 +660,10 @@ void MeshTopoAlgorithm::SwapEdge(unsigned long ulFacetPos, unsigned long ulNeigh
     if (uFSide == USHRT_MAX || uNSide == USHRT_MAX) 
         return; // not neighbours
 
+    std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
+    aclOld.push_back(std::make_pair(ulFacetPos, rclF));
+    aclOld.push_back(std::make_pair(ulNeighbour, rclN));
+
     // adjust the neighbourhood
     if (rclF._aulNeighbours[(uFSide+1)%3] != ULONG_MAX)
         _rclMesh._aclFacetArray[rclF._aulNeighbours[(uFSide+1)%3]].ReplaceNeighbour(ulFacetPos, ulNeighbour);
@@ -664,6 +677,8 @@ void MeshTopoAlgorithm::SwapEdge(unsigned long ulFacetPos, unsigned long ulNeigh
     rclN._aulNeighbours[uNSide] = rclF._aulNeighbours[(uFSide+1)%3];
     rclF._aulNeighbours[(uFSide+1)%3] = ulNeighbour;
     rclN._aulNeighbours[(uNSide+1)%3] = ulFacetPos;
+
+    _rclMesh.UpdateTopology(aclOld);
 }
 
 bool MeshTopoAlgorithm::SplitEdge(unsigned long ulFacetPos, unsigned long ulNeighbour, const Base::Vector3f& rP)
@@ -686,6 +701,12 @@ bool MeshTopoAlgorithm::SplitEdge(unsigned long ulFacetPos, unsigned long ulNeig
     if (uPtInd < uPtCnt)
         return false;
 
+    std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
+    aclOld.push_back(std::make_pair(ulFacetPos, rclF));
+    aclOld.push_back(std::make_pair(ulNeighbour, rclN));
+    aclOld.push_back(std::make_pair(ulSize, MeshFacet()));
+    aclOld.push_back(std::make_pair(ulSize+1, MeshFacet()));
+
     // adjust the neighbourhood
     if (rclF._aulNeighbours[(uFSide+1)%3] != ULONG_MAX)
         _rclMesh._aclFacetArray[rclF._aulNeighbours[(uFSide+1)%3]].ReplaceNeighbour(ulFacetPos, ulSize);
@@ -716,6 +737,7 @@ bool MeshTopoAlgorithm::SplitEdge(unsigned long ulFacetPos, unsigned long ulNeig
     // insert new facets
     _rclMesh._aclFacetArray.push_back(cNew1);
     _rclMesh._aclFacetArray.push_back(cNew2);
+    _rclMesh.UpdateTopology(aclOld);
 
     return true;
 }
@@ -733,6 +755,10 @@ void MeshTopoAlgorithm::SplitOpenEdge(unsigned long ulFacetPos, unsigned short u
     if (uPtInd < uPtCnt)
         return; // the given point is already part of the mesh => creating new facets would be an illegal operation
 
+    std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
+    aclOld.push_back(std::make_pair(ulFacetPos, rclF));
+    aclOld.push_back(std::make_pair(ulSize, MeshFacet()));
+
     // adjust the neighbourhood
     if (rclF._aulNeighbours[(uSide+1)%3] != ULONG_MAX)
         _rclMesh._aclFacetArray[rclF._aulNeighbours[(uSide+1)%3]].ReplaceNeighbour(ulFacetPos, ulSize);
@@ -751,6 +777,7 @@ void MeshTopoAlgorithm::SplitOpenEdge(unsigned long ulFacetPos, unsigned short u
 
     // insert new facets
     _rclMesh._aclFacetArray.push_back(cNew);
+    _rclMesh.UpdateTopology(aclOld);
 }
 
 bool MeshTopoAlgorithm::Vertex_Less::operator ()(const Base::Vector3f& u,
@@ -878,6 +905,9 @@ bool MeshTopoAlgorithm::CollapseVertex(const VertexCollapse& vc)
         }
     }
 
+    std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
+    aclOld.push_back(std::make_pair(vc._circumFacets[0], rFace1));
+
     // adjust point and neighbour indices
     rFace1.Transpose(vc._point, ptIndex);
     rFace1.ReplaceNeighbour(vc._circumFacets[1], neighbour1);
@@ -896,6 +926,7 @@ bool MeshTopoAlgorithm::CollapseVertex(const VertexCollapse& vc)
     rFace2.SetInvalid();
     rFace3.SetInvalid();
     _rclMesh._aclPointArray[vc._point].SetInvalid();
+    _rclMesh.UpdateTopology(aclOld);
 
     _needsCleanup = true;
 
@@ -922,9 +953,11 @@ bool MeshTopoAlgorithm::CollapseEdge(unsigned long ulFacetPos, unsigned long ulN
 
   // get all facets this point is referenced by
   std::vector<unsigned long> aRefs = GetFacetsToPoint(ulFacetPos, ulPointPos);
+  std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
   for ( std::vector<unsigned long>::iterator it = aRefs.begin(); it != aRefs.end(); ++it )
   {
     MeshFacet& rFace = _rclMesh._aclFacetArray[*it];
+    aclOld.push_back(std::make_pair(*it, rFace));
     rFace.Transpose( ulPointPos, ulPointNew );
   }
 
@@ -948,6 +981,7 @@ bool MeshTopoAlgorithm::CollapseEdge(unsigned long ulFacetPos, unsigned long ulN
   rclN._aulNeighbours[2] = ULONG_MAX;
   rclN.SetInvalid();
   _rclMesh._aclPointArray[ulPointPos].SetInvalid();
+  _rclMesh.UpdateTopology(aclOld);
 
   _needsCleanup = true;
 
@@ -1034,12 +1068,15 @@ bool MeshTopoAlgorithm::CollapseEdge(const EdgeCollapse& ec)
         }
     }
 
+    std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
     for (it = ec._changeFacets.begin(); it != ec._changeFacets.end(); ++it) {
         MeshFacet& f = _rclMesh._aclFacetArray[*it];
+        aclOld.push_back(std::make_pair(*it, f));
         f.Transpose(ec._fromPoint, ec._toPoint);
     }
 
     _rclMesh._aclPointArray[ec._fromPoint].SetInvalid();
+    _rclMesh.UpdateTopology(aclOld);
 
     _needsCleanup = true;
     return true;
@@ -1061,15 +1098,18 @@ bool MeshTopoAlgorithm::CollapseFacet(unsigned long ulFacetPos)
     _rclMesh._aclPointArray[ulPointInd0] = cCenter;
 
     // set the new point indices for all facets that share one of the points to be deleted
+    std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
     std::vector<unsigned long> aRefs = GetFacetsToPoint(ulFacetPos, ulPointInd1);
     for (std::vector<unsigned long>::iterator it = aRefs.begin(); it != aRefs.end(); ++it) {
         MeshFacet& rFace = _rclMesh._aclFacetArray[*it];
+        aclOld.push_back(std::make_pair(*it, rFace));
         rFace.Transpose(ulPointInd1, ulPointInd0);
     }
     
     aRefs = GetFacetsToPoint(ulFacetPos, ulPointInd2);
     for (std::vector<unsigned long>::iterator it = aRefs.begin(); it != aRefs.end(); ++it) {
         MeshFacet& rFace = _rclMesh._aclFacetArray[*it];
+        aclOld.push_back(std::make_pair(*it, rFace));
         rFace.Transpose(ulPointInd2, ulPointInd0);
     }
 
@@ -1103,6 +1143,7 @@ bool MeshTopoAlgorithm::CollapseFacet(unsigned long ulFacetPos)
     rclF.SetInvalid();
     _rclMesh._aclPointArray[ulPointInd1].SetInvalid();
     _rclMesh._aclPointArray[ulPointInd2].SetInvalid();
+    _rclMesh.UpdateTopology(aclOld);
 
     _needsCleanup = true;
 
@@ -1250,6 +1291,10 @@ void MeshTopoAlgorithm::SplitNeighbourFacet(unsigned long ulFacetPos, unsigned s
   unsigned long uPtInd = this->GetOrAddIndex(rPoint);
   unsigned long ulSize = _rclMesh._aclFacetArray.size();
 
+  std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
+  aclOld.push_back(std::make_pair(ulNeighbour, rclN));
+  aclOld.push_back(std::make_pair(ulSize, MeshFacet()));
+
   // adjust the neighbourhood
   if (rclN._aulNeighbours[(uNSide+1)%3] != ULONG_MAX)
     _rclMesh._aclFacetArray[rclN._aulNeighbours[(uNSide+1)%3]].ReplaceNeighbour(ulNeighbour, ulSize);
@@ -1268,6 +1313,7 @@ void MeshTopoAlgorithm::SplitNeighbourFacet(unsigned long ulFacetPos, unsigned s
 
   // insert new facet
   _rclMesh._aclFacetArray.push_back(cNew);
+  _rclMesh.UpdateTopology(aclOld);
 }
 
 #if 0
@@ -1335,6 +1381,10 @@ void MeshTopoAlgorithm::RemoveDegeneratedFacet(unsigned long index)
         MeshFacet& rNb = _rclMesh._aclFacetArray[uN1];
         unsigned short side = rNb.Side(index);
 
+        std::vector<std::pair<unsigned long, MeshFacet> > aclOld;
+        aclOld.push_back(std::make_pair(index, rFace));
+        aclOld.push_back(std::make_pair(uN1, rNb));
+
         // bend the point indices
         rFace._aulPoints[(j+2)%3] = rNb._aulPoints[(side+2)%3];
         rNb._aulPoints[(side+1)%3] = rFace._aulPoints[j];
@@ -1352,6 +1402,7 @@ void MeshTopoAlgorithm::RemoveDegeneratedFacet(unsigned long index)
         }
         rNb._aulNeighbours[(side+1)%3] = index;
         rFace._aulNeighbours[(j+2)%3] = uN1;
+        _rclMesh.UpdateTopology(aclOld);
       }
       else
         _rclMesh.DeleteFacet(index);
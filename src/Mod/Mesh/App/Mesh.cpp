@@ -37,8 +37,10 @@
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
 #include <Base/ViewProj.h>
+#include <QMutexLocker>
 
 #include "Core/Builder.h"
+#include "Core/BVH.h"
 #include "Core/MeshKernel.h"
 #include "Core/Grid.h"
 #include "Core/Iterator.h"
@@ -64,23 +66,24 @@ float MeshObject::Epsilon = 1.0e-5f;
 TYPESYSTEM_SOURCE(Mesh::MeshObject, Data::ComplexGeoData)
 
 MeshObject::MeshObject()
+  : _facetTreeVersion(0)
 {
 }
 
 MeshObject::MeshObject(const MeshCore::MeshKernel& Kernel)
-  : _kernel(Kernel)
+  : _kernel(Kernel), _facetTreeVersion(0)
 {
     // copy the mesh structure
 }
 
 MeshObject::MeshObject(const MeshCore::MeshKernel& Kernel, const Base::Matrix4D &Mtrx)
-  : _Mtrx(Mtrx),_kernel(Kernel)
+  : _Mtrx(Mtrx),_kernel(Kernel),_facetTreeVersion(0)
 {
     // copy the mesh structure
 }
 
 MeshObject::MeshObject(const MeshObject& mesh)
-  : _Mtrx(mesh._Mtrx),_kernel(mesh._kernel)
+  : _Mtrx(mesh._Mtrx),_kernel(mesh._kernel),_facetTreeVersion(0)
 {
     // copy the mesh structure
     copySegments(mesh);
@@ -773,6 +776,20 @@ std::vector<unsigned long> MeshObject::getPointsFromFacets(const std::vector<uns
     return _kernel.GetFacetPoints(facets);
 }
 
+std::shared_ptr<const MeshCore::MeshFacetBVH> MeshObject::getFacetTree() const
+{
+    QMutexLocker locker(&_facetTreeMutex);
+    unsigned long version = _kernel.GetGeometryVersion();
+    if (!_facetTree || _facetTreeVersion != version) {
+        // release the outdated tree before building the new one
+        _facetTree.reset();
+        _facetTree = std::make_shared<MeshCore::MeshFacetBVH>(_kernel);
+        _facetTreeVersion = version;
+    }
+
+    return _facetTree;
+}
+
 void MeshObject::updateMesh(const std::vector<unsigned long>& facets)
 {
     std::vector<unsigned long> points;
@@ -985,15 +1002,17 @@ void MeshObject::smooth(int iterations, float d_max)
     _kernel.Smooth(iterations, d_max);
 }
 
-void MeshObject::decimate(float fTolerance, float fReduction)
+void MeshObject::decimate(float fTolerance, float fReduction, float fFeatureAngle)
 {
     MeshCore::MeshSimplify dm(this->_kernel);
+    dm.setFeatureAngle(fFeatureAngle);
     dm.simplify(fTolerance, fReduction);
 }
 
-void MeshObject::decimate(int targetSize)
+void MeshObject::decimate(int targetSize, float fFeatureAngle)
 {
     MeshCore::MeshSimplify dm(this->_kernel);
+    dm.setFeatureAngle(fFeatureAngle);
     dm.simplify(targetSize);
 }
 
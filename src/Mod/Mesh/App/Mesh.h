@@ -26,9 +26,11 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <set>
 #include <string>
 #include <map>
+#include <QMutex>
 
 #include <Base/Matrix.h>
 #include <Base/Vector3D.h>
@@ -56,6 +58,7 @@ namespace Base {
 
 namespace MeshCore {
 class AbstractPolygonTriangulator;
+class MeshFacetBVH;
 }
 
 namespace Mesh
@@ -134,6 +137,11 @@ public:
     virtual void getFaces(std::vector<Base::Vector3d> &Points,std::vector<Facet> &Topo,
         float Accuracy, uint16_t flags=0) const;
     std::vector<unsigned long> getPointsFromFacets(const std::vector<unsigned long>& facets) const;
+    /** Returns the bounding volume hierarchy of the facets for ray and closest point
+     * queries. It's built on first use and shared by all queries until the mesh changes.
+     * The tree is in the coordinate system of the kernel, i.e. without the placement.
+     */
+    std::shared_ptr<const MeshCore::MeshFacetBVH> getFacetTree() const;
     //@}
 
     void setKernel(const MeshCore::MeshKernel& m);
@@ -216,8 +224,12 @@ public:
     void movePoint(unsigned long, const Base::Vector3d& v);
     void setPoint(unsigned long, const Base::Vector3d& v);
     void smooth(int iterations, float d_max);
-    void decimate(float fTolerance, float fReduction);
-    void decimate(int targetSize);
+    /** Reduces the mesh by up to \a fReduction while the error stays below \a fTolerance.
+     * Edges with adjacent facets enclosing an angle above \a fFeatureAngle are preserved.
+     */
+    void decimate(float fTolerance, float fReduction, float fFeatureAngle = 0.0f);
+    /** Reduces the mesh to about \a targetSize facets. */
+    void decimate(int targetSize, float fFeatureAngle = 0.0f);
     Base::Vector3d getPointNormal(unsigned long) const;
     std::vector<Base::Vector3d> getPointNormals() const;
     void crossSections(const std::vector<TPlane>&, std::vector<TPolylines> &sections,
@@ -394,6 +406,9 @@ private:
     Base::Matrix4D _Mtrx;
     MeshCore::MeshKernel _kernel;
     std::vector<Segment> _segments;
+    mutable std::shared_ptr<const MeshCore::MeshFacetBVH> _facetTree;
+    mutable unsigned long _facetTreeVersion;
+    mutable QMutex _facetTreeMutex;
     static float Epsilon;
 };
 
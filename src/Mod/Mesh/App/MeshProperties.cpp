@@ -33,10 +33,12 @@
 #include <Base/Reader.h>
 #include <Base/Stream.h>
 #include <Base/VectorPy.h>
+#include <App/PropertyDelta.h>
 
 #include "Core/MeshKernel.h"
 #include "Core/MeshIO.h"
 #include "Core/Iterator.h"
+#include "Core/Evaluation.h"
 
 #include "MeshProperties.h"
 #include "Mesh.h"
@@ -451,6 +453,8 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
     // before calling hasSetValue()
     Base::Reference<MeshObject> tmp(_meshObject);
     aboutToSetValue();
+    _loader.reset();
+    _shared.reset();
     _meshObject = mesh;
     hasSetValue();
 }
@@ -458,6 +462,8 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
 void PropertyMeshKernel::setValue(const MeshObject& mesh)
 {
     aboutToSetValue();
+    _loader.reset();
+    detach(false);
     *_meshObject = mesh;
     hasSetValue();
 }
@@ -465,46 +471,57 @@ void PropertyMeshKernel::setValue(const MeshObject& mesh)
 void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 {
     aboutToSetValue();
+    _loader.reset();
+    detach(false);
     _meshObject->setKernel(mesh);
     hasSetValue();
 }
 
 void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 {
+    restoreLazily();
     aboutToSetValue();
+    detach();
     _meshObject->swap(mesh);
     hasSetValue();
 }
 
 void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 {
+    restoreLazily();
     aboutToSetValue();
+    detach();
     _meshObject->swap(mesh);
     hasSetValue();
 }
 
 const MeshObject& PropertyMeshKernel::getValue(void)const 
 {
+    restoreLazily();
     return *_meshObject;
 }
 
 const MeshObject* PropertyMeshKernel::getValuePtr(void)const 
 {
+    restoreLazily();
     return (MeshObject*)_meshObject;
 }
 
 const Data::ComplexGeoData* PropertyMeshKernel::getComplexData() const
 {
+    restoreLazily();
     return (MeshObject*)_meshObject;
 }
 
 Base::BoundBox3d PropertyMeshKernel::getBoundingBox() const
 {
+    restoreLazily();
     return _meshObject->getBoundBox();
 }
 
 unsigned int PropertyMeshKernel::getMemSize (void) const
 {
+    restoreLazily();
     unsigned int size = 0;
     size += _meshObject->getMemSize();
     
@@ -513,7 +530,9 @@ unsigned int PropertyMeshKernel::getMemSize (void) const
 
 MeshObject* PropertyMeshKernel::startEditing()
 {
+    restoreLazily();
     aboutToSetValue();
+    detach();
     return (MeshObject*)_meshObject;
 }
 
@@ -524,14 +543,18 @@ void PropertyMeshKernel::finishEditing()
 
 void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    restoreLazily();
     aboutToSetValue();
+    detach();
     _meshObject->transformGeometry(rclMat);
     hasSetValue();
 }
 
 void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned long, Base::Vector3f> >& inds)
 {
+    restoreLazily();
     aboutToSetValue();
+    detach();
     MeshCore::MeshKernel& kernel = _meshObject->getKernel();
     for (std::vector<std::pair<unsigned long, Base::Vector3f> >::const_iterator it = inds.begin(); it != inds.end(); ++it)
         kernel.SetPoint(it->first, it->second);
@@ -540,6 +563,7 @@ void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned lo
 
 PyObject *PropertyMeshKernel::getPyObject(void)
 {
+    restoreLazily();
     if (!meshPyObject) {
         meshPyObject = new MeshPy(&*_meshObject);
         meshPyObject->setConst(); // set immutable
@@ -575,6 +599,7 @@ void PropertyMeshKernel::setPyObject(PyObject *value)
 
 void PropertyMeshKernel::Save (Base::Writer &writer) const
 {
+    restoreLazily();
     if (writer.isForceXML()) {
         writer.Stream() << writer.ind() << "<Mesh>" << std::endl;
         MeshCore::MeshOutput saver(_meshObject->getKernel());
@@ -603,6 +628,7 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
         kernel.Adopt(points, facets);
 
         aboutToSetValue();
+        detach(false);
         _meshObject->getKernel().Adopt(points, facets);
         hasSetValue();
     } 
@@ -614,18 +640,163 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
 
 void PropertyMeshKernel::SaveDocFile (Base::Writer &writer) const
 {
+    restoreLazily();
+    if (_loader && _loader->isPending()) {
+        // don't replace the data in the project file that couldn't be read
+        writer.addError(std::string("Cannot save '") + getName() + "' because its data couldn't be loaded");
+        return;
+    }
     _meshObject->save(writer.Stream());
 }
 
 void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
 {
+    _loader.reset();
     aboutToSetValue();
+    detach(false);
     _meshObject->load(reader);
     hasSetValue();
 }
 
+std::function<void()> PropertyMeshKernel::RestoreDocFileInThread(Base::Reader &reader)
+{
+    std::shared_ptr<MeshCore::MeshKernel> kernel(new MeshCore::MeshKernel);
+    kernel->Read(reader);
+
+    // the same checks as MeshObject::load() but the messages are printed
+    // in the main thread
+    bool neighbours = true, topology = true;
+#ifndef FC_DEBUG
+    try {
+        MeshCore::MeshEvalNeighbourhood nb(*kernel);
+        neighbours = nb.Evaluate();
+        if (!neighbours)
+            kernel->RebuildNeighbours();
+
+        MeshCore::MeshEvalTopology eval(*kernel);
+        topology = eval.Evaluate();
+    }
+    catch (const Base::MemoryException&) {
+        // ignore memory exceptions and continue
+    }
+#endif
+
+    return [this, kernel, neighbours, topology]() {
+        if (!neighbours)
+            Base::Console().Warning("Errors in neighbourhood of mesh found...fixed\n");
+        if (!topology)
+            Base::Console().Warning("The mesh data structure has some defects\n");
+        swapMesh(*kernel);
+    };
+}
+
+bool PropertyMeshKernel::RestoreDocFileLater(const std::shared_ptr<Base::DocFileLoader>& loader)
+{
+    _loader = loader;
+    return true;
+}
+
+void PropertyMeshKernel::restoreLazily() const
+{
+    if (_loader && _loader->isPending()) {
+        MeshObject* mesh = _meshObject;
+        _loader->read([mesh](Base::Reader& reader) {
+            mesh->load(reader);
+        });
+    }
+}
+
+std::shared_ptr<const App::Property> PropertyMeshKernel::Snapshot() const
+{
+    restoreLazily();
+    if (!_shared)
+        _shared = std::make_shared<char>(0);
+    std::shared_ptr<PropertyMeshKernel> prop = std::make_shared<PropertyMeshKernel>();
+    prop->_meshObject = this->_meshObject;
+    prop->_shared = this->_shared;
+    return prop;
+}
+
+namespace Mesh {
+/// Undo/redo record of moved mesh points, see PropertyMeshKernel::Diff()
+class MeshPointsDelta : public App::PropertyArrayDelta<Base::Vector3f>
+{
+public:
+    void apply(App::Property &prop) const
+    {
+        if (!prop.isDerivedFrom(PropertyMeshKernel::getClassTypeId()))
+            throw Base::TypeError("Property type mismatch");
+        PropertyMeshKernel& kernel = static_cast<PropertyMeshKernel&>(prop);
+        check(kernel.getValue().getKernel().GetPoints());
+        std::vector<std::pair<unsigned long, Base::Vector3f> > points;
+        points.reserve(changes.size());
+        for (const auto& it : changes)
+            points.emplace_back(static_cast<unsigned long>(it.first), it.second);
+        kernel.setPointIndices(points);
+    }
+};
+}
+
+App::PropertyDelta *PropertyMeshKernel::Diff(const App::Property &from) const
+{
+    if (!from.isDerivedFrom(PropertyMeshKernel::getClassTypeId()))
+        return 0;
+    restoreLazily();
+    const MeshObject& cur = *this->_meshObject;
+    const MeshObject& old = *static_cast<const PropertyMeshKernel&>(from)._meshObject;
+    if (&cur == &old) {
+        // unchanged, the checksum must still match the current points
+        std::unique_ptr<MeshPointsDelta> delta(new MeshPointsDelta());
+        delta->diff(cur.getKernel().GetPoints(), cur.getKernel().GetPoints());
+        return delta.release();
+    }
+
+    // only moved points are recorded, everything else must be unchanged
+    if (cur.countPoints() != old.countPoints() ||
+        cur.countFacets() != old.countFacets() ||
+        cur.countSegments() != old.countSegments() ||
+        cur.getTransform() != old.getTransform())
+        return 0;
+
+    const MeshCore::MeshFacetArray& curFacets = cur.getKernel().GetFacets();
+    const MeshCore::MeshFacetArray& oldFacets = old.getKernel().GetFacets();
+    for (std::size_t i = 0; i < curFacets.size(); i++) {
+        const MeshCore::MeshFacet& f1 = curFacets[i];
+        const MeshCore::MeshFacet& f2 = oldFacets[i];
+        if (f1._aulPoints[0] != f2._aulPoints[0] ||
+            f1._aulPoints[1] != f2._aulPoints[1] ||
+            f1._aulPoints[2] != f2._aulPoints[2])
+            return 0;
+    }
+
+    for (unsigned long i = 0; i < cur.countSegments(); i++) {
+        const Segment& s1 = cur.getSegment(i);
+        const Segment& s2 = old.getSegment(i);
+        if (s1.getName() != s2.getName() || s1.getIndices() != s2.getIndices())
+            return 0;
+    }
+
+    std::unique_ptr<MeshPointsDelta> delta(new MeshPointsDelta());
+    if (!delta->diff(cur.getKernel().GetPoints(), old.getKernel().GetPoints()))
+        return 0;
+    return delta.release();
+}
+
+void PropertyMeshKernel::detach(bool copy)
+{
+    if (_shared.use_count() > 1) {
+        _meshObject = copy ? new MeshObject(*_meshObject) : new MeshObject();
+        // the Python object refers to the mesh of this property, the snapshot
+        // doesn't keep it alive
+        if (meshPyObject)
+            meshPyObject->setTwinPointer(&*_meshObject);
+    }
+    _shared.reset();
+}
+
 App::Property *PropertyMeshKernel::Copy(void) const
 {
+    restoreLazily();
     // Note: Copy the content, do NOT reference the same mesh object
     PropertyMeshKernel *prop = new PropertyMeshKernel();
     *(prop->_meshObject) = *(this->_meshObject);
@@ -635,8 +806,11 @@ App::Property *PropertyMeshKernel::Copy(void) const
 void PropertyMeshKernel::Paste(const App::Property &from)
 {
     // Note: Copy the content, do NOT reference the same mesh object
-    aboutToSetValue();
     const PropertyMeshKernel& prop = dynamic_cast<const PropertyMeshKernel&>(from);
+    prop.restoreLazily();
+    aboutToSetValue();
+    _loader.reset();
+    detach(false);
     *(this->_meshObject) = *(prop._meshObject);
     hasSetValue();
 }
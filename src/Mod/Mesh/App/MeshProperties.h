@@ -85,6 +85,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
 
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool canSaveDocFileInThread() const {return true;}
     virtual void RestoreDocFile(Base::Reader &reader);
 
     virtual App::Property *Copy(void) const;
@@ -147,6 +148,7 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool canSaveDocFileInThread() const {return true;}
     void RestoreDocFile(Base::Reader &reader);
 
     /** @name Python interface */
@@ -243,15 +245,32 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool canSaveDocFileInThread() const {return true;}
     void RestoreDocFile(Base::Reader &reader);
+    bool canRestoreDocFileInThread() const {return true;}
+    std::function<void()> RestoreDocFileInThread(Base::Reader &reader);
+    bool RestoreDocFileLater(const std::shared_ptr<Base::DocFileLoader>& loader);
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
+    /// returns a snapshot that shares the mesh until it is modified
+    std::shared_ptr<const App::Property> Snapshot() const;
+    /// returns a delta of the moved points if the topology is unchanged
+    App::PropertyDelta *Diff(const App::Property &from) const;
     //@}
 
+private:
+    /// reads the mesh if it was skipped on restore
+    void restoreLazily() const;
+    /// continues with a new mesh if a snapshot still uses the current one
+    void detach(bool copy=true);
+
 private:
     Base::Reference<MeshObject> _meshObject;
     MeshPy* meshPyObject;
+    std::shared_ptr<Base::DocFileLoader> _loader;
+    /// shared with the snapshots that use the same mesh
+    mutable std::shared_ptr<char> _shared;
 };
 
 } // namespace Mesh
@@ -38,6 +38,7 @@
 #include "MeshPy.cpp"
 #include "MeshProperties.h"
 #include "Core/Algorithm.h"
+#include "Core/BVH.h"
 #include "Core/Triangulation.h"
 #include "Core/Iterator.h"
 #include "Core/Degeneration.h"
@@ -817,6 +818,7 @@ PyObject*  MeshPy::setPoint(PyObject *args)
         return NULL;
 
     PY_TRY {
+        MeshPropertyLock lock(this->parentProperty);
         getMeshObjectPtr()->setPoint(index, static_cast<Base::VectorPy*>(pnt)->value());
     } PY_CATCH;
 
@@ -1693,9 +1695,10 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
     int iter=1;
     double lambda = 0;
     double micro = 0;
-    static char* keywords_smooth[] = {"Method","Iteration","Lambda","Micro",NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|sidd",keywords_smooth,
-                                     &method, &iter, &lambda, &micro))
+    PyObject* parallel = Py_False;
+    static char* keywords_smooth[] = {"Method","Iteration","Lambda","Micro","Parallel",NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|siddO!",keywords_smooth,
+                                     &method, &iter, &lambda, &micro, &PyBool_Type, &parallel))
         return 0;
 
     PY_TRY {
@@ -1705,6 +1708,7 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
             MeshCore::LaplaceSmoothing smooth(kernel);
             if (lambda > 0)
                 smooth.SetLambda(lambda);
+            smooth.SetParallel(PyObject_IsTrue(parallel) ? true : false);
             smooth.Smooth(iter);
         }
         else if (strcmp(method, "Taubin") == 0) {
@@ -1713,6 +1717,7 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
                 smooth.SetLambda(lambda);
             if (micro > 0)
                 smooth.SetMicro(micro);
+            smooth.SetParallel(PyObject_IsTrue(parallel) ? true : false);
             smooth.Smooth(iter);
         }
         else if (strcmp(method, "PlaneFit") == 0) {
@@ -1727,12 +1732,17 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
     Py_Return;
 }
 
-PyObject*  MeshPy::decimate(PyObject *args)
+PyObject*  MeshPy::decimate(PyObject *args, PyObject *kwds)
 {
+    // The tolerance form must be tried first to keep the meaning of
+    // decimate(1, 0.5). The feature angle is accepted as keyword only, so
+    // that a second positional argument is always the reduction.
+    float fAngle = 0.0f;
     float fTol, fRed;
-    if (PyArg_ParseTuple(args, "ff", &fTol,&fRed)) {
+    static char* keywords_tol[] = {"tolerance","reduction","featureAngle",NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwds, "ff|$f", keywords_tol, &fTol,&fRed,&fAngle)) {
         PY_TRY {
-            getMeshObjectPtr()->decimate(fTol, fRed);
+            getMeshObjectPtr()->decimate(fTol, fRed, fAngle);
         } PY_CATCH;
 
         Py_Return;
@@ -1740,15 +1750,17 @@ PyObject*  MeshPy::decimate(PyObject *args)
 
     PyErr_Clear();
     int targetSize;
-    if (PyArg_ParseTuple(args, "i", &targetSize)) {
+    static char* keywords_size[] = {"targetSize","featureAngle",NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwds, "i|$f", keywords_size, &targetSize,&fAngle)) {
         PY_TRY {
-            getMeshObjectPtr()->decimate(targetSize);
+            getMeshObjectPtr()->decimate(targetSize, fAngle);
         } PY_CATCH;
 
         Py_Return;
     }
 
-    PyErr_SetString(PyExc_ValueError, "decimate(tolerance=float, reduction=float) or decimate(targetSize=int)");
+    PyErr_SetString(PyExc_ValueError, "decimate(tolerance=float, reduction=float, [featureAngle=float]) "
+                                      "or decimate(targetSize=int, [featureAngle=float])");
     return nullptr;
 }
 
@@ -1772,15 +1784,27 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
 
         unsigned long index = 0;
         Base::Vector3f res;
-        MeshCore::MeshAlgorithm alg(getMeshObjectPtr()->getKernel());
 
 #if 0 // for testing only
+        MeshCore::MeshAlgorithm alg(getMeshObjectPtr()->getKernel());
         MeshCore::MeshFacetGrid grid(getMeshObjectPtr()->getKernel(),10);
         // With grids we might search in the opposite direction, too
         if (alg.NearestFacetOnRay(pnt,  dir, grid, res, index) ||
             alg.NearestFacetOnRay(pnt, -dir, grid, res, index)) {
 #else
-        if (alg.NearestFacetOnRay(pnt, dir, res, index)) {
+        // the ray is regarded as a line, so search in both directions
+        std::shared_ptr<const MeshCore::MeshFacetBVH> tree = getMeshObjectPtr()->getFacetTree();
+        Base::Vector3f res2;
+        unsigned long index2 = 0;
+        bool found = tree->NearestFacetOnRay(pnt, dir, res, index);
+        if (tree->NearestFacetOnRay(pnt, -dir, res2, index2)) {
+            if (!found || Base::DistanceP2(pnt, res2) < Base::DistanceP2(pnt, res)) {
+                res = res2;
+                index = index2;
+                found = true;
+            }
+        }
+        if (found) {
 #endif
             Py::Tuple tuple(3);
             tuple.setItem(0, Py::Float(res.x));
@@ -5,7 +5,7 @@
 #  LGPL
 
 import FreeCAD, os, sys, unittest, Mesh
-import time, tempfile, math
+import time, tempfile, math, struct, random
 # http://python-kurs.eu/threads.php
 try:
     import _thread as thread
@@ -230,3 +230,611 @@ class PolynomialFitCases(unittest.TestCase):
 
     def tearDown(self):
         pass
+
+
+class ReadOnlyStream:
+    """A stream without seek(), so that the files are read sequentially"""
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read(self, size=-1):
+        if size < 0:
+            size = len(self.data) - self.pos
+        chunk = self.data[self.pos:self.pos + size]
+        self.pos += len(chunk)
+        return chunk
+
+
+class LoadMappedFileCases(unittest.TestCase):
+    """Memory-mapped files are decoded in parallel, streams sequentially"""
+    def setUp(self):
+        self.directory = tempfile.mkdtemp()
+
+    def tearDown(self):
+        for f in os.listdir(self.directory):
+            os.remove(os.path.join(self.directory, f))
+        os.rmdir(self.directory)
+
+    def corners(self, mesh):
+        # corner points with the smallest first, independent of the point order
+        result = []
+        for f in mesh.Facets:
+            pts = [tuple(p) for p in f.Points]
+            i = pts.index(min(pts))
+            result.append(tuple(pts[i:] + pts[:i]))
+        return sorted(result)
+
+    def writeSTL(self, name, triangles):
+        with open(name, "wb") as f:
+            f.write(b"\0" * 80)
+            f.write(struct.pack("<I", len(triangles)))
+            for t in triangles:
+                f.write(struct.pack("<3f", 0.0, 0.0, 1.0))
+                for p in t:
+                    f.write(struct.pack("<3f", *p))
+                f.write(struct.pack("<H", 0))
+
+    def writePLY(self, name, points, faces):
+        with open(name, "wb") as f:
+            f.write(b"ply\nformat binary_little_endian 1.0\n")
+            f.write(b"element vertex %d\n" % len(points))
+            f.write(b"property float x\nproperty float y\nproperty float z\n")
+            f.write(b"element face %d\n" % len(faces))
+            f.write(b"property list uchar int vertex_indices\nend_header\n")
+            for p in points:
+                f.write(struct.pack("<3f", *p))
+            for t in faces:
+                f.write(struct.pack("<B3i", 3, *t))
+
+    def testBinarySTL(self):
+        mesh = Mesh.createSphere(1.0, 20)
+        name = os.path.join(self.directory, "sphere.stl")
+        mesh.write(name)
+        mapped = Mesh.Mesh(name)
+        self.assertEqual(mapped.CountPoints, mesh.CountPoints)
+        self.assertEqual(self.corners(mapped), self.corners(mesh))
+
+        # the file object can seek, so the facets are read one by one
+        other = Mesh.Mesh()
+        with open(name, "rb") as f:
+            other.read(Stream=f, Format="STL")
+        self.assertEqual(mapped.Topology, other.Topology)
+
+    def testBinarySTLDuplicatePoints(self):
+        # a quad, the points of the common edge are written twice
+        name = os.path.join(self.directory, "quad.stl")
+        self.writeSTL(name, [((0, 0, 0), (1, 0, 0), (1, 1, 0)),
+                             ((0, 0, 0), (1, 1, 0), (0, 1, 0))])
+        mapped = Mesh.Mesh(name)
+        self.assertEqual(mapped.CountPoints, 4)
+        self.assertEqual(mapped.CountFacets, 2)
+
+        other = Mesh.Mesh()
+        with open(name, "rb") as f:
+            other.read(Stream=f, Format="STL")
+        self.assertEqual(mapped.Topology, other.Topology)
+
+    def testBinaryPLY(self):
+        mesh = Mesh.createSphere(1.0, 20)
+        name = os.path.join(self.directory, "sphere.ply")
+        mesh.write(name)
+        mapped = Mesh.Mesh(name)
+        self.assertEqual(mapped.Topology, mesh.Topology)
+
+    def testBinaryPLYDuplicatePoints(self):
+        # the duplicate of the third point is kept
+        points = [(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0), (1, 1, 0)]
+        faces = [(0, 1, 2), (0, 4, 3)]
+        name = os.path.join(self.directory, "quad.ply")
+        self.writePLY(name, points, faces)
+        mapped = Mesh.Mesh(name)
+        self.assertEqual(mapped.CountPoints, 5)
+        self.assertEqual([tuple(f) for f in mapped.Topology[1]], faces)
+        self.assertEqual([tuple(p) for p in mapped.Topology[0]], points)
+
+    def testNonSeekableStream(self):
+        points = [(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0), (1, 1, 0)]
+        faces = [(0, 1, 2), (0, 4, 3)]
+        name = os.path.join(self.directory, "quad.ply")
+        self.writePLY(name, points, faces)
+        with open(name, "rb") as f:
+            data = f.read()
+        other = Mesh.Mesh()
+        other.read(Stream=ReadOnlyStream(data), Format="PLY")
+        self.assertEqual(other.Topology, Mesh.Mesh(name).Topology)
+
+
+class AsciiOutputCases(unittest.TestCase):
+    """The ASCII writers must give the same bytes as the formatted stream
+    output, i.e. six decimal places like printf("%f")"""
+    def setUp(self):
+        self.directory = tempfile.mkdtemp()
+        # values that round differently, tiny negative ones and huge ones
+        values = [0.0, 1.0, -1e-7, 5e-7, 2.5e-6, 0.1, -0.3, 123456.789, 999999.9999995,
+                  1234567.0, 16777216.0, 3e12, -3e12, 1e-3, -2.0000005, 0.4999995]
+        rnd = random.Random(3)
+        triangles = []
+        for i in range(300):
+            triangles.append([(rnd.choice(values) + rnd.random() * (i % 3),
+                               rnd.choice(values),
+                               rnd.uniform(-200.0, 200.0)) for j in range(3)])
+        self.mesh = Mesh.Mesh(triangles)
+
+    def tearDown(self):
+        for f in os.listdir(self.directory):
+            os.remove(os.path.join(self.directory, f))
+        os.rmdir(self.directory)
+
+    def write(self, name, *args):
+        name = os.path.join(self.directory, name)
+        self.mesh.write(name, *args)
+        with open(name, "rb") as f:
+            return f.read().decode("ascii")
+
+    def colors(self):
+        return [(0.5, 0.25, 1.0) if i % 2 else (0.1, 0.7, 0.0) for i in range(self.mesh.CountPoints)]
+
+    def colorText(self, c):
+        # like (int)(255.0f * c) in single precision
+        return " %d %d %d" % tuple(int(struct.unpack("f", struct.pack("f", 255.0 * struct.unpack("f", struct.pack("f", v))[0]))[0]) for v in c)
+
+    def testSTL(self):
+        lines = ["solid Mesh"]
+        for f in self.mesh.Facets:
+            lines.append("  facet normal %f %f %f" % tuple(f.Normal))
+            lines.append("    outer loop")
+            for p in f.Points:
+                lines.append("      vertex %f %f %f" % tuple(p))
+            lines.append("    endloop")
+            lines.append("  endfacet")
+        lines.append("endsolid Mesh")
+        self.assertEqual(self.write("mesh.ast"), "\n".join(lines) + "\n")
+
+    def testOBJ(self):
+        points, facets = self.mesh.Topology
+        lines = ["# Created by FreeCAD <http://www.freecadweb.org>"]
+        lines += ["v %f %f %f" % tuple(p) for p in points]
+        lines += ["vn %f %f %f" % tuple(f.Normal) for f in self.mesh.Facets]
+        lines += ["f %d//%d %d//%d %d//%d" % (f[0] + 1, i + 1, f[1] + 1, i + 1, f[2] + 1, i + 1)
+                  for i, f in enumerate(facets)]
+        self.assertEqual(self.write("mesh.obj"), "\n".join(lines) + "\n")
+
+        colors = self.colors()
+        lines[1:1 + len(points)] = ["v %f %f %f" % tuple(p) + self.colorText(c) for p, c in zip(points, colors)]
+        self.assertEqual(self.write("color.obj", "OBJ", "Mesh", colors), "\n".join(lines) + "\n")
+
+    def testPLY(self):
+        points, facets = self.mesh.Topology
+        header = ["ply", "format ascii 1.0",
+                  "comment Created by FreeCAD <http://www.freecadweb.org>",
+                  "element vertex %d" % len(points),
+                  "property float32 x", "property float32 y", "property float32 z"]
+        footer = ["element face %d" % len(facets),
+                  "property list uchar int vertex_index", "end_header"]
+        faces = ["3 %d %d %d" % tuple(f) for f in facets]
+        lines = header + footer + ["%f %f %f" % tuple(p) for p in points] + faces
+        self.assertEqual(self.write("mesh.ply", "APLY"), "\n".join(lines) + "\n")
+
+        colors = self.colors()
+        lines = header + ["property uchar red", "property uchar green", "property uchar blue"] + footer
+        lines += ["%f %f %f" % tuple(p) + self.colorText(c) for p, c in zip(points, colors)] + faces
+        self.assertEqual(self.write("color.ply", "APLY", "Mesh", colors), "\n".join(lines) + "\n")
+
+
+class AdjacencyCases(unittest.TestCase):
+    def testSwapEdges(self):
+        mesh = Mesh.createSphere(1.0, 10)
+        # builds the adjacency data which must be updated by the swaps
+        mesh.removeNonManifoldPoints()
+        for i in range(0, mesh.CountFacets, 7):
+            facet = mesh.Facets[i]
+            neighbour = facet.NeighbourIndices[0]
+            if neighbour < mesh.CountFacets:
+                mesh.swapEdge(i, neighbour)
+
+        # a copy starts with a fresh adjacency
+        other = mesh.copy()
+        other.removeNonManifoldPoints()
+        mesh.removeNonManifoldPoints()
+        self.assertEqual(mesh.CountFacets, other.CountFacets)
+        self.assertEqual(mesh.Topology, other.Topology)
+
+    def testQueryAfterModification(self):
+        mesh = Mesh.createSphere(1.0, 10)
+        # builds the adjacency data which must not be used after the changes below
+        mesh.getCurvaturePerVertex()
+        for i in range(0, mesh.CountFacets, 7):
+            facet = mesh.Facets[i]
+            neighbour = facet.NeighbourIndices[0]
+            if neighbour < mesh.CountFacets:
+                mesh.swapEdge(i, neighbour)
+        mesh.setPoint(0, mesh.Points[0].Vector * 1.1)
+
+        # a copy starts with a fresh adjacency
+        other = mesh.copy()
+        self.assertEqual(mesh.getCurvaturePerVertex(), other.getCurvaturePerVertex())
+
+        mesh.removeFacets(list(range(0, mesh.CountFacets, 5)))
+        other = mesh.copy()
+        mesh.removeFullBoundaryFacets()
+        other.removeFullBoundaryFacets()
+        self.assertEqual(mesh.CountFacets, other.CountFacets)
+        self.assertEqual(mesh.Topology, other.Topology)
+
+
+class SmoothingCases(unittest.TestCase):
+    def setUp(self):
+        # an open mesh, the border points must not be moved
+        self.mesh = Mesh.createSphere(1.0, 20)
+        self.mesh.removeFacets(list(range(0, self.mesh.CountFacets, 9)))
+
+    def umbrella(self, points, facets, stepsize, parallel=False):
+        # serial reference: each point sees the points moved before it,
+        # in parallel mode all points are moved from the previous positions
+        previous = [list(p) for p in points] if parallel else points
+        neighbours = [set() for p in points]
+        faces = [0] * len(points)
+        for f in facets:
+            for i in range(3):
+                faces[f[i]] += 1
+                neighbours[f[i]].add(f[(i+1)%3])
+                neighbours[f[i]].add(f[(i+2)%3])
+        for i, nb in enumerate(neighbours):
+            if len(nb) < 3 or len(nb) != faces[i]:
+                continue
+            w = 1.0 / len(nb)
+            p = previous[i]
+            d = [w * sum(previous[j][k] - p[k] for j in sorted(nb)) for k in range(3)]
+            points[i] = [p[k] + stepsize * d[k] for k in range(3)]
+
+    def compare(self, mesh, points):
+        for p, q in zip(mesh.Topology[0], points):
+            for k in range(3):
+                self.assertAlmostEqual(p[k], q[k], 4)
+
+    def testLaplace(self):
+        points = [[v.x, v.y, v.z] for v in self.mesh.Topology[0]]
+        facets = self.mesh.Topology[1]
+        for i in range(3):
+            self.umbrella(points, facets, 0.6307)
+        self.mesh.smooth(Method="Laplace", Iteration=3)
+        self.compare(self.mesh, points)
+
+    def testTaubin(self):
+        points = [[v.x, v.y, v.z] for v in self.mesh.Topology[0]]
+        facets = self.mesh.Topology[1]
+        for i in range(2):
+            self.umbrella(points, facets, 0.6307)
+            self.umbrella(points, facets, -(0.6307 + 0.0424))
+        self.mesh.smooth(Method="Taubin", Iteration=4)
+        self.compare(self.mesh, points)
+
+    def testLaplaceParallel(self):
+        points = [[v.x, v.y, v.z] for v in self.mesh.Topology[0]]
+        facets = self.mesh.Topology[1]
+        for i in range(3):
+            self.umbrella(points, facets, 0.6307, True)
+        self.mesh.smooth(Method="Laplace", Iteration=3, Parallel=True)
+        self.compare(self.mesh, points)
+
+    def testTaubinParallel(self):
+        points = [[v.x, v.y, v.z] for v in self.mesh.Topology[0]]
+        facets = self.mesh.Topology[1]
+        for i in range(2):
+            self.umbrella(points, facets, 0.6307, True)
+            self.umbrella(points, facets, -(0.6307 + 0.0424), True)
+        self.mesh.smooth(Method="Taubin", Iteration=4, Parallel=True)
+        self.compare(self.mesh, points)
+
+
+class OutOfCoreCases(unittest.TestCase):
+    def setUp(self):
+        self.name = tempfile.gettempdir() + os.sep + "outofcore.stl"
+        self.directory = tempfile.mkdtemp()
+
+    def tearDown(self):
+        os.remove(self.name)
+        for f in os.listdir(self.directory):
+            os.remove(os.path.join(self.directory, f))
+        os.rmdir(self.directory)
+
+    def testSolid(self):
+        mesh = Mesh.createSphere(1.0, 30)
+        mesh.write(self.name)
+        info = Mesh.outOfCoreStatistics(self.name, self.directory, 500)
+        self.assertGreater(info["Chunks"], 1)
+        self.assertEqual(info["Facets"], mesh.CountFacets)
+        self.assertAlmostEqual(info["Area"], mesh.Area, 3)
+        self.assertAlmostEqual(info["Volume"], mesh.Volume, 3)
+        self.assertAlmostEqual(info["BoundBox"].DiagonalLength, mesh.BoundBox.DiagonalLength, 4)
+        self.assertTrue(info["Solid"])
+
+    def testOpen(self):
+        mesh = Mesh.createSphere(1.0, 30)
+        mesh.removeFacets([0, 1, 2])
+        mesh.write(self.name)
+        info = Mesh.outOfCoreStatistics(self.name, self.directory, 500)
+        self.assertEqual(info["Facets"], mesh.CountFacets)
+        self.assertFalse(info["Solid"])
+
+    def testFacets(self):
+        mesh = Mesh.createSphere(1.0, 30)
+        mesh.write(self.name)
+        info = Mesh.outOfCoreStatistics(self.name, self.directory, 500)
+        # the chunks sort the facets spatially, so only compare the sets
+        def key(points):
+            return tuple(sorted((round(p[0], 5), round(p[1], 5), round(p[2], 5)) for p in points))
+        facets = Mesh.outOfCoreFacets(self.directory, range(info["Facets"]))
+        self.assertEqual(sorted(key(f) for f in facets), sorted(key(f.Points) for f in mesh.Facets))
+        with self.assertRaises(IndexError):
+            Mesh.outOfCoreFacets(self.directory, [info["Facets"]])
+
+    def testProjectLine(self):
+        # a flat grid of 20x20 squares in the xy plane
+        points = []
+        for i in range(20):
+            for j in range(20):
+                p00 = FreeCAD.Vector(i, j, 0)
+                p10 = FreeCAD.Vector(i + 1, j, 0)
+                p01 = FreeCAD.Vector(i, j + 1, 0)
+                p11 = FreeCAD.Vector(i + 1, j + 1, 0)
+                points += [p00, p10, p11, p00, p11, p01]
+        mesh = Mesh.Mesh(points)
+        mesh.write(self.name)
+        info = Mesh.outOfCoreStatistics(self.name, self.directory, 100)
+        self.assertGreater(info["Chunks"], 1)
+
+        def inside(p, f):
+            a, b, c = f
+            def cross(u, v, w):
+                return (v[0] - u[0]) * (w[1] - u[1]) - (v[1] - u[1]) * (w[0] - u[0])
+            return cross(a, b, p) >= 0 and cross(b, c, p) >= 0 and cross(c, a, p) >= 0
+
+        p1 = FreeCAD.Vector(1.3, 2.1, 0)
+        p2 = FreeCAD.Vector(17.7, 12.4, 0)
+        facets = Mesh.outOfCoreFacets(self.directory, range(info["Facets"]))
+        f1 = [i for i, f in enumerate(facets) if inside(p1, f)][0]
+        f2 = [i for i, f in enumerate(facets) if inside(p2, f)][0]
+        line = Mesh.projectLineOutOfCore(self.directory, p1, f1, p2, f2, FreeCAD.Vector(0, 0, 1))
+
+        # the polyline runs straight from p1 to p2 and crosses every grid line
+        # in between as well as the diagonal of each visited square
+        self.assertLess((line[0] - p1).Length, 1e-5)
+        self.assertLess((line[-1] - p2).Length, 1e-5)
+        self.assertGreater(len(line), 16 + 10)
+        direction = p2 - p1
+        direction.normalize()
+        last = -1.0
+        for p in line:
+            self.assertLess(p.distanceToLine(p1, direction), 1e-4)
+            param = (p - p1).dot(direction)
+            self.assertGreaterEqual(param, last - 1e-4)
+            last = param
+
+
+class SelfIntersectionCases(unittest.TestCase):
+    def setUp(self):
+        # two overlapping spheres
+        self.mesh = Mesh.createSphere(1.0, 10)
+        other = self.mesh.copy()
+        other.translate(0.5, 0.0, 0.0)
+        self.mesh.addMesh(other)
+
+    def testSelfIntersections(self):
+        result = self.mesh.getSelfIntersections()
+        pairs = [(i[0], i[1]) for i in result]
+        self.assertTrue(self.mesh.hasSelfIntersections())
+        self.assertEqual(len(pairs), len(set(pairs)), "Pairs are reported more than once")
+
+        # compare with a brute-force check of all pairs of facets
+        facets = self.mesh.Facets
+        points = [set(f.PointIndices) for f in facets]
+        bounds = []
+        for f in facets:
+            box = FreeCAD.BoundBox()
+            for p in f.Points:
+                box.add(FreeCAD.Vector(p[0], p[1], p[2]))
+            bounds.append(box)
+        expected = []
+        for i in range(len(facets)):
+            for j in range(i + 1, len(facets)):
+                if points[i] & points[j]:
+                    continue
+                if not bounds[i].intersect(bounds[j]):
+                    continue
+                if len(facets[i].intersect(facets[j])) == 2:
+                    expected.append((i, j))
+        self.assertEqual(sorted(pairs), expected)
+
+    def testNoSelfIntersections(self):
+        mesh = Mesh.createSphere(1.0, 10)
+        self.assertFalse(mesh.hasSelfIntersections())
+        self.assertEqual(len(mesh.getSelfIntersections()), 0)
+
+    def testFixSelfIntersections(self):
+        self.mesh.fixSelfIntersections()
+        self.assertFalse(self.mesh.hasSelfIntersections())
+
+
+class NearestFacetCases(unittest.TestCase):
+    def testNearestFacetOnRay(self):
+        mesh = Mesh.createSphere(1.0, 20)
+        result = mesh.nearestFacetOnRay((0.0, 0.0, 2.0), (0.0, 0.0, -1.0))
+        self.assertEqual(len(result), 1)
+        index, point = list(result.items())[0]
+        self.assertAlmostEqual(point[2], 1.0, 1)
+        self.assertTrue(0 <= index < mesh.CountFacets)
+
+        # the ray is handled as a line
+        other = mesh.nearestFacetOnRay((0.0, 0.0, 2.0), (0.0, 0.0, 1.0))
+        self.assertEqual(list(other.keys()), [index])
+
+    def testMeshChanged(self):
+        mesh = Mesh.createSphere(1.0, 20)
+        self.assertEqual(len(mesh.nearestFacetOnRay((0.0, 0.0, 2.0), (0.0, 0.0, -1.0))), 1)
+        # the search tree must be rebuilt
+        mesh.translate(5.0, 0.0, 0.0)
+        self.assertEqual(len(mesh.nearestFacetOnRay((0.0, 0.0, 2.0), (0.0, 0.0, -1.0))), 0)
+        result = mesh.nearestFacetOnRay((5.0, 0.0, 2.0), (0.0, 0.0, -1.0))
+        self.assertEqual(len(result), 1)
+
+    def testProjectPointsOnMesh(self):
+        # MeshPart casts the rays of all points together, the result must be
+        # the same as casting one ray after another
+        try:
+            import MeshPart
+        except ImportError:
+            self.skipTest("MeshPart is not available")
+        mesh = Mesh.createSphere(1.0, 20)
+        direction = FreeCAD.Vector(0.0, 0.0, -1.0)
+        points = []
+        for i in range(25):
+            for j in range(25):
+                points.append(FreeCAD.Vector(-1.2 + 0.1 * i, -1.2 + 0.1 * j, 2.0))
+
+        expected = []
+        for p in points:
+            result = mesh.nearestFacetOnRay((p.x, p.y, p.z), (direction.x, direction.y, direction.z))
+            expected += [FreeCAD.Vector(*q) for q in result.values()]
+        projected = MeshPart.projectPointsOnMesh(points, mesh, direction)
+
+        # the points outside the sphere miss it
+        self.assertLess(len(expected), len(points))
+        self.assertEqual(len(projected), len(expected))
+        for p, q in zip(projected, expected):
+            self.assertLess((p - q).Length, 1e-5)
+
+
+class DecimationCases(unittest.TestCase):
+    def testTargetSize(self):
+        mesh = Mesh.createSphere(1.0, 50)
+        target = mesh.CountFacets // 10
+        mesh.decimate(target)
+        self.assertLessEqual(mesh.CountFacets, target)
+        self.assertTrue(mesh.isSolid())
+
+    def testFeatureAngle(self):
+        mesh = Mesh.createCylinder(1.0, 2.0, 1, 0.1, 100)
+        length = mesh.BoundBox.ZLength
+        mesh.decimate(mesh.CountFacets // 4, featureAngle=0.5)
+        self.assertTrue(mesh.isSolid())
+        self.assertAlmostEqual(mesh.BoundBox.ZLength, length, 4)
+
+    def testPartitions(self):
+        # big enough to be decimated in several partitions first
+        mesh = Mesh.createSphere(1.0, 200)
+        self.assertGreater(mesh.CountFacets, 40000)
+        target = mesh.CountFacets // 10
+        mesh.decimate(target, featureAngle=0.0)
+        self.assertLessEqual(mesh.CountFacets, target)
+        # the seams between the partitions must be closed
+        self.assertTrue(mesh.isSolid())
+        self.assertFalse(mesh.hasNonManifolds())
+        self.assertAlmostEqual(mesh.BoundBox.XLength, 2.0, 1)
+
+    def testTolerance(self):
+        mesh = Mesh.createSphere(1.0, 50)
+        count = mesh.CountFacets
+        mesh.decimate(tolerance=1, reduction=0.5)
+        self.assertLess(mesh.CountFacets, count)
+        self.assertGreater(mesh.CountFacets, count // 4)
+
+    def testPositionalTolerance(self):
+        # two positional numbers are tolerance and reduction, even integers
+        mesh = Mesh.createSphere(1.0, 50)
+        other = mesh.copy()
+        mesh.decimate(1, 0.5)
+        other.decimate(tolerance=1.0, reduction=0.5)
+        self.assertEqual(mesh.CountFacets, other.CountFacets)
+        self.assertGreater(mesh.CountFacets, 1)
+
+    def testFeatureAngleKeyword(self):
+        mesh = Mesh.createSphere(1.0, 50)
+        with self.assertRaises(ValueError):
+            mesh.decimate(1, 0.5, 0.5)
+        mesh.decimate(1, 0.5, featureAngle=0.5)
+
+class SnapshotCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("MeshSnapshot")
+        self.doc.UndoMode = 1
+
+    def testEditWithSnapshot(self):
+        feature = self.doc.addObject("Mesh::Feature", "Box")
+        feature.Mesh = Mesh.createBox(1.0, 1.0, 1.0)
+        mesh = feature.Mesh
+        points = [p.Vector for p in mesh.Points]
+
+        # the transaction keeps a snapshot that shares the mesh until it's edited
+        self.doc.openTransaction("Smooth")
+        feature.smooth(3)
+        self.doc.commitTransaction()
+        smoothed = [p.Vector for p in feature.Mesh.Points]
+        self.assertNotEqual(smoothed, points)
+        # the Python object follows the edited mesh of the property
+        self.assertEqual([p.Vector for p in mesh.Points], smoothed)
+
+        # the snapshot wasn't changed by the edit
+        self.doc.undo()
+        self.assertEqual([p.Vector for p in feature.Mesh.Points], points)
+        self.assertEqual([p.Vector for p in mesh.Points], points)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+
+
+class SaveRestoreInThreadsCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("MeshThreads")
+        self.name = tempfile.gettempdir() + os.sep + "MeshThreads.FCStd"
+        self.param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.threads = self.param.GetInt("RestoreThreads", 0)
+        self.param.SetInt("RestoreThreads", 4)
+        self.lazy = self.param.GetBool("LazyRestore", False)
+
+    def testRestoreMeshes(self):
+        counts = []
+        for i in range(6):
+            feature = self.doc.addObject("Mesh::Feature", "Sphere")
+            feature.Mesh = Mesh.createSphere(1.0, 20 + 10 * i)
+            counts.append(feature.Mesh.CountFacets)
+        self.doc.saveAs(self.name)
+        FreeCAD.closeDocument("MeshThreads")
+
+        self.doc = FreeCAD.open(self.name)
+        features = self.doc.findObjects("Mesh::Feature")
+        self.assertEqual([f.Mesh.CountFacets for f in features], counts)
+        for f in features:
+            self.assertTrue(f.Mesh.isSolid())
+
+    def testLazyRestore(self):
+        self.param.SetBool("LazyRestore", True)
+        counts = []
+        for i in range(3):
+            feature = self.doc.addObject("Mesh::Feature", "Sphere")
+            feature.Mesh = Mesh.createSphere(1.0, 20 + 10 * i)
+            counts.append(feature.Mesh.CountFacets)
+        self.doc.saveAs(self.name)
+        FreeCAD.closeDocument("MeshThreads")
+
+        self.doc = FreeCAD.open(self.name)
+        features = self.doc.findObjects("Mesh::Feature")
+        if not FreeCAD.GuiUp:
+            # the view providers would access the meshes while opening
+            # the file, so a modified file must give empty meshes here
+            stat = os.stat(self.name)
+            os.utime(self.name, (stat.st_atime, stat.st_mtime + 10))
+            self.assertEqual(features[0].Mesh.CountFacets, 0)
+            # the failed mesh stays pending and is read once the file matches
+            os.utime(self.name, (stat.st_atime, stat.st_mtime))
+            self.assertEqual(features[0].Mesh.CountFacets, counts[0])
+
+        # save again before accessing the other meshes
+        self.doc.save()
+        self.assertEqual([f.Mesh.CountFacets for f in features], counts)
+
+    def tearDown(self):
+        self.param.SetInt("RestoreThreads", self.threads)
+        self.param.SetBool("LazyRestore", self.lazy)
+        FreeCAD.closeDocument(self.doc.Name)
@@ -53,6 +53,7 @@
 #include <Gui/SoFCInteractiveElement.h>
 #include <Gui/SoFCSelectionAction.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
+#include <Mod/Mesh/App/Core/BVH.h>
 #include <Mod/Mesh/App/Core/MeshIO.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Mesh/App/Core/Elements.h>
@@ -334,7 +335,7 @@ SO_NODE_SOURCE(SoFCMeshPickNode)
 /*!
   Constructor.
 */
-SoFCMeshPickNode::SoFCMeshPickNode(void) : meshGrid(0)
+SoFCMeshPickNode::SoFCMeshPickNode(void)
 {
     SO_NODE_CONSTRUCTOR(SoFCMeshPickNode);
 
@@ -346,7 +347,6 @@ SoFCMeshPickNode::SoFCMeshPickNode(void) : meshGrid(0)
 */
 SoFCMeshPickNode::~SoFCMeshPickNode()
 {
-    delete meshGrid;
 }
 
 // Doc from superclass.
@@ -361,10 +361,8 @@ void SoFCMeshPickNode::notify(SoNotList *list)
     if (f == &mesh) {
         const Mesh::MeshObject* meshObject = mesh.getValue();
         if (meshObject) {
-            MeshCore::MeshAlgorithm alg(meshObject->getKernel());
-            float fAvgLen = alg.GetAverageEdgeLength();
-            delete meshGrid;
-            meshGrid = new MeshCore::MeshFacetGrid(meshObject->getKernel(), 5.0f * fAvgLen);
+            // build the search tree now and not with the first pick
+            meshObject->getFacetTree();
         }
     }
 }
@@ -381,7 +379,7 @@ void SoFCMeshPickNode::pick(SoPickAction * action)
     raypick->setObjectSpace();
 
     const Mesh::MeshObject* meshObject = mesh.getValue();
-    MeshCore::MeshAlgorithm alg(meshObject->getKernel());
+    std::shared_ptr<const MeshCore::MeshFacetBVH> tree = meshObject->getFacetTree();
 
     const SbLine& line = raypick->getLine();
     const SbVec3f& pos = line.getPosition();
@@ -389,7 +387,7 @@ void SoFCMeshPickNode::pick(SoPickAction * action)
     Base::Vector3f pt(pos[0],pos[1],pos[2]);
     Base::Vector3f dr(dir[0],dir[1],dir[2]);
     unsigned long index;
-    if (alg.NearestFacetOnRay(pt, dr, *meshGrid, pt, index)) {
+    if (tree->NearestFacetOnRay(pt, dr, pt, index)) {
         SoPickedPoint* pp = raypick->addIntersection(SbVec3f(pt.x,pt.y,pt.z));
         if (pp) {
             SoFaceDetail* det = new SoFaceDetail();
@@ -94,9 +94,6 @@ public:
 
 protected:
     virtual ~SoFCMeshPickNode();
-
-private:
-    MeshCore::MeshFacetGrid* meshGrid;
 };
 
 // -------------------------------------------------------
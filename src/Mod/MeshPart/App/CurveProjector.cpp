@@ -26,6 +26,7 @@
 # ifdef FC_OS_LINUX
 #  include <unistd.h>
 # endif
+# include <climits>
 # include <Bnd_Box.hxx>
 # include <BndLib_Add3dCurve.hxx>
 # include <BRepAdaptor_Curve.hxx>
@@ -53,6 +54,7 @@
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
+#include <Mod/Mesh/App/Core/BVH.h>
 #include <Mod/Mesh/App/Core/Projection.h>
 #include <Mod/Mesh/App/Core/Grid.h>
 #include <Mod/Mesh/App/Mesh.h>
@@ -693,6 +695,41 @@ MeshProjection::~MeshProjection()
 {
 }
 
+void MeshProjection::nearestFacetsOnLines(const MeshCore::MeshFacetBVH& tree,
+                                          const std::vector<Base::Vector3f>& points,
+                                          const Base::Vector3f& dir,
+                                          std::vector<Base::Vector3f>& results,
+                                          std::vector<unsigned long>& facets) const
+{
+    // cast all rays forward and then all rays backward, so that the rays traced
+    // together in a packet are neighbours on the curve
+    std::size_t count = points.size();
+    std::vector<Base::Vector3f> rayPoints, rayDirs;
+    rayPoints.reserve(2 * count);
+    rayPoints.insert(rayPoints.end(), points.begin(), points.end());
+    rayPoints.insert(rayPoints.end(), points.begin(), points.end());
+    rayDirs.resize(count, dir);
+    rayDirs.resize(2 * count, -dir);
+
+    std::vector<Base::Vector3f> hits;
+    std::vector<unsigned long> hitFacets;
+    tree.NearestFacetsOnRays(rayPoints, rayDirs, hits, hitFacets);
+
+    // keep the nearer hit of both directions
+    results.resize(count);
+    facets.resize(count);
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t j = i;
+        if (hitFacets[count + i] != ULONG_MAX) {
+            if (hitFacets[i] == ULONG_MAX ||
+                Base::DistanceP2(points[i], hits[count + i]) < Base::DistanceP2(points[i], hits[i]))
+                j = count + i;
+        }
+        results[i] = hits[j];
+        facets[i] = hitFacets[j];
+    }
+}
+
 void MeshProjection::discretize(const TopoDS_Edge& aEdge, std::vector<Base::Vector3f>& polyline, std::size_t minPoints) const
 {
     BRepAdaptor_Curve clCurve(aEdge);
@@ -849,10 +886,10 @@ void MeshProjection::projectOnMesh(const std::vector<Base::Vector3f>& pointsIn,
                                    float tolerance,
                                    std::vector<Base::Vector3f>& pointsOut) const
 {
-    // calculate the average edge length and create a grid
-    MeshAlgorithm clAlg(_rcMesh);
-    float fAvgLen = clAlg.GetAverageEdgeLength();
-    MeshFacetGrid cGrid(_rcMesh, 5.0f*fAvgLen);
+    MeshCore::MeshFacetBVH tree(_rcMesh);
+    std::vector<Base::Vector3f> hits;
+    std::vector<unsigned long> hitFacets;
+    nearestFacetsOnLines(tree, pointsIn, dir, hits, hitFacets);
 
     // get all boundary points and edges of the mesh
     std::vector<Base::Vector3f> boundaryPoints;
@@ -876,10 +913,11 @@ void MeshProjection::projectOnMesh(const std::vector<Base::Vector3f>& pointsIn,
 
     Base::SequencerLauncher seq( "Project points on mesh", pointsIn.size() );
 
-    for (auto it : pointsIn) {
-        Base::Vector3f result;
-        unsigned long index;
-        if (clAlg.NearestFacetOnRay(it, dir, cGrid, result, index)) {
+    for (std::size_t i = 0; i < pointsIn.size(); i++) {
+        const Base::Vector3f& it = pointsIn[i];
+        Base::Vector3f result = hits[i];
+        unsigned long index = hitFacets[i];
+        if (index != ULONG_MAX) {
             MeshCore::MeshGeomFacet geomFacet = _rcMesh.GetFacet(index);
             if (tolerance > 0 && geomFacet.IntersectPlaneWithLine(it, dir, result)) {
                 if (geomFacet.IsPointOfFace(result, tolerance))
@@ -930,6 +968,7 @@ void MeshProjection::projectParallelToMesh (const TopoDS_Shape &aShape, const Ba
     MeshAlgorithm clAlg(_rcMesh);
     float fAvgLen = clAlg.GetAverageEdgeLength();
     MeshFacetGrid cGrid(_rcMesh, 5.0f*fAvgLen);
+    MeshCore::MeshFacetBVH tree(_rcMesh);
     TopExp_Explorer Ex;
 
     int iCnt=0;
@@ -947,11 +986,12 @@ void MeshProjection::projectParallelToMesh (const TopoDS_Shape &aShape, const Ba
         std::vector<HitPoint> hitPoints;
         typedef std::pair<HitPoint, HitPoint> HitPoints;
         std::vector<HitPoints> hitPointPairs;
-        for (auto it : points) {
-            Base::Vector3f result;
-            unsigned long index;
-            if (clAlg.NearestFacetOnRay(it, dir, cGrid, result, index)) {
-                hitPoints.emplace_back(result, index);
+        std::vector<Base::Vector3f> results;
+        std::vector<unsigned long> indices;
+        nearestFacetsOnLines(tree, points, dir, results, indices);
+        for (std::size_t i = 0; i < points.size(); i++) {
+            if (indices[i] != ULONG_MAX) {
+                hitPoints.emplace_back(results[i], indices[i]);
 
                 if (hitPoints.size() > 1) {
                     HitPoint p1 = hitPoints[hitPoints.size()-2];
@@ -982,6 +1022,7 @@ void MeshProjection::projectParallelToMesh (const std::vector<PolyLine> &aEdges,
     MeshAlgorithm clAlg(_rcMesh);
     float fAvgLen = clAlg.GetAverageEdgeLength();
     MeshFacetGrid cGrid(_rcMesh, 5.0f*fAvgLen);
+    MeshCore::MeshFacetBVH tree(_rcMesh);
 
     Base::SequencerLauncher seq( "Project curve on mesh", aEdges.size() );
 
@@ -992,11 +1033,12 @@ void MeshProjection::projectParallelToMesh (const std::vector<PolyLine> &aEdges,
         std::vector<HitPoint> hitPoints;
         typedef std::pair<HitPoint, HitPoint> HitPoints;
         std::vector<HitPoints> hitPointPairs;
-        for (auto it : points) {
-            Base::Vector3f result;
-            unsigned long index;
-            if (clAlg.NearestFacetOnRay(it, dir, cGrid, result, index)) {
-                hitPoints.emplace_back(result, index);
+        std::vector<Base::Vector3f> results;
+        std::vector<unsigned long> indices;
+        nearestFacetsOnLines(tree, points, dir, results, indices);
+        for (std::size_t i = 0; i < points.size(); i++) {
+            if (indices[i] != ULONG_MAX) {
+                hitPoints.emplace_back(results[i], indices[i]);
 
                 if (hitPoints.size() > 1) {
                     HitPoint p1 = hitPoints[hitPoints.size()-2];
@@ -39,6 +39,7 @@ namespace MeshCore
 class MeshKernel;
 class MeshGeomFacet;
 class MeshFacetGrid;
+class MeshFacetBVH;
 }
 
 using MeshCore::MeshKernel;
@@ -226,6 +227,14 @@ protected:
     void projectEdgeToEdge(const TopoDS_Edge &aCurve, float fMaxDist, const MeshCore::MeshFacetGrid& rGrid,
                            std::vector<SplitEdge>& rSplitEdges) const;
     bool findIntersection(const Edge&, const Edge&, const Base::Vector3f& dir, Base::Vector3f& res) const;
+    /**
+     * Searches the nearest facets hit by the lines through \a points with the direction \a dir.
+     * The lines are cast as rays in both directions and the nearer hit is taken. A facet index
+     * of ULONG_MAX marks a line that misses the mesh.
+     */
+    void nearestFacetsOnLines(const MeshCore::MeshFacetBVH& tree, const std::vector<Base::Vector3f>& points,
+                              const Base::Vector3f& dir, std::vector<Base::Vector3f>& results,
+                              std::vector<unsigned long>& facets) const;
 
 private:
     const MeshKernel& _rcMesh;
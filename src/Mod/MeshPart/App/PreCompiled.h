@@ -56,6 +56,7 @@
 #include <vector>
 #include <set>
 #include <bitset>
+#include <climits>
 
 // OpenCasCade =====================================================================================
 // Base
@@ -144,6 +144,7 @@
 #include <Mod/Part/App/GeomPlate/PointConstraintPy.h>
 #include <Mod/Part/App/ShapeUpgrade/UnifySameDomainPy.h>
 #include "PropertyGeometryList.h"
+#include "ShapeStore.h"
 #include "DatumFeature.h"
 #include "Attacher.h"
 #include "AttachExtension.h"
@@ -329,6 +330,7 @@ PyMOD_INIT_FUNC(Part)
     Part::PropertyGeometryList  ::init();
     Part::PropertyShapeHistory  ::init();
     Part::PropertyFilletEdges   ::init();
+    Part::ShapeStore            ::init();
 
     Part::FaceMaker             ::init();
     Part::FaceMakerPublic       ::init();
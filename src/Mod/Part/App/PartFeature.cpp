@@ -52,6 +52,7 @@
 # include <gce_MakeDir.hxx>
 #endif
 
+#include <mutex>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost_bind_bind.hpp>
 #include <Base/Console.h>
@@ -217,6 +218,9 @@ struct ShapeCache {
     std::unordered_map<const App::Document*,
         std::map<std::pair<const App::DocumentObject*, std::string> ,TopoShape> > cache;
 
+    // objects may be recomputed in worker threads, see canRecomputeInThread()
+    std::mutex mutex;
+
     bool inited = false;
     void init() {
         if(inited)
@@ -231,6 +235,7 @@ struct ShapeCache {
     }
 
     void slotDeleteDocument(const App::Document &doc) {
+        std::lock_guard<std::mutex> lock(mutex);
         cache.erase(&doc);
     }
 
@@ -245,6 +250,7 @@ struct ShapeCache {
     }
 
     void slotClear(const App::DocumentObject &obj) {
+        std::lock_guard<std::mutex> lock(mutex);
         auto it = cache.find(obj.getDocument());
         if(it==cache.end())
             return;
@@ -257,6 +263,7 @@ struct ShapeCache {
     }
 
     bool getShape(const App::DocumentObject *obj, TopoShape &shape, const char *subname=0) {
+        std::lock_guard<std::mutex> lock(mutex);
         init();
         auto &entry = cache[obj->getDocument()];
         if(!subname) subname = "";
@@ -269,6 +276,7 @@ struct ShapeCache {
     }
 
     void setShape(const App::DocumentObject *obj, const TopoShape &shape, const char *subname=0) {
+        std::lock_guard<std::mutex> lock(mutex);
         init();
         if(!subname) subname = "";
         cache[obj->getDocument()][std::make_pair(obj,std::string(subname))] = shape;
@@ -277,6 +285,7 @@ struct ShapeCache {
 static ShapeCache _ShapeCache;
 
 void Feature::clearShapeCache() {
+    std::lock_guard<std::mutex> lock(_ShapeCache.mutex);
     _ShapeCache.cache.clear();
 }
 
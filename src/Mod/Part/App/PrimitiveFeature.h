@@ -45,6 +45,10 @@ public:
     App::DocumentObjectExecReturn *execute(void) override;
     short mustExecute() const override;
     PyObject* getPyObject() override;
+    /// primitives only build their own shape
+    bool canRecomputeInThread() const override {
+        return true;
+    }
     //@}
 
 protected:
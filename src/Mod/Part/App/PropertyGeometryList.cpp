@@ -25,6 +25,8 @@
 
 #ifndef _PreComp_
 #   include <assert.h>
+#   include <functional>
+#   include <limits>
 #endif
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
@@ -33,6 +35,7 @@
 #include <Base/Reader.h>
 #include <Base/Writer.h>
 #include <Base/Console.h>
+#include <App/PropertyDelta.h>
 
 #include "Geometry.h"
 #include "GeometryPy.h"
@@ -242,6 +245,79 @@ void PropertyGeometryList::Paste(const Property &from)
     setValues(FromList._lValueList);
 }
 
+namespace Part {
+/// Undo/redo record of changed geometries, see PropertyGeometryList::Diff()
+class GeometryListDelta : public App::PropertyDelta
+{
+public:
+    /// Geometries are compared by their saved content
+    static std::string dump(const Geometry *geo)
+    {
+        Base::StringWriter writer;
+        writer.Stream().precision(std::numeric_limits<double>::digits10 + 2);
+        geo->Save(writer);
+        return writer.getString();
+    }
+
+    void apply(App::Property &prop) const
+    {
+        if (!prop.isDerivedFrom(PropertyGeometryList::getClassTypeId()))
+            throw Base::TypeError("Property type mismatch");
+        PropertyGeometryList &list = static_cast<PropertyGeometryList&>(prop);
+        std::vector<Geometry*> values = list.getValues();
+        std::size_t seed = values.size();
+        for (auto geo : values)
+            hashCombine(seed, std::hash<std::string>()(dump(geo)));
+        if (values.size() != size || seed != checksum)
+            throw Base::RuntimeError("Property changed outside of transaction");
+        values.resize(oldSize);
+        for (auto &change : changes)
+            values[change.first] = change.second.get();
+        list.setValues(values);
+    }
+
+    unsigned int getMemSize() const
+    {
+        unsigned int memSize = sizeof(GeometryListDelta);
+        for (auto &change : changes)
+            memSize += change.second->getMemSize();
+        return memSize;
+    }
+
+    std::vector<std::pair<std::size_t, std::unique_ptr<Geometry> > > changes;
+    std::size_t size = 0;
+    std::size_t oldSize = 0;
+    std::size_t checksum = 0;
+};
+}
+
+App::PropertyDelta *PropertyGeometryList::Diff(const App::Property &from) const
+{
+    if (!from.isDerivedFrom(PropertyGeometryList::getClassTypeId()))
+        return 0;
+    const std::vector<Geometry*> &old = static_cast<const PropertyGeometryList&>(from)._lValueList;
+    std::unique_ptr<GeometryListDelta> delta(new GeometryListDelta);
+    delta->size = _lValueList.size();
+    delta->oldSize = old.size();
+    delta->checksum = delta->size;
+    std::size_t limit = old.size() / 2;
+    for (std::size_t i = 0; i < _lValueList.size(); i++) {
+        std::string data = GeometryListDelta::dump(_lValueList[i]);
+        App::PropertyDelta::hashCombine(delta->checksum, std::hash<std::string>()(data));
+        if (i < old.size() && data != GeometryListDelta::dump(old[i])) {
+            if (delta->changes.size() >= limit)
+                return 0;
+            delta->changes.emplace_back(i, std::unique_ptr<Geometry>(old[i]->clone()));
+        }
+    }
+    for (std::size_t i = _lValueList.size(); i < old.size(); i++) {
+        if (delta->changes.size() >= limit)
+            return 0;
+        delta->changes.emplace_back(i, std::unique_ptr<Geometry>(old[i]->clone()));
+    }
+    return delta.release();
+}
+
 unsigned int PropertyGeometryList::getMemSize(void) const
 {
     int size = sizeof(PropertyGeometryList);
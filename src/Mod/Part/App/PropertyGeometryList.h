@@ -85,6 +85,7 @@ public:
 
     virtual App::Property *Copy(void) const;
     virtual void Paste(const App::Property &from);
+    virtual App::PropertyDelta *Diff(const App::Property &from) const;
 
     virtual unsigned int getMemSize(void) const;
 
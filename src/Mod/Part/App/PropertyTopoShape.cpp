@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <mutex>
 # include <sstream>
 # include <BRepAdaptor_Curve.hxx>
 # include <BRepAdaptor_Surface.hxx>
@@ -60,6 +61,7 @@
 #include <App/ObjectIdentifier.h>
 
 #include "PropertyTopoShape.h"
+#include "ShapeStore.h"
 #include "TopoShapePy.h"
 #include "TopoShapeFacePy.h"
 #include "TopoShapeEdgePy.h"
@@ -75,6 +77,7 @@ using namespace Part;
 TYPESYSTEM_SOURCE(Part::PropertyPartShape , App::PropertyComplexGeoData)
 
 PropertyPartShape::PropertyPartShape()
+  : _storeIndex(-1), _pending(false)
 {
 }
 
@@ -85,6 +88,7 @@ PropertyPartShape::~PropertyPartShape()
 void PropertyPartShape::setValue(const TopoShape& sh)
 {
     aboutToSetValue();
+    resetPending();
     _Shape = sh;
     hasSetValue();
 }
@@ -92,27 +96,32 @@ void PropertyPartShape::setValue(const TopoShape& sh)
 void PropertyPartShape::setValue(const TopoDS_Shape& sh)
 {
     aboutToSetValue();
+    resetPending();
     _Shape.setShape(sh);
     hasSetValue();
 }
 
 const TopoDS_Shape& PropertyPartShape::getValue(void)const
 {
+    restoreLazily();
     return _Shape.getShape();
 }
 
 const TopoShape& PropertyPartShape::getShape() const
 {
+    restoreLazily();
     return this->_Shape;
 }
 
 const Data::ComplexGeoData* PropertyPartShape::getComplexData() const
 {
+    restoreLazily();
     return &(this->_Shape);
 }
 
 Base::BoundBox3d PropertyPartShape::getBoundingBox() const
 {
+    restoreLazily();
     Base::BoundBox3d box;
     if (_Shape.getShape().IsNull())
         return box;
@@ -139,6 +148,7 @@ Base::BoundBox3d PropertyPartShape::getBoundingBox() const
 
 void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 {
+    restoreLazily();
     aboutToSetValue();
     _Shape.transformGeometry(rclTrf);
     hasSetValue();
@@ -146,6 +156,7 @@ void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 
 PyObject *PropertyPartShape::getPyObject(void)
 {
+    restoreLazily();
     Base::PyObjectBase* prop = static_cast<Base::PyObjectBase*>(_Shape.getPyObject());
     if (prop)
         prop->setConst();
@@ -167,6 +178,7 @@ void PropertyPartShape::setPyObject(PyObject *value)
 
 App::Property *PropertyPartShape::Copy(void) const
 {
+    restoreLazily();
     PropertyPartShape *prop = new PropertyPartShape();
     prop->_Shape = this->_Shape;
     if (!_Shape.getShape().IsNull()) {
@@ -179,13 +191,17 @@ App::Property *PropertyPartShape::Copy(void) const
 
 void PropertyPartShape::Paste(const App::Property &from)
 {
+    const PropertyPartShape& prop = dynamic_cast<const PropertyPartShape&>(from);
+    prop.restoreLazily();
     aboutToSetValue();
-    _Shape = dynamic_cast<const PropertyPartShape&>(from)._Shape;
+    resetPending();
+    _Shape = prop._Shape;
     hasSetValue();
 }
 
 unsigned int PropertyPartShape::getMemSize (void) const
 {
+    restoreLazily();
     return _Shape.getMemSize();
 }
 
@@ -205,18 +221,42 @@ void PropertyPartShape::getPaths(std::vector<App::ObjectIdentifier> &paths) cons
 
 void PropertyPartShape::Save (Base::Writer &writer) const
 {
+    restoreLazily();
     if(!writer.isForceXML()) {
         //See SaveDocFile(), RestoreDocFile()
-        if (writer.getMode("BinaryBrep")) {
-            writer.Stream() << writer.ind() << "<Part file=\""
-                            << writer.addFile("PartShape.bin", this)
-                            << "\"/>" << std::endl;
+        // A shape that couldn't be read is not added to the store but left to
+        // SaveDocFile() which reports it
+        bool useStore = writer.getMode("ShapeStore") && !isPending();
+        // without an own file older versions restore an empty shape
+        std::string file;
+        if (!useStore || writer.getMode("ShapeFiles")) {
+            if (writer.getMode("BinaryBrep")) {
+                file = writer.addFile("PartShape.bin", this);
+            }
+            else {
+                // SaveDocFile() may run in a thread where the parameters must not be
+                // accessed, so the choice is passed on through the writer
+                bool direct = App::GetApplication().GetParameterGroupByPath
+                    ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("DirectAccess", true);
+                if (direct)
+                    writer.clearMode("BrepTempFile");
+                else
+                    writer.setMode("BrepTempFile");
+                file = writer.addFile("PartShape.brp", this);
+            }
         }
-        else {
-            writer.Stream() << writer.ind() << "<Part file=\""
-                            << writer.addFile("PartShape.brp", this)
-                            << "\"/>" << std::endl;
+
+        writer.Stream() << writer.ind() << "<Part file=\"" << file << "\"";
+        if (useStore && !_Shape.getShape().IsNull()) {
+            // the shape is saved with the shapes of the other properties, in
+            // compatibility mode its own file is read by versions that don't
+            // know the store
+            std::shared_ptr<ShapeStore> store = ShapeStore::getStore(writer);
+            int index = store->addShape(_Shape.getShape());
+            writer.Stream() << " store=\"" << store->getFileName()
+                            << "\" shape=\"" << index << "\"";
         }
+        writer.Stream() << "/>" << std::endl;
     }
 }
 
@@ -225,7 +265,18 @@ void PropertyPartShape::Restore(Base::XMLReader &reader)
     reader.readElement("Part");
     std::string file (reader.getAttribute("file") );
 
-    if (!file.empty()) {
+    if (reader.hasAttribute("store")) {
+        // the shape is taken from the store when it's accessed the first time,
+        // its own file is only read if the store cannot be read
+        resetPending();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _store = ShapeStore::getStore(reader, reader.getAttribute("store"));
+        _storeIndex = static_cast<int>(reader.getAttributeAsInteger("shape"));
+        if (!file.empty())
+            _loader = reader.getFileLoader(file.c_str());
+        _pending = true;
+    }
+    else if (!file.empty()) {
         // initiate a file read
         reader.addFile(file.c_str(),this);
     }
@@ -277,6 +328,12 @@ static Standard_Boolean  BRepTools_Write(const TopoDS_Shape& Sh, const Standard_
 
 void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
 {
+    restoreLazily();
+    if (isPending()) {
+        // don't replace the data in the project file that couldn't be read
+        writer.addError(std::string("Cannot save '") + getName() + "' because its data couldn't be loaded");
+        return;
+    }
     // If the shape is empty we simply store nothing. The file size will be 0 which
     // can be checked when reading in the data.
     if (_Shape.getShape().IsNull())
@@ -288,9 +345,7 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
         shape.exportBinary(writer.Stream());
     }
     else {
-        bool direct = App::GetApplication().GetParameterGroupByPath
-            ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("DirectAccess", true);
-        if (!direct) {
+        if (writer.getMode("BrepTempFile")) {
             // create a temporary file and copy the content to the zip stream
             // once the tmp. filename is known use always the same because otherwise
             // we may run into some problems on the Linux platform
@@ -344,8 +399,99 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
     }
 }
 
+bool PropertyPartShape::canSaveDocFileInThread() const
+{
+    // without direct access a shared temporary file is used
+    return App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("DirectAccess", true);
+}
+
+bool PropertyPartShape::canRestoreDocFileInThread() const
+{
+    return canSaveDocFileInThread();
+}
+
+TopoDS_Shape PropertyPartShape::readShape(Base::Reader &reader)
+{
+    // the same as RestoreDocFile() with direct access
+    TopoDS_Shape shape;
+    Base::FileInfo brep(reader.getFileName());
+    if (brep.hasExtension("bin")) {
+        TopoShape topo;
+        topo.importBinary(reader);
+        shape = topo.getShape();
+    }
+    else {
+        BRep_Builder builder;
+        BRepTools::Read(shape, reader, builder);
+    }
+    return shape;
+}
+
+std::function<void()> PropertyPartShape::RestoreDocFileInThread(Base::Reader &reader)
+{
+    TopoDS_Shape shape = readShape(reader);
+    return [this, shape]() {
+        setValue(shape);
+    };
+}
+
+bool PropertyPartShape::RestoreDocFileLater(const std::shared_ptr<Base::DocFileLoader>& loader)
+{
+    if (!canRestoreDocFileInThread())
+        return false;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _loader = loader;
+    _pending = true;
+    return true;
+}
+
+void PropertyPartShape::restoreLazily() const
+{
+    if (!_pending)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    TopoShape& shape = const_cast<TopoShape&>(_Shape);
+    if (_store) {
+        // the store is read only once for all shapes
+        TopoDS_Shape storeShape;
+        if (_store->getShape(_storeIndex, storeShape)) {
+            shape.setShape(storeShape);
+            _store.reset();
+            _loader.reset();
+        }
+        else if (_loader) {
+            // fall back to the own file of the shape
+            _store.reset();
+        }
+    }
+    if (!_store && _loader) {
+        _loader->read([&shape](Base::Reader& reader) {
+            shape.setShape(readShape(reader));
+        });
+        if (!_loader->isPending())
+            _loader.reset();
+    }
+    _pending = _store || _loader;
+}
+
+bool PropertyPartShape::isPending() const
+{
+    return _pending;
+}
+
+void PropertyPartShape::resetPending()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _loader.reset();
+    _store.reset();
+    _pending = false;
+}
+
 void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
 {
+    resetPending();
     Base::FileInfo brep(reader.getFileName());
     if (brep.hasExtension("bin")) {
         TopoShape shape;
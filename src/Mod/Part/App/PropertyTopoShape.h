@@ -28,12 +28,16 @@
 #include <TopAbs_ShapeEnum.hxx>
 #include <App/DocumentObject.h>
 #include <App/PropertyGeo.h>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <vector>
 
 namespace Part
 {
 
+class ShapeStore;
+
 /** The part shape property class.
  * @author Werner Mayer
  */
@@ -81,7 +85,11 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool canSaveDocFileInThread() const;
     void RestoreDocFile(Base::Reader &reader);
+    bool canRestoreDocFileInThread() const;
+    std::function<void()> RestoreDocFileInThread(Base::Reader &reader);
+    bool RestoreDocFileLater(const std::shared_ptr<Base::DocFileLoader>& loader);
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
@@ -91,8 +99,24 @@ public:
     /// Get valid paths for this property; used by auto completer
     virtual void getPaths(std::vector<App::ObjectIdentifier> & paths) const;
 
+private:
+    static TopoDS_Shape readShape(Base::Reader &reader);
+    /// reads the shape if it was skipped on restore
+    void restoreLazily() const;
+    /// returns true if the shape of a restored document couldn't be read yet
+    bool isPending() const;
+    /// forgets where the shape of a restored document is to be read from
+    void resetPending();
+
 private:
     TopoShape _Shape;
+    mutable std::shared_ptr<Base::DocFileLoader> _loader;
+    mutable std::shared_ptr<ShapeStore> _store;
+    int _storeIndex;
+    /// true while _loader or _store hold a shape that wasn't read yet
+    mutable std::atomic<bool> _pending;
+    /// guards _loader and _store, the shape may be accessed from several threads
+    mutable std::mutex _mutex;
 };
 
 struct PartExport ShapeHistory {
@@ -0,0 +1,203 @@
+/***************************************************************************
+ *   Copyright (c) 2018 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <BinTools.hxx>
+# include <BinTools_ShapeSet.hxx>
+# include <Standard_Failure.hxx>
+#endif
+
+#include <Base/Console.h>
+#include <Base/Reader.h>
+#include <Base/Writer.h>
+
+#include "ShapeStore.h"
+
+FC_LOG_LEVEL_INIT("Part",true,true)
+
+using namespace Part;
+
+TYPESYSTEM_SOURCE(Part::ShapeStore, Base::Persistence)
+
+ShapeStore::ShapeStore()
+  : shapeSet(new BinTools_ShapeSet())
+{
+}
+
+ShapeStore::~ShapeStore()
+{
+}
+
+std::shared_ptr<ShapeStore> ShapeStore::getStore(Base::Writer& writer)
+{
+    std::shared_ptr<ShapeStore> store = std::static_pointer_cast<ShapeStore>
+        (writer.getSharedObject("Part::ShapeStore"));
+    if (!store) {
+        store = std::make_shared<ShapeStore>();
+        store->fileName = writer.addFile("PartShapes.bin", store.get());
+        writer.addSharedObject("Part::ShapeStore", store);
+    }
+    return store;
+}
+
+std::shared_ptr<ShapeStore> ShapeStore::getStore(Base::XMLReader& reader, const std::string& fileName)
+{
+    std::string key = "Part::ShapeStore:" + fileName;
+    std::shared_ptr<ShapeStore> store = std::static_pointer_cast<ShapeStore>
+        (reader.getSharedObject(key));
+    if (!store) {
+        store = std::make_shared<ShapeStore>();
+        store->fileName = fileName;
+        reader.addFile(fileName.c_str(), store.get());
+        reader.addSharedObject(key, store);
+    }
+    return store;
+}
+
+int ShapeStore::addShape(const TopoDS_Shape& shape)
+{
+    // An example how to use BinTools_ShapeSet can be found in BinMNaming_NamedShapeDriver.cxx
+    Entry entry;
+    entry.shape = shapeSet->Add(shape);
+    entry.location = shapeSet->Locations().Index(shape.Location());
+    entry.orientation = static_cast<int>(shape.Orientation());
+
+    std::map<Entry, int>::iterator it = entryIndex.find(entry);
+    if (it != entryIndex.end())
+        return it->second;
+
+    int index = static_cast<int>(entries.size());
+    entries.push_back(entry);
+    entryIndex[entry] = index;
+    return index;
+}
+
+bool ShapeStore::getShape(int index, TopoDS_Shape& shape)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (loader) {
+        loader->read([this](Base::Reader& reader) {
+            shapes = readShapes(reader);
+        });
+        if (loader->isPending())
+            return false;
+        loader.reset();
+    }
+
+    if (index < 0 || index >= static_cast<int>(shapes.size()))
+        return false;
+    shape = shapes[index];
+    return true;
+}
+
+unsigned int ShapeStore::getMemSize (void) const
+{
+    return 0;
+}
+
+void ShapeStore::Save (Base::Writer &/*writer*/) const
+{
+    // the properties refer to the file
+}
+
+void ShapeStore::Restore(Base::XMLReader &/*reader*/)
+{
+}
+
+void ShapeStore::SaveDocFile (Base::Writer &writer) const
+{
+    std::ostream& out = writer.Stream();
+    shapeSet->Write(out);
+    BinTools::PutInteger(out, static_cast<Standard_Integer>(entries.size()));
+    for (std::vector<Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        BinTools::PutInteger(out, it->shape);
+        BinTools::PutInteger(out, it->location);
+        BinTools::PutInteger(out, it->orientation);
+    }
+    FC_LOG("Saved " << entries.size() << " shapes with "
+        << shapeSet->NbShapes() << " sub-shapes to " << fileName);
+}
+
+std::vector<TopoDS_Shape> ShapeStore::readShapes(Base::Reader &reader) const
+{
+    std::vector<TopoDS_Shape> shapes;
+    try {
+        BinTools_ShapeSet set;
+        set.Read(reader);
+        Standard_Integer count = 0;
+        BinTools::GetInteger(reader, count);
+        shapes.reserve(count > 0 ? count : 0);
+        for (Standard_Integer i = 0; i < count && reader; i++) {
+            Standard_Integer shapeId=0, locId=0, orient=0;
+            BinTools::GetInteger(reader, shapeId);
+            BinTools::GetInteger(reader, locId);
+            BinTools::GetInteger(reader, orient);
+
+            TopoDS_Shape shape;
+            if (shapeId > 0 && shapeId <= set.NbShapes()) {
+                shape = set.Shape(shapeId);
+                shape.Location(set.Locations().Location(locId));
+                shape.Orientation(static_cast<TopAbs_Orientation>(orient));
+            }
+            shapes.push_back(shape);
+        }
+    }
+    catch (Standard_Failure& e) {
+        // the properties fall back to their own files if there are any
+        Base::Console().Error("Failed to read shapes from '%s': %s\n",
+            reader.getFileName().c_str(), e.GetMessageString());
+        shapes.clear();
+    }
+
+    return shapes;
+}
+
+void ShapeStore::setShapes(const std::vector<TopoDS_Shape>& result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    loader.reset();
+    shapes = result;
+}
+
+void ShapeStore::RestoreDocFile(Base::Reader &reader)
+{
+    setShapes(readShapes(reader));
+}
+
+std::function<void()> ShapeStore::RestoreDocFileInThread(Base::Reader &reader)
+{
+    std::vector<TopoDS_Shape> result = readShapes(reader);
+    return [this, result]() {
+        setShapes(result);
+    };
+}
+
+bool ShapeStore::RestoreDocFileLater(const std::shared_ptr<Base::DocFileLoader>& loader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->loader = loader;
+    return true;
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (c) 2018 Werner Mayer <wmayer[at]users.sourceforge.net>     *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PART_SHAPESTORE_H
+#define PART_SHAPESTORE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+#include <Base/Persistence.h>
+
+class BinTools_ShapeSet;
+
+namespace Base {
+class DocFileLoader;
+}
+
+namespace Part
+{
+
+/** The ShapeStore class keeps the shapes of all PropertyPartShape objects of a
+ * document in one binary BRep file. Sub-shapes, geometries and locations that
+ * are used by several shapes are thus saved and restored only once, which is
+ * common for the consecutive features of a body. Each property refers to its
+ * entry of the store by an index.
+ *
+ * The store is shared with the other properties through the writer and reader,
+ * see Base::Writer::getSharedObject(). After restore each property keeps a
+ * reference to the store and takes its shape when it's accessed the first time.
+ * If the document is saved in compatibility mode each property also writes its
+ * own shape file, which is read by versions that don't know the store and used
+ * as fallback if the store cannot be read.
+ */
+class PartExport ShapeStore : public Base::Persistence
+{
+    TYPESYSTEM_HEADER();
+
+public:
+    ShapeStore();
+    ~ShapeStore();
+
+    /** Returns the store of \a writer. It's created and its file is registered
+     * on first use.
+     */
+    static std::shared_ptr<ShapeStore> getStore(Base::Writer& writer);
+    /** Returns the store of \a reader that restores the file \a fileName. */
+    static std::shared_ptr<ShapeStore> getStore(Base::XMLReader& reader, const std::string& fileName);
+
+    /// The name of the file as registered with the writer
+    const std::string& getFileName() const
+    { return fileName; }
+    /** Adds \a shape to the store and returns the index of its entry. Identical
+     * shapes share the same entry.
+     */
+    int addShape(const TopoDS_Shape& shape);
+    /** Sets \a shape to the entry \a index. If the file was skipped on restore
+     * it's read now. Returns false if the file couldn't be read or has no such
+     * entry. It can be called from several threads.
+     */
+    bool getShape(int index, TopoDS_Shape& shape);
+
+    /** @name Save/restore */
+    //@{
+    unsigned int getMemSize (void) const;
+    void Save (Base::Writer &writer) const;
+    void Restore(Base::XMLReader &reader);
+    void SaveDocFile (Base::Writer &writer) const;
+    void RestoreDocFile(Base::Reader &reader);
+    bool canSaveDocFileInThread() const {return true;}
+    bool canRestoreDocFileInThread() const {return true;}
+    std::function<void()> RestoreDocFileInThread(Base::Reader &reader);
+    bool RestoreDocFileLater(const std::shared_ptr<Base::DocFileLoader>& loader);
+    //@}
+
+private:
+    std::vector<TopoDS_Shape> readShapes(Base::Reader &reader) const;
+    void setShapes(const std::vector<TopoDS_Shape>& result);
+
+private:
+    struct Entry {
+        int shape;
+        int location;
+        int orientation;
+        bool operator < (const Entry& e) const {
+            if (shape != e.shape)
+                return shape < e.shape;
+            if (location != e.location)
+                return location < e.location;
+            return orientation < e.orientation;
+        }
+    };
+
+    std::string fileName;
+    std::unique_ptr<BinTools_ShapeSet> shapeSet;
+    std::vector<Entry> entries;
+    std::map<Entry, int> entryIndex;
+    std::vector<TopoDS_Shape> shapes;
+    std::shared_ptr<Base::DocFileLoader> loader;
+    std::mutex mutex;
+};
+
+} //namespace Part
+
+
+#endif // PART_SHAPESTORE_H
@@ -28,9 +28,11 @@
 #include <Gui/WidgetFactory.h>
 
 #include <Mod/Part/App/PropertyTopoShape.h>
+#include <Mod/Part/App/TopoShapePy.h>
 
 #include "AttacherTexts.h"
 #include "PropertyEnumAttacherItem.h"
+#include "SoBrepDetailSwitch.h"
 #include "SoBrepFaceSet.h"
 #include "SoBrepEdgeSet.h"
 #include "SoBrepPointSet.h"
@@ -63,6 +65,7 @@
 #include "ViewProviderRegularPolygon.h"
 #include "ViewProviderAttachExtension.h"
 #include "TaskDimension.h"
+#include "TessellationCache.h"
 #include "DlgSettingsGeneral.h"
 #include "DlgSettingsObjectColor.h"
 #include "DlgSettings3DViewPartImp.h"
@@ -91,12 +94,33 @@ class Module : public Py::ExtensionModule<Module>
 public:
     Module() : Py::ExtensionModule<Module>("PartGui")
     {
+        add_varargs_method("getTessellationCacheFile",&Module::getTessellationCacheFile,
+            "getTessellationCacheFile(shape, deviation, angularDeflection, normalsFromUV)\n"
+            "Returns the file of the tessellation cache entry of the shape, after the\n"
+            "queued entries are written. The file may not exist."
+        );
         initialize("This module is the PartGui module."); // register with Python
     }
 
     virtual ~Module() {}
 
 private:
+    Py::Object getTessellationCacheFile(const Py::Tuple& args)
+    {
+        PyObject *pyShape;
+        double deviation, angularDeflection;
+        PyObject *normalsFromUV;
+        if (!PyArg_ParseTuple(args.ptr(), "O!ddO", &Part::TopoShapePy::Type, &pyShape,
+                              &deviation, &angularDeflection, &normalsFromUV))
+            throw Py::Exception();
+
+        const TopoDS_Shape &shape = static_cast<Part::TopoShapePy*>(pyShape)->getTopoShapePtr()->getShape();
+        TessellationCache &cache = TessellationCache::instance();
+        cache.flush();
+        std::string key = TessellationCache::makeKey(shape, deviation, angularDeflection,
+                                                     PyObject_IsTrue(normalsFromUV) ? true : false);
+        return Py::String(cache.getFileName(key));
+    }
 };
 
 PyObject* initModule()
@@ -150,6 +174,8 @@ PyMOD_INIT_FUNC(PartGui)
     PyModule_AddObject(partGuiModule, "AttachEngineResources", pAttachEngineTextsModule);
 
     PartGui::PropertyEnumAttacherItem               ::init();
+    PartGui::SoBrepDetailElement                    ::initClass();
+    PartGui::SoBrepDetailSwitch                     ::initClass();
     PartGui::SoBrepFaceSet                          ::initClass();
     PartGui::SoBrepEdgeSet                          ::initClass();
     PartGui::SoBrepPointSet                         ::initClass();
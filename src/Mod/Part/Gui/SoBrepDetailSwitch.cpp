@@ -0,0 +1,235 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <Inventor/actions/SoCallbackAction.h>
+# include <Inventor/actions/SoGetBoundingBoxAction.h>
+# include <Inventor/actions/SoGetMatrixAction.h>
+# include <Inventor/actions/SoGetPrimitiveCountAction.h>
+# include <Inventor/actions/SoGLRenderAction.h>
+# include <Inventor/actions/SoHandleEventAction.h>
+# include <Inventor/actions/SoPickAction.h>
+# include <Inventor/actions/SoSearchAction.h>
+# include <Inventor/elements/SoGLCacheContextElement.h>
+# include <Inventor/elements/SoViewportRegionElement.h>
+# include <Inventor/misc/SoChildList.h>
+# include <Inventor/misc/SoState.h>
+# include <Inventor/nodes/SoSeparator.h>
+#endif
+
+#include "SoBrepDetailSwitch.h"
+#include "SoBrepFaceSet.h"
+
+using namespace PartGui;
+
+SO_ELEMENT_SOURCE(SoBrepDetailElement)
+
+void SoBrepDetailElement::initClass(void)
+{
+    SO_ELEMENT_INIT_CLASS(SoBrepDetailElement, inherited);
+    SO_ENABLE(SoGLRenderAction, SoBrepDetailElement);
+}
+
+void SoBrepDetailElement::init(SoState * state)
+{
+    inherited::init(state);
+    this->data = SoBrepFaceSet::FineDetail;
+}
+
+SoBrepDetailElement::~SoBrepDetailElement()
+{
+}
+
+void SoBrepDetailElement::set(SoState * const state, SoNode * const node, int32_t level)
+{
+    SoInt32Element::set(classStackIndex, state, node, level);
+}
+
+int32_t SoBrepDetailElement::get(SoState * const state)
+{
+    return SoInt32Element::get(classStackIndex, state);
+}
+
+// ---------------------------------
+
+SO_NODE_SOURCE(SoBrepDetailSwitch)
+
+void SoBrepDetailSwitch::initClass()
+{
+    SO_NODE_INIT_CLASS(SoBrepDetailSwitch, SoGroup, "Group");
+}
+
+SoBrepDetailSwitch::SoBrepDetailSwitch()
+    : numLevels(1), levelBoxValid(false)
+{
+    SO_NODE_CONSTRUCTOR(SoBrepDetailSwitch);
+}
+
+SoBrepDetailSwitch::~SoBrepDetailSwitch()
+{
+}
+
+void SoBrepDetailSwitch::setContent(SoNode *node)
+{
+    removeAllChildren();
+    for (int level = SoBrepFaceSet::FineDetail; level < SoBrepFaceSet::NumDetailLevels; level++) {
+        SoSeparator *sep = new SoSeparator;
+        sep->renderCaching = numLevels > 1 ? SoSeparator::ON : SoSeparator::OFF;
+        sep->boundingBoxCaching = SoSeparator::OFF;
+        sep->addChild(node);
+        addChild(sep);
+    }
+}
+
+void SoBrepDetailSwitch::setNumLevels(int num)
+{
+    num = std::max(1, std::min<int>(num, SoBrepFaceSet::NumDetailLevels));
+    if (num == numLevels)
+        return;
+    numLevels = num;
+
+    // With a single level the caching is left to the nodes above
+    for (int i=0; i<getNumChildren(); i++) {
+        SoNode *child = getChild(i);
+        if (child->isOfType(SoSeparator::getClassTypeId()))
+            static_cast<SoSeparator*>(child)->renderCaching = num > 1 ? SoSeparator::ON : SoSeparator::OFF;
+    }
+    touch();
+}
+
+void SoBrepDetailSwitch::notify(SoNotList *list)
+{
+    levelBoxValid = false;
+    inherited::notify(list);
+}
+
+const SbBox3f &SoBrepDetailSwitch::getLevelBox(SoState *state)
+{
+    if (!levelBoxValid && getNumChildren() > 0) {
+        SoGetBoundingBoxAction action(SoViewportRegionElement::get(state));
+        action.apply(getChild(SoBrepFaceSet::FineDetail));
+        levelBox = action.getBoundingBox();
+        levelBoxValid = true;
+    }
+    return levelBox;
+}
+
+void SoBrepDetailSwitch::renderLevel(SoGLRenderAction *action, int level)
+{
+    if (level < 0 || level >= getNumChildren())
+        return;
+
+    SoState *state = action->getState();
+    state->push();
+    SoBrepDetailElement::set(state, this, level);
+    this->children->traverse(action, level);
+    state->pop();
+}
+
+void SoBrepDetailSwitch::GLRender(SoGLRenderAction *action)
+{
+    int numIndices;
+    const int *indices;
+    switch (action->getPathCode(numIndices, indices)) {
+    case SoAction::IN_PATH:
+        // e.g. delayed transparent shapes, whose path holds their level
+        for (int i=0; i<numIndices; i++)
+            renderLevel(action, indices[i]);
+        break;
+    case SoAction::OFF_PATH:
+        // the separators don't affect the state
+        break;
+    default: {
+        int level = SoBrepFaceSet::FineDetail;
+        int num = std::min(numLevels, getNumChildren());
+        if (num > 1) {
+            // The choice depends on the camera, so a render cache above
+            // would be rebuilt on every move, unlike the ones of the levels
+            SoState *state = action->getState();
+            SoGLCacheContextElement::shouldAutoCache(state, SoGLCacheContextElement::DONT_AUTO_CACHE);
+            const SbBox3f &box = getLevelBox(state);
+            if (!box.isEmpty())
+                level = std::min<int>(SoBrepFaceSet::getDetailLevel(state, box), num - 1);
+        }
+        renderLevel(action, level);
+        break;
+    }
+    }
+}
+
+void SoBrepDetailSwitch::doAction(SoAction *action)
+{
+    int numIndices;
+    const int *indices;
+    switch (action->getPathCode(numIndices, indices)) {
+    case SoAction::IN_PATH:
+        this->children->traverseInPath(action, numIndices, indices);
+        break;
+    case SoAction::OFF_PATH:
+        break;
+    default:
+        // all other actions use the full resolution
+        if (getNumChildren() > 0)
+            this->children->traverse(action, SoBrepFaceSet::FineDetail);
+        break;
+    }
+}
+
+void SoBrepDetailSwitch::callback(SoCallbackAction *action)
+{
+    doAction(action);
+}
+
+void SoBrepDetailSwitch::getBoundingBox(SoGetBoundingBoxAction *action)
+{
+    doAction(action);
+}
+
+void SoBrepDetailSwitch::getMatrix(SoGetMatrixAction *action)
+{
+    doAction(action);
+}
+
+void SoBrepDetailSwitch::handleEvent(SoHandleEventAction *action)
+{
+    doAction(action);
+}
+
+void SoBrepDetailSwitch::pick(SoPickAction *action)
+{
+    doAction(action);
+}
+
+void SoBrepDetailSwitch::search(SoSearchAction *action)
+{
+    SoNode::search(action);
+    if (!action->isFound())
+        doAction(action);
+}
+
+void SoBrepDetailSwitch::getPrimitiveCount(SoGetPrimitiveCountAction *action)
+{
+    doAction(action);
+}
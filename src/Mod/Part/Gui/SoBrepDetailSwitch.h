@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PARTGUI_SOBREPDETAILSWITCH_H
+#define PARTGUI_SOBREPDETAILSWITCH_H
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/elements/SoInt32Element.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoSubNode.h>
+
+class SoSeparator;
+
+namespace PartGui {
+
+/** The level of detail SoBrepFaceSet and SoBrepEdgeSet render with
+ * The value is one of SoBrepFaceSet::DetailLevel, it is set by SoBrepDetailSwitch.
+ */
+class PartGuiExport SoBrepDetailElement : public SoInt32Element {
+    typedef SoInt32Element inherited;
+
+    SO_ELEMENT_HEADER(SoBrepDetailElement);
+
+public:
+    static void initClass(void);
+
+    virtual void init(SoState * state);
+    static void set(SoState * const state, SoNode * const node, int32_t level);
+    static int32_t get(SoState * const state);
+
+protected:
+    virtual ~SoBrepDetailElement();
+};
+
+/** Chooses the level of detail of the shapes below it
+ *
+ * The switch holds the same subgraph once per level, each below its own separator, see setContent(). When rendering
+ * it picks the level from the projected size of the subgraph and whether the user is currently navigating, see
+ * SoBrepFaceSet::getDetailLevel(), and renders the separator of this level with SoBrepDetailElement set accordingly.
+ *
+ * The level is chosen above the separators, so each of them keeps a render cache of its level, which stays valid
+ * while the camera moves. The switch itself depends on the camera, so it keeps auto caching separators above from
+ * caching. All other actions use the full resolution. As long as there is only the full resolution, see
+ * setNumLevels(), the switch doesn't depend on the camera and leaves caching to the nodes above.
+ */
+class PartGuiExport SoBrepDetailSwitch : public SoGroup {
+    typedef SoGroup inherited;
+
+    SO_NODE_HEADER(SoBrepDetailSwitch);
+
+public:
+    static void initClass();
+    SoBrepDetailSwitch();
+
+    /// Replaces the children with one separator per level holding \a node
+    void setContent(SoNode *node);
+    /// Sets the number of levels that can be rendered, starting with the full resolution
+    void setNumLevels(int num);
+    int getNumLevels() const {
+        return numLevels;
+    }
+
+protected:
+    virtual ~SoBrepDetailSwitch();
+    virtual void doAction(SoAction *action);
+    virtual void GLRender(SoGLRenderAction *action);
+    virtual void callback(SoCallbackAction *action);
+    virtual void getBoundingBox(SoGetBoundingBoxAction *action);
+    virtual void getMatrix(SoGetMatrixAction *action);
+    virtual void handleEvent(SoHandleEventAction *action);
+    virtual void pick(SoPickAction *action);
+    virtual void search(SoSearchAction *action);
+    virtual void getPrimitiveCount(SoGetPrimitiveCountAction *action);
+    virtual void notify(SoNotList *list);
+
+private:
+    void renderLevel(SoGLRenderAction *action, int level);
+    const SbBox3f &getLevelBox(SoState *state);
+
+private:
+    int numLevels;
+    SbBox3f levelBox;
+    bool levelBoxValid;
+};
+
+} // namespace PartGui
+
+#endif // PARTGUI_SOBREPDETAILSWITCH_H
@@ -57,9 +57,11 @@
 # include <Inventor/details/SoLineDetail.h>
 # include <Inventor/misc/SoState.h>
 # include <Inventor/elements/SoCacheElement.h>
+# include <Inventor/elements/SoMaterialBindingElement.h>
 #endif
 
 #include "SoBrepEdgeSet.h"
+#include "SoBrepDetailSwitch.h"
 #include <Gui/SoFCUnifiedSelection.h>
 #include <Gui/SoFCSelectionAction.h>
 
@@ -71,6 +73,11 @@ struct SoBrepEdgeSet::SelContext: Gui::SoFCSelectionContext {
     std::vector<int32_t> hl, sl;
 };
 
+struct SoBrepEdgeSet::LevelData {
+    std::vector<SbVec3f> coords;
+    std::vector<int32_t> indices;
+};
+
 void SoBrepEdgeSet::initClass()
 {
     SO_NODE_INIT_CLASS(SoBrepEdgeSet, SoIndexedLineSet, "IndexedLineSet");
@@ -84,6 +91,81 @@ SoBrepEdgeSet::SoBrepEdgeSet()
     SO_NODE_CONSTRUCTOR(SoBrepEdgeSet);
 }
 
+SoBrepEdgeSet::~SoBrepEdgeSet()
+{
+}
+
+void SoBrepEdgeSet::setDetailLevel(SoBrepFaceSet::DetailLevel level, const std::vector<SbVec3f> &coords,
+                                   const std::vector<int32_t> &indices)
+{
+    if (level <= SoBrepFaceSet::FineDetail || level >= SoBrepFaceSet::NumDetailLevels)
+        return;
+
+    std::unique_ptr<LevelData> data(new LevelData);
+    data->coords = coords;
+    data->indices = indices;
+    levels[level] = std::move(data);
+
+    levelBox.makeEmpty();
+    for (auto &it : levels) {
+        if (it) {
+            for (auto &pnt : it->coords)
+                levelBox.extendBy(pnt);
+        }
+    }
+    touch();
+}
+
+void SoBrepEdgeSet::clearDetailLevels()
+{
+    bool changed = false;
+    for (auto &data : levels) {
+        if (data) {
+            data.reset();
+            changed = true;
+        }
+    }
+    levelBox.makeEmpty();
+    if (changed)
+        touch();
+}
+
+bool SoBrepEdgeSet::renderDetailLevel(SoGLRenderAction *action)
+{
+    if (levelBox.isEmpty() || this->vertexProperty.getValue())
+        return false;
+
+    // the level is chosen by SoBrepDetailSwitch above any render cache
+    SoState *state = action->getState();
+    int level = SoBrepDetailElement::get(state);
+    if (level <= SoBrepFaceSet::FineDetail)
+        return false;
+
+    // colors per edge refer to the full resolution
+    if (SoMaterialBindingElement::get(state) != SoMaterialBindingElement::OVERALL)
+        return false;
+
+    // use the next finer level if the requested one is not available
+    const LevelData *data = nullptr;
+    for (level = std::min<int>(level, SoBrepFaceSet::CoarseDetail);
+            level > SoBrepFaceSet::FineDetail && !data; level--)
+        data = levels[level].get();
+    if (!data)
+        return false;
+
+    if (!this->shouldGLRender(action))
+        return true;
+
+    // like SoIndexedLineSet without normals, render unlit
+    state->push();
+    SoLazyElement::setLightModel(state, SoLazyElement::BASE_COLOR);
+    SoMaterialBundle mb(action);
+    mb.sendFirst();
+    renderShape(data->coords.data(), data->indices.data(), static_cast<int>(data->indices.size()));
+    state->pop();
+    return true;
+}
+
 void SoBrepEdgeSet::GLRender(SoGLRenderAction *action)
 {
     auto state = action->getState();
@@ -146,7 +228,7 @@ void SoBrepEdgeSet::GLRender(SoGLRenderAction *action)
     }
     if(ctx2 && ctx2->selectionIndex.size())
         renderSelection(action,ctx2,false);
-    else
+    else if(!renderDetailLevel(action))
         inherited::GLRender(action);
 
     // Workaround for #0000433
@@ -200,12 +282,9 @@ void SoBrepEdgeSet::getBoundingBox(SoGetBoundingBoxAction * action) {
         action->extendBy(bbox);
 }
 
-void SoBrepEdgeSet::renderShape(const SoGLCoordinateElement * const coords,
+void SoBrepEdgeSet::renderShape(const SbVec3f *coords3d,
                                 const int32_t *cindices, int numindices)
 {
-
-    const SbVec3f * coords3d = coords->getArrayPtr3();
-
     int32_t i;
     int previ;
     const int32_t *end = cindices + numindices;
@@ -254,7 +333,7 @@ void SoBrepEdgeSet::renderHighlight(SoGLRenderAction *action, SelContextPtr ctx)
     int num = (int)ctx->hl.size();
     if (num > 0) {
         if (ctx->hl[0] < 0) {
-            renderShape(static_cast<const SoGLCoordinateElement*>(coords), cindices, numcindices);
+            renderShape(coords->getArrayPtr3(), cindices, numcindices);
         }
         else {
             const int32_t* id = &(ctx->hl[0]);
@@ -262,7 +341,7 @@ void SoBrepEdgeSet::renderHighlight(SoGLRenderAction *action, SelContextPtr ctx)
                 SoDebugError::postWarning("SoBrepEdgeSet::renderHighlight", "highlightIndex out of range");
             }
             else {
-                renderShape(static_cast<const SoGLCoordinateElement*>(coords), id, num);
+                renderShape(coords->getArrayPtr3(), id, num);
             }
         }
     }
@@ -299,7 +378,7 @@ void SoBrepEdgeSet::renderSelection(SoGLRenderAction *action, SelContextPtr ctx,
     int num = (int)ctx->sl.size();
     if (num > 0) {
         if (ctx->sl[0] < 0) {
-            renderShape(static_cast<const SoGLCoordinateElement*>(coords), cindices, numcindices);
+            renderShape(coords->getArrayPtr3(), cindices, numcindices);
         }
         else {
             cindices = &(ctx->sl[0]);
@@ -308,7 +387,7 @@ void SoBrepEdgeSet::renderSelection(SoGLRenderAction *action, SelContextPtr ctx,
                 SoDebugError::postWarning("SoBrepEdgeSet::renderSelection", "selectionIndex out of range");
             }
             else {
-                renderShape(static_cast<const SoGLCoordinateElement*>(coords), cindices, numcindices);
+                renderShape(coords->getArrayPtr3(), cindices, numcindices);
             }
         }
     }
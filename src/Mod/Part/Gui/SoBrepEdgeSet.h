@@ -34,6 +34,7 @@
 #include <vector>
 #include <memory>
 #include <Gui/SoFCSelectionContext.h>
+#include "SoBrepFaceSet.h"
 
 class SoCoordinateElement;
 class SoGLCoordinateElement;
@@ -50,8 +51,18 @@ public:
     static void initClass();
     SoBrepEdgeSet();
 
+    /** Sets the lines used for a coarser level of detail
+     * The coordinates replace the ones of the state while the level is
+     * rendered. Highlighting and selection always use the full resolution.
+     * \sa SoBrepFaceSet::setDetailLevel()
+     */
+    void setDetailLevel(SoBrepFaceSet::DetailLevel level, const std::vector<SbVec3f> &coords,
+                        const std::vector<int32_t> &indices);
+    /// Removes all coarser levels of detail
+    void clearDetailLevels();
+
 protected:
-    virtual ~SoBrepEdgeSet() {};
+    virtual ~SoBrepEdgeSet();
     virtual void GLRender(SoGLRenderAction *action);
     virtual void GLRenderBelowPath(SoGLRenderAction * action);
     virtual void doAction(SoAction* action); 
@@ -67,8 +78,9 @@ private:
     struct SelContext;
     typedef std::shared_ptr<SelContext> SelContextPtr;
 
-    void renderShape(const SoGLCoordinateElement * const vertexlist,
+    void renderShape(const SbVec3f *coords3d,
                      const int32_t *vertexindices, int num_vertexindices);
+    bool renderDetailLevel(SoGLRenderAction *action);
     void renderHighlight(SoGLRenderAction *action, SelContextPtr);
     void renderSelection(SoGLRenderAction *action, SelContextPtr, bool push=true);
     bool validIndexes(const SoCoordinateElement*, const std::vector<int32_t>&) const;
@@ -78,6 +90,10 @@ private:
     SelContextPtr selContext2;
     Gui::SoFCSelectionCounter selCounter;
     uint32_t packedColor;
+
+    struct LevelData;
+    std::unique_ptr<LevelData> levels[SoBrepFaceSet::NumDetailLevels];
+    SbBox3f levelBox;
 };
 
 } // namespace PartGui
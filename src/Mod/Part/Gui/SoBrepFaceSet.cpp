@@ -60,6 +60,7 @@
 # include <Inventor/elements/SoShapeStyleElement.h>
 # include <Inventor/elements/SoCacheElement.h>
 # include <Inventor/elements/SoTextureEnabledElement.h>
+# include <Inventor/elements/SoNormalElement.h>
 # ifdef FC_OS_WIN32
 #  include <windows.h>
 #  include <GL/gl.h>
@@ -79,6 +80,7 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 #include "SoBrepFaceSet.h"
+#include "SoBrepDetailSwitch.h"
 #include <Gui/SoFCUnifiedSelection.h>
 #include <Gui/SoFCSelectionAction.h>
 #include <Gui/SoFCInteractiveElement.h>
@@ -165,6 +167,14 @@ public:
 
 SbBool SoBrepFaceSet::VBO::vboAvailable = false;
 
+struct SoBrepFaceSet::LevelData {
+    std::vector<SbVec3f> coords;
+    std::vector<SbVec3f> normals;
+    std::vector<int32_t> indices;
+    std::vector<int32_t> parts;
+    std::unique_ptr<VBO> vbo;
+};
+
 void SoBrepFaceSet::initClass()
 {
     SO_NODE_INIT_CLASS(SoBrepFaceSet, SoIndexedFaceSet, "IndexedFaceSet");
@@ -180,12 +190,117 @@ SoBrepFaceSet::SoBrepFaceSet()
     packedColor = 0;
 
     pimpl.reset(new VBO);
+    renderLevel = nullptr;
 }
 
 SoBrepFaceSet::~SoBrepFaceSet()
 {
 }
 
+void SoBrepFaceSet::setDetailLevel(DetailLevel level, const std::vector<SbVec3f> &coords,
+                                   const std::vector<SbVec3f> &normals, const std::vector<int32_t> &indices,
+                                   const std::vector<int32_t> &parts)
+{
+    if (level <= FineDetail || level >= NumDetailLevels)
+        return;
+
+    std::unique_ptr<LevelData> data(new LevelData);
+    data->coords = coords;
+    data->normals = normals;
+    data->indices = indices;
+    data->parts = parts;
+    data->vbo.reset(new VBO);
+    levels[level] = std::move(data);
+
+    levelBox.makeEmpty();
+    for (auto &it : levels) {
+        if (it) {
+            for (auto &pnt : it->coords)
+                levelBox.extendBy(pnt);
+        }
+    }
+    touch();
+}
+
+void SoBrepFaceSet::clearDetailLevels()
+{
+    bool changed = false;
+    for (auto &data : levels) {
+        if (data) {
+            data.reset();
+            changed = true;
+        }
+    }
+    levelBox.makeEmpty();
+    if (changed)
+        touch();
+}
+
+SoBrepFaceSet::DetailLevel SoBrepFaceSet::getDetailLevel(SoState *state, const SbBox3f &box)
+{
+    // projected size in pixels below which the medium or coarse level is enough
+    static const int MediumDetailPixels = 400;
+    static const int CoarseDetailPixels = 100;
+
+    SbVec2s screenSize;
+    getScreenSize(state, box, screenSize);
+    int pixels = std::max(screenSize[0], screenSize[1]);
+    int level = FineDetail;
+    if (pixels < CoarseDetailPixels)
+        level = CoarseDetail;
+    else if (pixels < MediumDetailPixels)
+        level = MediumDetail;
+
+    // one level coarser while the user is navigating
+    if (Gui::SoFCInteractiveElement::get(state))
+        level++;
+    return static_cast<DetailLevel>(std::min<int>(level, CoarseDetail));
+}
+
+const SoBrepFaceSet::LevelData *SoBrepFaceSet::findDetailLevel(SoGLRenderAction *action)
+{
+    if (levelBox.isEmpty() || this->vertexProperty.getValue())
+        return nullptr;
+
+    // the level is chosen by SoBrepDetailSwitch above any render cache
+    SoState *state = action->getState();
+    int level = SoBrepDetailElement::get(state);
+    if (level <= FineDetail)
+        return nullptr;
+
+    // textures and colors per vertex or face refer to the full resolution
+    if (SoTextureEnabledElement::get(state))
+        return nullptr;
+    Binding mbind = this->findMaterialBinding(state);
+    if (mbind != OVERALL && mbind != PER_PART && mbind != PER_PART_INDEXED)
+        return nullptr;
+
+    // use the next finer level if the requested one is not available
+    for (level = std::min<int>(level, CoarseDetail); level > FineDetail; level--) {
+        const LevelData *data = levels[level].get();
+        if (data && !data->normals.empty()
+                 && data->parts.size() == static_cast<std::size_t>(this->partIndex.getNum()))
+            return data;
+    }
+    return nullptr;
+}
+
+void SoBrepFaceSet::getDetailLevelData(const SbVec3f *&normals, const int32_t *&cindices, int &numindices,
+                                       const int32_t *&nindices, const int32_t *&mindices,
+                                       const int32_t *&pindices, Binding &nbind) const
+{
+    const int32_t *indices = renderLevel->indices.data();
+    if (mindices == cindices)
+        mindices = indices;
+    if (nbind != OVERALL)
+        nbind = PER_VERTEX_INDEXED;
+    normals = renderLevel->normals.data();
+    nindices = indices;
+    cindices = indices;
+    numindices = static_cast<int>(renderLevel->indices.size());
+    pindices = renderLevel->parts.data();
+}
+
 void SoBrepFaceSet::doAction(SoAction* action)
 {
     if (action->getTypeId() == Gui::SoHighlightElementAction::getClassTypeId()) {
@@ -346,6 +461,14 @@ void SoBrepFaceSet::doAction(SoAction* action)
             v.second.updateVbo = true;
             v.second.vboLoaded = false;
         }
+        for(auto &data : levels) {
+            if(!data)
+                continue;
+            for(auto &v : data->vbo->vbomap) {
+                v.second.updateVbo = true;
+                v.second.vboLoaded = false;
+            }
+        }
     }
 
     inherited::doAction(action);
@@ -515,6 +638,26 @@ void SoBrepFaceSet::renderColoredArray(SoMaterialBundle *const materials)
 #else
 
 void SoBrepFaceSet::GLRender(SoGLRenderAction *action)
+{
+    const LevelData *level = findDetailLevel(action);
+    if (!level) {
+        renderFaces(action);
+        return;
+    }
+
+    // The level replaces the coordinates and normals of the state here and
+    // the indices in getDetailLevelData()
+    SoState *state = action->getState();
+    state->push();
+    SoCoordinateElement::set3(state, this, static_cast<int32_t>(level->coords.size()), level->coords.data());
+    SoNormalElement::set(state, this, static_cast<int32_t>(level->normals.size()), level->normals.data());
+    renderLevel = level;
+    renderFaces(action);
+    renderLevel = nullptr;
+    state->pop();
+}
+
+void SoBrepFaceSet::renderFaces(SoGLRenderAction *action)
 {
     //SoBase::staticDataLock();
     static bool init = false;
@@ -652,6 +795,8 @@ void SoBrepFaceSet::GLRender(SoGLRenderAction *action)
         if (!nindices) nindices = cindices;
         pindices = this->partIndex.getValues(0);
         numparts = this->partIndex.getNum();
+        if (renderLevel)
+            getDetailLevelData(normals, cindices, numindices, nindices, mindices, pindices, nbind);
 
         SbBool hasVBO = !ctx2 && PRIVATE(this)->vboAvailable;
         if (hasVBO) {
@@ -1008,6 +1153,11 @@ void SoBrepFaceSet::generatePrimitives(SoAction * action)
                         nindices, tindices, mindices, numindices,
                         sendNormals, normalCacheUsed);
 
+    // called by shouldGLRender() for sorted transparency
+    const int32_t *pindices = this->partIndex.getValues(0);
+    if (renderLevel)
+        getDetailLevelData(normals, cindices, numindices, nindices, mindices, pindices, nbind);
+
     SoTextureCoordinateBundle tb(action, false, false);
     doTextures = tb.needCoordinates();
 
@@ -1063,7 +1213,7 @@ void SoBrepFaceSet::generatePrimitives(SoAction * action)
     TriangleShape newmode;
     const int32_t *viptr = cindices;
     const int32_t *viendptr = viptr + numindices;
-    const int32_t *piptr = this->partIndex.getValues(0);
+    const int32_t *piptr = pindices;
     int num_partindices = this->partIndex.getNum();
     const int32_t *piendptr = piptr + num_partindices;
     int32_t v1, v2, v3, v4, v5 = 0, pi; // v5 init unnecessary, but kills a compiler warning.
@@ -1259,6 +1409,8 @@ void SoBrepFaceSet::renderHighlight(SoGLRenderAction *action, SelContextPtr ctx)
         if (!mindices) mindices = cindices;
         if (!nindices) nindices = cindices;
         pindices = this->partIndex.getValues(0);
+        if (renderLevel)
+            getDetailLevelData(normals, cindices, numindices, nindices, mindices, pindices, nbind);
 
         // coords
         int start=0;
@@ -1342,6 +1494,8 @@ void SoBrepFaceSet::renderSelection(SoGLRenderAction *action, SelContextPtr ctx,
     if (!mindices) mindices = cindices;
     if (!nindices) nindices = cindices;
     pindices = this->partIndex.getValues(0);
+    if (renderLevel)
+        getDetailLevelData(normals, cindices, numindices, nindices, mindices, pindices, nbind);
 
     if(push) {
         // materials
@@ -1747,7 +1901,8 @@ void SoBrepFaceSet::renderShape(SoGLRenderAction * action,
             // if no shading is set then the normals are all equal
             nbinding = static_cast<int>(OVERALL);
         }
-        PRIVATE(this)->render(action, vertexlist, vertexindices, num_indices, partindices, num_partindices, normals,
+        VBO *vbo = renderLevel ? renderLevel->vbo.get() : PRIVATE(this).get();
+        vbo->render(action, vertexlist, vertexindices, num_indices, partindices, num_partindices, normals,
                     normalindices, materials, matindices, texcoords, texindices, nbinding, mbind, texture);
         return;
     }
@@ -31,6 +31,8 @@
 #include <Inventor/nodes/SoIndexedFaceSet.h>
 #include <Inventor/elements/SoLazyElement.h>
 #include <Inventor/elements/SoReplacedElement.h>
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbVec2s.h>
 #include <vector>
 #include <memory>
 #include <Gui/SoFCSelectionContext.h>
@@ -73,6 +75,13 @@ namespace PartGui {
  * Actually you can access the highlightIndex directly or you can apply a SoHighlightElementAction on it. And don't forget: if you
  * do some mouse picking and you got a SoFaceDetail then use getPartIndex() to get the correct part.
  *
+ * Level of detail:
+ * Besides the full resolution given by the fields a shape may have coarser tessellations, see setDetailLevel(). When
+ * rendering, the shape uses the level given by SoBrepDetailElement, which a SoBrepDetailSwitch above sets depending on
+ * the projected size of the shape and whether the user is currently navigating. Every level must have the same number
+ * of parts, so highlightIndex and selectionIndex address the same faces on all levels. Picking and all other actions
+ * always use the full resolution.
+ *
  * As an example how to use the class correctly see ViewProviderPartExt::updateVisual().
  */
 class PartGuiExport SoBrepFaceSet : public SoIndexedFaceSet {
@@ -86,6 +95,27 @@ public:
 
     SoMFInt32 partIndex;
 
+    enum DetailLevel {
+        FineDetail = 0,
+        MediumDetail,
+        CoarseDetail,
+        NumDetailLevels
+    };
+
+    /** Sets the tessellation used for a coarser level of detail
+     * The coordinates and normals replace the ones of the state while the level
+     * is rendered, the normals are bound per vertex indexed. \a parts must have
+     * as many entries as the partIndex field when rendering, otherwise the level
+     * is ignored.
+     */
+    void setDetailLevel(DetailLevel level, const std::vector<SbVec3f> &coords,
+                        const std::vector<SbVec3f> &normals, const std::vector<int32_t> &indices,
+                        const std::vector<int32_t> &parts);
+    /// Removes all coarser levels of detail
+    void clearDetailLevels();
+    /// Returns the level of detail to render a shape with the given bounding box, see SoBrepDetailSwitch
+    static DetailLevel getDetailLevel(SoState *state, const SbBox3f &box);
+
 protected:
     virtual ~SoBrepFaceSet();
     virtual void GLRender(SoGLRenderAction *action);
@@ -138,6 +168,13 @@ private:
 
     bool overrideMaterialBinding(SoGLRenderAction *action, SelContextPtr ctx, SelContextPtr ctx2);
 
+    void renderFaces(SoGLRenderAction *action);
+    struct LevelData;
+    const LevelData *findDetailLevel(SoGLRenderAction *action);
+    void getDetailLevelData(const SbVec3f *&normals, const int32_t *&cindices, int &numindices,
+                            const int32_t *&nindices, const int32_t *&mindices,
+                            const int32_t *&pindices, Binding &nbind) const;
+
 #ifdef RENDER_GLARRAYS
     void renderSimpleArray();
     void renderColoredArray(SoMaterialBundle *const materials);
@@ -158,6 +195,11 @@ private:
     // Define some VBO pointer for the current mesh
     class VBO;
     std::unique_ptr<VBO> pimpl;
+
+    // Coarser tessellations, the one being rendered is renderLevel
+    std::unique_ptr<LevelData> levels[NumDetailLevels];
+    const LevelData *renderLevel;
+    SbBox3f levelBox;
 };
 
 } // namespace PartGui
@@ -0,0 +1,323 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <ctime>
+# include <sstream>
+# include <BRep_Tool.hxx>
+# include <Geom_Curve.hxx>
+# include <Geom_Surface.hxx>
+# include <Geom2d_Curve.hxx>
+# include <GeomTools_Curve2dSet.hxx>
+# include <GeomTools_CurveSet.hxx>
+# include <GeomTools_SurfaceSet.hxx>
+# include <gp_Trsf.hxx>
+# include <TopExp.hxx>
+# include <TopExp_Explorer.hxx>
+# include <TopLoc_Location.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Edge.hxx>
+# include <TopoDS_Face.hxx>
+# include <TopoDS_Shape.hxx>
+# include <TopoDS_Vertex.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+# include <QCoreApplication>
+# include <QCryptographicHash>
+# include <QThreadPool>
+# include <QtConcurrentRun>
+#endif
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <Base/Console.h>
+#include <Base/FileInfo.h>
+#include <Base/Stream.h>
+#include <Base/TimeInfo.h>
+#include <App/Application.h>
+
+#include "TessellationCache.h"
+
+FC_LOG_LEVEL_INIT("Part", true, true)
+
+using namespace PartGui;
+
+static void writeLocation(std::ostream &str, const TopLoc_Location &loc)
+{
+    if (loc.IsIdentity()) {
+        str << " I";
+        return;
+    }
+    const gp_Trsf &trsf = loc.Transformation();
+    for (int r=1; r<=3; r++) {
+        for (int c=1; c<=4; c++)
+            str << ' ' << trsf.Value(r,c);
+    }
+}
+
+TessellationCache::TessellationCache()
+    : writer(new QThreadPool), maxSize(0), storedSize(0)
+{
+    // one thread keeps the writes in order and off the other cores
+    writer->setMaxThreadCount(1);
+}
+
+TessellationCache::~TessellationCache()
+{
+    writer->waitForDone();
+}
+
+TessellationCache &TessellationCache::instance()
+{
+    static TessellationCache cache;
+    return cache;
+}
+
+std::string TessellationCache::makeKey(const TopoDS_Shape &shape, double deviation,
+                                       double angularDeflection, bool normalsFromUV)
+{
+    // The geometry is written with the OCC tools while the topology is
+    // described by the indices into the maps of sub-shapes. Triangulations
+    // are left out on purpose.
+    std::ostringstream str;
+    str.precision(17);
+    str << "TessellationCache 1 " << deviation << ' ' << angularDeflection
+        << ' ' << normalsFromUV << ' ' << shape.ShapeType();
+    writeLocation(str, shape.Location());
+    str << '\n';
+
+    TopTools_IndexedMapOfShape faceMap, edgeMap, vertexMap;
+    TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+    TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+    TopExp::MapShapes(shape, TopAbs_VERTEX, vertexMap);
+
+    GeomTools_SurfaceSet surfaces;
+    GeomTools_CurveSet curves;
+    GeomTools_Curve2dSet curves2d;
+
+    for (int i=1; i<=vertexMap.Extent(); i++) {
+        gp_Pnt pnt = BRep_Tool::Pnt(TopoDS::Vertex(vertexMap(i)));
+        str << "V " << pnt.X() << ' ' << pnt.Y() << ' ' << pnt.Z() << '\n';
+    }
+
+    for (int i=1; i<=edgeMap.Extent(); i++) {
+        const TopoDS_Edge &edge = TopoDS::Edge(edgeMap(i));
+        TopLoc_Location loc;
+        Standard_Real first = 0, last = 0;
+        Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, loc, first, last);
+        str << "E " << (curve.IsNull() ? 0 : curves.Add(curve)) << ' ' << first << ' ' << last;
+        writeLocation(str, loc);
+        for (TopExp_Explorer xp(edge, TopAbs_VERTEX); xp.More(); xp.Next())
+            str << ' ' << vertexMap.FindIndex(xp.Current()) << ' ' << xp.Current().Orientation();
+        str << '\n';
+    }
+
+    for (int i=1; i<=faceMap.Extent(); i++) {
+        const TopoDS_Face &face = TopoDS::Face(faceMap(i));
+        TopLoc_Location loc;
+        Handle(Geom_Surface) surface = BRep_Tool::Surface(face, loc);
+        str << "F " << (surface.IsNull() ? 0 : surfaces.Add(surface)) << ' ' << face.Orientation();
+        writeLocation(str, loc);
+        str << '\n';
+        for (TopExp_Explorer xp(face, TopAbs_EDGE); xp.More(); xp.Next()) {
+            const TopoDS_Edge &edge = TopoDS::Edge(xp.Current());
+            Standard_Real first = 0, last = 0;
+            Handle(Geom2d_Curve) pcurve = BRep_Tool::CurveOnSurface(edge, face, first, last);
+            str << ' ' << edgeMap.FindIndex(edge) << ' ' << edge.Orientation()
+                << ' ' << (pcurve.IsNull() ? 0 : curves2d.Add(pcurve)) << ' ' << first << ' ' << last;
+        }
+        str << '\n';
+    }
+
+    surfaces.Write(str);
+    curves.Write(str);
+    curves2d.Write(str);
+
+    std::string data = str.str();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(data.c_str(), static_cast<int>(data.size()));
+    return std::string(hash.result().toHex().constData());
+}
+
+void TessellationCache::setMaxSize(std::size_t bytes)
+{
+    maxSize = bytes;
+}
+
+std::string TessellationCache::getDirectory() const
+{
+    return App::Application::getUserAppDataDir() + "TessellationCache";
+}
+
+std::string TessellationCache::getFileName(const std::string &key) const
+{
+    return getDirectory() + "/" + key + ".fctc";
+}
+
+bool TessellationCache::load(const std::string &key, std::string &data) const
+{
+    if (!isEnabled())
+        return false;
+
+    Base::FileInfo fi(getFileName(key));
+    if (!fi.exists())
+        return false;
+
+    Base::ifstream file(fi, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    std::ostringstream str;
+    str << file.rdbuf();
+    if (file.bad())
+        return false;
+    data = str.str();
+    file.close();
+
+    // prune() removes the least recently written or read entries first
+#ifdef FC_OS_WIN32
+    boost::filesystem::path path(fi.toStdWString());
+#else
+    boost::filesystem::path path(fi.filePath());
+#endif
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+    return true;
+}
+
+void TessellationCache::store(const std::string &key, const std::string &data)
+{
+    std::size_t limit = maxSize;
+    if (!limit || data.size() > limit)
+        return;
+
+    QtConcurrent::run(writer.get(), [this, key, data]() {
+        write(key, data);
+    });
+}
+
+void TessellationCache::write(const std::string &key, const std::string &data)
+{
+    std::size_t limit = maxSize;
+    if (!limit || data.size() > limit)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Base::FileInfo dir(getDirectory());
+        if (!dir.exists() && !dir.createDirectory()) {
+            FC_WARN("Cannot create tessellation cache directory " << dir.filePath());
+            return;
+        }
+        // Remove old entries once per session and whenever a quarter of the
+        // allowed size has been added since
+        if (!pruned || storedSize > limit / 4) {
+            pruned = true;
+            storedSize = 0;
+            prune();
+        }
+    }
+
+    // Write to a temporary file first, so that other threads or processes
+    // never read a partial entry
+    static std::atomic<unsigned> counter(0);
+    std::ostringstream tmpName;
+    tmpName << getFileName(key) << '.' << QCoreApplication::applicationPid()
+            << '.' << ++counter << ".tmp";
+    Base::FileInfo tmp(tmpName.str());
+    {
+        Base::ofstream file(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return;
+        file.write(data.c_str(), data.size());
+        if (!file.good()) {
+            file.close();
+            tmp.deleteFile();
+            return;
+        }
+    }
+    if (!tmp.renameFile(getFileName(key).c_str()))
+        tmp.deleteFile();
+    storedSize += data.size();
+}
+
+void TessellationCache::clear()
+{
+    writer->waitForDone();
+    std::lock_guard<std::mutex> lock(mutex);
+    Base::FileInfo dir(getDirectory());
+    if (dir.exists())
+        dir.deleteDirectoryRecursive();
+    storedSize = 0;
+}
+
+void TessellationCache::flush()
+{
+    writer->waitForDone();
+}
+
+void TessellationCache::prune()
+{
+    Base::FileInfo dir(getDirectory());
+    std::vector<Base::FileInfo> files = dir.getDirectoryContent();
+
+    struct Entry {
+        Base::FileInfo file;
+        Base::TimeInfo time;
+        std::size_t size;
+    };
+    std::vector<Entry> entries;
+    std::size_t total = 0;
+    Base::TimeInfo now;
+    for (auto &fi : files) {
+        if (!fi.isFile())
+            continue;
+        // left over by a crashed session
+        if (fi.hasExtension("tmp")) {
+            if (now.getSeconds() > fi.lastModified().getSeconds() + 24*3600)
+                fi.deleteFile();
+            continue;
+        }
+        if (!fi.hasExtension("fctc"))
+            continue;
+        Entry entry = {fi, fi.lastModified(), fi.size()};
+        entries.push_back(entry);
+        total += entry.size;
+    }
+
+    std::size_t limit = maxSize;
+    if (total <= limit)
+        return;
+
+    // oldest entries first
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.time < b.time;
+    });
+    for (auto &entry : entries) {
+        if (total <= limit)
+            break;
+        if (entry.file.deleteFile())
+            total -= entry.size;
+    }
+}
@@ -0,0 +1,103 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Project                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PARTGUI_TESSELLATIONCACHE_H
+#define PARTGUI_TESSELLATIONCACHE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class QThreadPool;
+class TopoDS_Shape;
+
+namespace PartGui {
+
+/** Disk cache of shape visuals
+ *
+ * The tessellated visual of a shape is stored in the user data directory
+ * under a key computed from the geometry and topology of the shape and the
+ * tessellation settings. Opening a document again can then load the visual
+ * instead of meshing the unchanged shapes once more.
+ *
+ * The entries are opaque to the cache, the caller is responsible for the
+ * format. All methods may be called from any thread. Entries are written
+ * and old ones removed by a background thread, so that storing never blocks
+ * the caller on disk access.
+ */
+class PartGuiExport TessellationCache
+{
+public:
+    /// Returns the one and only cache
+    static TessellationCache &instance();
+
+    /** Computes the cache key of a shape
+     *
+     * The key only depends on the geometry, the topology and the location of
+     * the shape, i.e. a shape restored from a file has the same key as the
+     * shape it was saved from, no matter if it has a triangulation or not.
+     */
+    static std::string makeKey(const TopoDS_Shape &shape, double deviation,
+                               double angularDeflection, bool normalsFromUV);
+
+    /// Sets the maximum size of the cache in bytes, 0 disables the cache
+    void setMaxSize(std::size_t bytes);
+    /// Whether the cache is used
+    bool isEnabled() const {
+        return maxSize.load() > 0;
+    }
+
+    /** Reads the entry of \a key into \a data, returns false if there is none
+     *
+     * A found entry counts as recently used, i.e. it is removed after the
+     * entries that weren't read since.
+     */
+    bool load(const std::string &key, std::string &data) const;
+    /// Queues \a data to be stored as entry of \a key and returns immediately
+    void store(const std::string &key, const std::string &data);
+    /// Removes all entries, waits for queued writes first
+    void clear();
+    /// Waits until the queued entries are written
+    void flush();
+    /// Returns the file of the entry of \a key
+    std::string getFileName(const std::string &key) const;
+
+private:
+    TessellationCache();
+    ~TessellationCache();
+
+    std::string getDirectory() const;
+    void write(const std::string &key, const std::string &data);
+    void prune();
+
+private:
+    std::unique_ptr<QThreadPool> writer;
+    std::atomic<std::size_t> maxSize;
+    std::atomic<std::size_t> storedSize;
+    std::mutex mutex;
+    bool pruned = false;
+};
+
+} // namespace PartGui
+
+#endif // PARTGUI_TESSELLATIONCACHE_H
@@ -24,10 +24,15 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
+# include <cstring>
+# include <mutex>
+# include <shared_mutex>
 # include <sstream>
 # include <Bnd_Box.hxx>
 # include <Poly_Polygon3D.hxx>
 # include <BRepBndLib.hxx>
+# include <BRepBuilderAPI_Copy.hxx>
 # include <BRepBuilderAPI_MakeVertex.hxx>
 # include <BRepExtrema_DistShapeShape.hxx>
 # include <BRepMesh_IncrementalMesh.hxx>
@@ -95,6 +100,8 @@
 # include <Inventor/nodes/SoLightModel.h>
 # include <QAction>
 # include <QMenu>
+# include <QFutureWatcher>
+# include <QtConcurrentRun>
 #endif
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -103,6 +110,7 @@
 #include <Base/Console.h>
 #include <Base/Parameter.h>
 #include <Base/Exception.h>
+#include <Base/Profiler.h>
 #include <Base/TimeInfo.h>
 
 #include <App/Application.h>
@@ -120,8 +128,10 @@
 #include "ViewProviderExt.h"
 #include "SoBrepPointSet.h"
 #include "SoBrepEdgeSet.h"
+#include "SoBrepDetailSwitch.h"
 #include "SoBrepFaceSet.h"
 #include "TaskFaceColors.h"
+#include "TessellationCache.h"
 
 #include <Mod/Part/App/PartFeature.h>
 #include <Mod/Part/App/PrimitiveFeature.h>
@@ -132,6 +142,161 @@ using namespace PartGui;
 
 PROPERTY_SOURCE(PartGui::ViewProviderPartExt, Gui::ViewProviderGeometryObject)
 
+/// Coin buffers of the visual, see ViewProviderPartExt::buildVisual()
+struct ViewProviderPartExt::VisualBuffers
+{
+    std::vector<SbVec3f> verts;
+    std::vector<SbVec3f> norms;
+    std::vector<int32_t> faces;
+    std::vector<int32_t> parts;
+    std::vector<int32_t> lines;
+    int nodeStart = 0;
+
+    /// Serializes the buffers for the TessellationCache
+    std::string save() const;
+    /// Reads the buffers written by save(), returns false if the data is not valid
+    bool restore(const std::string &data);
+};
+
+template<class T>
+static void writeArray(std::ostream &str, const std::vector<T> &values)
+{
+    uint64_t count = values.size();
+    str.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    if (count)
+        str.write(reinterpret_cast<const char*>(values.data()), count * sizeof(T));
+}
+
+template<class T>
+static bool readArray(std::istream &str, std::vector<T> &values, std::size_t limit)
+{
+    uint64_t count = 0;
+    if (!str.read(reinterpret_cast<char*>(&count), sizeof(count)) || count > limit / sizeof(T))
+        return false;
+    values.resize(static_cast<std::size_t>(count));
+    return count == 0 || str.read(reinterpret_cast<char*>(values.data()), count * sizeof(T));
+}
+
+static bool checkIndices(const std::vector<int32_t> &indices, std::size_t numNodes)
+{
+    for (int32_t idx : indices) {
+        if (idx < -1 || idx >= static_cast<int64_t>(numNodes))
+            return false;
+    }
+    return true;
+}
+
+static const char VisualMagic[4] = {'F','C','T','C'};
+static const uint32_t VisualVersion = 1;
+
+std::string ViewProviderPartExt::VisualBuffers::save() const
+{
+    std::ostringstream str(std::ios::out | std::ios::binary);
+    int32_t start = nodeStart;
+    str.write(VisualMagic, sizeof(VisualMagic));
+    str.write(reinterpret_cast<const char*>(&VisualVersion), sizeof(VisualVersion));
+    str.write(reinterpret_cast<const char*>(&start), sizeof(start));
+    writeArray(str, verts);
+    writeArray(str, norms);
+    writeArray(str, faces);
+    writeArray(str, parts);
+    writeArray(str, lines);
+    return str.str();
+}
+
+bool ViewProviderPartExt::VisualBuffers::restore(const std::string &data)
+{
+    std::istringstream str(data, std::ios::in | std::ios::binary);
+    char magic[sizeof(VisualMagic)];
+    uint32_t version = 0;
+    int32_t start = 0;
+    if (!str.read(magic, sizeof(magic)) || memcmp(magic, VisualMagic, sizeof(magic)) != 0)
+        return false;
+    if (!str.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != VisualVersion)
+        return false;
+    if (!str.read(reinterpret_cast<char*>(&start), sizeof(start)))
+        return false;
+    std::size_t limit = data.size();
+    if (!readArray(str, verts, limit) || !readArray(str, norms, limit)
+            || !readArray(str, faces, limit) || !readArray(str, parts, limit)
+            || !readArray(str, lines, limit))
+        return false;
+
+    // make sure that a damaged entry can't make Coin read out of bounds
+    int64_t numTriangles = 0;
+    for (int32_t n : parts) {
+        if (n < 0)
+            return false;
+        numTriangles += n;
+    }
+    if (start < 0 || static_cast<std::size_t>(start) > verts.size()
+            || norms.size() > verts.size()
+            || numTriangles * 4 != static_cast<int64_t>(faces.size())
+            || !checkIndices(faces, norms.size())
+            || !checkIndices(lines, verts.size()))
+        return false;
+    nodeStart = start;
+    return true;
+}
+
+/// Shared between the GUI and the worker thread
+struct ViewProviderPartExt::TessellationData
+{
+    std::atomic<bool> canceled;
+    VisualBuffers buffers;
+    /// The shape meshed by the worker
+    TopoDS_Shape shape;
+    /// The coarser levels of detail, see startDetailLevels()
+    VisualBuffers levels[SoBrepFaceSet::NumDetailLevels];
+
+    TessellationData() : canceled(false) {}
+};
+
+/** A tessellation running in a worker thread
+ *
+ * Destroying the job cancels the tessellation. The worker checks this between
+ * its steps and for every face it converts, but a running
+ * BRepMesh_IncrementalMesh isn't interrupted. In any case the result of a
+ * canceled job is discarded.
+ */
+class ViewProviderPartExt::TessellationJob
+{
+public:
+    explicit TessellationJob(const std::shared_ptr<TessellationData> &data)
+        : data(data), watcher(new QFutureWatcher<bool>)
+    {
+    }
+    ~TessellationJob() {
+        data->canceled = true;
+        // the job may be destroyed from within the finished() signal of the watcher
+        watcher->disconnect();
+        watcher->deleteLater();
+    }
+
+    std::shared_ptr<TessellationData> data;
+    QFutureWatcher<bool> *watcher;
+};
+
+// BRepMesh adds the triangulation to the shape of the document object, which
+// must not happen while a worker copies the same shape for its tessellation.
+// Workers only read the shape and therefore share the lock.
+static std::shared_timed_mutex &sharedShapeMutex()
+{
+    static std::shared_timed_mutex mutex;
+    return mutex;
+}
+
+template<class Field, class T>
+static void setFieldValues(Field &field, const std::vector<T> &values)
+{
+    field.setNum(static_cast<int>(values.size()));
+    if (!values.empty()) {
+        T *data = field.startEditing();
+        std::copy(values.begin(), values.end(), data);
+        field.finishEditing();
+    }
+}
+
 
 void ViewProviderPartExt::getNormals(const TopoDS_Face&  theFace,
                                      const Handle(Poly_Triangulation)& aPolyTri,
@@ -235,6 +400,8 @@ ViewProviderPartExt::ViewProviderPartExt()
     VisualTouched = true;
     forceUpdateCount = 0;
     NormalsFromUV = true;
+    BackgroundFaces = 1000;
+    DetailLevels = true;
 
     unsigned long lcol = Gui::ViewParams::instance()->getDefaultShapeLineColor(); // dark grey (25,25,25)
     float r,g,b;
@@ -340,6 +507,7 @@ ViewProviderPartExt::ViewProviderPartExt()
 
 ViewProviderPartExt::~ViewProviderPartExt()
 {
+    tessJob.reset();
     pcFaceBind->unref();
     pcLineBind->unref();
     pcPointBind->unref();
@@ -553,10 +721,19 @@ void ViewProviderPartExt::attach(App::DocumentObject *pcFeat)
     // Move 'coords' before the switch
     pcRoot->insertChild(coords,pcRoot->findChild(pcModeSwitch));
 
+    // The level of detail of faces and edges is chosen above the render
+    // caches of the display modes
+    auto addDetailSwitch = [this](SoNode *node) {
+        SoBrepDetailSwitch *detailSwitch = new SoBrepDetailSwitch;
+        detailSwitch->setContent(node);
+        detailSwitches.push_back(detailSwitch);
+        return detailSwitch;
+    };
+
     // putting all together with the switch
-    addDisplayMaskMode(pcNormalRoot, "Flat Lines");
-    addDisplayMaskMode(pcFlatRoot, "Shaded");
-    addDisplayMaskMode(pcWireframeRoot, "Wireframe");
+    addDisplayMaskMode(addDetailSwitch(pcNormalRoot), "Flat Lines");
+    addDisplayMaskMode(addDetailSwitch(pcFlatRoot), "Shaded");
+    addDisplayMaskMode(addDetailSwitch(pcWireframeRoot), "Wireframe");
     addDisplayMaskMode(pcPointsRoot, "Point");
 }
 
@@ -590,6 +767,10 @@ std::vector<std::string> ViewProviderPartExt::getDisplayModes(void) const
 
 std::string ViewProviderPartExt::getElement(const SoDetail* detail) const
 {
+    // the element indices of a pending visual don't match the shape
+    if (isTessellating())
+        return std::string();
+
     std::stringstream str;
     if (detail) {
         if (detail->getTypeId() == SoFaceDetail::getClassTypeId()) {
@@ -623,7 +804,7 @@ SoDetail* ViewProviderPartExt::getDetail(const char* subelement) const
     }
 
     SoDetail* detail = 0;
-    if (index < 0)
+    if (index < 0 || isTessellating())
         return detail;
     if (element == "Face") {
         detail = new SoFaceDetail();
@@ -917,6 +1098,11 @@ bool ViewProviderPartExt::loadParameter()
     float deviation = hGrp->GetFloat("MeshDeviation",0.2);
     float angularDeflection = hGrp->GetFloat("MeshAngularDeflection",28.65);
     NormalsFromUV = hGrp->GetBool("NormalsFromUVNodes", NormalsFromUV);
+    BackgroundFaces = hGrp->GetInt("BackgroundTessellationFaces", BackgroundFaces);
+    DetailLevels = hGrp->GetBool("LevelOfDetail", DetailLevels);
+    // size of the tessellation cache in MB
+    long cacheSize = hGrp->GetInt("TessellationCacheSize", 256);
+    TessellationCache::instance().setMaxSize(cacheSize > 0 ? static_cast<std::size_t>(cacheSize) << 20 : 0);
 
     if (Deviation.getValue() != deviation) {
         Deviation.setValue(deviation);
@@ -998,7 +1184,12 @@ void ViewProviderPartExt::unsetEdit(int ModNum)
     }
 }
 
-void ViewProviderPartExt::updateVisual()
+bool ViewProviderPartExt::isTessellating() const
+{
+    return tessJob != nullptr;
+}
+
+void ViewProviderPartExt::clearElementHighlight()
 {
     Gui::SoUpdateVBOAction action;
     action.apply(this->faceset);
@@ -1014,327 +1205,568 @@ void ViewProviderPartExt::updateVisual()
     haction.apply(this->faceset);
     haction.apply(this->lineset);
     haction.apply(this->nodeset);
+}
+
+void ViewProviderPartExt::clearVisual()
+{
+    coords  ->point      .setNum(0);
+    norm    ->vector     .setNum(0);
+    faceset ->coordIndex .setNum(0);
+    faceset ->partIndex  .setNum(0);
+    lineset ->coordIndex .setNum(0);
+    nodeset ->startIndex .setValue(0);
+    faceset ->clearDetailLevels();
+    lineset ->clearDetailLevels();
+    setNumDetailLevels(1);
+}
+
+void ViewProviderPartExt::updateVisual()
+{
+    FC_PROFILE_ZONE_DETAIL("ViewProviderPartExt::updateVisual",
+            pcObject ? pcObject->getNameInDocument() : 0);
+
+    // a running tessellation is outdated now
+    tessJob.reset();
+    detailJob.reset();
+
+    clearElementHighlight();
 
     TopoDS_Shape cShape = Part::Feature::getShape(getObject());
     if (cShape.IsNull()) {
-        coords  ->point      .setNum(0);
-        norm    ->vector     .setNum(0);
-        faceset ->coordIndex .setNum(0);
-        faceset ->partIndex  .setNum(0);
-        lineset ->coordIndex .setNum(0);
-        nodeset ->startIndex .setValue(0);
+        clearVisual();
+        VisualTouched = false;
+        return;
+    }
+
+    // Large shapes are tessellated in the background unless the caller needs
+    // the visual right away
+    if (BackgroundFaces > 0 && !isUpdateForced()) {
+        int numFaces = 0;
+        for (TopExp_Explorer xp(cShape, TopAbs_FACE); xp.More() && numFaces < BackgroundFaces; xp.Next())
+            numFaces++;
+        if (numFaces >= BackgroundFaces) {
+            startTessellation(cShape);
+            VisualTouched = false;
+            return;
+        }
+    }
+
+    // Looking up the disk cache costs about as much as meshing a small shape,
+    // so the synchronous path only uses it while opening a document
+    bool useCache = isRestoring() || App::GetApplication().isRestoring();
+
+    VisualBuffers buffers;
+    try {
+        {
+            std::unique_lock<std::shared_timed_mutex> lock(sharedShapeMutex());
+            buildVisual(cShape, Deviation.getValue(), AngularDeflection.getValue(),
+                        NormalsFromUV, useCache, nullptr, buffers);
+        }
+        applyVisual(buffers);
+    }
+    catch (...) {
+        FC_ERR("Cannot compute Inventor representation for the shape of " << pcObject->getFullName());
         VisualTouched = false;
         return;
     }
 
+    if (DetailLevels)
+        startDetailLevels(cShape, true);
+
+    VisualTouched = false;
+}
+
+void ViewProviderPartExt::startTessellation(const TopoDS_Shape &shape)
+{
+    // Without a previous visual, show the bounding box until the new one is ready
+    if (coords->point.getNum() == 0) {
+        // the placement is applied by the transform node
+        Bnd_Box bounds;
+        BRepBndLib::Add(shape.Located(TopLoc_Location()), bounds);
+        if (!bounds.IsVoid()) {
+            bounds.SetGap(0.0);
+            Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+            bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+
+            static const int32_t boxLines[] = {
+                0,1,-1, 1,3,-1, 3,2,-1, 2,0,-1,
+                4,5,-1, 5,7,-1, 7,6,-1, 6,4,-1,
+                0,4,-1, 1,5,-1, 2,6,-1, 3,7,-1,
+            };
+            VisualBuffers box;
+            for (int i=0; i<8; i++) {
+                box.verts.emplace_back((float)(i & 1 ? xMax : xMin),
+                                       (float)(i & 2 ? yMax : yMin),
+                                       (float)(i & 4 ? zMax : zMin));
+            }
+            box.lines.assign(boxLines, boxLines + sizeof(boxLines)/sizeof(boxLines[0]));
+            box.nodeStart = 8;
+            applyVisual(box);
+        }
+    }
+
+    std::shared_ptr<TessellationData> data(new TessellationData);
+    double deviation = Deviation.getValue();
+    double angularDeflection = AngularDeflection.getValue();
+    bool normalsFromUV = NormalsFromUV;
+
+    tessJob.reset(new TessellationJob(data));
+    QObject::connect(tessJob->watcher, &QFutureWatcher<bool>::finished,
+                     tessJob->watcher, [this]() { finishTessellation(); });
+    tessJob->watcher->setFuture(QtConcurrent::run([=]() {
+        try {
+            // The worker meshes its own copy because BRepMesh stores the triangulation
+            // in the shape, which may be shared with other shapes meshed meanwhile.
+            {
+                FC_PROFILE_ZONE("BRepBuilderAPI_Copy");
+                std::shared_lock<std::shared_timed_mutex> lock(sharedShapeMutex());
+                data->shape = BRepBuilderAPI_Copy(shape).Shape();
+            }
+            if (data->canceled)
+                return false;
+            return buildVisual(data->shape, deviation, angularDeflection, normalsFromUV,
+                               true, &data->canceled, data->buffers);
+        }
+        catch (...) {
+            return false;
+        }
+    }));
+}
+
+void ViewProviderPartExt::finishTessellation()
+{
+    if (!tessJob)
+        return;
+
+    std::shared_ptr<TessellationData> data = tessJob->data;
+    bool done = tessJob->watcher->result();
+    tessJob.reset();
+    if (data->canceled)
+        return;
+
+    clearElementHighlight();
+    if (!done) {
+        clearVisual();
+        FC_ERR("Cannot compute Inventor representation for the shape of " << pcObject->getFullName());
+        return;
+    }
+
+    applyVisual(data->buffers);
+
+    // the face count may have changed since the colors were applied
+    if (this->faceset->partIndex.getNum() > this->pcShapeMaterial->diffuseColor.getNum())
+        this->pcFaceBind->value = SoMaterialBinding::OVERALL;
+    onChanged(&DiffuseColor);
+
+    if (DetailLevels)
+        startDetailLevels(data->shape, false);
+}
+
+void ViewProviderPartExt::startDetailLevels(const TopoDS_Shape &shape, bool copy)
+{
+    // Each level is meshed from scratch because BRepMesh keeps a finer
+    // triangulation. The shape of a background tessellation is the copy the
+    // visual was built from, which no other thread uses any more. A shape
+    // meshed in the GUI thread is copied like in startTessellation().
+    std::shared_ptr<TessellationData> data(new TessellationData);
+    if (!copy)
+        data->shape = shape;
+    double deviation = Deviation.getValue();
+    double angularDeflection = AngularDeflection.getValue();
+    bool normalsFromUV = NormalsFromUV;
+
+    detailJob.reset(new TessellationJob(data));
+    QObject::connect(detailJob->watcher, &QFutureWatcher<bool>::finished,
+                     detailJob->watcher, [this]() { finishDetailLevels(); });
+    detailJob->watcher->setFuture(QtConcurrent::run([=]() {
+        try {
+            if (copy) {
+                FC_PROFILE_ZONE("BRepBuilderAPI_Copy");
+                std::shared_lock<std::shared_timed_mutex> lock(sharedShapeMutex());
+                data->shape = BRepBuilderAPI_Copy(shape).Shape();
+            }
+            double factor = 1.0;
+            for (int level = SoBrepFaceSet::MediumDetail; level < SoBrepFaceSet::NumDetailLevels; level++) {
+                factor *= 4.0;
+                BRepTools::Clean(data->shape);
+                if (!buildVisual(data->shape, deviation * factor,
+                                 std::min(angularDeflection * factor / 2.0, 90.0),
+                                 normalsFromUV, true, &data->canceled, data->levels[level]))
+                    return false;
+            }
+            return true;
+        }
+        catch (...) {
+            return false;
+        }
+    }));
+}
+
+void ViewProviderPartExt::finishDetailLevels()
+{
+    if (!detailJob)
+        return;
+
+    std::shared_ptr<TessellationData> data = detailJob->data;
+    bool done = detailJob->watcher->result();
+    detailJob.reset();
+    if (data->canceled || !done)
+        return;
+
+    std::size_t numParts = static_cast<std::size_t>(faceset->partIndex.getNum());
+    std::size_t numIndices = static_cast<std::size_t>(faceset->coordIndex.getNum());
+    int numLevels = 1;
+    for (int level = SoBrepFaceSet::MediumDetail; level < SoBrepFaceSet::NumDetailLevels; level++) {
+        const VisualBuffers &buffers = data->levels[level];
+        // skip levels that hardly save anything
+        if (buffers.parts.size() != numParts || buffers.faces.size() * 4 > numIndices * 3)
+            continue;
+        auto detail = static_cast<SoBrepFaceSet::DetailLevel>(level);
+        faceset->setDetailLevel(detail, buffers.verts, buffers.norms, buffers.faces, buffers.parts);
+        lineset->setDetailLevel(detail, buffers.verts, buffers.lines);
+        numLevels = level + 1;
+    }
+    setNumDetailLevels(numLevels);
+}
+
+void ViewProviderPartExt::setNumDetailLevels(int num)
+{
+    for (auto detailSwitch : detailSwitches)
+        detailSwitch->setNumLevels(num);
+}
+
+void ViewProviderPartExt::applyVisual(const VisualBuffers &buffers)
+{
+    setFieldValues(coords->point, buffers.verts);
+    setFieldValues(norm->vector, buffers.norms);
+    setFieldValues(faceset->coordIndex, buffers.faces);
+    setFieldValues(faceset->partIndex, buffers.parts);
+    setFieldValues(lineset->coordIndex, buffers.lines);
+    nodeset->startIndex.setValue(buffers.nodeStart);
+    faceset->clearDetailLevels();
+    lineset->clearDetailLevels();
+    setNumDetailLevels(1);
+}
+
+bool ViewProviderPartExt::buildVisual(TopoDS_Shape cShape, double deviation, double angularDeflection,
+                                      bool normalsFromUV, bool useCache,
+                                      const std::atomic<bool> *canceled, VisualBuffers &buffers)
+{
+    std::string cacheKey;
+    TessellationCache &cache = TessellationCache::instance();
+    if (useCache && cache.isEnabled()) {
+        FC_PROFILE_ZONE("TessellationCache::load");
+        cacheKey = TessellationCache::makeKey(cShape, deviation, angularDeflection, normalsFromUV);
+        std::string data;
+        if (cache.load(cacheKey, data)) {
+            if (buffers.restore(data))
+                return true;
+            buffers = VisualBuffers();
+        }
+        if (canceled && *canceled)
+            return false;
+    }
+
     // time measurement and book keeping
     Base::TimeInfo start_time;
     int numTriangles=0,numNodes=0,numNorms=0,numFaces=0,numEdges=0,numLines=0;
     std::set<int> faceEdges;
 
-    try {
-        // calculating the deflection value
-        Bnd_Box bounds;
-        BRepBndLib::Add(cShape, bounds);
-        bounds.SetGap(0.0);
-        Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
-        bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
-        Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
-            Deviation.getValue();
-
-        // create or use the mesh on the data structure
+    // calculating the deflection value
+    Bnd_Box bounds;
+    BRepBndLib::Add(cShape, bounds);
+    bounds.SetGap(0.0);
+    Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+    bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 * deviation;
+
+    // create or use the mesh on the data structure
+    {
+        FC_PROFILE_ZONE("BRepMesh_IncrementalMesh");
 #if OCC_VERSION_HEX >= 0x060600
-        Standard_Real AngDeflectionRads = AngularDeflection.getValue() / 180.0 * M_PI;
+        Standard_Real AngDeflectionRads = angularDeflection / 180.0 * M_PI;
         BRepMesh_IncrementalMesh(cShape,deflection,Standard_False,
                 AngDeflectionRads,Standard_True);
 #else
+        (void)angularDeflection;
         BRepMesh_IncrementalMesh(cShape,deflection);
 #endif
-        // We must reset the location here because the transformation data
-        // are set in the placement property
-        TopLoc_Location aLoc;
-        cShape.Location(aLoc);
-
-        // count triangles and nodes in the mesh
-        TopTools_IndexedMapOfShape faceMap;
-        TopExp::MapShapes(cShape, TopAbs_FACE, faceMap);
-        for (int i=1; i <= faceMap.Extent(); i++) {
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(faceMap(i)), aLoc);
-            // Note: we must also count empty faces
-            if (!mesh.IsNull()) {
-                numTriangles += mesh->NbTriangles();
-                numNodes     += mesh->NbNodes();
-                numNorms     += mesh->NbNodes();
-            }
+    }
+    if (canceled && *canceled)
+        return false;
 
-            TopExp_Explorer xp;
-            for (xp.Init(faceMap(i),TopAbs_EDGE);xp.More();xp.Next())
-                faceEdges.insert(xp.Current().HashCode(INT_MAX));
-            numFaces++;
+    // We must reset the location here because the transformation data
+    // are set in the placement property
+    TopLoc_Location aLoc;
+    cShape.Location(aLoc);
+
+    // count triangles and nodes in the mesh
+    TopTools_IndexedMapOfShape faceMap;
+    TopExp::MapShapes(cShape, TopAbs_FACE, faceMap);
+    for (int i=1; i <= faceMap.Extent(); i++) {
+        Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(faceMap(i)), aLoc);
+        // Note: we must also count empty faces
+        if (!mesh.IsNull()) {
+            numTriangles += mesh->NbTriangles();
+            numNodes     += mesh->NbNodes();
+            numNorms     += mesh->NbNodes();
         }
 
-        // get an indexed map of edges
-        TopTools_IndexedMapOfShape edgeMap;
-        TopExp::MapShapes(cShape, TopAbs_EDGE, edgeMap);
-
-         // key is the edge number, value the coord indexes. This is needed to keep the same order as the edges.
-        std::map<int, std::vector<int32_t> > lineSetMap;
-        std::set<int>          edgeIdxSet;
-        std::vector<int32_t>   edgeVector;
-
-        // count and index the edges
-        for (int i=1; i <= edgeMap.Extent(); i++) {
-            edgeIdxSet.insert(i);
-            numEdges++;
-
-            const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
-            TopLoc_Location aLoc;
-
-            // handling of the free edge that are not associated to a face
-            // Note: The assumption that if for an edge BRep_Tool::Polygon3D
-            // returns a valid object is wrong. This e.g. happens for ruled
-            // surfaces which gets created by two edges or wires.
-            // So, we have to store the hashes of the edges associated to a face.
-            // If the hash of a given edge is not in this list we know it's really
-            // a free edge.
-            int hash = aEdge.HashCode(INT_MAX);
-            if (faceEdges.find(hash) == faceEdges.end()) {
-                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
-                if (!aPoly.IsNull()) {
-                    int nbNodesInEdge = aPoly->NbNodes();
-                    numNodes += nbNodesInEdge;
-                }
+        TopExp_Explorer xp;
+        for (xp.Init(faceMap(i),TopAbs_EDGE);xp.More();xp.Next())
+            faceEdges.insert(xp.Current().HashCode(INT_MAX));
+        numFaces++;
+    }
+
+    // get an indexed map of edges
+    TopTools_IndexedMapOfShape edgeMap;
+    TopExp::MapShapes(cShape, TopAbs_EDGE, edgeMap);
+
+     // key is the edge number, value the coord indexes. This is needed to keep the same order as the edges.
+    std::map<int, std::vector<int32_t> > lineSetMap;
+    std::set<int>          edgeIdxSet;
+    std::vector<int32_t>   edgeVector;
+
+    // count and index the edges
+    for (int i=1; i <= edgeMap.Extent(); i++) {
+        edgeIdxSet.insert(i);
+        numEdges++;
+
+        const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
+        TopLoc_Location aLoc;
+
+        // handling of the free edge that are not associated to a face
+        // Note: The assumption that if for an edge BRep_Tool::Polygon3D
+        // returns a valid object is wrong. This e.g. happens for ruled
+        // surfaces which gets created by two edges or wires.
+        // So, we have to store the hashes of the edges associated to a face.
+        // If the hash of a given edge is not in this list we know it's really
+        // a free edge.
+        int hash = aEdge.HashCode(INT_MAX);
+        if (faceEdges.find(hash) == faceEdges.end()) {
+            Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
+            if (!aPoly.IsNull()) {
+                int nbNodesInEdge = aPoly->NbNodes();
+                numNodes += nbNodesInEdge;
             }
         }
+    }
 
-        // handling of the vertices
-        TopTools_IndexedMapOfShape vertexMap;
-        TopExp::MapShapes(cShape, TopAbs_VERTEX, vertexMap);
-        numNodes += vertexMap.Extent();
-
-        // create memory for the nodes and indexes
-        coords  ->point      .setNum(numNodes);
-        norm    ->vector     .setNum(numNorms);
-        faceset ->coordIndex .setNum(numTriangles*4);
-        faceset ->partIndex  .setNum(numFaces);
-        // get the raw memory for fast fill up
-        SbVec3f* verts = coords  ->point       .startEditing();
-        SbVec3f* norms = norm    ->vector      .startEditing();
-        int32_t* index = faceset ->coordIndex  .startEditing();
-        int32_t* parts = faceset ->partIndex   .startEditing();
-
-        // preset the normal vector with null vector
-        for (int i=0;i < numNorms;i++)
-            norms[i]= SbVec3f(0.0,0.0,0.0);
-
-        int ii = 0,faceNodeOffset=0,faceTriaOffset=0;
-        for (int i=1; i <= faceMap.Extent(); i++, ii++) {
-            TopLoc_Location aLoc;
-            const TopoDS_Face &actFace = TopoDS::Face(faceMap(i));
-            // get the mesh of the shape
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
-            if (mesh.IsNull()) continue;
-
-            // getting the transformation of the shape/face
-            gp_Trsf myTransf;
-            Standard_Boolean identity = true;
-            if (!aLoc.IsIdentity()) {
-                identity = false;
-                myTransf = aLoc.Transformation();
-            }
+    // handling of the vertices
+    TopTools_IndexedMapOfShape vertexMap;
+    TopExp::MapShapes(cShape, TopAbs_VERTEX, vertexMap);
+    numNodes += vertexMap.Extent();
+
+    // create memory for the nodes and indexes, the normals are preset with
+    // the null vector
+    buffers.verts.resize(numNodes);
+    buffers.norms.assign(numNorms, SbVec3f(0.0,0.0,0.0));
+    buffers.faces.resize(numTriangles*4);
+    buffers.parts.resize(numFaces);
+    // get the raw memory for fast fill up
+    SbVec3f* verts = buffers.verts.data();
+    SbVec3f* norms = buffers.norms.data();
+    int32_t* index = buffers.faces.data();
+    int32_t* parts = buffers.parts.data();
+
+    int ii = 0,faceNodeOffset=0,faceTriaOffset=0;
+    for (int i=1; i <= faceMap.Extent(); i++, ii++) {
+        if (canceled && *canceled)
+            return false;
 
-            // getting size of node and triangle array of this face
-            int nbNodesInFace = mesh->NbNodes();
-            int nbTriInFace   = mesh->NbTriangles();
-            // check orientation
-            TopAbs_Orientation orient = actFace.Orientation();
-
-
-            // cycling through the poly mesh
-            const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
-            const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
-            TColgp_Array1OfDir Normals (Nodes.Lower(), Nodes.Upper());
-            if (NormalsFromUV)
-                getNormals(actFace, mesh, Normals);
-            
-            for (int g=1;g<=nbTriInFace;g++) {
-                // Get the triangle
-                Standard_Integer N1,N2,N3;
-                Triangles(g).Get(N1,N2,N3);
-
-                // change orientation of the triangle if the face is reversed
-                if ( orient != TopAbs_FORWARD ) {
-                    Standard_Integer tmp = N1;
-                    N1 = N2;
-                    N2 = tmp;
-                }
+        TopLoc_Location aLoc;
+        const TopoDS_Face &actFace = TopoDS::Face(faceMap(i));
+        // get the mesh of the shape
+        Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
+        if (mesh.IsNull()) continue;
+
+        // getting the transformation of the shape/face
+        gp_Trsf myTransf;
+        Standard_Boolean identity = true;
+        if (!aLoc.IsIdentity()) {
+            identity = false;
+            myTransf = aLoc.Transformation();
+        }
 
-                // get the 3 points of this triangle
-                gp_Pnt V1(Nodes(N1)), V2(Nodes(N2)), V3(Nodes(N3));
+        // getting size of node and triangle array of this face
+        int nbNodesInFace = mesh->NbNodes();
+        int nbTriInFace   = mesh->NbTriangles();
+        // check orientation
+        TopAbs_Orientation orient = actFace.Orientation();
 
-                // get the 3 normals of this triangle
-                gp_Vec NV1, NV2, NV3;
-                if (NormalsFromUV) {
-                    NV1.SetXYZ(Normals(N1).XYZ());
-                    NV2.SetXYZ(Normals(N2).XYZ());
-                    NV3.SetXYZ(Normals(N3).XYZ());
-                }
-                else {
-                    gp_Vec v1(V1.X(),V1.Y(),V1.Z()),
-                           v2(V2.X(),V2.Y(),V2.Z()),
-                           v3(V3.X(),V3.Y(),V3.Z());
-                    gp_Vec normal = (v2-v1)^(v3-v1);
-                    NV1 = normal;
-                    NV2 = normal;
-                    NV3 = normal;
-                }
 
-                // transform the vertices and normals to the place of the face
-                if (!identity) {
-                    V1.Transform(myTransf);
-                    V2.Transform(myTransf);
-                    V3.Transform(myTransf);
-                    if (NormalsFromUV) {
-                        NV1.Transform(myTransf);
-                        NV2.Transform(myTransf);
-                        NV3.Transform(myTransf);
-                    }
-                }
+        // cycling through the poly mesh
+        const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
+        const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
+        TColgp_Array1OfDir Normals (Nodes.Lower(), Nodes.Upper());
+        if (normalsFromUV)
+            getNormals(actFace, mesh, Normals);
+        
+        for (int g=1;g<=nbTriInFace;g++) {
+            // Get the triangle
+            Standard_Integer N1,N2,N3;
+            Triangles(g).Get(N1,N2,N3);
+
+            // change orientation of the triangle if the face is reversed
+            if ( orient != TopAbs_FORWARD ) {
+                Standard_Integer tmp = N1;
+                N1 = N2;
+                N2 = tmp;
+            }
 
-                // add the normals for all points of this triangle
-                norms[faceNodeOffset+N1-1] += SbVec3f(NV1.X(),NV1.Y(),NV1.Z());
-                norms[faceNodeOffset+N2-1] += SbVec3f(NV2.X(),NV2.Y(),NV2.Z());
-                norms[faceNodeOffset+N3-1] += SbVec3f(NV3.X(),NV3.Y(),NV3.Z());
-
-                // set the vertices
-                verts[faceNodeOffset+N1-1].setValue((float)(V1.X()),(float)(V1.Y()),(float)(V1.Z()));
-                verts[faceNodeOffset+N2-1].setValue((float)(V2.X()),(float)(V2.Y()),(float)(V2.Z()));
-                verts[faceNodeOffset+N3-1].setValue((float)(V3.X()),(float)(V3.Y()),(float)(V3.Z()));
-
-                // set the index vector with the 3 point indexes and the end delimiter
-                index[faceTriaOffset*4+4*(g-1)]   = faceNodeOffset+N1-1;
-                index[faceTriaOffset*4+4*(g-1)+1] = faceNodeOffset+N2-1;
-                index[faceTriaOffset*4+4*(g-1)+2] = faceNodeOffset+N3-1;
-                index[faceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
+            // get the 3 points of this triangle
+            gp_Pnt V1(Nodes(N1)), V2(Nodes(N2)), V3(Nodes(N3));
+
+            // get the 3 normals of this triangle
+            gp_Vec NV1, NV2, NV3;
+            if (normalsFromUV) {
+                NV1.SetXYZ(Normals(N1).XYZ());
+                NV2.SetXYZ(Normals(N2).XYZ());
+                NV3.SetXYZ(Normals(N3).XYZ());
+            }
+            else {
+                gp_Vec v1(V1.X(),V1.Y(),V1.Z()),
+                       v2(V2.X(),V2.Y(),V2.Z()),
+                       v3(V3.X(),V3.Y(),V3.Z());
+                gp_Vec normal = (v2-v1)^(v3-v1);
+                NV1 = normal;
+                NV2 = normal;
+                NV3 = normal;
             }
 
-            parts[ii] = nbTriInFace; // new part
-
-            // handling the edges lying on this face
-            TopExp_Explorer Exp;
-            for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
-                const TopoDS_Edge &curEdge = TopoDS::Edge(Exp.Current());
-                // get the overall index of this edge
-                int edgeIndex = edgeMap.FindIndex(curEdge);
-                edgeVector.push_back((int32_t)edgeIndex-1);
-                // already processed this index ?
-                if (edgeIdxSet.find(edgeIndex)!=edgeIdxSet.end()) {
-                    
-                    // this holds the indices of the edge's triangulation to the current polygon
-                    Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, mesh, aLoc);
-                    if (aPoly.IsNull())
-                        continue; // polygon does not exist
-                    
-                    // getting the indexes of the edge polygon
-                    const TColStd_Array1OfInteger& indices = aPoly->Nodes();
-                    for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++) {
-                        int nodeIndex = indices(i);
-                        int index = faceNodeOffset+nodeIndex-1;
-                        lineSetMap[edgeIndex].push_back(index);
-
-                        // usually the coordinates for this edge are already set by the
-                        // triangles of the face this edge belongs to. However, there are
-                        // rare cases where some points are only referenced by the polygon
-                        // but not by any triangle. Thus, we must apply the coordinates to
-                        // make sure that everything is properly set.
-                        gp_Pnt p(Nodes(nodeIndex));
-                        if (!identity)
-                            p.Transform(myTransf);
-                        verts[index].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
-                    }
-
-                    // remove the handled edge index from the set
-                    edgeIdxSet.erase(edgeIndex);
+            // transform the vertices and normals to the place of the face
+            if (!identity) {
+                V1.Transform(myTransf);
+                V2.Transform(myTransf);
+                V3.Transform(myTransf);
+                if (normalsFromUV) {
+                    NV1.Transform(myTransf);
+                    NV2.Transform(myTransf);
+                    NV3.Transform(myTransf);
                 }
             }
 
-            edgeVector.push_back(-1);
-            
-            // counting up the per Face offsets
-            faceNodeOffset += nbNodesInFace;
-            faceTriaOffset += nbTriInFace;
+            // add the normals for all points of this triangle
+            norms[faceNodeOffset+N1-1] += SbVec3f(NV1.X(),NV1.Y(),NV1.Z());
+            norms[faceNodeOffset+N2-1] += SbVec3f(NV2.X(),NV2.Y(),NV2.Z());
+            norms[faceNodeOffset+N3-1] += SbVec3f(NV3.X(),NV3.Y(),NV3.Z());
+
+            // set the vertices
+            verts[faceNodeOffset+N1-1].setValue((float)(V1.X()),(float)(V1.Y()),(float)(V1.Z()));
+            verts[faceNodeOffset+N2-1].setValue((float)(V2.X()),(float)(V2.Y()),(float)(V2.Z()));
+            verts[faceNodeOffset+N3-1].setValue((float)(V3.X()),(float)(V3.Y()),(float)(V3.Z()));
+
+            // set the index vector with the 3 point indexes and the end delimiter
+            index[faceTriaOffset*4+4*(g-1)]   = faceNodeOffset+N1-1;
+            index[faceTriaOffset*4+4*(g-1)+1] = faceNodeOffset+N2-1;
+            index[faceTriaOffset*4+4*(g-1)+2] = faceNodeOffset+N3-1;
+            index[faceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
         }
 
-        // handling of the free edges
-        for (int i=1; i <= edgeMap.Extent(); i++) {
-            const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
-            Standard_Boolean identity = true;
-            gp_Trsf myTransf;
-            TopLoc_Location aLoc;
-
-            // handling of the free edge that are not associated to a face
-            int hash = aEdge.HashCode(INT_MAX);
-            if (faceEdges.find(hash) == faceEdges.end()) {
-                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
-                if (!aPoly.IsNull()) {
-                    if (!aLoc.IsIdentity()) {
-                        identity = false;
-                        myTransf = aLoc.Transformation();
-                    }
-
-                    const TColgp_Array1OfPnt& aNodes = aPoly->Nodes();
-                    int nbNodesInEdge = aPoly->NbNodes();
-
-                    gp_Pnt pnt;
-                    for (Standard_Integer j=1;j <= nbNodesInEdge;j++) {
-                        pnt = aNodes(j);
-                        if (!identity)
-                            pnt.Transform(myTransf);
-                        int index = faceNodeOffset+j-1;
-                        verts[index].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
-                        lineSetMap[i].push_back(index);
-                    }
-
-                    faceNodeOffset += nbNodesInEdge;
+        parts[ii] = nbTriInFace; // new part
+
+        // handling the edges lying on this face
+        TopExp_Explorer Exp;
+        for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
+            const TopoDS_Edge &curEdge = TopoDS::Edge(Exp.Current());
+            // get the overall index of this edge
+            int edgeIndex = edgeMap.FindIndex(curEdge);
+            edgeVector.push_back((int32_t)edgeIndex-1);
+            // already processed this index ?
+            if (edgeIdxSet.find(edgeIndex)!=edgeIdxSet.end()) {
+                
+                // this holds the indices of the edge's triangulation to the current polygon
+                Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, mesh, aLoc);
+                if (aPoly.IsNull())
+                    continue; // polygon does not exist
+                
+                // getting the indexes of the edge polygon
+                const TColStd_Array1OfInteger& indices = aPoly->Nodes();
+                for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++) {
+                    int nodeIndex = indices(i);
+                    int index = faceNodeOffset+nodeIndex-1;
+                    lineSetMap[edgeIndex].push_back(index);
+
+                    // usually the coordinates for this edge are already set by the
+                    // triangles of the face this edge belongs to. However, there are
+                    // rare cases where some points are only referenced by the polygon
+                    // but not by any triangle. Thus, we must apply the coordinates to
+                    // make sure that everything is properly set.
+                    gp_Pnt p(Nodes(nodeIndex));
+                    if (!identity)
+                        p.Transform(myTransf);
+                    verts[index].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
                 }
-            }
-        }
 
-        nodeset->startIndex.setValue(faceNodeOffset);
-        for (int i=0; i<vertexMap.Extent(); i++) {
-            const TopoDS_Vertex& aVertex = TopoDS::Vertex(vertexMap(i+1));
-            gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
-            verts[faceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+                // remove the handled edge index from the set
+                edgeIdxSet.erase(edgeIndex);
+            }
         }
 
-        // normalize all normals 
-        for (int i = 0; i< numNorms ;i++)
-            norms[i].normalize();
+        edgeVector.push_back(-1);
         
-        std::vector<int32_t> lineSetCoords;
-        for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
-            lineSetCoords.insert(lineSetCoords.end(), it->second.begin(), it->second.end());
-            lineSetCoords.push_back(-1);
-        }
+        // counting up the per Face offsets
+        faceNodeOffset += nbNodesInFace;
+        faceTriaOffset += nbTriInFace;
+    }
+
+    // handling of the free edges
+    for (int i=1; i <= edgeMap.Extent(); i++) {
+        const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
+        Standard_Boolean identity = true;
+        gp_Trsf myTransf;
+        TopLoc_Location aLoc;
+
+        // handling of the free edge that are not associated to a face
+        int hash = aEdge.HashCode(INT_MAX);
+        if (faceEdges.find(hash) == faceEdges.end()) {
+            Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
+            if (!aPoly.IsNull()) {
+                if (!aLoc.IsIdentity()) {
+                    identity = false;
+                    myTransf = aLoc.Transformation();
+                }
+
+                const TColgp_Array1OfPnt& aNodes = aPoly->Nodes();
+                int nbNodesInEdge = aPoly->NbNodes();
+
+                gp_Pnt pnt;
+                for (Standard_Integer j=1;j <= nbNodesInEdge;j++) {
+                    pnt = aNodes(j);
+                    if (!identity)
+                        pnt.Transform(myTransf);
+                    int index = faceNodeOffset+j-1;
+                    verts[index].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+                    lineSetMap[i].push_back(index);
+                }
 
-        // preset the index vector size
-        numLines =  lineSetCoords.size();
-        lineset ->coordIndex .setNum(numLines);
-        int32_t* lines = lineset ->coordIndex  .startEditing();
+                faceNodeOffset += nbNodesInEdge;
+            }
+        }
+    }
 
-        int l=0;
-        for (std::vector<int32_t>::const_iterator it=lineSetCoords.begin();it!=lineSetCoords.end();++it,l++)
-            lines[l] = *it;
+    buffers.nodeStart = faceNodeOffset;
+    for (int i=0; i<vertexMap.Extent(); i++) {
+        const TopoDS_Vertex& aVertex = TopoDS::Vertex(vertexMap(i+1));
+        gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
+        verts[faceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+    }
 
-        // end the editing of the nodes
-        coords  ->point       .finishEditing();
-        norm    ->vector      .finishEditing();
-        faceset ->coordIndex  .finishEditing();
-        faceset ->partIndex   .finishEditing();
-        lineset ->coordIndex  .finishEditing();
+    // normalize all normals 
+    for (int i = 0; i< numNorms ;i++)
+        norms[i].normalize();
+    
+    std::vector<int32_t> &lineSetCoords = buffers.lines;
+    lineSetCoords.clear();
+    for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
+        lineSetCoords.insert(lineSetCoords.end(), it->second.begin(), it->second.end());
+        lineSetCoords.push_back(-1);
     }
-    catch (...) {
-        FC_ERR("Cannot compute Inventor representation for the shape of " << pcObject->getFullName());
+    numLines = lineSetCoords.size();
+
+    if (!cacheKey.empty()) {
+        FC_PROFILE_ZONE("TessellationCache::store");
+        cache.store(cacheKey, buffers.save());
     }
 
 #   ifdef FC_DEBUG
@@ -1342,8 +1774,9 @@ void ViewProviderPartExt::updateVisual()
         Base::Console().Log("ViewProvider update time: %f s\n",Base::TimeInfo::diffTimeF(start_time,Base::TimeInfo()));
         Base::Console().Log("Shape tria info: Faces:%d Edges:%d Nodes:%d Triangles:%d IdxVec:%d\n",numFaces,numEdges,numNodes,numTriangles,numLines);
 #   endif
-    VisualTouched = false;
+    return true;
 }
+
 void ViewProviderPartExt::forceUpdate(bool enable) {
     if(enable) {
         if(++forceUpdateCount == 1) {
@@ -32,7 +32,10 @@
 #include <TColgp_Array1OfDir.hxx>
 #include <App/PropertyUnits.h>
 #include <Gui/ViewProviderGeometryObject.h>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <vector>
 #include <Mod/Part/App/PartFeature.h>
 
 class TopoDS_Shape;
@@ -61,6 +64,7 @@ namespace PartGui {
 class SoBrepFaceSet;
 class SoBrepEdgeSet;
 class SoBrepPointSet;
+class SoBrepDetailSwitch;
 
 class PartGuiExport ViewProviderPartExt : public Gui::ViewProviderGeometryObject
 {
@@ -157,9 +161,17 @@ protected:
     /// get called by the container whenever a property has been changed
     virtual void onChanged(const App::Property* prop) override;
     bool loadParameter();
+    /** Recreates the visual of the shape
+     * Shapes with many faces are tessellated in a worker thread, in which case
+     * the previous visual, or the bounding box of the shape, is shown until the
+     * new one is ready. The coarser levels of detail of any shape are built
+     * in a worker thread afterwards.
+     */
     void updateVisual();
-    void getNormals(const TopoDS_Face&  theFace, const Handle(Poly_Triangulation)& aPolyTri,
-                    TColgp_Array1OfDir& theNormals);
+    /// Returns true while the visual is tessellated in a worker thread
+    bool isTessellating() const;
+    static void getNormals(const TopoDS_Face&  theFace, const Handle(Poly_Triangulation)& aPolyTri,
+                           TColgp_Array1OfDir& theNormals);
 
     // nodes for the data representation
     SoMaterialBinding * pcFaceBind;
@@ -180,8 +192,31 @@ protected:
 
     bool VisualTouched;
     bool NormalsFromUV;
+    int BackgroundFaces;
+    bool DetailLevels;
 
 private:
+    struct VisualBuffers;
+    struct TessellationData;
+    class TessellationJob;
+
+    static bool buildVisual(TopoDS_Shape shape, double deviation, double angularDeflection,
+                            bool normalsFromUV, bool useCache,
+                            const std::atomic<bool> *canceled, VisualBuffers &buffers);
+    void applyVisual(const VisualBuffers &buffers);
+    void clearVisual();
+    void clearElementHighlight();
+    void startTessellation(const TopoDS_Shape &shape);
+    void finishTessellation();
+    void startDetailLevels(const TopoDS_Shape &shape, bool copy);
+    void finishDetailLevels();
+    void setNumDetailLevels(int num);
+
+    std::unique_ptr<TessellationJob> tessJob;
+    std::unique_ptr<TessellationJob> detailJob;
+    /// choose the level of detail of the display modes, see attach()
+    std::vector<SoBrepDetailSwitch*> detailSwitches;
+
     // settings stuff
     int forceUpdateCount;
     static App::PropertyFloatConstraint::Constraints sizeRange;
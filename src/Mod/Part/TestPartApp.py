@@ -21,6 +21,7 @@
 
 import FreeCAD, unittest, Part
 import copy 
+import os, tempfile, zipfile
 from FreeCAD import Units
 App = FreeCAD
 
@@ -54,6 +55,105 @@ class PartTestCases(unittest.TestCase):
         #self.Doc.addObject("Part::Feature","Face").Shape = result
         #self.assertTrue(isinstance(result.Surface, Part.BSplineSurface))
 
+    def testParallelRecompute(self):
+        param = App.ParamGet("User parameter:BaseApp/Preferences/Document")
+        old = param.GetBool("ParallelRecompute", False)
+        param.SetBool("ParallelRecompute", True)
+        try:
+            boxes = [self.Doc.addObject("Part::Box","Box") for i in range(4)]
+            for i, box in enumerate(boxes):
+                box.Length = i + 1
+            cut = self.Doc.addObject("Part::Cut","Cut")
+            cut.Base = boxes[1]
+            cut.Tool = boxes[0]
+            self.assertEqual(self.Doc.recompute(), 5)
+            for i, box in enumerate(boxes):
+                self.assertAlmostEqual(box.Shape.Volume, 100.0 * (i + 1))
+            self.assertAlmostEqual(cut.Shape.Volume, 100.0)
+        finally:
+            param.SetBool("ParallelRecompute", old)
+
+    def testParallelRecomputeCycle(self):
+        param = App.ParamGet("User parameter:BaseApp/Preferences/Document")
+        old = param.GetBool("ParallelRecompute", False)
+        param.SetBool("ParallelRecompute", True)
+        try:
+            box = self.Doc.addObject("Part::Box","Box")
+            first = self.Doc.addObject("Part::Compound","First")
+            second = self.Doc.addObject("Part::Compound","Second")
+            third = self.Doc.addObject("Part::Compound","Third")
+            first.Links = [box, second]
+            second.Links = [first]
+            third.Links = [first]
+            # each object of the cycle is recomputed once
+            self.assertLessEqual(self.Doc.recompute(), 4)
+            self.assertAlmostEqual(box.Shape.Volume, 1000.0)
+        finally:
+            param.SetBool("ParallelRecompute", old)
+
+    def saveShapes(self, name):
+        box = Part.makeBox(1,2,3)
+        self.Doc.addObject("Part::Feature","Box").Shape = box
+        self.Doc.addObject("Part::Feature","Copy").Shape = box
+        self.Doc.addObject("Part::Feature","Face").Shape = box.Faces[0]
+        self.Doc.addObject("Part::Feature","Empty")
+        self.Doc.saveAs(name)
+        FreeCAD.closeDocument("PartTest")
+        with zipfile.ZipFile(name) as archive:
+            files = [f for f in archive.namelist() if f.startswith("PartShape")]
+            document = archive.read("Document.xml").decode("utf-8")
+        return files, document
+
+    def testShapeStore(self):
+        param = App.ParamGet("User parameter:BaseApp/Preferences/Document")
+        old = param.GetBool("SaveShapeStore", True)
+        param.SetBool("SaveShapeStore", True)
+        try:
+            name = tempfile.gettempdir() + os.sep + "PartTest.FCStd"
+            files, document = self.saveShapes(name)
+            # all shapes are saved to the store only
+            self.assertEqual(files, ["PartShapes.bin"])
+            self.assertIn('SchemaVersion="5"', document)
+
+            self.Doc = FreeCAD.open(name)
+            shape = self.Doc.Box.Shape
+            self.assertAlmostEqual(shape.Volume, 6.0)
+            # the shapes share their geometry after restore
+            self.assertTrue(self.Doc.Copy.Shape.isSame(shape))
+            self.assertTrue(self.Doc.Face.Shape.isSame(shape.Faces[0]))
+            self.assertTrue(self.Doc.Empty.Shape.isNull())
+        finally:
+            param.SetBool("SaveShapeStore", old)
+
+    def testShapeStoreCompatible(self):
+        param = App.ParamGet("User parameter:BaseApp/Preferences/Document")
+        old = param.GetBool("SaveShapeFiles", False)
+        param.SetBool("SaveShapeFiles", True)
+        try:
+            name = tempfile.gettempdir() + os.sep + "PartTest.FCStd"
+            files, document = self.saveShapes(name)
+            # each shape is also saved to its own file for older versions
+            self.assertEqual(len(files), 5)
+            self.assertIn('SchemaVersion="4"', document)
+
+            # replace the store by an empty file
+            with zipfile.ZipFile(name) as archive:
+                entries = [(info, archive.read(info.filename)) for info in archive.infolist()]
+            with zipfile.ZipFile(name, "w") as archive:
+                for info, data in entries:
+                    if info.filename == "PartShapes.bin":
+                        data = b""
+                    archive.writestr(info, data)
+
+            # the shapes are read from their own files instead
+            self.Doc = FreeCAD.open(name)
+            self.assertAlmostEqual(self.Doc.Box.Shape.Volume, 6.0)
+            self.assertAlmostEqual(self.Doc.Copy.Shape.Volume, 6.0)
+            self.assertAlmostEqual(self.Doc.Face.Shape.Area, 6.0)
+            self.assertTrue(self.Doc.Empty.Shape.isNull())
+        finally:
+            param.SetBool("SaveShapeFiles", old)
+
     def tearDown(self):
         #closing doc
         FreeCAD.closeDocument("PartTest")
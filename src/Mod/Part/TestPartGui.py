@@ -19,7 +19,8 @@
 #   USA                                                                   *
 #**************************************************************************
 
-import FreeCAD, FreeCADGui, os, sys, unittest, Part, PartGui
+import FreeCAD, FreeCADGui, os, sys, tempfile, time, unittest, Part, PartGui
+from PySide import QtCore, QtGui
 
 
 #---------------------------------------------------------------------------
@@ -41,3 +42,152 @@ import FreeCAD, FreeCADGui, os, sys, unittest, Part, PartGui
 #	def tearDown(self):
 #		#closing doc
 #		FreeCAD.closeDocument("PartGuiTest")
+
+
+class PartGuiLevelOfDetailCases(unittest.TestCase):
+	"""Selection and preselection of faces rendered with a coarser level of detail"""
+	def setUp(self):
+		self.Params = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part")
+		self.Saved = (self.Params.GetInt("BackgroundTessellationFaces", 1000),
+		              self.Params.GetBool("LevelOfDetail", True),
+		              self.Params.GetInt("TessellationCacheSize", 256))
+		# tessellate in the background to get the coarser levels, without disk cache
+		self.Params.SetInt("BackgroundTessellationFaces", 1)
+		self.Params.SetBool("LevelOfDetail", True)
+		self.Params.SetInt("TessellationCacheSize", 0)
+
+		self.Doc = FreeCAD.newDocument("PartGuiLevelOfDetail")
+		self.Cyl = self.Doc.addObject("Part::Feature", "Cylinder")
+		vp = self.Cyl.ViewObject
+		vp.Deviation = 0.05
+		vp.AngularDeflection = 5
+		# Face1 is the lateral face, Face2 the top face
+		self.Cyl.Shape = Part.makeCylinder(10, 10)
+		self.Doc.recompute()
+		self.waitForTessellation()
+
+		self.View = FreeCADGui.getDocument(self.Doc.Name).ActiveView
+		self.View.viewTop()
+		self.View.fitAll()
+		FreeCADGui.Selection.clearSelection()
+		FreeCADGui.Selection.clearPreselection()
+
+	def waitForTessellation(self):
+		# the coarser levels are computed once the full resolution is applied
+		for i in range(2):
+			QtCore.QThreadPool.globalInstance().waitForDone()
+			QtGui.QApplication.processEvents()
+
+	def centerColor(self, size):
+		fd, name = tempfile.mkstemp(suffix=".png")
+		os.close(fd)
+		try:
+			self.View.saveImage(name, size, size, "White")
+			img = QtGui.QImage(name)
+			return QtGui.QColor(img.pixel(size // 2, size // 2))
+		finally:
+			os.remove(name)
+
+	def isSelectionColor(self, c):
+		return c.green() > c.red() + 40 and c.green() > c.blue() + 40
+
+	def isPreselectionColor(self, c):
+		return c.red() > c.blue() + 40 and c.green() > c.blue() + 40
+
+	def testSelectFace(self):
+		# 64 pixels render the coarse level, 512 pixels the full resolution
+		for size in (64, 512):
+			FreeCADGui.Selection.clearSelection()
+			FreeCADGui.Selection.addSelection(self.Cyl, "Face1")
+			self.assertFalse(self.isSelectionColor(self.centerColor(size)))
+			FreeCADGui.Selection.clearSelection()
+			FreeCADGui.Selection.addSelection(self.Cyl, "Face2")
+			self.assertTrue(self.isSelectionColor(self.centerColor(size)))
+
+	def testPreselectFace(self):
+		for size in (64, 512):
+			FreeCADGui.Selection.setPreselection(self.Cyl, "Face1")
+			self.assertFalse(self.isPreselectionColor(self.centerColor(size)))
+			FreeCADGui.Selection.clearPreselection()
+			FreeCADGui.Selection.setPreselection(self.Cyl, "Face2")
+			self.assertTrue(self.isPreselectionColor(self.centerColor(size)))
+			FreeCADGui.Selection.clearPreselection()
+
+	def tearDown(self):
+		FreeCADGui.Selection.clearSelection()
+		FreeCADGui.Selection.clearPreselection()
+		FreeCAD.closeDocument(self.Doc.Name)
+		self.Params.SetInt("BackgroundTessellationFaces", self.Saved[0])
+		self.Params.SetBool("LevelOfDetail", self.Saved[1])
+		self.Params.SetInt("TessellationCacheSize", self.Saved[2])
+
+
+class PartGuiTessellationCacheCases(unittest.TestCase):
+	"""Disk cache of the tessellation used while opening a document"""
+	def setUp(self):
+		self.Params = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part")
+		self.Saved = (self.Params.GetInt("BackgroundTessellationFaces", 1000),
+		              self.Params.GetInt("TessellationCacheSize", 256))
+		# tessellate in the GUI thread, which uses the cache while restoring
+		self.Params.SetInt("BackgroundTessellationFaces", 0)
+		self.Params.SetInt("TessellationCacheSize", 16)
+
+		fd, self.FileName = tempfile.mkstemp(suffix=".FCStd")
+		os.close(fd)
+		doc = FreeCAD.newDocument("PartGuiTessellationCache")
+		box = doc.addObject("Part::Feature", "Box")
+		box.Shape = Part.makeBox(1, 2, 3)
+		doc.recompute()
+		self.Entry = self.cacheFile(box)
+		doc.saveAs(self.FileName)
+		FreeCAD.closeDocument(doc.Name)
+		if os.path.exists(self.Entry):
+			os.remove(self.Entry)
+
+	def cacheFile(self, obj):
+		vp = obj.ViewObject
+		normalsFromUV = self.Params.GetBool("NormalsFromUVNodes", True)
+		return PartGui.getTessellationCacheFile(obj.Shape, vp.Deviation, vp.AngularDeflection, normalsFromUV)
+
+	def openEntry(self):
+		doc = FreeCAD.openDocument(self.FileName)
+		try:
+			return self.cacheFile(doc.getObject("Box"))
+		finally:
+			FreeCAD.closeDocument(doc.Name)
+
+	def readEntry(self):
+		with open(self.Entry, "rb") as f:
+			return f.read()
+
+	def testKeyAfterRestore(self):
+		# the restored shape has the key of the saved one
+		self.assertEqual(self.openEntry(), self.Entry)
+		self.assertTrue(os.path.exists(self.Entry))
+
+		# reading the entry marks it as recently used
+		old = time.time() - 3600
+		os.utime(self.Entry, (old, old))
+		self.assertEqual(self.openEntry(), self.Entry)
+		self.assertGreater(os.path.getmtime(self.Entry), old + 1800)
+
+	def testCorruptEntry(self):
+		self.openEntry()
+		data = self.readEntry()
+		# a damaged entry is ignored and written again
+		with open(self.Entry, "wb") as f:
+			f.write(data[:8] + b"\xff" * (len(data) - 8))
+		self.openEntry()
+		self.assertEqual(self.readEntry(), data)
+
+	def testDisabled(self):
+		self.Params.SetInt("TessellationCacheSize", 0)
+		self.openEntry()
+		self.assertFalse(os.path.exists(self.Entry))
+
+	def tearDown(self):
+		if os.path.exists(self.Entry):
+			os.remove(self.Entry)
+		os.remove(self.FileName)
+		self.Params.SetInt("BackgroundTessellationFaces", self.Saved[0])
+		self.Params.SetInt("TessellationCacheSize", self.Saved[1])
@@ -34,6 +34,16 @@
 # include <BRepBuilderAPI_Copy.hxx>
 # include <BRepBndLib.hxx>
 # include <Bnd_Box.hxx>
+# include <TopLoc_Location.hxx>
+# include <TopTools_ListOfShape.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Compound.hxx>
+# include <TopoDS_Iterator.hxx>
+# include <gp.hxx>
+# include <Standard_Version.hxx>
+# include <cmath>
+# include <deque>
+# include <memory>
 #endif
 
 
@@ -250,6 +260,10 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
     typedef std::map<App::DocumentObject*,  trsf_it> rej_it_map;
     rej_it_map nointersect_trsfms;
 
+    Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter()
+        .GetGroup("BaseApp")->GetGroup("Preferences")->GetGroup("Mod/PartDesign");
+    bool batched = hGrp->GetBool("BatchedTransform", true);
+
     // NOTE: It would be possible to build a compound from all original addShapes/subShapes and then
     // transform the compounds as a whole. But we choose to apply the transformations to each
     // Original separately. This way it is easier to discover what feature causes a fuse/cut
@@ -277,10 +291,21 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
             return new App::DocumentObjectExecReturn("Only additive and subtractive features can be transformed");
         }
 
-        // Transform the add/subshape and collect the resulting shapes for overlap testing
-        /*typedef std::vector<std::vector<gp_Trsf>::const_iterator> trsf_it_vec;
-        trsf_it_vec v_transformations;
-        std::vector<TopoDS_Shape> v_transformedShapes;*/
+        // Apply all transformations with one boolean operation. If that fails, fall back to
+        // applying them one by one below, which tells more precisely what went wrong.
+        if (batched && (fuseShape.isNull() || cutShape.isNull())) {
+            TopoDS_Shape result;
+            std::vector<std::vector<gp_Trsf>::const_iterator> nointersect;
+            try {
+                if (applyBatched(support, fuseShape.isNull() ? cutShape.getShape() : fuseShape.getShape(),
+                                 !fuseShape.isNull(), transformations, result, nointersect)) {
+                    nointersect_trsfms[*o].insert(nointersect.begin(), nointersect.end());
+                    support = result;
+                    continue;
+                }
+            } catch (Standard_Failure&) {
+            }
+        }
 
         std::vector<gp_Trsf>::const_iterator t = transformations.begin();
         ++t; // Skip first transformation, which is always the identity transformation
@@ -323,19 +348,6 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
                     //
                     // Therefore, if the transformation succeeded, then we fuse it with the support now, before checking the intersection
                     // of the next transformation.
-                    
-                    /*v_transformations.push_back(t);
-                    v_transformedShapes.push_back(mkTrf.Shape());*/
-    
-                    // Note: Transformations that do not intersect the support are ignored in the overlap tests
-                    
-                    //insert scheme here.
-                    /*TopoDS_Compound compoundTool;
-                    std::vector<TopoDS_Shape> individualTools;
-                    divideTools(v_transformedShapes, individualTools, compoundTool);*/
-                    
-                    // Fuse/Cut the compounded transformed shapes with the support
-                    //TopoDS_Shape result;
 
                     BRepAlgoAPI_Fuse mkFuse(current, shape);
                     if (!mkFuse.IsDone())
@@ -422,6 +434,161 @@ TopoDS_Shape Transformed::refineShapeIfActive(const TopoDS_Shape& oldShape) cons
     return oldShape;
 }
 
+static TopoDS_Shape makeInstance(const TopoDS_Shape &shape, const gp_Trsf &trsf)
+{
+    // Rigid motions only change the location and share the geometry with the original shape.
+    // Mirroring and scaling need a transformed copy.
+    if (!trsf.IsNegative() && std::fabs(trsf.ScaleFactor() - 1.0) < gp::Resolution())
+        return shape.Moved(TopLoc_Location(trsf));
+
+    BRepBuilderAPI_Transform mkTrf(BRepBuilderAPI_Copy(shape).Shape(), trsf, false);
+    if (!mkTrf.IsDone())
+        return TopoDS_Shape();
+    return mkTrf.Shape();
+}
+
+bool Transformed::applyBatched(const TopoDS_Shape &support, const TopoDS_Shape &tool, bool fuse,
+                               const std::vector<gp_Trsf> &transformations, TopoDS_Shape &result,
+                               std::vector<std::vector<gp_Trsf>::const_iterator> &nointersect) const
+{
+#if OCC_VERSION_HEX < 0x060900
+    (void)support;
+    (void)tool;
+    (void)fuse;
+    (void)transformations;
+    (void)result;
+    (void)nointersect;
+    return false;
+#else
+    if (tool.IsNull() || transformations.empty())
+        return false;
+
+    Bnd_Box toolBox;
+    BRepBndLib::Add(tool, toolBox);
+    Bnd_Box supportBox;
+    BRepBndLib::Add(support, supportBox);
+
+    // Skip first transformation, which is always the identity transformation
+    std::vector<std::vector<gp_Trsf>::const_iterator> trsfs;
+    std::vector<TopoDS_Shape> instances;
+    std::vector<Bnd_Box> boxes;
+    for (std::vector<gp_Trsf>::const_iterator t = transformations.begin() + 1; t != transformations.end(); ++t) {
+        TopoDS_Shape instance = makeInstance(tool, *t);
+        if (instance.IsNull())
+            return false;
+        trsfs.push_back(t);
+        instances.push_back(instance);
+        boxes.push_back(toolBox.Transformed(*t));
+    }
+
+    // Instances whose bounding box is not connected to the support, either directly or through
+    // other instances, can't overlap it and are left out of the boolean operation.
+    std::vector<bool> connected(instances.size(), false);
+    std::deque<std::size_t> queue;
+    for (std::size_t i = 0; i < instances.size(); ++i) {
+        if (!boxes[i].IsOut(supportBox)) {
+            connected[i] = true;
+            queue.push_back(i);
+        }
+    }
+    while (!queue.empty()) {
+        std::size_t j = queue.front();
+        queue.pop_front();
+        for (std::size_t i = 0; i < instances.size(); ++i) {
+            if (!connected[i] && !boxes[i].IsOut(boxes[j])) {
+                connected[i] = true;
+                queue.push_back(i);
+            }
+        }
+    }
+
+    std::vector<TopoDS_Shape> candidates;
+    for (std::size_t i = 0; i < instances.size(); ++i) {
+        if (connected[i])
+            candidates.push_back(instances[i]);
+        else if (fuse)
+            nointersect.push_back(trsfs[i]);
+    }
+    if (candidates.empty()) {
+        result = support;
+        return true;
+    }
+
+    // Instances that don't overlap each other are passed as one compound to keep the number
+    // of arguments of the general fuse low
+    TopoDS_Compound compoundTool;
+    std::vector<TopoDS_Shape> individualTools;
+    divideTools(candidates, individualTools, compoundTool);
+
+    TopTools_ListOfShape shapeArguments, shapeTools;
+    shapeArguments.Append(support);
+    for (std::vector<TopoDS_Shape>::const_iterator it = individualTools.begin(); it != individualTools.end(); ++it)
+        shapeTools.Append(*it);
+    if (TopoDS_Iterator(compoundTool).More())
+        shapeTools.Append(compoundTool);
+
+    std::unique_ptr<BRepAlgoAPI_BooleanOperation> mkBool;
+    if (fuse)
+        mkBool.reset(new BRepAlgoAPI_Fuse);
+    else
+        mkBool.reset(new BRepAlgoAPI_Cut);
+    mkBool->SetRunParallel(true);
+    mkBool->SetArguments(shapeArguments);
+    mkBool->SetTools(shapeTools);
+    mkBool->Build();
+    if (!mkBool->IsDone())
+        return false;
+
+    if (!fuse) {
+        result = mkBool->Shape();
+        return !result.IsNull();
+    }
+
+    std::vector<TopoDS_Shape> solids;
+    for (TopExp_Explorer xp(mkBool->Shape(), TopAbs_SOLID); xp.More(); xp.Next())
+        solids.push_back(xp.Current());
+    if (solids.empty())
+        return false;
+    if (solids.size() == 1) {
+        result = solids.front();
+        return true;
+    }
+
+    // The fused shape has more than one solid. Keep the solid of the support and report the
+    // instances that ended up in other solids, the same way the sequential fusion does.
+    std::vector<TopTools_IndexedMapOfShape> solidFaces(solids.size());
+    for (std::size_t i = 0; i < solids.size(); ++i)
+        TopExp::MapShapes(solids[i], TopAbs_FACE, solidFaces[i]);
+
+    auto findSolid = [&](const TopoDS_Shape &shape) -> int {
+        for (TopExp_Explorer xp(shape, TopAbs_FACE); xp.More(); xp.Next()) {
+            if (mkBool->IsDeleted(xp.Current()))
+                continue;
+            const TopTools_ListOfShape &modified = mkBool->Modified(xp.Current());
+            const TopoDS_Shape &image = modified.IsEmpty() ? xp.Current() : modified.First();
+            for (std::size_t i = 0; i < solidFaces.size(); ++i) {
+                if (solidFaces[i].Contains(image))
+                    return static_cast<int>(i);
+            }
+        }
+        return -1;
+    };
+
+    int supportSolid = findSolid(support);
+    if (supportSolid < 0)
+        return false;
+    for (std::size_t i = 0; i < instances.size(); ++i) {
+        if (!connected[i])
+            continue;
+        int solid = findSolid(instances[i]);
+        if (solid >= 0 && solid != supportSolid)
+            nointersect.push_back(trsfs[i]);
+    }
+    result = solids[supportSolid];
+    return true;
+#endif
+}
+
 void Transformed::divideTools(const std::vector<TopoDS_Shape> &toolsIn, std::vector<TopoDS_Shape> &individualsOut,
                               TopoDS_Compound &compoundOut) const
 {
@@ -93,7 +93,15 @@ protected:
     virtual void positionBySupport(void);
     TopoDS_Shape refineShapeIfActive(const TopoDS_Shape&) const;
     void divideTools(const std::vector<TopoDS_Shape> &toolsIn, std::vector<TopoDS_Shape> &individualsOut,
-		     TopoDS_Compound &compoundOut) const; 
+		     TopoDS_Compound &compoundOut) const;
+    /** Fuses or cuts all transformed instances of \a tool with \a support in one operation
+      * @param nointersect receives the transformations whose instance does not overlap the support
+      * @return false if the operation failed, in which case the caller has to apply the
+      *         transformations one by one
+      */
+    bool applyBatched(const TopoDS_Shape &support, const TopoDS_Shape &tool, bool fuse,
+                      const std::vector<gp_Trsf> &transformations, TopoDS_Shape &result,
+                      std::vector<std::vector<gp_Trsf>::const_iterator> &nointersect) const;
 
     rejectedMap rejected;
 };
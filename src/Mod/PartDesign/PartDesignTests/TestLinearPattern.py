@@ -19,6 +19,7 @@
 #   USA                                                                   *
 #**************************************************************************
 import unittest
+import math
 
 import FreeCAD
 import TestSketcherApp
@@ -138,6 +139,58 @@ class TestLinearPattern(unittest.TestCase):
         self.Doc.recompute()
         self.assertAlmostEqual(self.LinearPattern.Shape.Volume, 1e4)
 
+    def testBatchedLinearPattern(self):
+        # all holes are cut in one boolean operation, the result must match the
+        # one by one operation
+        self.Body = self.Doc.addObject('PartDesign::Body','Body')
+        self.Box = self.Doc.addObject('PartDesign::AdditiveBox','Box')
+        self.Body.addObject(self.Box)
+        self.Box.Length=100.00
+        self.Box.Width=10.00
+        self.Box.Height=10.00
+        self.Hole = self.Doc.addObject('PartDesign::SubtractiveCylinder','Hole')
+        self.Body.addObject(self.Hole)
+        self.Hole.Radius=2.00
+        self.Hole.Height=10.00
+        self.Hole.Placement.Base = FreeCAD.Vector(5, 5, 0)
+        self.Doc.recompute()
+        self.LinearPattern = self.Doc.addObject("PartDesign::LinearPattern","LinearPattern")
+        self.LinearPattern.Originals = [self.Hole]
+        self.LinearPattern.Direction = (self.Doc.X_Axis,[""])
+        self.LinearPattern.Length = 90.0
+        self.LinearPattern.Occurrences = 20
+        self.Body.addObject(self.LinearPattern)
+        self.Doc.recompute()
+        volume = 1e4 - 20 * math.pi * 4 * 10
+        self.assertAlmostEqual(self.LinearPattern.Shape.Volume, volume, places=3)
+
+        hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/PartDesign")
+        hGrp.SetBool("BatchedTransform", False)
+        try:
+            self.LinearPattern.touch()
+            self.Doc.recompute()
+            self.assertAlmostEqual(self.LinearPattern.Shape.Volume, volume, places=3)
+        finally:
+            hGrp.RemBool("BatchedTransform")
+
+    def testBatchedRejectedLinearPattern(self):
+        # instances not overlapping the support are rejected
+        self.Body = self.Doc.addObject('PartDesign::Body','Body')
+        self.Box = self.Doc.addObject('PartDesign::AdditiveBox','Box')
+        self.Body.addObject(self.Box)
+        self.Box.Length=10.00
+        self.Box.Width=10.00
+        self.Box.Height=10.00
+        self.Doc.recompute()
+        self.LinearPattern = self.Doc.addObject("PartDesign::LinearPattern","LinearPattern")
+        self.LinearPattern.Originals = [self.Box]
+        self.LinearPattern.Direction = (self.Doc.X_Axis,[""])
+        self.LinearPattern.Length = 60.0
+        self.LinearPattern.Occurrences = 4
+        self.Body.addObject(self.LinearPattern)
+        self.Doc.recompute()
+        self.assertFalse(self.LinearPattern.isValid())
+
     def tearDown(self):
         #closing doc
         FreeCAD.closeDocument("PartDesignTestLinearPattern")
@@ -33,6 +33,7 @@
 #include <Base/Matrix.h>
 #include <Base/Stream.h>
 #include <Base/Writer.h>
+#include <App/PropertyDelta.h>
 
 #include "PropertyPointKernel.h"
 #include "PointsPy.h"
@@ -54,6 +55,7 @@ PropertyPointKernel::~PropertyPointKernel()
 void PropertyPointKernel::setValue(const PointKernel& m)
 {
     aboutToSetValue();
+    detach(false);
     *_cPoints = m;
     hasSetValue();
 }
@@ -114,6 +116,7 @@ void PropertyPointKernel::Restore(Base::XMLReader &reader)
         mtrx.fromString(Matrix);
 
         aboutToSetValue();
+        detach();
         _cPoints->setTransform(mtrx);
         hasSetValue();
     }
@@ -128,10 +131,25 @@ void PropertyPointKernel::SaveDocFile (Base::Writer &writer) const
 void PropertyPointKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    detach(false);
     _cPoints->RestoreDocFile(reader);
     hasSetValue();
 }
 
+std::function<void()> PropertyPointKernel::RestoreDocFileInThread(Base::Reader &reader)
+{
+    std::shared_ptr<PointKernel> kernel(new PointKernel);
+    kernel->RestoreDocFile(reader);
+    return [this, kernel]() {
+        std::vector<PointKernel::value_type> points;
+        kernel->swap(points);
+        aboutToSetValue();
+        detach();
+        _cPoints->swap(points);
+        hasSetValue();
+    };
+}
+
 App::Property *PropertyPointKernel::Copy(void) const 
 {
     PropertyPointKernel* prop = new PropertyPointKernel();
@@ -142,11 +160,72 @@ App::Property *PropertyPointKernel::Copy(void) const
 void PropertyPointKernel::Paste(const App::Property &from)
 {
     aboutToSetValue();
+    detach(false);
     const PropertyPointKernel& prop = dynamic_cast<const PropertyPointKernel&>(from);
     *(this->_cPoints) = *(prop._cPoints);
     hasSetValue();
 }
 
+std::shared_ptr<const App::Property> PropertyPointKernel::Snapshot() const
+{
+    if (!_shared)
+        _shared = std::make_shared<char>(0);
+    std::shared_ptr<PropertyPointKernel> prop = std::make_shared<PropertyPointKernel>();
+    prop->_cPoints = this->_cPoints;
+    prop->_shared = this->_shared;
+    return prop;
+}
+
+namespace Points {
+/// Undo/redo record of moved points, see PropertyPointKernel::Diff()
+class PointsDelta : public App::PropertyArrayDelta<PointKernel::value_type>
+{
+public:
+    void apply(App::Property &prop) const
+    {
+        if (!prop.isDerivedFrom(PropertyPointKernel::getClassTypeId()))
+            throw Base::TypeError("Property type mismatch");
+        PropertyPointKernel& kernel = static_cast<PropertyPointKernel&>(prop);
+        check(kernel.getValue().getBasicPoints());
+        PointKernel* points = kernel.startEditing();
+        std::vector<PointKernel::value_type>& values = points->getBasicPoints();
+        for (const auto& it : changes)
+            values[it.first] = it.second;
+        kernel.finishEditing();
+    }
+};
+}
+
+App::PropertyDelta *PropertyPointKernel::Diff(const App::Property &from) const
+{
+    if (!from.isDerivedFrom(PropertyPointKernel::getClassTypeId()))
+        return 0;
+    const PointKernel& cur = *this->_cPoints;
+    const PointKernel& old = *static_cast<const PropertyPointKernel&>(from)._cPoints;
+    if (&cur == &old) {
+        // unchanged, the checksum must still match the current points
+        std::unique_ptr<PointsDelta> delta(new PointsDelta());
+        delta->diff(cur.getBasicPoints(), cur.getBasicPoints());
+        return delta.release();
+    }
+
+    // only moved points are recorded
+    if (cur.size() != old.size() || cur.getTransform() != old.getTransform())
+        return 0;
+
+    std::unique_ptr<PointsDelta> delta(new PointsDelta());
+    if (!delta->diff(cur.getBasicPoints(), old.getBasicPoints()))
+        return 0;
+    return delta.release();
+}
+
+void PropertyPointKernel::detach(bool copy)
+{
+    if (_shared.use_count() > 1)
+        _cPoints = copy ? new PointKernel(*_cPoints) : new PointKernel();
+    _shared.reset();
+}
+
 unsigned int PropertyPointKernel::getMemSize (void) const
 {
     return sizeof(Base::Vector3f) * this->_cPoints->size();
@@ -155,6 +234,7 @@ unsigned int PropertyPointKernel::getMemSize (void) const
 PointKernel* PropertyPointKernel::startEditing()
 {
     aboutToSetValue();
+    detach();
     return static_cast<PointKernel*>(_cPoints);
 }
 
@@ -194,6 +274,7 @@ void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndi
 void PropertyPointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
     aboutToSetValue();
+    detach();
     _cPoints->transformGeometry(rclMat);
     hasSetValue();
 }
@@ -66,6 +66,10 @@ public:
     App::Property *Copy(void) const;
     /// paste the value from the property (mainly for Undo/Redo and transactions)
     void Paste(const App::Property &from);
+    /// returns a snapshot that shares the points until they are modified
+    std::shared_ptr<const App::Property> Snapshot() const;
+    /// returns a delta of the moved points if the number of points is unchanged
+    App::PropertyDelta *Diff(const App::Property &from) const;
     unsigned int getMemSize (void) const;
     //@}
 
@@ -75,6 +79,8 @@ public:
     void Restore(Base::XMLReader &reader);
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    bool canRestoreDocFileInThread() const {return true;}
+    std::function<void()> RestoreDocFileInThread(Base::Reader &reader);
     //@}
 
     /** @name Modification */
@@ -86,8 +92,14 @@ public:
     void removeIndices( const std::vector<unsigned long>& );
     //@}
 
+private:
+    /// continues with a new point kernel if a snapshot still uses the current one
+    void detach(bool copy=true);
+
 private:
     Base::Reference<PointKernel> _cPoints;
+    /// shared with the snapshots that use the same point kernel
+    mutable std::shared_ptr<char> _shared;
 };
 
 } // namespace Points
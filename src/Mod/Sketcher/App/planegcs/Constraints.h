@@ -104,7 +104,7 @@ namespace GCS
         Constraint();
         virtual ~Constraint(){}
 
-        inline VEC_pD params() { return pvec; }
+        inline const VEC_pD &params() const { return pvec; }
 
         void redirectParams(MAP_pD_pD redirectionmap);
         void revertParams();
@@ -118,7 +118,10 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
-        // virtual void grad(MAP_pD_D &deriv);  --> TODO: vectorized grad version
+        // Computes the derivatives with respect to all entries of pvec in one call,
+        // derivs[i] receives the partial derivative for pvec[i]. If a parameter occurs
+        // more than once in pvec, its derivative is the sum of its entries.
+        virtual void grads(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
         // Finds first occurrence of param in pvec. This is useful to test if a constraint depends 
         // on the parameter (it may not actually depend on it, e.g. angle-via-point doesn't depend 
@@ -140,6 +143,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
     };
 
     // Difference
@@ -155,6 +159,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
     };
 
     // P2PDistance
@@ -175,6 +180,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
     };
 
@@ -197,6 +203,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
     };
 
@@ -220,6 +227,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
         double abs(double darea);
     };
@@ -244,6 +252,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
     };
 
     // PointOnPerpBisector
@@ -291,6 +300,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
     };
 
     // Perpendicular
@@ -315,6 +325,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
     };
 
     // L2LAngle
@@ -341,6 +352,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
     };
 
@@ -366,6 +378,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void grads(double *derivs);
     };
 
     // TangentCircumf
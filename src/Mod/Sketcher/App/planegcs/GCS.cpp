@@ -3820,15 +3820,25 @@ void System::makeReducedJacobian(Eigen::MatrixXd &J,
 
     J = Eigen::MatrixXd::Zero(clist.size(), pdiagnoselist.size());
 
+    MAP_pD_I pdiagnoseindex;
+    for (int j=0; j < int(pdiagnoselist.size()); j++)
+        pdiagnoseindex[pdiagnoselist[j]] = j;
+
     int jacobianconstraintcount=0;
     int allcount=0;
+    VEC_D derivs;
     for (std::vector<Constraint *>::iterator constr=clist.begin(); constr != clist.end(); ++constr) {
         (*constr)->revertParams();
         ++allcount;
         if ((*constr)->getTag() >= 0 && (*constr)->isDriving()) {
             jacobianconstraintcount++;
-            for (int j=0; j < int(pdiagnoselist.size()); j++) {
-                J(jacobianconstraintcount-1,j) = (*constr)->grad(pdiagnoselist[j]);
+            const VEC_pD &cparams = (*constr)->params();
+            derivs.resize(cparams.size());
+            (*constr)->grads(derivs.data());
+            for (std::size_t k=0; k < cparams.size(); k++) {
+                MAP_pD_I::const_iterator it = pdiagnoseindex.find(cparams[k]);
+                if (it != pdiagnoseindex.end())
+                    J(jacobianconstraintcount-1,it->second) += derivs[k];
             }
 
             // parallel processing: create tag multiplicity map
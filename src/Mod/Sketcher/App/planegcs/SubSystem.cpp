@@ -20,6 +20,7 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include "SubSystem.h"
@@ -258,18 +259,65 @@ void SubSystem::calcJacobi()
 }
 */
 
-void SubSystem::calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi)
+// Index of the variable p points to in vals, or -1 if it points elsewhere.
+// Unlike the built-in operators, std::less orders pointers into other arrays.
+static int indexOfValue(const double *p, const VEC_D &vals)
 {
-    jacobi.setZero(csize, params.size());
+    std::less<const double *> less;
+    const double *first = vals.data();
+    if (less(p, first) || !less(p, first + vals.size()))
+        return -1;
+    return static_cast<int>(p - first);
+}
+
+void SubSystem::mapColumns(VEC_pD &params, VEC_I &columns,
+                           std::vector<std::pair<int,int> > &copies)
+{
+    columns.assign(psize, -1);
+    copies.clear();
     for (int j=0; j < int(params.size()); j++) {
         MAP_pD_pD::const_iterator
           pmapfind = pmap.find(params[j]);
-        if (pmapfind != pmap.end())
-            for (int i=0; i < csize; i++)
-                jacobi(i,j) = clist[i]->grad(pmapfind->second);
+        if (pmapfind != pmap.end()) {
+            int &column = columns[pmapfind->second - pvals.data()];
+            if (column < 0)
+                column = j;
+            else // reduced to the same variable as an earlier parameter
+                copies.push_back(std::make_pair(j, column));
+        }
     }
 }
 
+void SubSystem::calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi)
+{
+    jacobi.setZero(csize, params.size());
+
+    VEC_I columns;
+    std::vector<std::pair<int,int> > copies;
+    mapColumns(params, columns, copies);
+
+    // Each constraint computes the derivatives for its own parameters only,
+    // which are summed into the columns of the variables they point to
+    VEC_D derivs;
+    for (int i=0; i < csize; i++) {
+        const VEC_pD &cparams = clist[i]->params();
+        derivs.resize(cparams.size());
+        clist[i]->grads(derivs.data());
+        for (std::size_t k=0; k < cparams.size(); k++) {
+            int v = indexOfValue(cparams[k], pvals);
+            if (v >= 0) {
+                int j = columns[v];
+                if (j >= 0)
+                    jacobi(i,j) += derivs[k];
+            }
+        }
+    }
+
+    for (std::vector<std::pair<int,int> >::const_iterator it=copies.begin();
+         it != copies.end(); ++it)
+        jacobi.col(it->first) = jacobi.col(it->second);
+}
+
 void SubSystem::calcJacobi(Eigen::MatrixXd &jacobi)
 {
     calcJacobi(plist, jacobi);
@@ -280,17 +328,30 @@ void SubSystem::calcGrad(VEC_pD &params, Eigen::VectorXd &grad)
     assert(grad.size() == int(params.size()));
 
     grad.setZero();
-    for (int j=0; j < int(params.size()); j++) {
-        MAP_pD_pD::const_iterator
-          pmapfind = pmap.find(params[j]);
-        if (pmapfind != pmap.end()) {
-            // assert(p2c.find(pmapfind->second) != p2c.end());
-            std::vector<Constraint *> constrs=p2c[pmapfind->second];
-            for (std::vector<Constraint *>::const_iterator constr = constrs.begin();
-                 constr != constrs.end(); ++constr)
-                grad[j] += (*constr)->error() * (*constr)->grad(pmapfind->second);
+
+    VEC_I columns;
+    std::vector<std::pair<int,int> > copies;
+    mapColumns(params, columns, copies);
+
+    VEC_D derivs;
+    for (int i=0; i < csize; i++) {
+        const VEC_pD &cparams = clist[i]->params();
+        derivs.resize(cparams.size());
+        clist[i]->grads(derivs.data());
+        double err = clist[i]->error();
+        for (std::size_t k=0; k < cparams.size(); k++) {
+            int v = indexOfValue(cparams[k], pvals);
+            if (v >= 0) {
+                int j = columns[v];
+                if (j >= 0)
+                    grad[j] += err * derivs[k];
+            }
         }
     }
+
+    for (std::vector<std::pair<int,int> >::const_iterator it=copies.begin();
+         it != copies.end(); ++it)
+        grad[it->first] = grad[it->second];
 }
 
 void SubSystem::calcGrad(Eigen::VectorXd &grad)
@@ -44,6 +44,9 @@ namespace GCS
         std::map<Constraint *,VEC_pD > c2p; // constraint to parameter adjacency list
         std::map<double *,std::vector<Constraint *> > p2c; // parameter to constraint adjacency list
         void initialize(VEC_pD &params, MAP_pD_pD &reductionmap); // called by the constructors
+        // column in params of each entry of pvals, or -1, and the (column, source column)
+        // pairs of parameters that are reduced to the same entry
+        void mapColumns(VEC_pD &params, VEC_I &columns, std::vector<std::pair<int,int> > &copies);
     public:
         SubSystem(std::vector<Constraint *> &clist_, VEC_pD &params);
         SubSystem(std::vector<Constraint *> &clist_, VEC_pD &params,
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Constraints.h>
+#include <SubSystem.h>
+
+using namespace GCS;
+
+// Random lines and points with constraints of all the types that compute
+// their derivatives at once in grads()
+class TstSubSystem : public ::testing::Test
+{
+protected:
+    static const int NumPoints = 40;
+    static const int NumConstraints = 220;
+
+    void SetUp() override
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> coord(-5.0, 5.0);
+        // the points, then one distance or angle per constraint
+        values.resize(2 * NumPoints + NumConstraints);
+        for (auto &v : values)
+            v = coord(rng);
+
+        for (int n=0; n < NumConstraints; n++) {
+            int a = rng() % NumPoints, b = rng() % NumPoints;
+            int c = rng() % NumPoints, d = rng() % NumPoints;
+            if (b == a)
+                b = (a + 1) % NumPoints;
+            if (d == c)
+                d = (c + 1) % NumPoints;
+            double *dist = &values[2 * NumPoints + n];
+            Point pa = point(a), pb = point(b), pc = point(c);
+            Line l1 = line(a, b), l2 = line(c, d);
+            switch (n % 11) {
+            case 0: add(new ConstraintEqual(pa.x, pb.x)); break;
+            case 1: add(new ConstraintDifference(pa.x, pb.x, dist)); break;
+            case 2: add(new ConstraintP2PDistance(pa, pb, dist)); break;
+            case 3: add(new ConstraintP2PAngle(pa, pb, dist)); break;
+            case 4: add(new ConstraintP2LDistance(pc, l1, dist)); break;
+            case 5: add(new ConstraintPointOnLine(pc, l1)); break;
+            case 6: add(new ConstraintParallel(l1, l2)); break;
+            case 7: add(new ConstraintPerpendicular(l1, l2)); break;
+            case 8: add(new ConstraintL2LAngle(l1, l2, dist)); break;
+            case 9: add(new ConstraintMidpointOnLine(l1, l2)); break;
+            // falls back to Constraint::grads()
+            case 10: add(new ConstraintPointOnPerpBisector(pc, l1)); break;
+            }
+        }
+        // lines sharing a point, so a constraint has the same parameter twice
+        {
+            Line x = line(1, 2), y = line(2, 3);
+            Point p = point(2);
+            add(new ConstraintPerpendicular(x, y));
+            add(new ConstraintP2LDistance(p, x, &values[2 * NumPoints]));
+        }
+
+        for (auto &v : values)
+            params.push_back(&v);
+
+        // coincident points, as the solver reduces them
+        for (int i=0; i < NumPoints / 4; i++) {
+            reduction[&values[2 * i]] = &values[2 * (i + NumPoints / 2)];
+            reduction[&values[2 * i + 1]] = &values[2 * (i + NumPoints / 2) + 1];
+        }
+    }
+
+    Point point(int i)
+    {
+        Point p;
+        p.x = &values[2 * i];
+        p.y = &values[2 * i + 1];
+        return p;
+    }
+
+    Line line(int i, int j)
+    {
+        Line l;
+        l.p1 = point(i);
+        l.p2 = point(j);
+        return l;
+    }
+
+    void add(Constraint *constr)
+    {
+        owner.emplace_back(constr);
+        constraints.push_back(constr);
+    }
+
+    // Compares grads() with grad() of each parameter of all constraints
+    void checkGrads()
+    {
+        for (auto constr : constraints) {
+            const VEC_pD &cparams = constr->params();
+            std::vector<double> derivs(cparams.size());
+            constr->grads(derivs.data());
+            // a parameter used twice gets the sum of its entries
+            std::map<double *, double> sums;
+            for (std::size_t k=0; k < cparams.size(); k++)
+                sums[cparams[k]] += derivs[k];
+            for (auto &it : sums)
+                EXPECT_NEAR(it.second, constr->grad(it.first), 1e-9)
+                    << "constraint type " << constr->getTypeId();
+        }
+    }
+
+    // Compares calcJacobi() and calcGrad() with the per parameter grad()
+    void checkSubSystem(SubSystem &subsys)
+    {
+        subsys.redirectParams();
+        checkGrads();
+
+        MAP_pD_pD pmap;
+        subsys.getParamMap(pmap);
+        int rows = static_cast<int>(constraints.size());
+        int cols = static_cast<int>(params.size());
+
+        Eigen::MatrixXd jacobi;
+        subsys.calcJacobi(params, jacobi);
+        ASSERT_EQ(jacobi.rows(), rows);
+        ASSERT_EQ(jacobi.cols(), cols);
+
+        Eigen::VectorXd grad(cols);
+        subsys.calcGrad(params, grad);
+
+        for (int j=0; j < cols; j++) {
+            MAP_pD_pD::const_iterator it = pmap.find(params[j]);
+            double sum = 0;
+            for (int i=0; i < rows; i++) {
+                double expected = 0;
+                if (it != pmap.end())
+                    expected = constraints[i]->grad(it->second);
+                EXPECT_NEAR(jacobi(i,j), expected, 1e-9) << "row " << i << ", column " << j;
+                sum += constraints[i]->error() * expected;
+            }
+            EXPECT_NEAR(grad[j], sum, 1e-9) << "column " << j;
+        }
+
+        subsys.revertParams();
+    }
+
+    std::vector<double> values;
+    VEC_pD params;
+    MAP_pD_pD reduction;
+    std::vector<Constraint *> constraints;
+    std::vector<std::unique_ptr<Constraint> > owner;
+};
+
+TEST_F(TstSubSystem, testGrads)
+{
+    checkGrads();
+}
+
+TEST_F(TstSubSystem, testJacobi)
+{
+    SubSystem subsys(constraints, params);
+    checkSubSystem(subsys);
+}
+
+TEST_F(TstSubSystem, testJacobiReduced)
+{
+    SubSystem subsys(constraints, params, reduction);
+    checkSubSystem(subsys);
+}
@@ -22,7 +22,7 @@
 #***************************************************************************/
 
 import FreeCAD, os, unittest, tempfile
-import math
+import math, json
 
 #---------------------------------------------------------------------------
 # define the functions to test the FreeCAD Document code
@@ -491,6 +491,54 @@ class DocumentSaveRestoreCases(unittest.TestCase):
 
     FreeCAD.closeDocument("SaveRestoreExtensions")
 
+  def testRecoveryJournal(self):
+    if not FreeCAD.GuiUp:
+      return
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    if not param.GetBool("AutoSaveCompressed", True):
+      return
+    journal = param.GetBool("AutoSaveJournal", True)
+    param.SetBool("AutoSaveJournal", True)
+    try:
+      FileName = self.Doc.TransientDir + os.sep + "fc_recovery_file.fcstd"
+      JournalName = self.Doc.TransientDir + os.sep + "fc_recovery_journal.dat"
+      # the first auto-save writes the whole document
+      self.Doc.Label_1.Integer = 1
+      FreeCAD.Gui.autoSaveDocument(self.Doc.Name)
+      self.assertTrue(os.path.exists(FileName))
+      self.assertFalse(os.path.exists(JournalName))
+
+      # further changes are appended to the journal
+      self.Doc.Label_2.String = "journal"
+      self.Doc.Label_1.Integer = 2
+      self.Doc.Label_3.Vector = (1,2,3)
+      FreeCAD.Gui.autoSaveDocument(self.Doc.Name)
+      self.Doc.Label_1.Integer = 3
+      FreeCAD.Gui.autoSaveDocument(self.Doc.Name)
+      self.assertTrue(os.path.exists(JournalName))
+
+      Doc = FreeCAD.openDocument(FileName)
+      self.assertEqual(Doc.Label_1.Integer, 1)
+      FreeCAD.Gui.replayRecoveryJournal(Doc, JournalName)
+      self.assertEqual(Doc.Label_1.Integer, 3)
+      self.assertEqual(Doc.Label_2.String, "journal")
+      self.assertEqual(Doc.Label_3.Vector, FreeCAD.Vector(1,2,3))
+      FreeCAD.closeDocument(Doc.Name)
+
+      # a record cut off by a crash is ignored
+      CutName = self.TempPath + os.sep + "RecoveryJournal.dat"
+      with open(JournalName, "rb") as f:
+        data = f.read()
+      with open(CutName, "wb") as f:
+        f.write(data[:-2])
+      Doc = FreeCAD.openDocument(FileName)
+      FreeCAD.Gui.replayRecoveryJournal(Doc, CutName)
+      self.assertEqual(Doc.Label_1.Integer, 2)
+      self.assertEqual(Doc.Label_2.String, "journal")
+      FreeCAD.closeDocument(Doc.Name)
+    finally:
+      param.SetBool("AutoSaveJournal", journal)
+
   def testPersistenceContentDump(self):
     #test smallest level... property
     self.Doc.Label_1.Vector = (1,2,3)
@@ -533,6 +581,48 @@ class DocumentRecomputeCases(unittest.TestCase):
     self.L1.Link = self.L2
     self.L2.Link = self.L3
 
+  def testDependencyOrder(self):
+    # the cached dependency order must follow the link changes
+    self.L1.Link = self.L2
+    self.L2.Link = self.L3
+    order = self.Doc.TopologicalSortedObjects
+    self.failUnless(order.index(self.L1) < order.index(self.L2) < order.index(self.L3))
+    self.assertEqual(FreeCAD.getDependentObjects(self.L1, 1), (self.L3, self.L2, self.L1))
+    self.L2.Link = None
+    self.L3.Link = self.L1
+    self.assertEqual(FreeCAD.getDependentObjects(self.L3, 1), (self.L2, self.L1, self.L3))
+
+  def testAffectedObjects(self):
+    # the affected objects come in recompute order and follow link changes
+    L4 = self.Doc.addObject("App::FeatureTest","Label_4")
+    self.L1.Link = self.L2
+    self.L2.Link = self.L3
+    self.assertEqual(self.Doc.getAffectedObjects(self.L3), [self.L3, self.L2, self.L1])
+    self.assertEqual(self.Doc.getAffectedObjects([self.L2]), [self.L2, self.L1])
+    self.assertEqual(self.Doc.getAffectedObjects(L4), [L4])
+
+    # reverse the chain
+    self.L1.Link = None
+    self.L2.Link = None
+    self.L3.Link = self.L2
+    self.L2.Link = self.L1
+    self.assertEqual(self.Doc.getAffectedObjects(self.L1), [self.L1, self.L2, self.L3])
+
+    # a cycle and its removal
+    self.L1.Link = self.L3
+    self.failUnless(self.L1 in self.Doc.getAffectedObjects(self.L1))
+    self.L1.Link = L4
+    self.assertEqual(self.Doc.getAffectedObjects(L4), [L4, self.L1, self.L2, self.L3])
+
+    # removed objects are not returned
+    self.L2.Link = None
+    self.L3.Link = L4
+    self.Doc.removeObject(self.L2.Name)
+    affected = self.Doc.getAffectedObjects(L4)
+    self.assertEqual(affected[0], L4)
+    self.assertEqual(set(affected), set([L4, self.L1, self.L3]))
+    self.assertEqual(self.Doc.TopologicalSortedObjects[-1], L4)
+
   def testRecompute(self):
 
     # sequence to test recompute behaviour
@@ -607,6 +697,40 @@ class DocumentRecomputeCases(unittest.TestCase):
     self.Doc.removeObject(L7.Name)
     self.Doc.removeObject(L8.Name)
 
+  def testProfiling(self):
+    # recomputes are captured as nested zones and exported as Chrome trace
+    self.L1.Link = self.L2
+    self.L2.Link = self.L3
+    FreeCAD.startProfiling()
+    self.failUnless(FreeCAD.isProfiling())
+    self.Doc.recompute()
+    self.failUnless(FreeCAD.stopProfiling() >= 4)
+    self.failIf(FreeCAD.isProfiling())
+
+    FileName = tempfile.gettempdir() + os.sep + "ProfileTest.json"
+    FreeCAD.saveProfile(FileName)
+    with open(FileName) as f:
+        trace = json.load(f)
+    os.remove(FileName)
+
+    events = trace["traceEvents"]
+    recompute = [e for e in events if e["name"] == "Document::recompute"]
+    features = [e for e in events if e["name"] == "Document::_recomputeFeature"]
+    self.assertEqual(len(recompute), 1)
+    self.assertEqual(recompute[0]["args"]["detail"], self.Doc.Name)
+    self.assertEqual(set(e["args"]["detail"] for e in features), set(["Label_1", "Label_2", "Label_3"]))
+    for e in features:
+        self.failUnless(recompute[0]["ts"] <= e["ts"])
+        self.failUnless(e["ts"] + e["dur"] <= recompute[0]["ts"] + recompute[0]["dur"])
+
+    # a small buffer keeps the latest events only
+    FreeCAD.startProfiling(2)
+    self.L1.touch()
+    self.L2.touch()
+    self.L3.touch()
+    self.Doc.recompute()
+    self.assertEqual(FreeCAD.stopProfiling(), 2)
+
   def tearDown(self):
     #closing doc
     FreeCAD.closeDocument("RecomputeTests")
@@ -907,6 +1031,137 @@ class UndoRedoCases(unittest.TestCase):
     self.Doc.undo()
     self.failUnless(self.Doc.recompute() >= 0)
 
+  def testUndoDelta(self):
+    self.Doc.UndoMode = 1
+    obj = self.Doc.getObject("Base")
+    values = [float(i) for i in range(10000)]
+    obj.FloatList = values
+
+    # changing one element only records the old value of this element
+    self.Doc.openTransaction("Change")
+    changed = list(values)
+    changed[42] = -1.0
+    obj.FloatList = changed
+    self.Doc.commitTransaction()
+    self.failUnless(self.Doc.UndoRedoMemSize < len(values) * 8)
+
+    self.Doc.undo()
+    self.assertEqual(obj.FloatList, values)
+    self.Doc.redo()
+    self.assertEqual(obj.FloatList, changed)
+
+  def testUndoDeltaChangedOutside(self):
+    self.Doc.UndoMode = 1
+    obj = self.Doc.getObject("Base")
+    values = [float(i) for i in range(10000)]
+    obj.FloatList = values
+
+    self.Doc.openTransaction("Change")
+    changed = list(values)
+    changed[42] = -1.0
+    obj.FloatList = changed
+    self.Doc.commitTransaction()
+
+    # a change outside of a transaction keeps the undo record usable
+    other = list(changed)
+    other[7] = -2.0
+    obj.FloatList = other
+    self.Doc.undo()
+    self.assertEqual(obj.FloatList, values)
+
+  def testUndoDeltaMesh(self):
+    try:
+      import Mesh
+    except ImportError:
+      return
+    self.Doc.UndoMode = 1
+    obj = self.Doc.addObject("Mesh::Feature","Mesh")
+    obj.Mesh = Mesh.createSphere(1.0, 50)
+    points = [p.Vector for p in obj.Mesh.Points]
+
+    # moving a point only records its old position
+    self.Doc.openTransaction("Move")
+    obj.Mesh.setPoint(0, FreeCAD.Vector(0, 0, 2))
+    self.Doc.commitTransaction()
+    moved = [p.Vector for p in obj.Mesh.Points]
+    self.assertEqual(moved[0], FreeCAD.Vector(0, 0, 2))
+    self.failUnless(self.Doc.UndoRedoMemSize < len(points) * 12)
+
+    self.Doc.undo()
+    self.assertEqual([p.Vector for p in obj.Mesh.Points], points)
+    self.Doc.redo()
+    self.assertEqual([p.Vector for p in obj.Mesh.Points], moved)
+
+  def testUndoDeltaPoints(self):
+    try:
+      import Points
+    except ImportError:
+      return
+    self.Doc.UndoMode = 1
+    obj = self.Doc.addObject("Points::Feature","Points")
+    vectors = [FreeCAD.Vector(i, 0.5 * i, 0) for i in range(1000)]
+    obj.Points = Points.Points(vectors)
+
+    # moving a point only records its old position
+    self.Doc.openTransaction("Move")
+    moved = list(vectors)
+    moved[42] = FreeCAD.Vector(0, 0, 1)
+    obj.Points = Points.Points(moved)
+    self.Doc.commitTransaction()
+    self.failUnless(self.Doc.UndoRedoMemSize < len(vectors) * 12)
+
+    self.Doc.undo()
+    self.assertEqual(obj.Points.Points, vectors)
+    self.Doc.redo()
+    self.assertEqual(obj.Points.Points, moved)
+
+  def testUndoDeltaGeometry(self):
+    try:
+      import Part
+    except ImportError:
+      return
+    self.Doc.UndoMode = 1
+    obj = self.Doc.addObject("Part::FeatureGeometrySet","Geometry")
+    obj.GeometrySet = [Part.LineSegment(FreeCAD.Vector(i, 0, 0), FreeCAD.Vector(i, 1, 0)) for i in range(100)]
+    ends = [g.EndPoint for g in obj.GeometrySet]
+
+    # moving the end point of a line only records the old line
+    self.Doc.openTransaction("Move")
+    geometries = obj.GeometrySet
+    geometries[42] = Part.LineSegment(FreeCAD.Vector(42, 0, 0), FreeCAD.Vector(42, 2, 0))
+    obj.GeometrySet = geometries
+    self.Doc.commitTransaction()
+    size = self.Doc.UndoRedoMemSize
+
+    self.Doc.undo()
+    self.assertEqual([g.EndPoint for g in obj.GeometrySet], ends)
+    self.Doc.redo()
+    self.assertEqual(obj.GeometrySet[42].EndPoint, FreeCAD.Vector(42, 2, 0))
+
+    # changing all lines records a full copy
+    self.Doc.clearUndos()
+    self.Doc.openTransaction("Move all")
+    obj.GeometrySet = [Part.LineSegment(FreeCAD.Vector(i, 0, 0), FreeCAD.Vector(i, 3, 0)) for i in range(100)]
+    self.Doc.commitTransaction()
+    self.failUnless(size * 10 < self.Doc.UndoRedoMemSize)
+
+  def testUndoMemoryLimit(self):
+    self.Doc.UndoMode = 1
+    self.Doc.UndoLimit = 200000
+    obj = self.Doc.getObject("Base")
+    for i in range(4):
+      self.Doc.openTransaction("Change%d" % i)
+      obj.FloatList = [float(i)] * 10000
+      self.Doc.commitTransaction()
+
+    # each full copy takes 80 kB, so the oldest transactions are discarded
+    self.assertEqual(self.Doc.UndoCount, 2)
+    self.failUnless(self.Doc.UndoRedoMemSize <= 200000)
+    self.Doc.undo()
+    self.Doc.undo()
+    self.assertEqual(obj.FloatList, [1.0] * 10000)
+    self.assertEqual(self.Doc.UndoCount, 0)
+
   def tearDown(self):
     # closing doc
     FreeCAD.closeDocument("UndoTest")
@@ -1158,6 +1413,30 @@ class DocumentPlatformCases(unittest.TestCase):
 
     self.failUnless(len(self.Doc.Test.VectorList) == 2)
 
+  def testParallelSave(self):
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    threads = param.GetInt("SaveThreads", 0)
+    param.SetInt("SaveThreads", 4)
+    try:
+      floats = [0.5 * i for i in range(10000)]
+      for i in range(8):
+        obj = self.Doc.addObject("App::FeatureTest", "Parallel")
+        obj.FloatList = floats[i:]
+        obj.VectorList = [(i, j, 0.5) for j in range(1000)]
+
+      # saving and restoring
+      self.Doc.saveAs(self.DocName)
+      FreeCAD.closeDocument("PlatformTests")
+      self.Doc = FreeCAD.open(self.DocName)
+    finally:
+      param.SetInt("SaveThreads", threads)
+
+    for i in range(8):
+      obj = self.Doc.getObject("Parallel" + ("%03d" % i if i else ""))
+      self.failUnless(obj.FloatList == floats[i:])
+      self.failUnless(len(obj.VectorList) == 1000)
+      self.failUnless(obj.VectorList[999] == FreeCAD.Vector(i, 999, 0.5))
+
   def testPoints(self):
     try:
       self.Doc.addObject("Points::Feature", "Points")
@@ -1407,6 +1686,54 @@ class DocumentExpressionCases(unittest.TestCase):
     # must not raise a topological error
     self.assertEqual(self.Doc.recompute(), 2)
 
+  def _evalExpressions(self, compile):
+    self.param.SetBool("CompileExpressions", compile)
+    self.Obj2.touch()
+    self.Doc.recompute()
+
+  def testCompiledExpression(self):
+    self.param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Expression")
+    name = self.Obj1.Name
+    exprs = {
+      'Float': '{0}.Float * 2 + {0}.Integer / 4',
+      'Integer': '{0}.Integer % 7 + 2 ^ 3 - -{0}.Bool',
+      'Distance': '{0}.Distance * 2 + 1 mm',
+      'Angle': 'atan2({0}.Distance; 3 mm)',
+      'ConstraintFloat': '{0}.Bool ? hypot({0}.Float; 3) / 1 : -1',
+      'ConstraintInt': '{0}.Placement.Base.x / 1 mm + 2',
+      'String': '{0}.String',
+    }
+    for prop, expr in exprs.items():
+      self.Obj2.setExpression(prop, expr.format(name))
+    self.Obj1.Placement = FreeCAD.Placement(FreeCAD.Vector(3,0,0),FreeCAD.Rotation())
+    self.Obj1.String = "compiled"
+
+    try:
+      self._evalExpressions(False)
+      values = [getattr(self.Obj2, prop) for prop in exprs]
+      self._evalExpressions(True)
+      for prop, value in zip(exprs, values):
+        self.assertEqual(getattr(self.Obj2, prop), value, prop)
+
+      # mixing units is an error either way
+      self.Obj2.setExpression('Distance', '{0}.Distance + 1'.format(name))
+      self.Doc.recompute()
+      self.assertFalse(self.Obj2.isValid())
+      self.Obj2.setExpression('Distance', None)
+
+      # both branches of a condition give the same results
+      self.Obj1.Float = 2.0
+      for i in range(20):
+        prop = 'V%d' % i
+        self.Obj2.addProperty("App::PropertyFloat", prop)
+        self.Obj2.setExpression(prop, '({0}.Float + {1}) * 2 > 10 ? sqrt({0}.Float * {1}) : {0}.Integer / 3'.format(name, i))
+      self._evalExpressions(False)
+      values = [getattr(self.Obj2, 'V%d' % i) for i in range(20)]
+      self._evalExpressions(True)
+      self.assertEqual([getattr(self.Obj2, 'V%d' % i) for i in range(20)], values)
+    finally:
+      self.param.RemBool("CompileExpressions")
+
   def tearDown(self):
     #closing doc
     FreeCAD.closeDocument(self.Doc.Name)
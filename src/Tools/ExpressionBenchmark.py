@@ -0,0 +1,70 @@
+#! python
+# -*- coding: utf-8 -*-
+# Compares the recompute time of expression bindings evaluated by
+# Expression::eval() with the compiled evaluation of PropertyExpressionEngine.
+#
+# Usage: FreeCADCmd ExpressionBenchmark.py [bindings] [runs]
+
+import sys, os, time
+import FreeCAD
+
+def arguments():
+    args = []
+    for i, arg in enumerate(sys.argv):
+        if os.path.basename(arg) == "ExpressionBenchmark.py":
+            args = sys.argv[i+1:]
+            break
+    bindings = int(args[0]) if len(args) > 0 else 2000
+    runs = int(args[1]) if len(args) > 1 else 10
+    return bindings, runs
+
+def createDocument(bindings):
+    doc = FreeCAD.newDocument("ExpressionBenchmark")
+    source = doc.addObject("App::FeatureTest", "Source")
+    source.Float = 2.0
+    source.Integer = 7
+    target = doc.addObject("App::FeatureTest", "Target")
+    for i in range(bindings):
+        prop = 'V%d' % i
+        target.addProperty("App::PropertyFloat", prop)
+        target.setExpression(prop, '(Source.Float + {0}) * 2 > 10 ? '
+                             'sqrt(Source.Float * {0}) + abs(Source.Integer - {0}) : '
+                             'Source.Integer / 3 + Source.Float ^ 2'.format(i))
+    doc.recompute()
+    return doc, target
+
+def measure(doc, target, compile, runs):
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Expression")
+    param.SetBool("CompileExpressions", compile)
+    # the first recompute compiles the bindings
+    target.touch()
+    doc.recompute()
+    start = time.time()
+    for i in range(runs):
+        target.touch()
+        doc.recompute()
+    return time.time() - start
+
+def values(target, bindings):
+    return [getattr(target, 'V%d' % i) for i in range(bindings)]
+
+def main():
+    bindings, runs = arguments()
+    doc, target = createDocument(bindings)
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Expression")
+    try:
+        uncompiled = measure(doc, target, False, runs)
+        expected = values(target, bindings)
+        compiled = measure(doc, target, True, runs)
+        if values(target, bindings) != expected:
+            FreeCAD.Console.PrintError("The results differ\n")
+    finally:
+        param.RemBool("CompileExpressions")
+        FreeCAD.closeDocument(doc.Name)
+
+    FreeCAD.Console.PrintMessage("Bindings: %d, recomputes: %d\n" % (bindings, runs))
+    FreeCAD.Console.PrintMessage("Uncompiled: %.3f s\n" % uncompiled)
+    FreeCAD.Console.PrintMessage("Compiled:   %.3f s\n" % compiled)
+    FreeCAD.Console.PrintMessage("Speed-up:   %.2f\n" % (uncompiled / compiled))
+
+main()
@@ -55,6 +55,11 @@ void ZipOutputStream::putNextEntry(const std::string& entryName) {
   putNextEntry( ZipCDirEntry(entryName));
 }
 
+void ZipOutputStream::putCompressedEntry( const std::string& entryName, const char *data,
+                                          uint32 compressed_size, uint32 size, uint32 crc ) {
+  ozf->putCompressedEntry( ZipCDirEntry(entryName), data, compressed_size, size, crc ) ;
+}
+
 
 void ZipOutputStream::setComment( const std::string &comment ) {
   ozf->setComment( comment ) ;
@@ -49,6 +49,16 @@ public:
       entry. */
   void putNextEntry( const ZipCDirEntry &entry ) ;
 
+  /** Writes a complete entry whose data has already been compressed
+      elsewhere, e.g. in another thread. The current entry is closed first.
+      @param entry the entry to write.
+      @param data the raw deflate stream (without zlib header) of the entry.
+      @param compressed_size the size of data in bytes.
+      @param size the size of the uncompressed data in bytes.
+      @param crc the CRC32 of the uncompressed data. */
+  void putCompressedEntry( const ZipCDirEntry &entry, const char *data,
+                           uint32 compressed_size, uint32 size, uint32 crc ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const string &comment ) ;
 
@@ -68,6 +78,7 @@ protected:
 
   void setEntryClosedState() ;
   void updateEntryHeaderInfo() ;
+  static int currentDosTime() ;
 
   // Should/could be moved to zipheadio.h ?!
   static void writeCentralDirectory( const vector< ZipCDirEntry > &entries, 